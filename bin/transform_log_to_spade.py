@@ -17,6 +17,7 @@
 # You should have received a copy of the GNU General Public License
 # along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
+# NOTE: 'ameba-convert' (src/utils/convert) does the same conversion natively and much faster.
 
 
 import argparse
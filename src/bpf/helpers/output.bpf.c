@@ -31,103 +31,264 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 struct
 {
     __uint(type, BPF_MAP_TYPE_RINGBUF);
-    __uint(max_entries, 1 << 12);
+    __uint(max_entries, OUTPUT_RINGBUF_SIZE);
 } ameba_output_ringbuf SEC(".maps");
 // NOTE: Update 'OUTPUT_RINGBUF_MAP_NAME' on 'constants.h' when ameba_output_ringbuf updated.
 
+struct output_percpu_ringbuf
+{
+    __uint(type, BPF_MAP_TYPE_RINGBUF);
+    __uint(max_entries, OUTPUT_RINGBUF_SIZE);
+};
+
+/*
+    Index is the CPU id. Empty unless the user space sets a ringbuf for each CPU
+    (and resizes this map to the number of CPUs) before attaching.
+*/
+struct
+{
+    __uint(type, BPF_MAP_TYPE_ARRAY_OF_MAPS);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __array(values, struct output_percpu_ringbuf);
+} ameba_output_percpu_ringbufs SEC(".maps");
+// NOTE: Update 'OUTPUT_PERCPU_RINGBUFS_MAP_NAME' on 'constants.h' when ameba_output_percpu_ringbufs updated.
+
+
+struct
+{
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, OUTPUT_DROPS_MAP_SIZE);
+    __type(key, __u32);
+    __type(value, __u64);
+} ameba_output_drops SEC(".maps");
+// NOTE: Update 'OUTPUT_DROPS_MAP_NAME' on 'constants.h' when ameba_output_drops updated.
+
+
+struct
+{
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, struct output_config);
+} ameba_output_config SEC(".maps");
+// NOTE: Update 'OUTPUT_CONFIG_MAP_NAME' on 'constants.h' when ameba_output_config updated.
+
+
+static __always_inline void count_drop(record_type_t record_type)
+{
+    __u32 key = record_type;
+    __u64 *count = bpf_map_lookup_elem(&ameba_output_drops, &key);
+    if (count)
+        *count += 1;
+}
+
+/*
+    Wake up the consumer only once the pending data in the ringbuf reaches the
+    wakeup watermark so that a batch of records is consumed per wakeup instead of one.
+*/
+static __always_inline __u64 get_wakeup_flags(void *ringbuf)
+{
+    __u32 key = 0;
+    __u64 watermark;
+    struct output_config *config = bpf_map_lookup_elem(&ameba_output_config, &key);
+    if (config)
+        watermark = config->wakeup_watermark;
+    else
+        watermark = bpf_ringbuf_query(ringbuf, BPF_RB_RING_SIZE) / OUTPUT_RINGBUF_WAKEUP_DIVISOR;
+
+    if (watermark == 0)
+        return 0;
+    if (bpf_ringbuf_query(ringbuf, BPF_RB_AVAIL_DATA) >= watermark)
+        return BPF_RB_FORCE_WAKEUP;
+    return BPF_RB_NO_WAKEUP;
+}
+
+/*
+    Output to the ringbuf of the current CPU if set, otherwise to the shared ringbuf.
+    Count the record as dropped on failure.
+*/
+static __always_inline long output_record(void *ptr, __u64 size, record_type_t record_type)
+{
+    long ret;
+    __u32 cpu = bpf_get_smp_processor_id();
+    void *percpu_ringbuf = bpf_map_lookup_elem(&ameba_output_percpu_ringbufs, &cpu);
+    // 'bpf_ringbuf_output' reserves, copies and submits in a single helper call.
+    if (percpu_ringbuf)
+        ret = bpf_ringbuf_output(percpu_ringbuf, ptr, size, get_wakeup_flags(percpu_ringbuf));
+    else
+        ret = bpf_ringbuf_output(&ameba_output_ringbuf, ptr, size, get_wakeup_flags(&ameba_output_ringbuf));
+    if (ret != 0)
+        count_drop(record_type);
+    return ret;
+}
+
+/*
+    Size of the compact form of the sockaddr. 0 if no sockaddr.
+*/
+static __always_inline __u32 get_compact_sockaddr_size(struct elem_sockaddr *e_sa)
+{
+    if (!e_sa)
+        return 0;
+    __u32 addrlen = e_sa->addrlen;
+    if (addrlen > SOCKADDR_MAX_SIZE)
+        addrlen = SOCKADDR_MAX_SIZE;
+    return sizeof(struct elem_sockaddr_compact) + addrlen;
+}
+
+/*
+    Write the sockaddr at 'offset' in the dynptr as 'struct elem_sockaddr_compact'
+    followed by its bytes.
+
+    Return:
+        See 'bpf_dynptr_write'.
+*/
+static __always_inline long write_compact_sockaddr(struct bpf_dynptr *dynptr, __u32 offset, struct elem_sockaddr *e_sa)
+{
+    struct elem_sockaddr_compact header;
+    __u32 addrlen = e_sa->addrlen;
+    if (addrlen > SOCKADDR_MAX_SIZE)
+        addrlen = SOCKADDR_MAX_SIZE;
+
+    header.family = *((unsigned short *)&(e_sa->addr[0]));
+    header.byte_order = (unsigned char)e_sa->byte_order;
+    header.addrlen = (unsigned char)addrlen;
+
+    long ret = bpf_dynptr_write(dynptr, offset, &header, sizeof(header), 0);
+    if (ret != 0)
+        return ret;
+    return bpf_dynptr_write(dynptr, offset + sizeof(header), &(e_sa->addr[0]), addrlen, 0);
+}
+
+/*
+    Write the record in compact form (see 'record_compact_prefix_size_t') into space
+    reserved in the ringbuf and submit it. 'remote' is NULL for records without it.
+
+    Return:
+        0 on success, otherwise the error from reserving or writing.
+*/
+static __always_inline long output_compact_to_ringbuf(
+    void *ringbuf, void *ptr, __u32 prefix_size,
+    struct elem_sockaddr *local, struct elem_sockaddr *remote
+)
+{
+    struct bpf_dynptr dynptr;
+    __u32 local_size = get_compact_sockaddr_size(local);
+    __u32 size = prefix_size + local_size + get_compact_sockaddr_size(remote);
+
+    long ret = bpf_ringbuf_reserve_dynptr(ringbuf, size, 0, &dynptr);
+    if (ret != 0)
+        goto discard;
+    ret = bpf_dynptr_write(&dynptr, 0, ptr, prefix_size, 0);
+    if (ret != 0)
+        goto discard;
+    ret = write_compact_sockaddr(&dynptr, prefix_size, local);
+    if (ret != 0)
+        goto discard;
+    if (remote)
+    {
+        ret = write_compact_sockaddr(&dynptr, prefix_size + local_size, remote);
+        if (ret != 0)
+            goto discard;
+    }
+    bpf_ringbuf_submit_dynptr(&dynptr, get_wakeup_flags(ringbuf));
+    return 0;
+
+discard:
+    // The dynptr must be released even if the reserve failed.
+    bpf_ringbuf_discard_dynptr(&dynptr, BPF_RB_NO_WAKEUP);
+    return ret;
+}
+
+/*
+    Same as 'output_record' but for records with sockaddrs which are written in compact form.
+*/
+static __always_inline long output_compact_record(
+    void *ptr, __u32 prefix_size,
+    struct elem_sockaddr *local, struct elem_sockaddr *remote,
+    record_type_t record_type
+)
+{
+    long ret;
+    __u32 cpu = bpf_get_smp_processor_id();
+    void *percpu_ringbuf = bpf_map_lookup_elem(&ameba_output_percpu_ringbufs, &cpu);
+    if (percpu_ringbuf)
+        ret = output_compact_to_ringbuf(percpu_ringbuf, ptr, prefix_size, local, remote);
+    else
+        ret = output_compact_to_ringbuf(&ameba_output_ringbuf, ptr, prefix_size, local, remote);
+    if (ret != 0)
+        count_drop(record_type);
+    return ret;
+}
+
 
 long output_record_cred(struct record_cred *ptr)
 {
     if (!ptr)
         return -1;
-    return bpf_ringbuf_output(&ameba_output_ringbuf, ptr, RECORD_SIZE_CRED, 0);
+    return output_record(ptr, RECORD_SIZE_CRED, RECORD_TYPE_CRED);
 }
 
 long output_record_namespace(struct record_namespace *ptr)
 {
     if (!ptr)
         return -1;
-    return bpf_ringbuf_output(&ameba_output_ringbuf, ptr, RECORD_SIZE_NAMESPACE, 0);
+    return output_record(ptr, RECORD_SIZE_NAMESPACE, RECORD_TYPE_NAMESPACE);
 }
 
 long output_record_new_process(struct record_new_process *ptr)
 {
     if (!ptr)
         return -1;
-    return bpf_ringbuf_output(&ameba_output_ringbuf, ptr, RECORD_SIZE_NEW_PROCESS, 0);
+    return output_record(ptr, RECORD_SIZE_NEW_PROCESS, RECORD_TYPE_NEW_PROCESS);
 }
 
 long output_record_accept(struct record_accept *ptr)
 {
     if (!ptr)
         return -1;
-    return bpf_ringbuf_output(&ameba_output_ringbuf, ptr, RECORD_SIZE_ACCEPT, 0);
+    return output_compact_record(
+        ptr, RECORD_COMPACT_PREFIX_SIZE_ACCEPT, &(ptr->local), &(ptr->remote), RECORD_TYPE_ACCEPT
+    );
 }
 
 long output_record_bind(struct record_bind *ptr)
 {
     if (!ptr)
         return -1;
-    return bpf_ringbuf_output(&ameba_output_ringbuf, ptr, RECORD_SIZE_BIND, 0);
+    return output_compact_record(
+        ptr, RECORD_COMPACT_PREFIX_SIZE_BIND, &(ptr->local), NULL, RECORD_TYPE_BIND
+    );
 }
 
 long output_record_kill(struct record_kill *ptr)
 {
     if (!ptr)
         return -1;
-    return bpf_ringbuf_output(&ameba_output_ringbuf, ptr, RECORD_SIZE_KILL, 0);
+    return output_record(ptr, RECORD_SIZE_KILL, RECORD_TYPE_KILL);
 }
 
 long output_record_send_recv(struct record_send_recv *ptr)
 {
     if (!ptr)
         return -1;
-    return bpf_ringbuf_output(&ameba_output_ringbuf, ptr, RECORD_SIZE_SEND_RECV, 0);
+    return output_compact_record(
+        ptr, RECORD_COMPACT_PREFIX_SIZE_SEND_RECV, &(ptr->local), &(ptr->remote), RECORD_TYPE_SEND_RECV
+    );
 }
 
 long output_record_connect(struct record_connect *ptr)
 {
     if (!ptr)
         return -1;
-    return bpf_ringbuf_output(&ameba_output_ringbuf, ptr, RECORD_SIZE_CONNECT, 0);
+    return output_compact_record(
+        ptr, RECORD_COMPACT_PREFIX_SIZE_CONNECT, &(ptr->local), &(ptr->remote), RECORD_TYPE_CONNECT
+    );
 }
 
 long output_record_audit_log_exit(struct record_audit_log_exit *ptr)
 {
     if (!ptr)
         return -1;
-    return bpf_ringbuf_output(&ameba_output_ringbuf, ptr, RECORD_SIZE_AUDIT_LOG_EXIT, 0);
-}
-
-// long output_record_as_dynptr(struct bpf_dynptr *ptr, record_type_t record_type){
-//     if (!ptr)
-//         return 0;
-//     void *data = NULL;
-//     size_t size = 0;
-//     switch(record_type)
-//     {
-//         case RECORD_TYPE_CONNECT:
-//             size = RECORD_SIZE_CONNECT;
-//             data = bpf_dynptr_data(ptr, 0, RECORD_SIZE_CONNECT);
-//             break;
-//         case RECORD_TYPE_ACCEPT:
-//             size = RECORD_SIZE_ACCEPT;
-//             data = bpf_dynptr_data(ptr, 0, RECORD_SIZE_ACCEPT);
-//             break;
-//         case RECORD_TYPE_NAMESPACE:
-//             size = RECORD_SIZE_NAMESPACE;
-//             data = bpf_dynptr_data(ptr, 0, RECORD_SIZE_NAMESPACE);
-//             break;
-//         case RECORD_TYPE_NEW_PROCESS:
-//             size = RECORD_SIZE_NEW_PROCESS;
-//             data = bpf_dynptr_data(ptr, 0, RECORD_SIZE_NEW_PROCESS);
-//             break;
-//         default: break;
-//     }
-//     if (data){
-//         return bpf_ringbuf_output(&ameba_output_ringbuf, data, size, 0);
-//     } else {
-//         LOG_WARN("Unknown record to output ring buffer. Type = %d", record_type);
-//         return 0;
-//     }
-// }
+    return output_record(ptr, RECORD_SIZE_AUDIT_LOG_EXIT, RECORD_TYPE_AUDIT_LOG_EXIT);
+}
@@ -31,7 +31,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
     Write record_cred to output ring buffer.
 
     Return:
-        See 'bpf_ringbuf_output'.
+        0 on success, otherwise non-zero and the record is counted as dropped.
 */
 long output_record_cred(struct record_cred *ptr);
 
@@ -39,7 +39,7 @@ long output_record_cred(struct record_cred *ptr);
     Write record_namespace to output ring buffer.
 
     Return:
-        See 'bpf_ringbuf_output'.
+        0 on success, otherwise non-zero and the record is counted as dropped.
 */
 long output_record_namespace(struct record_namespace *ptr);
 
@@ -47,23 +47,23 @@ long output_record_namespace(struct record_namespace *ptr);
     Write record_new_process to output ring buffer.
 
     Return:
-        See 'bpf_ringbuf_output'.
+        0 on success, otherwise non-zero and the record is counted as dropped.
 */
 long output_record_new_process(struct record_new_process *ptr);
 
 /*
-    Write record_accept to output ring buffer.
+    Write record_accept to output ring buffer in compact form. See 'record_compact_prefix_size_t'.
 
     Return:
-        See 'bpf_ringbuf_output'.
+        0 on success, otherwise non-zero and the record is counted as dropped.
 */
 long output_record_accept(struct record_accept *ptr);
 
 /*
-    Write record_bind to output ring buffer.
+    Write record_bind to output ring buffer in compact form. See 'record_compact_prefix_size_t'.
 
     Return:
-        See 'bpf_ringbuf_output'.
+        0 on success, otherwise non-zero and the record is counted as dropped.
 */
 long output_record_bind(struct record_bind *ptr);
 
@@ -71,23 +71,23 @@ long output_record_bind(struct record_bind *ptr);
     Write record_kill to output ring buffer.
 
     Return:
-        See 'bpf_ringbuf_output'.
+        0 on success, otherwise non-zero and the record is counted as dropped.
 */
 long output_record_kill(struct record_kill *ptr);
 
 /*
-    Write record_send_recv to output ring buffer.
+    Write record_send_recv to output ring buffer in compact form. See 'record_compact_prefix_size_t'.
 
     Return:
-        See 'bpf_ringbuf_output'.
+        0 on success, otherwise non-zero and the record is counted as dropped.
 */
 long output_record_send_recv(struct record_send_recv *ptr);
 
 /*
-    Write record_connect to output ring buffer.
+    Write record_connect to output ring buffer in compact form. See 'record_compact_prefix_size_t'.
 
     Return:
-        See 'bpf_ringbuf_output'.
+        0 on success, otherwise non-zero and the record is counted as dropped.
 */
 long output_record_connect(struct record_connect *ptr);
 
@@ -95,7 +95,7 @@ long output_record_connect(struct record_connect *ptr);
     Write record_audit_log_exit to output ring buffer.
 
     Return:
-        See 'bpf_ringbuf_output'.
+        0 on success, otherwise non-zero and the record is counted as dropped.
 */
 long output_record_audit_log_exit(struct record_audit_log_exit *ptr);
 // long output_record_as_dynptr(struct bpf_dynptr *ptr, record_type_t record_type);
\ No newline at end of file
@@ -31,6 +31,25 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 // Name of the BPF ringbuf where all records are written to.
 #define OUTPUT_RINGBUF_MAP_NAME "ameba_output_ringbuf"
+// Name of the BPF array of per-CPU ringbufs. Records are written to the ringbuf
+// of the current CPU instead of 'OUTPUT_RINGBUF_MAP_NAME' if one is set.
+#define OUTPUT_PERCPU_RINGBUFS_MAP_NAME "ameba_output_percpu_ringbufs"
+// Name of the BPF per-CPU array counting the records that could not be written
+// to a ringbuf. Index is record_type_t.
+#define OUTPUT_DROPS_MAP_NAME "ameba_output_drops"
+// Entries in 'OUTPUT_DROPS_MAP_NAME'. Must be greater than the max record_type_t.
+#define OUTPUT_DROPS_MAP_SIZE 16
+// Size (bytes) of each ringbuf when loaded. The user space resizes them before load.
+#define OUTPUT_RINGBUF_SIZE (1 << 12)
+// Name of the BPF array holding the 'struct output_config' set by the user space.
+#define OUTPUT_CONFIG_MAP_NAME "ameba_output_config"
+// Records are submitted without waking up the consumer until the unconsumed data
+// in a ringbuf reaches the wakeup watermark. Default watermark is
+// 1/OUTPUT_RINGBUF_WAKEUP_DIVISOR of the ringbuf size.
+#define OUTPUT_RINGBUF_WAKEUP_DIVISOR 8
+// Default max time (ms) the user space waits on the ringbufs before consuming them
+// without a wakeup. Bounds the latency of records submitted without a wakeup.
+#define OUTPUT_RINGBUF_MAX_POLL_LATENCY_MS 100
 
 // Sockaddr max size in kernel.
 #define SOCKADDR_MAX_SIZE 128
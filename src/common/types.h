@@ -29,10 +29,14 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "common/constants.h"
 
 
-#define RECORD_VERSION_MAJOR 1
+#define RECORD_VERSION_MAJOR 2
 #define RECORD_VERSION_MINOR 0
 #define RECORD_VERSION_PATCH 0
 
+// First major version in which the sockaddrs of records are written as
+// 'struct elem_sockaddr_compact'. See 'record_compact_prefix_size_t'.
+#define RECORD_VERSION_MAJOR_COMPACT_SOCKADDR 2
+
 
 // scalar typedefs
 typedef int magic_t;
@@ -123,6 +127,17 @@ struct elem_sockaddr
     byte_order_t byte_order;
 };
 
+/*
+    Compact form of 'struct elem_sockaddr'. Followed by 'addrlen' bytes of the
+    sockaddr (starting with its family) instead of SOCKADDR_MAX_SIZE bytes.
+*/
+struct elem_sockaddr_compact
+{
+    unsigned short family;
+    unsigned char byte_order;
+    unsigned char addrlen;
+};
+
 struct elem_las_timestamp
 {
     unsigned long event_id;
@@ -255,4 +270,29 @@ typedef enum {
     RECORD_SIZE_BIND = sizeof(struct record_bind),
     RECORD_SIZE_KILL = sizeof(struct record_kill),
     RECORD_SIZE_AUDIT_LOG_EXIT = sizeof(struct record_audit_log_exit)
-} record_size_t;
\ No newline at end of file
+} record_size_t;
+
+/*
+    Records with sockaddrs are written in compact form when the record version major is
+    at least RECORD_VERSION_MAJOR_COMPACT_SOCKADDR. The compact form is:
+        1. The first 'RECORD_COMPACT_PREFIX_SIZE_*' bytes of the record struct i.e. all
+           members before 'local'.
+        2. 'local' as 'struct elem_sockaddr_compact' followed by its bytes.
+        3. 'remote' (if the record has it) as 'struct elem_sockaddr_compact' followed
+           by its bytes.
+*/
+typedef enum {
+    RECORD_COMPACT_PREFIX_SIZE_CONNECT = __builtin_offsetof(struct record_connect, local),
+    RECORD_COMPACT_PREFIX_SIZE_ACCEPT = __builtin_offsetof(struct record_accept, local),
+    RECORD_COMPACT_PREFIX_SIZE_SEND_RECV = __builtin_offsetof(struct record_send_recv, local),
+    RECORD_COMPACT_PREFIX_SIZE_BIND = __builtin_offsetof(struct record_bind, local)
+} record_compact_prefix_size_t;
+
+/*
+    Output settings set by the user space in 'OUTPUT_CONFIG_MAP_NAME' before attach.
+*/
+struct output_config
+{
+    // Pending bytes in a ringbuf at which the consumer is woken up. 0 => Every record.
+    unsigned long long wakeup_watermark;
+};
\ No newline at end of file
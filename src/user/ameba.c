@@ -30,6 +30,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <dirent.h>
 #include <time.h>
 #include <signal.h>
+#include <errno.h>
+#include <limits.h>
 #include <sys/types.h>
 
 #include "common/types.h"
@@ -40,207 +42,1608 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "user/jsonify/control.h"
 #include "user/jsonify/user.h"
 #include "user/jsonify/types.h"
+#include "user/jsonify/stats.h"
 #include "common/constants.h"
 #include "user/error.h"
 
 #include "user/record/serializer/serializer.h"
 #include "user/record/writer/writer.h"
+#include "user/record/writer/columnar.h"
+#include "user/record/writer/compress.h"
+#include "user/record/writer/net.h"
+#include "user/record/writer/rotate.h"
+#include "user/record/writer/spill.h"
+#include "user/record/writer/shm.h"
+#include "user/record/writer/tcp.h"
+#include "user/record/writer/unix.h"
+#include "user/pipeline/pipeline.h"
+#include "user/fanout/fanout.h"
 
 #include "user/helpers/log.h"
+#include "user/helpers/cpu.h"
 
 #include "ameba.skel.h"
 
 //
 
 extern const struct record_serializer record_serializer_json;
+extern const struct record_serializer record_serializer_binary;
+extern const struct record_serializer record_serializer_cbor;
 extern const struct record_writer record_writer_file;
+extern const struct record_writer record_writer_file_uring;
 extern const struct record_writer record_writer_net;
+extern const struct record_writer record_writer_tcp;
+extern const struct record_writer record_writer_unix;
+extern const struct record_writer record_writer_shm;
+extern const struct record_writer record_writer_columnar;
+extern const struct record_writer record_writer_compress;
+extern const struct record_writer record_writer_rotate;
+extern const struct record_writer record_writer_spill;
 
 //
 
-static const struct record_serializer *default_record_serializer;
-static const struct record_writer *default_record_writer;
+/*
+    An output, the serializer of its format, and its writers.
+*/
+struct output_sink_writer
+{
+    struct user_input *input;
+    struct output_sink sink;
+    const struct record_serializer *serializer;
+    // The outermost writer.
+    const struct record_writer *writer;
+    /*
+        The writer of the output itself i.e. the innermost writer behind
+        'writer'.
+    */
+    const struct record_writer *output_writer;
+};
+
+/*
+    One per output in 'user_input.sinks'. The records are written to the
+    first one directly unless there are more (see 'fanned_out').
+*/
+static struct output_sink_writer sink_writers[MAX_OUTPUT_SINKS];
+static int sink_writers_len = 0;
+
+//
+
+static struct ameba *skel = NULL;
+
+/*
+    Set by the signal handler to stop the main loop. Everything else needed for
+    a clean shutdown (i.e. draining the ring buffer, flushing and closing the
+    writer) is done in 'main' since it is not async-signal-safe.
+*/
+static volatile sig_atomic_t exit_signal_received = 0;
+
+//
+
+/*
+    State of a ring buffer consumer.
+
+    The buffer used for serializing the records is allocated once in
+    'init_ringbuf_consumer' and reused for every record. Therefore, the consume
+    path does not do any heap allocations.
+
+    'output_lock' serializes the access to the writer (or the pipeline) when
+    there are multiple consumers. NULL otherwise.
+*/
+struct ringbuf_consumer
+{
+    char *dst;
+    size_t dst_len;
+    struct consumer_stats stats;
+    pthread_mutex_t *output_lock;
+};
+
+/*
+    A set of ring buffers consumed by a single thread.
+
+    Group 0 is consumed by the main thread. The others by their own threads.
+*/
+struct ringbuf_group
+{
+    struct ring_buffer *ringbuf;
+    struct ringbuf_consumer consumer;
+    int numa_node;
+    pthread_t thread;
+    int thread_started;
+    // Set if the stats are reported from this group's thread.
+    struct stats_config *stats_config;
+};
+
+static struct ringbuf_group *ringbuf_groups = NULL;
+static int ringbuf_groups_len = 0;
+
+static pthread_mutex_t ringbuf_output_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+    File descriptors of the per-CPU ring buffers. Index is the CPU id.
+*/
+static int *percpu_ringbuf_fds = NULL;
+static int percpu_ringbuf_fds_len = 0;
+
+/*
+    Ring buffer used as the template for the per-CPU ring buffers map. Only
+    needed until load.
+*/
+static int percpu_ringbuf_template_fd = -1;
+
+/*
+    If 'pipelined' is set then records are only copied into 'default_pipeline'
+    which serializes and writes them on its own threads.
+*/
+static int pipelined = 0;
+static struct pipeline default_pipeline;
+static struct consumer_stats pipeline_stats;
+
+/*
+    If 'fanned_out' is set then records are serialized once per format into
+    'default_fanout' which writes them to every output on its own threads.
+*/
+static int fanned_out = 0;
+static struct fanout default_fanout;
+static struct consumer_stats fanout_stats;
+
+/*
+    Set to stop the consumer threads when the main thread stops consuming.
+*/
+static volatile int stop_consuming = 0;
+
+// Max time a consumer thread waits before checking 'stop_consuming'.
+#define CONSUMER_THREAD_POLL_TIMEOUT_MS OUTPUT_RINGBUF_MAX_POLL_LATENCY_MS
+
+//
+
+static struct net_writer_args output_net_args;
+static struct tcp_writer_args output_tcp_args;
+static struct unix_writer_args output_unix_args;
+static struct shm_writer_args output_shm_args;
+
+/*
+    Serialize the header of the records (if any) for a writer that keeps it
+    apart from the records. The serializer must be selected.
+
+    Return:
+        0  => Success. 'header_len' is 0 if there is no header
+        -1 => Error
+*/
+static int serialize_record_header(
+    struct output_sink_writer *sw, char *header, size_t header_size, size_t *header_len
+)
+{
+    *header_len = 0;
+    if (sw->serializer->serialize_header)
+    {
+        long len = sw->serializer->serialize_header(header, header_size);
+        if (len <= 0)
+            return -1;
+        *header_len = (size_t)len;
+    }
+    return 0;
+}
+
+/*
+    Set the init args of the UDP writer. The serializer must be selected.
+
+    Return:
+        0  => Success
+        -1 => Error
+*/
+static int init_net_writer_args(struct output_sink_writer *sw)
+{
+    memset(&output_net_args, 0, sizeof(output_net_args));
+    output_net_args.output = sw->input->output_net;
+
+    // The header starts every datagram.
+    return serialize_record_header(
+        sw, output_net_args.header, sizeof(output_net_args.header), &output_net_args.header_len
+    );
+}
+
+/*
+    Set the init args of the TCP writer. The serializer must be selected.
+
+    Return:
+        0  => Success
+        -1 => Error
+*/
+static int init_tcp_writer_args(struct output_sink_writer *sw)
+{
+    memset(&output_tcp_args, 0, sizeof(output_tcp_args));
+    output_tcp_args.output = sw->input->output_tcp;
+
+    // The header is sent at the start of every connection.
+    struct output_compression *c = &(output_tcp_args.output.compression);
+    if (c->codec == OUTPUT_COMPRESSION_NONE)
+        return serialize_record_header(
+            sw, output_tcp_args.header, sizeof(output_tcp_args.header), &output_tcp_args.header_len
+        );
+
+    // Compressed into a frame of its own, like the blocks of records that follow it.
+    char header[RECORD_SERIALIZER_MAX_HEADER_LEN];
+    size_t header_len;
+    if (serialize_record_header(sw, header, sizeof(header), &header_len) != 0)
+        return -1;
+    if (header_len == 0)
+        return 0;
+    long len = record_writer_compress_frame(
+        c, header, header_len, output_tcp_args.header, sizeof(output_tcp_args.header)
+    );
+    if (len < 0)
+        return -1;
+    output_tcp_args.header_len = (size_t)len;
+    return 0;
+}
+
+/*
+    Set the init args of the unix socket writer. The serializer must be selected.
+
+    Return:
+        0  => Success
+        -1 => Error
+*/
+static int init_unix_writer_args(struct output_sink_writer *sw)
+{
+    memset(&output_unix_args, 0, sizeof(output_unix_args));
+    output_unix_args.output = sw->input->output_unix;
+
+    // The header is sent at the start of every connection.
+    return serialize_record_header(
+        sw, output_unix_args.header, sizeof(output_unix_args.header), &output_unix_args.header_len
+    );
+}
+
+/*
+    Set the init args of the shared-memory writer. The serializer must be selected.
+
+    Return:
+        0  => Success
+        -1 => Error
+*/
+static int init_shm_writer_args(struct output_sink_writer *sw)
+{
+    memset(&output_shm_args, 0, sizeof(output_shm_args));
+    output_shm_args.output = sw->input->output_shm;
+
+    // The header is kept in the ring header, so every entry is a record.
+    return serialize_record_header(
+        sw, output_shm_args.header, sizeof(output_shm_args.header), &output_shm_args.header_len
+    );
+}
+
+static int select_output_writer(
+    struct output_sink_writer *sw,
+    void **o_writer_args_ptr,
+    size_t *o_writer_args_ptr_size
+)
+{
+    struct user_input *input = sw->input;
+    switch (sw->sink.o_type)
+    {
+        case OUTPUT_FILE:
+            *o_writer_args_ptr = &(input->output_file);
+            *o_writer_args_ptr_size = sizeof(input->output_file);
+            if (input->output_file.engine == OUTPUT_FILE_ENGINE_URING)
+                sw->output_writer = &record_writer_file_uring;
+            else
+                sw->output_writer = &record_writer_file;
+            return 0;
+        case OUTPUT_NET:
+            if (init_net_writer_args(sw) != 0)
+                return 1;
+            *o_writer_args_ptr = &output_net_args;
+            *o_writer_args_ptr_size = sizeof(output_net_args);
+            sw->output_writer = &record_writer_net;
+            return 0;
+        case OUTPUT_TCP:
+            if (init_tcp_writer_args(sw) != 0)
+                return 1;
+            *o_writer_args_ptr = &output_tcp_args;
+            *o_writer_args_ptr_size = sizeof(output_tcp_args);
+            sw->output_writer = &record_writer_tcp;
+            return 0;
+        case OUTPUT_UNIX:
+            if (init_unix_writer_args(sw) != 0)
+                return 1;
+            *o_writer_args_ptr = &output_unix_args;
+            *o_writer_args_ptr_size = sizeof(output_unix_args);
+            sw->output_writer = &record_writer_unix;
+            return 0;
+        case OUTPUT_SHM:
+            if (init_shm_writer_args(sw) != 0)
+                return 1;
+            *o_writer_args_ptr = &output_shm_args;
+            *o_writer_args_ptr_size = sizeof(output_shm_args);
+            sw->output_writer = &record_writer_shm;
+            return 0;
+        default:
+            return 1;
+    }
+}
+
+
+static int select_record_serializer(struct output_sink_writer *sw)
+{
+    switch (sw->sink.format)
+    {
+        case OUTPUT_FORMAT_JSON:
+            sw->serializer = &record_serializer_json;
+            return 0;
+        case OUTPUT_FORMAT_BINARY:
+            sw->serializer = &record_serializer_binary;
+            return 0;
+        case OUTPUT_FORMAT_CBOR:
+            sw->serializer = &record_serializer_cbor;
+            return 0;
+        case OUTPUT_FORMAT_COLUMNAR:
+            // The columnar writer batches the binary records.
+            sw->serializer = &record_serializer_binary;
+            return 0;
+        default:
+            return 1;
+    }
+}
+
+/*
+    Write the header of the serialized records (if any) before all records.
+
+    Return:
+        0  => Success
+        -1 => Error
+*/
+static int write_record_serializer_header(struct output_sink_writer *sw, const struct record_writer *writer)
+{
+    if (!sw->serializer->serialize_header)
+        return 0;
+
+    char header[RECORD_SERIALIZER_MAX_HEADER_LEN];
+    long header_len = sw->serializer->serialize_header(header, sizeof(header));
+    if (header_len <= 0)
+        return -1;
+    if (writer->write(header, header_len) < 0)
+        return -1;
+    return 0;
+}
+
+/*
+    Compression of the output of 'sw' i.e. OUTPUT_COMPRESSION_NONE unless it
+    is a file or TCP output with a codec.
+*/
+static struct output_compression *output_compression_of(struct output_sink_writer *sw)
+{
+    static struct output_compression none = {.codec = OUTPUT_COMPRESSION_NONE};
+    if (sw->sink.o_type == OUTPUT_FILE)
+        return &(sw->input->output_file.compression);
+    if (sw->sink.o_type == OUTPUT_TCP)
+        return &(sw->input->output_tcp.compression);
+    return &none;
+}
+
+/*
+    Put the compression writer in front of the initialized 'writer'.
+
+    Return:
+        0  => Success
+        -1 => Error. The writer is closed.
+*/
+static int init_compress_writer(struct output_sink_writer *sw, const struct record_writer **writer)
+{
+    struct compress_writer_args args = {
+        .writer = *writer,
+        .compression = *output_compression_of(sw),
+        .flush_interval_ms = sw->input->output_file.flush_policy.flush_interval_ms
+    };
+    if (sw->sink.o_type == OUTPUT_TCP)
+    {
+        // Every connection starts with the header then resumes at a write, so
+        // every block must decompress on its own.
+        args.flush_interval_ms = sw->input->output_tcp.flush_interval_ms;
+        args.frame_per_block = 1;
+    }
+    if (record_writer_compress.set_init_args(&args, sizeof(args)) != 0 || record_writer_compress.init() != 0)
+    {
+        (*writer)->close();
+        return -1;
+    }
+    *writer = &record_writer_compress;
+    return 0;
+}
+
+/*
+    Put the spill writer in front of the initialized TCP 'writer'.
+
+    Return:
+        0  => Success
+        -1 => Error. The writer is closed.
+*/
+static int init_spill_writer(struct output_sink_writer *sw, const struct record_writer **writer)
+{
+    struct spill_writer_args args = {
+        .writer = *writer,
+        .stop_writer = record_writer_tcp_stop_blocking,
+        .spill = sw->input->output_tcp.spill,
+        // Segments spilled with another codec are discarded too.
+        .format = sw->sink.format
+            | (unsigned int)(sw->input->output_tcp.compression.codec - OUTPUT_COMPRESSION_NONE) << 16
+    };
+    if (record_writer_spill.set_init_args(&args, sizeof(args)) != 0 || record_writer_spill.init() != 0)
+    {
+        (*writer)->close();
+        return -1;
+    }
+    *writer = &record_writer_spill;
+    return 0;
+}
+
+/*
+    Put the columnar writer in front of the initialized 'writer'.
+    The columnar writer writes its own header instead of the serializer header.
+
+    Return:
+        0  => Success
+        -1 => Error. The writer is closed.
+*/
+static int init_columnar_writer(struct user_input *input, const struct record_writer **writer)
+{
+    struct columnar_writer_args args = {
+        .writer = *writer,
+        .batch_rows = input->columnar.batch_rows,
+        .max_age_ms = input->columnar.max_age_ms
+    };
+    if (record_writer_columnar.set_init_args(&args, sizeof(args)) != 0 || record_writer_columnar.init() != 0)
+    {
+        (*writer)->close();
+        return -1;
+    }
+    *writer = &record_writer_columnar;
+    return 0;
+}
+
+/*
+    Helper function to use the json logger to log a string.
+*/
+static void _log_state_msg(app_state_t st, const char *s)
+{
+    int buf_size = 512;
+    char buf[buf_size];
+
+    struct json_buffer js_msg;
+    jsonify_core_init(&js_msg, &buf[0], buf_size);
+    jsonify_core_open_obj(&js_msg);
+    jsonify_core_write_str(&js_msg, "msg", s);
+    jsonify_core_close_obj(&js_msg);
+
+    log_state(st, &js_msg);
+}
+
+/*
+    Helper function to use the json logger to log a json_obj.
+*/
+static void _log_state_msg_and_js(
+    app_state_t st, 
+    const char *msg_val,
+    const char *js_key, struct json_buffer *js_val
+)
+{
+    char *js_val_buf_ptr;
+    int js_val_buf_size;
+
+    int buf_size = 2048;
+    char buf[buf_size];
+
+    struct json_buffer js_msg;
+    jsonify_core_init(&js_msg, &buf[0], buf_size);
+    jsonify_core_open_obj(&js_msg);
+    jsonify_core_write_str(&js_msg, "msg", msg_val);
+    if (jsonify_core_get_internal_buf_ptr(js_val, &js_val_buf_ptr, &js_val_buf_size) == 0)
+    {
+        jsonify_core_write_as_literal(&js_msg, js_key, js_val_buf_ptr);
+    }
+    jsonify_core_close_obj(&js_msg);
+
+    log_state(st, &js_msg);
+}
+
+static void _log_state_msg_with_pid(
+    app_state_t st,
+    const char *msg_val,
+    pid_t pid
+)
+{
+    int buf_size = 128;
+    char buf[buf_size];
+
+    struct json_buffer js_msg;
+    jsonify_core_init(&js_msg, &buf[0], buf_size);
+    jsonify_core_open_obj(&js_msg);
+    jsonify_core_write_str(&js_msg, "msg", msg_val);
+    jsonify_core_write_int(&js_msg, "pid", pid);
+    jsonify_core_close_obj(&js_msg);
+
+    log_state(st, &js_msg);
+}
+
+/*
+    State to log a failure to open the output writers with. They are opened again
+    while operational when the output file is rotated.
+*/
+static app_state_t output_writer_error_state = APP_STATE_STOPPED_WITH_ERROR;
+
+/*
+    Init the output writer, put the spill, compression and columnar writers in
+    front of it as configured, and write the header of the serialized records.
+    The init args of 'sw->output_writer' must be set.
+
+    Return:
+        The outermost writer
+        NULL => Error. Logged and the writers are closed.
+*/
+static const struct record_writer *open_output_writers(void *ctx)
+{
+    struct output_sink_writer *sw = (struct output_sink_writer *)ctx;
+    struct user_input *input = sw->input;
+    enum output_type o_type = sw->sink.o_type;
+    app_state_t error_state = output_writer_error_state;
+
+    int err = sw->output_writer->init();
+    if (err != 0 && sw->output_writer == &record_writer_file_uring)
+    {
+        _log_state_msg(APP_STATE_STARTING, "Failed to init io_uring file writer. Falling back to synchronous file writer");
+        sw->output_writer = &record_writer_file;
+        err = sw->output_writer->set_init_args(&(input->output_file), sizeof(input->output_file));
+        if (err == 0)
+            err = sw->output_writer->init();
+    }
+    if (err != 0)
+    {
+        _log_state_msg(error_state, "Error initing output writer");
+        return NULL;
+    }
+
+    const struct record_writer *writer = sw->output_writer;
+
+    // Compressed blocks are spilled rather than records.
+    if (o_type == OUTPUT_TCP && input->output_tcp.spill.dir[0] != '\0')
+    {
+        if (init_spill_writer(sw, &writer) != 0)
+        {
+            _log_state_msg(error_state, "Error initing spill writer");
+            return NULL;
+        }
+    }
+
+    if (output_compression_of(sw)->codec != OUTPUT_COMPRESSION_NONE)
+    {
+        if (init_compress_writer(sw, &writer) != 0)
+        {
+            _log_state_msg(error_state, "Error initing compression writer");
+            return NULL;
+        }
+    }
+
+    if (sw->sink.format == OUTPUT_FORMAT_COLUMNAR)
+    {
+        if (init_columnar_writer(input, &writer) != 0)
+        {
+            _log_state_msg(error_state, "Error initing columnar writer");
+            return NULL;
+        }
+    }
+    // The socket writers send the header themselves at the start of every
+    // connection (or datagram), and the shared-memory writer keeps it in the
+    // ring header.
+    else if (o_type == OUTPUT_FILE && write_record_serializer_header(sw, writer) != 0)
+    {
+        _log_state_msg(error_state, "Error writing the record serializer header");
+        writer->close();
+        return NULL;
+    }
+    return writer;
+}
+
+/*
+    Open the output file writers behind the rotation writer.
+
+    Return:
+        0  => Success
+        -1 => Error
+*/
+static int init_rotate_writer(struct output_sink_writer *sw)
+{
+    struct user_input *input = sw->input;
+    struct rotate_writer_args args = {
+        .open = open_output_writers,
+        .ctx = sw,
+        .rotation = input->output_file.rotation
+    };
+    memcpy(&(args.path[0]), &(input->output_file.path[0]), sizeof(args.path));
+
+    if (record_writer_rotate.set_init_args(&args, sizeof(args)) != 0 || record_writer_rotate.init() != 0)
+        return -1;
+    sw->writer = &record_writer_rotate;
+    return 0;
+}
+
+static int init_output_writer(struct output_sink_writer *sw){
+    void *record_writer_init_args = NULL;
+    size_t record_writer_init_args_size = 0;
+    
+    int err = select_record_serializer(sw);
+    if (err)
+    {
+        _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Error selecting a valid record serializer");
+        return -1;
+    }
+
+    err = select_output_writer(sw, &record_writer_init_args, &record_writer_init_args_size);
+    if (err)
+    {
+        _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Error selecting a valid output writer");
+        return -1;
+    }
+
+    err = sw->output_writer->set_init_args(
+        record_writer_init_args, record_writer_init_args_size
+    );
+    if (err != 0)
+    {
+        _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Error setting init args for the output writer");
+        return -1;
+    }
+
+    if (sw->sink.o_type == OUTPUT_FILE)
+    {
+        if (init_rotate_writer(sw) != 0)
+        {
+            _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Error initing rotation writer");
+            return -1;
+        }
+    }
+    else
+    {
+        sw->writer = open_output_writers(sw);
+        if (!sw->writer)
+            return -1;
+    }
+    return 0;
+}
+
+static void close_output_writers()
+{
+    for (int i = 0; i < sink_writers_len; i++)
+        sink_writers[i].writer->close();
+}
+
+/*
+    Init the writers of every output in 'input->sinks'.
+
+    Return:
+        0  => Success
+        -1 => Error. Logged and the writers are closed.
+*/
+static int init_output_writers(struct user_input *input)
+{
+    for (int i = 0; i < input->sinks_len; i++)
+    {
+        struct output_sink_writer *sw = &sink_writers[i];
+        memset(sw, 0, sizeof(struct output_sink_writer));
+        sw->input = input;
+        sw->sink = input->sinks[i];
+        if (init_output_writer(sw) != 0)
+        {
+            close_output_writers();
+            return -1;
+        }
+        sink_writers_len++;
+    }
+
+    output_writer_error_state = APP_STATE_OPERATIONAL_WITH_ERROR;
+    return 0;
+}
+
+static int init_ringbuf_consumer(struct ringbuf_consumer *consumer, pthread_mutex_t *output_lock)
+{
+    memset(consumer, 0, sizeof(struct ringbuf_consumer));
+
+    consumer->dst_len = MAX_BUFFER_LEN;
+    consumer->dst = malloc(sizeof(char) * consumer->dst_len);
+    if (!consumer->dst)
+        return -1;
+    consumer->output_lock = output_lock;
+
+    return 0;
+}
+
+static void close_ringbuf_consumer(struct ringbuf_consumer *consumer)
+{
+    free(consumer->dst);
+    consumer->dst = NULL;
+    consumer->dst_len = 0;
+}
+
+static void lock_ringbuf_output(struct ringbuf_consumer *consumer)
+{
+    if (consumer->output_lock)
+        pthread_mutex_lock(consumer->output_lock);
+}
+
+static void unlock_ringbuf_output(struct ringbuf_consumer *consumer)
+{
+    if (consumer->output_lock)
+        pthread_mutex_unlock(consumer->output_lock);
+}
+
+static void log_pipeline_error(const char *msg)
+{
+    _log_state_msg(APP_STATE_OPERATIONAL_WITH_ERROR, msg);
+}
+
+/*
+    Start serializing and writing records on 'workers' threads.
+    The output writer must be initialized.
+*/
+static int start_ringbuf_consumer_pipeline(int workers, long flush_interval_ms)
+{
+    struct pipeline_args args = {
+        .workers = workers,
+        .slots_len = PIPELINE_DEFAULT_SLOTS_LEN,
+        .serializer = sink_writers[0].serializer,
+        .writer = sink_writers[0].writer,
+        .flush_interval_ms = flush_interval_ms,
+        .stats = &pipeline_stats,
+        .log_error = log_pipeline_error
+    };
+
+    if (pipeline_start(&default_pipeline, &args) != 0)
+        return -1;
+
+    pipelined = 1;
+    return 0;
+}
+
+/*
+    Wait for all the records in the pipeline to be written and stop it.
+*/
+static void stop_ringbuf_consumer_pipeline()
+{
+    if (!pipelined)
+        return;
+
+    pipeline_stop(&default_pipeline);
+    pipelined = 0;
+}
+
+/*
+    Add the stats of 'src', which may be updated (atomically) by other threads meanwhile.
+*/
+static void add_consumer_stats(struct consumer_stats *dst, struct consumer_stats *src)
+{
+    dst->records += __atomic_load_n(&src->records, __ATOMIC_RELAXED);
+    dst->bytes_written += __atomic_load_n(&src->bytes_written, __ATOMIC_RELAXED);
+    dst->serialize_errors += __atomic_load_n(&src->serialize_errors, __ATOMIC_RELAXED);
+    dst->write_errors += __atomic_load_n(&src->write_errors, __ATOMIC_RELAXED);
+}
+
+/*
+    Get the stats of all the consumers (and the pipeline or fanout) combined.
+*/
+static void get_total_consumer_stats(struct consumer_stats *total)
+{
+    memset(total, 0, sizeof(struct consumer_stats));
+    for (int i = 0; i < ringbuf_groups_len; i++)
+        add_consumer_stats(total, &ringbuf_groups[i].consumer.stats);
+    add_consumer_stats(total, &pipeline_stats);
+    add_consumer_stats(total, &fanout_stats);
+}
+
+/*
+    Sum the per-CPU drop counters in the BPF map.
+*/
+static int read_output_drop_stats(struct output_drop_stats *dst)
+{
+    memset(dst, 0, sizeof(struct output_drop_stats));
+
+    int ncpus = libbpf_num_possible_cpus();
+    if (ncpus <= 0)
+        return -1;
+
+    __u64 values[ncpus];
+    for (__u32 key = 0; key < OUTPUT_DROPS_MAP_SIZE; key++)
+    {
+        int err = bpf_map__lookup_elem(
+            skel->maps.ameba_output_drops,
+            &key, sizeof(key),
+            &values[0], sizeof(__u64) * ncpus,
+            0
+        );
+        if (err != 0)
+            return -1;
+        for (int cpu = 0; cpu < ncpus; cpu++)
+            dst->per_record_type[key] += values[cpu];
+        dst->total += dst->per_record_type[key];
+    }
+    return 0;
+}
+
+static void log_ringbuf_consumer_stats(app_state_t st, struct consumer_stats *stats)
+{
+    int dst_len = 256;
+    char dst[dst_len];
+
+    struct json_buffer s;
+    jsonify_core_init(&s, dst, dst_len);
+    jsonify_core_open_obj(&s);
+
+    jsonify_stats_write_consumer_stats(&s, stats);
+
+    jsonify_core_close_obj(&s);
+
+    _log_state_msg_and_js(
+        st,
+        "Ring buffer consumer stats",
+        "consumer_stats", &s
+    );
+}
+
+static void log_output_spool_stats(app_state_t st, struct output_spool_stats *stats)
+{
+    int dst_len = 512;
+    char dst[dst_len];
+
+    struct json_buffer s;
+    jsonify_core_init(&s, dst, dst_len);
+    jsonify_core_open_obj(&s);
+
+    jsonify_stats_write_output_spool_stats(&s, stats);
+
+    jsonify_core_close_obj(&s);
+
+    _log_state_msg_and_js(
+        st,
+        "Output spool stats",
+        "output_spool", &s
+    );
+}
+
+static void log_output_spill_stats(app_state_t st, struct output_spill_stats *stats)
+{
+    int dst_len = 512;
+    char dst[dst_len];
+
+    struct json_buffer s;
+    jsonify_core_init(&s, dst, dst_len);
+    jsonify_core_open_obj(&s);
+
+    jsonify_stats_write_output_spill_stats(&s, stats);
+
+    jsonify_core_close_obj(&s);
+
+    _log_state_msg_and_js(
+        st,
+        "Output spill stats",
+        "output_spill", &s
+    );
+}
+
+static void log_output_drop_stats(app_state_t st, struct output_drop_stats *stats)
+{
+    int dst_len = 512;
+    char dst[dst_len];
+
+    struct json_buffer s;
+    jsonify_core_init(&s, dst, dst_len);
+    jsonify_core_open_obj(&s);
+
+    jsonify_stats_write_output_drop_stats(&s, stats);
+
+    jsonify_core_close_obj(&s);
+
+    _log_state_msg_and_js(
+        st,
+        "Ring buffer drop stats",
+        "output_drops", &s
+    );
+}
+
+/*
+    Write the stats of every output, keyed by its type, to json_buffer.
+*/
+static void write_output_sink_stats(struct json_buffer *s, struct output_sink_stats *stats)
+{
+    for (int i = 0; i < sink_writers_len; i++)
+    {
+        int buf_len = 256;
+        char buf[buf_len];
+        struct json_buffer js;
+        jsonify_core_init(&js, buf, buf_len);
+        jsonify_core_open_obj(&js);
+        jsonify_stats_write_output_sink_stats(&js, &stats[i]);
+        jsonify_core_close_obj(&js);
+        jsonify_core_write_as_literal(s, jsonify_user_output_type_name(sink_writers[i].sink.o_type), buf);
+    }
+}
+
+static void log_output_sink_stats(app_state_t st, struct output_sink_stats *stats)
+{
+    int dst_len = 1536;
+    char dst[dst_len];
+
+    struct json_buffer s;
+    jsonify_core_init(&s, dst, dst_len);
+    jsonify_core_open_obj(&s);
+
+    write_output_sink_stats(&s, stats);
+
+    jsonify_core_close_obj(&s);
+
+    _log_state_msg_and_js(
+        st,
+        "Output sink stats",
+        "output_sinks", &s
+    );
+}
+
+/*
+    Replace the stats file with the given stats. The file is written next to
+    it first and renamed so that readers never see a partial file.
+*/
+static int write_stats_file(
+    const char *path,
+    struct consumer_stats *c_stats,
+    struct output_drop_stats *d_stats,
+    struct output_spool_stats *s_stats,
+    struct output_spill_stats *spill_stats,
+    struct output_sink_stats *sink_stats
+)
+{
+    int dst_len = 4096;
+    char dst[dst_len];
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    int c_stats_buf_len = 256;
+    char c_stats_buf[c_stats_buf_len];
+    struct json_buffer c_stats_js;
+    jsonify_core_init(&c_stats_js, c_stats_buf, c_stats_buf_len);
+    jsonify_core_open_obj(&c_stats_js);
+    jsonify_stats_write_consumer_stats(&c_stats_js, c_stats);
+    jsonify_core_close_obj(&c_stats_js);
+
+    int d_stats_buf_len = 512;
+    char d_stats_buf[d_stats_buf_len];
+    struct json_buffer d_stats_js;
+    jsonify_core_init(&d_stats_js, d_stats_buf, d_stats_buf_len);
+    jsonify_core_open_obj(&d_stats_js);
+    jsonify_stats_write_output_drop_stats(&d_stats_js, d_stats);
+    jsonify_core_close_obj(&d_stats_js);
+
+    int s_stats_buf_len = 512;
+    char s_stats_buf[s_stats_buf_len];
+    if (s_stats)
+    {
+        struct json_buffer s_stats_js;
+        jsonify_core_init(&s_stats_js, s_stats_buf, s_stats_buf_len);
+        jsonify_core_open_obj(&s_stats_js);
+        jsonify_stats_write_output_spool_stats(&s_stats_js, s_stats);
+        jsonify_core_close_obj(&s_stats_js);
+    }
+
+    int spill_stats_buf_len = 512;
+    char spill_stats_buf[spill_stats_buf_len];
+    if (spill_stats)
+    {
+        struct json_buffer spill_stats_js;
+        jsonify_core_init(&spill_stats_js, spill_stats_buf, spill_stats_buf_len);
+        jsonify_core_open_obj(&spill_stats_js);
+        jsonify_stats_write_output_spill_stats(&spill_stats_js, spill_stats);
+        jsonify_core_close_obj(&spill_stats_js);
+    }
+
+    int sink_stats_buf_len = 1536;
+    char sink_stats_buf[sink_stats_buf_len];
+    if (sink_stats)
+    {
+        struct json_buffer sink_stats_js;
+        jsonify_core_init(&sink_stats_js, sink_stats_buf, sink_stats_buf_len);
+        jsonify_core_open_obj(&sink_stats_js);
+        write_output_sink_stats(&sink_stats_js, sink_stats);
+        jsonify_core_close_obj(&sink_stats_js);
+    }
+
+    struct json_buffer s;
+    jsonify_core_init(&s, dst, dst_len);
+    jsonify_core_open_obj(&s);
+    jsonify_core_write_timespec64(&s, "time", ts.tv_sec, ts.tv_nsec);
+    jsonify_core_write_as_literal(&s, "consumer_stats", c_stats_buf);
+    jsonify_core_write_as_literal(&s, "output_drops", d_stats_buf);
+    if (s_stats)
+        jsonify_core_write_as_literal(&s, "output_spool", s_stats_buf);
+    if (spill_stats)
+        jsonify_core_write_as_literal(&s, "output_spill", spill_stats_buf);
+    if (sink_stats)
+        jsonify_core_write_as_literal(&s, "output_sinks", sink_stats_buf);
+    jsonify_core_close_obj(&s);
+
+    char *buf_ptr;
+    int buf_size;
+    if (jsonify_core_get_internal_buf_ptr(&s, &buf_ptr, &buf_size) != 0)
+        return -1;
+
+    char tmp_path[PATH_MAX];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path))
+        return -1;
+
+    FILE *f = fopen(tmp_path, "w");
+    if (!f)
+        return -1;
+    int err = fprintf(f, "%s\n", buf_ptr) < 0;
+    err |= fclose(f) != 0;
+    if (err || rename(tmp_path, path) != 0)
+    {
+        unlink(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+    Whether the output writers keep output_spool_stats and output_spill_stats,
+    and whether the records are fanned out with output_sink_stats per output.
+*/
+static int report_spool_stats = 0;
+static int report_spill_stats = 0;
+static int report_sink_stats = 0;
+
+/*
+    Log the consumer stats, the drop counters, and the output spool, spill and
+    sink counters (if any), and write them to the stats file if any.
+*/
+static void report_stats(app_state_t st, struct stats_config *config)
+{
+    struct consumer_stats c_stats;
+    get_total_consumer_stats(&c_stats);
+    log_ringbuf_consumer_stats(st, &c_stats);
+
+    struct output_drop_stats d_stats;
+    if (read_output_drop_stats(&d_stats) != 0)
+    {
+        _log_state_msg(APP_STATE_OPERATIONAL_WITH_ERROR, "Failed to read ring buffer drop stats");
+        return;
+    }
+    log_output_drop_stats(st, &d_stats);
+
+    struct output_spool_stats s_stats;
+    struct output_spool_stats *s_stats_ptr = NULL;
+    if (report_spool_stats)
+    {
+        record_writer_tcp_get_stats(&s_stats);
+        log_output_spool_stats(st, &s_stats);
+        s_stats_ptr = &s_stats;
+    }
+
+    struct output_spill_stats spill_stats;
+    struct output_spill_stats *spill_stats_ptr = NULL;
+    if (report_spill_stats)
+    {
+        record_writer_spill_get_stats(&spill_stats);
+        log_output_spill_stats(st, &spill_stats);
+        spill_stats_ptr = &spill_stats;
+    }
+
+    struct output_sink_stats sink_stats[MAX_OUTPUT_SINKS];
+    struct output_sink_stats *sink_stats_ptr = NULL;
+    if (report_sink_stats)
+    {
+        for (int i = 0; i < sink_writers_len; i++)
+            fanout_get_sink_stats(&default_fanout, i, &sink_stats[i]);
+        log_output_sink_stats(st, &sink_stats[0]);
+        sink_stats_ptr = &sink_stats[0];
+    }
+
+    if (config->path[0] != '\0'
+        && write_stats_file(config->path, &c_stats, &d_stats, s_stats_ptr, spill_stats_ptr, sink_stats_ptr) != 0)
+        _log_state_msg(APP_STATE_OPERATIONAL_WITH_ERROR, "Failed to write stats file");
+}
+
+/*
+    Next time (CLOCK_MONOTONIC) the stats are due at.
+*/
+static struct timespec next_stats_report;
+
+static void schedule_stats_report(struct stats_config *config)
+{
+    clock_gettime(CLOCK_MONOTONIC, &next_stats_report);
+    next_stats_report.tv_sec += config->interval_sec;
+}
+
+static void report_stats_if_due(struct stats_config *config)
+{
+    if (config->interval_sec <= 0)
+        return;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (
+        now.tv_sec < next_stats_report.tv_sec
+        || (now.tv_sec == next_stats_report.tv_sec && now.tv_nsec < next_stats_report.tv_nsec)
+    )
+        return;
+
+    report_stats(APP_STATE_OPERATIONAL, config);
+    schedule_stats_report(config);
+}
+
+static int handle_ringbuf_data(void *ctx, void *data, size_t data_len)
+{
+    struct ringbuf_consumer *consumer = (struct ringbuf_consumer *)ctx;
+
+    consumer->stats.records++;
+
+    if (pipelined)
+    {
+        lock_ringbuf_output(consumer);
+        int submit_result = pipeline_submit(&default_pipeline, data, data_len);
+        unlock_ringbuf_output(consumer);
+        if (submit_result != 0)
+        {
+            consumer->stats.serialize_errors++;
+            _log_state_msg(APP_STATE_OPERATIONAL_WITH_ERROR, "Failed data conversion");
+        }
+        return 0;
+    }
+
+    if (fanned_out)
+    {
+        // The fanout counts and logs the records it fails to serialize.
+        lock_ringbuf_output(consumer);
+        fanout_submit(&default_fanout, data, data_len);
+        unlock_ringbuf_output(consumer);
+        return 0;
+    }
+
+    long data_copied_to_dst = sink_writers[0].serializer->serialize(consumer->dst, consumer->dst_len, data, data_len);
+    if (data_copied_to_dst <= 0)
+    {
+        consumer->stats.serialize_errors++;
+        _log_state_msg(APP_STATE_OPERATIONAL_WITH_ERROR, "Failed data conversion");
+        return 0;
+    }
+
+    lock_ringbuf_output(consumer);
+    int write_result = sink_writers[0].writer->write(consumer->dst, data_copied_to_dst);
+    unlock_ringbuf_output(consumer);
+    if (write_result < 0)
+    {
+        consumer->stats.write_errors++;
+        _log_state_msg(APP_STATE_OPERATIONAL_WITH_ERROR, "Failed data write");
+        return 0;
+    }
+
+    consumer->stats.bytes_written += write_result;
+    return 0;
+}
+
+static void flush_ringbuf_output(struct ringbuf_consumer *consumer)
+{
+    // The pipeline writer thread or the fanout sink threads flush the writers.
+    if (pipelined || fanned_out)
+        return;
+
+    lock_ringbuf_output(consumer);
+    int flush_result = sink_writers[0].writer->flush(0);
+    unlock_ringbuf_output(consumer);
+    if (flush_result == -1)
+        _log_state_msg(APP_STATE_OPERATIONAL_WITH_ERROR, "Failed data flush");
+}
+
+/*
+    Poll the ring buffers of the group until stopped.
+
+    Records are submitted without a wakeup until enough data is pending in a ring
+    buffer, so each round also consumes the ring buffers that were not signalled.
+
+    Return:
+        0  => Stopped by signal or 'stop_consuming'
+        -1 => Polling failed
+*/
+static int consume_ringbuf_group(struct ringbuf_group *group, int poll_timeout_ms)
+{
+    while (!exit_signal_received && !stop_consuming)
+    {
+        // collect prov in callback
+        int err = ring_buffer__poll(group->ringbuf, poll_timeout_ms);
+        if (err < 0 && err != -EINTR)
+            return -1;
+        err = ring_buffer__consume(group->ringbuf);
+        if (err < 0 && err != -EINTR)
+            return -1;
+        flush_ringbuf_output(&group->consumer);
+        if (group->stats_config)
+            report_stats_if_due(group->stats_config);
+    }
+    return 0;
+}
+
+static int consumer_thread_poll_timeout_ms = CONSUMER_THREAD_POLL_TIMEOUT_MS;
+
+static void *consume_ringbuf_group_thread(void *arg)
+{
+    struct ringbuf_group *group = (struct ringbuf_group *)arg;
+    if (consume_ringbuf_group(group, consumer_thread_poll_timeout_ms) != 0)
+        _log_state_msg(APP_STATE_OPERATIONAL_WITH_ERROR, "Failed to poll ring buffers");
+    return NULL;
+}
+
+/*
+    Create a ring buffer for each possible CPU and set it in the per-CPU
+    ring buffers map. Must be called after load and before attach.
+*/
+static int init_percpu_ringbufs(size_t ringbuf_size)
+{
+    int ncpus = libbpf_num_possible_cpus();
+    if (ncpus <= 0)
+        return -1;
+
+    percpu_ringbuf_fds = malloc(sizeof(int) * ncpus);
+    if (!percpu_ringbuf_fds)
+        return -1;
+    for (int i = 0; i < ncpus; i++)
+        percpu_ringbuf_fds[i] = -1;
+    percpu_ringbuf_fds_len = ncpus;
+
+    int outer_fd = bpf_map__fd(skel->maps.ameba_output_percpu_ringbufs);
+    if (outer_fd < 0)
+        return -1;
+
+    for (int cpu = 0; cpu < ncpus; cpu++)
+    {
+        int fd = bpf_map_create(BPF_MAP_TYPE_RINGBUF, "ameba_cpu_rb", 0, 0, ringbuf_size, NULL);
+        if (fd < 0)
+            return -1;
+        percpu_ringbuf_fds[cpu] = fd;
+
+        __u32 key = cpu;
+        if (bpf_map_update_elem(outer_fd, &key, &fd, BPF_ANY) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+static void close_percpu_ringbuf_template()
+{
+    if (percpu_ringbuf_template_fd >= 0)
+        close(percpu_ringbuf_template_fd);
+    percpu_ringbuf_template_fd = -1;
+}
 
-//
+/*
+    Resize the ring buffers (and the per-CPU ring buffers map) as configured.
+    Must be called after open and before load.
+*/
+static int resize_ringbufs(struct ringbuf_config *config)
+{
+    if (bpf_map__set_max_entries(skel->maps.ameba_output_ringbuf, config->size) != 0)
+        return -1;
 
-static struct ameba *skel = NULL;
+    int ringbufs = 1;
+    if (config->mode == RINGBUF_MODE_PERCPU)
+    {
+        int ncpus = libbpf_num_possible_cpus();
+        if (ncpus <= 0)
+            return -1;
+        if (bpf_map__set_max_entries(skel->maps.ameba_output_percpu_ringbufs, ncpus) != 0)
+            return -1;
+
+        // The inner ring buffers must have the size of the template the map is created with.
+        percpu_ringbuf_template_fd = bpf_map_create(BPF_MAP_TYPE_RINGBUF, "ameba_cpu_rb_tpl", 0, 0, config->size, NULL);
+        if (percpu_ringbuf_template_fd < 0)
+            return -1;
+        if (bpf_map__set_inner_map_fd(skel->maps.ameba_output_percpu_ringbufs, percpu_ringbuf_template_fd) != 0)
+            return -1;
+        ringbufs += ncpus;
+    }
 
-//
+    int dst_len = 128;
+    char dst[dst_len];
 
-static int select_default_output_writer(
-    struct user_input *input,
-    void **o_writer_args_ptr,
-    size_t *o_writer_args_ptr_size
-)
+    struct json_buffer s;
+    jsonify_core_init(&s, dst, dst_len);
+    jsonify_core_open_obj(&s);
+    jsonify_core_write_ulong(&s, "size", config->size);
+    jsonify_core_write_int(&s, "count", ringbufs);
+    jsonify_core_close_obj(&s);
+
+    _log_state_msg_and_js(
+        APP_STATE_STARTING,
+        "Ring buffer size",
+        "ringbuf", &s
+    );
+    return 0;
+}
+
+static void close_percpu_ringbufs()
 {
-    switch (input->o_type)
+    for (int i = 0; i < percpu_ringbuf_fds_len; i++)
     {
-        case OUTPUT_FILE:
-            *o_writer_args_ptr = &(input->output_file);
-            *o_writer_args_ptr_size = sizeof(input->output_file);
-            default_record_writer = &record_writer_file;
-            return 0;
-        case OUTPUT_NET:
-            *o_writer_args_ptr = &(input->output_net);
-            *o_writer_args_ptr_size = sizeof(input->output_net);
-            default_record_writer = &record_writer_net;
-            return 0;
-        default:
-            return 1;
+        if (percpu_ringbuf_fds[i] >= 0)
+            close(percpu_ringbuf_fds[i]);
     }
+    free(percpu_ringbuf_fds);
+    percpu_ringbuf_fds = NULL;
+    percpu_ringbuf_fds_len = 0;
 }
 
+/*
+    Find the group consuming the NUMA node, or add one if none.
+*/
+static struct ringbuf_group *get_ringbuf_group_for_numa_node(int numa_node)
+{
+    for (int i = 0; i < ringbuf_groups_len; i++)
+    {
+        if (ringbuf_groups[i].numa_node == numa_node)
+            return &ringbuf_groups[i];
+    }
+    struct ringbuf_group *group = &ringbuf_groups[ringbuf_groups_len++];
+    group->numa_node = numa_node;
+    return group;
+}
 
-static int select_default_record_serializer()
+static int add_ringbuf_to_group(struct ringbuf_group *group, int map_fd)
 {
-    default_record_serializer = &record_serializer_json;
-    return 0;
+    if (!group->ringbuf)
+    {
+        group->ringbuf = ring_buffer__new(map_fd, handle_ringbuf_data, &group->consumer, NULL);
+        return group->ringbuf ? 0 : -1;
+    }
+    return ring_buffer__add(group->ringbuf, map_fd, handle_ringbuf_data, &group->consumer);
 }
 
 /*
-    Helper function to use the json logger to log a string.
+    Create the ring buffer groups and their consumers.
+
+    The shared ring buffer is always consumed by group 0. Per-CPU ring buffers
+    go to group 0 too, unless there is a group per NUMA node.
 */
-static void _log_state_msg(app_state_t st, const char *s)
+static int init_ringbuf_groups(struct ringbuf_config *config, int shared_ringbuf_fd)
 {
-    int buf_size = 512;
-    char buf[buf_size];
+    int max_groups = 1;
+    if (config->consumers == RINGBUF_CONSUMERS_PER_NUMA_NODE && percpu_ringbuf_fds_len > 0)
+        max_groups = percpu_ringbuf_fds_len;
 
-    struct json_buffer js_msg;
-    jsonify_core_init(&js_msg, &buf[0], buf_size);
-    jsonify_core_open_obj(&js_msg);
-    jsonify_core_write_str(&js_msg, "msg", s);
-    jsonify_core_close_obj(&js_msg);
+    ringbuf_groups = calloc(max_groups, sizeof(struct ringbuf_group));
+    if (!ringbuf_groups)
+        return -1;
 
-    log_state(st, &js_msg);
+    // Group 0 is the main thread's and the first group.
+    ringbuf_groups_len = 1;
+    ringbuf_groups[0].numa_node = -1;
+
+    for (int cpu = 0; cpu < percpu_ringbuf_fds_len; cpu++)
+    {
+        struct ringbuf_group *group = &ringbuf_groups[0];
+        if (max_groups > 1)
+        {
+            int numa_node = cpu_get_numa_node(cpu);
+            if (cpu == 0)
+                ringbuf_groups[0].numa_node = numa_node;
+            group = get_ringbuf_group_for_numa_node(numa_node);
+        }
+        if (!group->consumer.dst)
+        {
+            pthread_mutex_t *output_lock = max_groups > 1 ? &ringbuf_output_lock : NULL;
+            if (init_ringbuf_consumer(&group->consumer, output_lock) != 0)
+                return -1;
+        }
+        if (add_ringbuf_to_group(group, percpu_ringbuf_fds[cpu]) != 0)
+            return -1;
+    }
+
+    if (!ringbuf_groups[0].consumer.dst)
+    {
+        pthread_mutex_t *output_lock = ringbuf_groups_len > 1 ? &ringbuf_output_lock : NULL;
+        if (init_ringbuf_consumer(&ringbuf_groups[0].consumer, output_lock) != 0)
+            return -1;
+    }
+    if (add_ringbuf_to_group(&ringbuf_groups[0], shared_ringbuf_fd) != 0)
+        return -1;
+
+    return 0;
+}
+
+static void close_ringbuf_groups()
+{
+    for (int i = 0; i < ringbuf_groups_len; i++)
+    {
+        ring_buffer__free(ringbuf_groups[i].ringbuf);
+        close_ringbuf_consumer(&ringbuf_groups[i].consumer);
+    }
+    free(ringbuf_groups);
+    ringbuf_groups = NULL;
+    ringbuf_groups_len = 0;
 }
 
 /*
-    Helper function to use the json logger to log a json_obj.
+    Start a thread for each group except group 0.
+    SIGTERM and SIGHUP are blocked in the threads so that they interrupt the main thread.
 */
-static void _log_state_msg_and_js(
-    app_state_t st, 
-    const char *msg_val,
-    const char *js_key, struct json_buffer *js_val
-)
+static int start_ringbuf_group_threads()
 {
-    char *js_val_buf_ptr;
-    int js_val_buf_size;
+    sigset_t mask, old_mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &mask, &old_mask);
+
+    int result = 0;
+    for (int i = 1; i < ringbuf_groups_len; i++)
+    {
+        struct ringbuf_group *group = &ringbuf_groups[i];
+        if (pthread_create(&group->thread, NULL, consume_ringbuf_group_thread, group) != 0)
+        {
+            result = -1;
+            break;
+        }
+        group->thread_started = 1;
+    }
 
-    int buf_size = 512;
-    char buf[buf_size];
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+    return result;
+}
 
-    struct json_buffer js_msg;
-    jsonify_core_init(&js_msg, &buf[0], buf_size);
-    jsonify_core_open_obj(&js_msg);
-    jsonify_core_write_str(&js_msg, "msg", msg_val);
-    if (jsonify_core_get_internal_buf_ptr(js_val, &js_val_buf_ptr, &js_val_buf_size) == 0)
+static void stop_ringbuf_group_threads()
+{
+    stop_consuming = 1;
+    for (int i = 1; i < ringbuf_groups_len; i++)
     {
-        jsonify_core_write_as_literal(&js_msg, js_key, js_val_buf_ptr);
+        if (ringbuf_groups[i].thread_started)
+            pthread_join(ringbuf_groups[i].thread, NULL);
+        ringbuf_groups[i].thread_started = 0;
     }
-    jsonify_core_close_obj(&js_msg);
+}
 
-    log_state(st, &js_msg);
+/*
+    Consume whatever is left in all the ring buffers.
+*/
+static void consume_ringbuf_groups_tail()
+{
+    for (int i = 0; i < ringbuf_groups_len; i++)
+        ring_buffer__consume(ringbuf_groups[i].ringbuf);
 }
 
-static void _log_state_msg_with_pid(
-    app_state_t st,
-    const char *msg_val,
-    pid_t pid
-)
+static int has_output_sink(struct user_input *input, enum output_type o_type)
 {
-    int buf_size = 128;
-    char buf[buf_size];
+    for (int i = 0; i < input->sinks_len; i++)
+        if (input->sinks[i].o_type == o_type)
+            return 1;
+    return 0;
+}
 
-    struct json_buffer js_msg;
-    jsonify_core_init(&js_msg, &buf[0], buf_size);
-    jsonify_core_open_obj(&js_msg);
-    jsonify_core_write_str(&js_msg, "msg", msg_val);
-    jsonify_core_write_int(&js_msg, "pid", pid);
-    jsonify_core_close_obj(&js_msg);
+/*
+    Whether SIGTERM stops a TCP writer waiting for a dead collector. Not when
+    the records are spilled, since they would be dropped instead of spilled
+    until the writers are closed.
+*/
+static volatile sig_atomic_t stop_tcp_writer_on_exit = 1;
 
-    log_state(st, &js_msg);
+static void sig_handler(int sig)
+{
+    if (sig == SIGTERM)
+    {
+        exit_signal_received = 1;
+        // Do not wait for a dead collector to drain the ring buffers.
+        if (stop_tcp_writer_on_exit)
+            record_writer_tcp_stop_blocking();
+    }
+    else if (sig == SIGHUP)
+    {
+        // The output file is rotated at the next write or flush.
+        record_writer_rotate_request();
+    }
 }
 
-static int init_output_writer(struct user_input *input){
-    void *record_writer_init_args = NULL;
-    size_t record_writer_init_args_size = 0;
-    
-    int err = select_default_output_writer(input, &record_writer_init_args, &record_writer_init_args_size);
-    if (err)
+/*
+    Timeout for polling the ring buffer such that the buffered output of 'sw'
+    is flushed within its configured age even when there are no new records.
+
+    Return:
+        -1 => Wait indefinitely
+        >0 => Timeout in milliseconds
+*/
+static int get_ringbuf_poll_timeout_ms(struct output_sink_writer *sw)
+{
+    struct user_input *input = sw->input;
+    enum output_type o_type = sw->sink.o_type;
+
+    if (o_type == OUTPUT_NET)
     {
-        _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Error selecting a valid output writer");
+        struct output_net *o_net = &(input->output_net);
+        if (o_net->datagram_size > 0 && o_net->flush_interval_ms > 0)
+            return o_net->flush_interval_ms > INT_MAX ? INT_MAX : (int)o_net->flush_interval_ms;
         return -1;
     }
 
-    err = select_default_record_serializer();
-    if (err)
+    if (o_type == OUTPUT_UNIX)
     {
-        _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Error selecting a valid record serializer");
+        struct output_unix *o_unix = &(input->output_unix);
+        if (o_unix->message_size > 0 && o_unix->flush_interval_ms > 0)
+            return o_unix->flush_interval_ms > INT_MAX ? INT_MAX : (int)o_unix->flush_interval_ms;
         return -1;
     }
 
-    err = default_record_writer->set_init_args(
-        record_writer_init_args, record_writer_init_args_size
-    );
-    if (err != 0)
+    if (o_type == OUTPUT_TCP)
     {
-        _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Error setting init args for the output writer");
-        return -1;
+        // Also (re)connect while no records arrive.
+        struct output_tcp *o_tcp = &(input->output_tcp);
+        long timeout_ms = o_tcp->reconnect_min_ms;
+        if (o_tcp->flush_interval_ms > 0 && o_tcp->flush_interval_ms < timeout_ms)
+            timeout_ms = o_tcp->flush_interval_ms;
+        return timeout_ms > INT_MAX ? INT_MAX : (int)timeout_ms;
     }
 
-    err = default_record_writer->init();
-    if (err != 0)
-    {
-        _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Error initing output writer");
+    if (o_type != OUTPUT_FILE)
         return -1;
-    }
-    return 0;
-}
 
-static void close_output_writer()
-{
-    default_record_writer->close();
+    long timeout_ms = -1;
+
+    // The io_uring file writer and the compression writer always buffer.
+    struct output_flush_policy *policy = &(input->output_file.flush_policy);
+    int buffered = policy->buffer_size > 0
+        || input->output_file.engine == OUTPUT_FILE_ENGINE_URING
+        || input->output_file.compression.codec != OUTPUT_COMPRESSION_NONE;
+    if (buffered && policy->flush_interval_ms > 0)
+        timeout_ms = policy->flush_interval_ms;
+
+    // Rotate an idle output file in time.
+    long rotate_interval_ms = input->output_file.rotation.interval_sec * 1000;
+    if (rotate_interval_ms > 0 && (timeout_ms < 0 || rotate_interval_ms < timeout_ms))
+        timeout_ms = rotate_interval_ms;
+
+    long max_age_ms = input->columnar.max_age_ms;
+    if (sw->sink.format == OUTPUT_FORMAT_COLUMNAR && max_age_ms > 0 && (timeout_ms < 0 || max_age_ms < timeout_ms))
+        timeout_ms = max_age_ms;
+
+    return timeout_ms > INT_MAX ? INT_MAX : (int)timeout_ms;
 }
 
-static int handle_ringbuf_data(void *ctx, void *data, size_t data_len)
+/*
+    Start writing records to every output on a thread of its own.
+    The output writers must be initialized.
+*/
+static int start_ringbuf_consumer_fanout()
 {
-    size_t dst_len = MAX_BUFFER_LEN;
-    void *dst = malloc(sizeof(char) * dst_len);
-    if (!dst)
-        goto exit;
-
-    long data_copied_to_dst = default_record_serializer->serialize(dst, dst_len, data, data_len);
-    if (data_copied_to_dst <= 0)
+    struct fanout_args args;
+    memset(&args, 0, sizeof(args));
+    args.sinks_len = sink_writers_len;
+    args.queue_size = FANOUT_DEFAULT_QUEUE_SIZE;
+    args.stats = &fanout_stats;
+    args.log_error = log_pipeline_error;
+    for (int i = 0; i < sink_writers_len; i++)
     {
-        _log_state_msg(APP_STATE_OPERATIONAL_WITH_ERROR, "Failed data conversion");
-        goto free_dst;
+        args.sinks[i].serializer = sink_writers[i].serializer;
+        args.sinks[i].writer = sink_writers[i].writer;
+        args.sinks[i].flush_interval_ms = get_ringbuf_poll_timeout_ms(&sink_writers[i]);
     }
 
-    int write_result = default_record_writer->write(dst, data_copied_to_dst);
-    if (write_result < 0)
-    {
-        _log_state_msg(APP_STATE_OPERATIONAL_WITH_ERROR, "Failed data write");
-        goto free_dst;
-    }
+    if (fanout_start(&default_fanout, &args) != 0)
+        return -1;
 
-free_dst:
-    free(dst);
-exit:
+    fanned_out = 1;
     return 0;
 }
 
-static void sig_handler(int sig)
+/*
+    Wait for the queued records to be written to every output and stop.
+*/
+static void stop_ringbuf_consumer_fanout()
 {
-    if (sig == SIGTERM)
-    {
-        close_output_writer();
-        if (skel != NULL)
-        {
-            ameba__destroy(skel);
-        }
-        _log_state_msg(APP_STATE_STOPPED_NORMALLY, "Stopped... received termination signal");
-        exit(0);
-    }
+    if (!fanned_out)
+        return;
+
+    fanout_stop(&default_fanout);
+    fanned_out = 0;
 }
 
 static void parse_user_input(struct user_input *input, int argc, char *argv[])
@@ -272,6 +1675,49 @@ static int update_control_input_map(struct control_input *input)
     return ret;
 }
 
+/*
+    Set the output config used by the BPF programs from the ring buffer config.
+
+    Return:
+        See 'bpf_map__update_elem'.
+*/
+static int update_output_config_map(struct ringbuf_config *ringbuf)
+{
+    struct output_config config;
+    memset(&config, 0, sizeof(config));
+    if (ringbuf->wakeup_watermark < 0)
+        config.wakeup_watermark = ringbuf->size / OUTPUT_RINGBUF_WAKEUP_DIVISOR;
+    else
+        config.wakeup_watermark = (unsigned long long)ringbuf->wakeup_watermark;
+
+    __u32 key = 0;
+    int ret = bpf_map__update_elem(
+        skel->maps.ameba_output_config,
+        &key, sizeof(key),
+        &config, sizeof(config),
+        BPF_ANY
+    );
+    if (ret != 0)
+        return ret;
+
+    int dst_len = 128;
+    char dst[dst_len];
+
+    struct json_buffer s;
+    jsonify_core_init(&s, dst, dst_len);
+    jsonify_core_open_obj(&s);
+    jsonify_core_write_ulonglong(&s, "wakeup_watermark", config.wakeup_watermark);
+    jsonify_core_write_long(&s, "max_latency_ms", ringbuf->max_latency_ms);
+    jsonify_core_close_obj(&s);
+
+    _log_state_msg_and_js(
+        APP_STATE_STARTING,
+        "Ring buffer wakeup",
+        "ringbuf", &s
+    );
+    return 0;
+}
+
 static int get_control_input_from_map(struct control_input *result)
 {
     int lookup_flags;
@@ -317,7 +1763,7 @@ static void print_current_control_input()
 
 static void print_user_input(struct user_input *user_input)
 {
-    int dst_len = 1024;
+    int dst_len = 2048;
     char dst[dst_len];
 
     struct json_buffer s;
@@ -338,7 +1784,6 @@ static void print_user_input(struct user_input *user_input)
 int main(int argc, char *argv[])
 {
     int result;
-    struct ring_buffer *ringbuf = NULL;
     int err, ringbuf_map_fd;
     struct user_input input;
     
@@ -346,17 +1791,36 @@ int main(int argc, char *argv[])
 
     print_user_input(&input);
 
+    stop_tcp_writer_on_exit = !has_output_sink(&input, OUTPUT_TCP) || input.output_tcp.spill.dir[0] == '\0';
     signal(SIGTERM, sig_handler);
+    signal(SIGHUP, sig_handler);
     _log_state_msg(APP_STATE_STARTING, "Registered signal handler");
 
-    skel = ameba__open_and_load();
+    skel = ameba__open();
     if (!skel)
     {
-        _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Failed to load bpf skeleton");
+        _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Failed to open bpf skeleton");
         result = 1;
         return result;
     }
 
+    if (resize_ringbufs(&input.ringbuf) != 0)
+    {
+        _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Failed to resize ring buffers");
+        close_percpu_ringbuf_template();
+        result = 1;
+        goto skel_destroy;
+    }
+
+    err = ameba__load(skel);
+    close_percpu_ringbuf_template();
+    if (err != 0)
+    {
+        _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Failed to load bpf skeleton");
+        result = 1;
+        goto skel_destroy;
+    }
+
     result = update_control_input_map(&input.c_in);
     if (result != 0)
     {
@@ -367,12 +1831,26 @@ int main(int argc, char *argv[])
 
     print_current_control_input();
 
+    if (update_output_config_map(&input.ringbuf) != 0)
+    {
+        _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Error updating output config");
+        result = 1;
+        goto skel_destroy;
+    }
+
+    if (input.ringbuf.mode == RINGBUF_MODE_PERCPU && init_percpu_ringbufs(input.ringbuf.size) != 0)
+    {
+        _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Failed to create per-CPU ring buffers");
+        result = 1;
+        goto percpu_ringbufs_close;
+    }
+
     err = ameba__attach(skel);
     if (err != 0)
     {
         _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Error attaching skeleton");
         result = 1;
-        goto skel_destroy;
+        goto percpu_ringbufs_close;
     }
 
     // Locate ring buffer
@@ -384,32 +1862,124 @@ int main(int argc, char *argv[])
         goto skel_detach;
     }
 
-    ringbuf = ring_buffer__new(ringbuf_map_fd, handle_ringbuf_data, NULL, NULL);
+    if (init_ringbuf_groups(&input.ringbuf, ringbuf_map_fd) != 0)
+    {
+        _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Failed to create ring buffer consumer");
+        result = 1;
+        goto consumer_close;
+    }
 
-    int writer_error = init_output_writer(&input);
+    int writer_error = init_output_writers(&input);
     if (writer_error != 0)
     {
         _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Error creating output writer");
         result = 1;
-        goto skel_detach;
+        goto consumer_close;
     }
 
-     _log_state_msg_with_pid(APP_STATE_OPERATIONAL_PID, "Started successfully", getpid());
+    int poll_timeout_ms = get_ringbuf_poll_timeout_ms(&sink_writers[0]);
 
-    while (ring_buffer__poll(ringbuf, -1) >= 0)
+    if (sink_writers_len > 1)
     {
-        // collect prov in callback
+        if (start_ringbuf_consumer_fanout() != 0)
+        {
+            _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Error starting ring buffer consumer fanout");
+            close_output_writers();
+            result = 1;
+            goto consumer_close;
+        }
+        // The fanout sink threads flush the writers.
+        poll_timeout_ms = -1;
+    }
+    else if (input.pipeline_workers > 0)
+    {
+        if (start_ringbuf_consumer_pipeline(input.pipeline_workers, poll_timeout_ms) != 0)
+        {
+            _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Error starting ring buffer consumer pipeline");
+            close_output_writers();
+            result = 1;
+            goto consumer_close;
+        }
+        // The pipeline writer thread flushes the writer.
+        poll_timeout_ms = -1;
+    }
+
+    if (input.ringbuf.max_latency_ms < consumer_thread_poll_timeout_ms)
+        consumer_thread_poll_timeout_ms = (int)input.ringbuf.max_latency_ms;
+    if (poll_timeout_ms > 0 && poll_timeout_ms < consumer_thread_poll_timeout_ms)
+        consumer_thread_poll_timeout_ms = poll_timeout_ms;
+
+    if (start_ringbuf_group_threads() != 0)
+    {
+        _log_state_msg(APP_STATE_STOPPED_WITH_ERROR, "Error starting ring buffer consumer threads");
+        stop_ringbuf_group_threads();
+        stop_ringbuf_consumer_pipeline();
+        stop_ringbuf_consumer_fanout();
+        close_output_writers();
+        result = 1;
+        goto consumer_close;
+    }
+
+    _log_state_msg_with_pid(APP_STATE_OPERATIONAL_PID, "Started successfully", getpid());
+
+    // The main thread also reports the stats periodically.
+    ringbuf_groups[0].stats_config = &input.stats;
+    report_spool_stats = has_output_sink(&input, OUTPUT_TCP);
+    report_spill_stats = report_spool_stats && input.output_tcp.spill.dir[0] != '\0';
+    report_sink_stats = fanned_out;
+    schedule_stats_report(&input.stats);
+    if (input.stats.interval_sec > 0)
+    {
+        long stats_interval_ms = input.stats.interval_sec * 1000;
+        if (poll_timeout_ms < 0 || stats_interval_ms < poll_timeout_ms)
+            poll_timeout_ms = stats_interval_ms > INT_MAX ? INT_MAX : (int)stats_interval_ms;
+    }
+    // Records submitted without a wakeup are only seen when the poll times out.
+    if (poll_timeout_ms < 0 || poll_timeout_ms > input.ringbuf.max_latency_ms)
+        poll_timeout_ms = (int)input.ringbuf.max_latency_ms;
+
+    consume_ringbuf_group(&ringbuf_groups[0], poll_timeout_ms);
+
+    stop_ringbuf_group_threads();
+
+    app_state_t stop_state = exit_signal_received ? APP_STATE_STOPPED_NORMALLY : APP_STATE_STOPPED_WITH_ERROR;
+    if (exit_signal_received)
+    {
+        // Stop producing records and consume whatever is left in the ring buffers.
+        ameba__detach(skel);
+        consume_ringbuf_groups_tail();
+        result = 0;
     }
+    else
+    {
+        result = 1;
+    }
+
+    stop_ringbuf_consumer_pipeline();
+    stop_ringbuf_consumer_fanout();
 
 // log_file_close:
-    close_output_writer();
+    close_output_writers();
+
+    report_stats(stop_state, &input.stats);
+
+    if (exit_signal_received)
+    {
+        _log_state_msg(APP_STATE_STOPPED_NORMALLY, "Stopped... received termination signal");
+    }
+
+consumer_close:
+    close_ringbuf_groups();
 
 skel_detach:
     ameba__detach(skel);
 
+percpu_ringbufs_close:
+    close_percpu_ringbufs();
+
 skel_destroy:
     ameba__destroy(skel);
 
 // exit:
     return result;
-}
+}
\ No newline at end of file
@@ -18,10 +18,13 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
 #include <argp.h>
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <arpa/inet.h>
+#include <sys/un.h>
 
 
 #include "user/args/control.h"
@@ -44,6 +47,17 @@ static struct user_input global_user_input;
 enum
 {
     OPT_RECORD_OUTPUT_URI = 'o',
+    OPT_FORMAT = 'f',
+    OPT_PIPELINE_WORKERS = 'w',
+    OPT_RINGBUF_MODE = 'r',
+    OPT_RINGBUF_CONSUMERS = 'R',
+    OPT_RINGBUF_SIZE = 's',
+    OPT_RINGBUF_WAKEUP_WATERMARK = 'W',
+    OPT_RINGBUF_MAX_LATENCY = 'L',
+    OPT_STATS_INTERVAL = 'i',
+    OPT_STATS_FILE = 'S',
+    OPT_COLUMNAR_BATCH_ROWS = 'B',
+    OPT_COLUMNAR_MAX_AGE = 'A',
     OPT_VERSION = 'v',
     OPT_HELP = '?',
     OPT_USAGE = 'u'
@@ -51,10 +65,58 @@ enum
 
 // Option definitions
 static struct argp_option options[] = {
-    {"output-uri", OPT_RECORD_OUTPUT_URI, "URI", 0, "URI to write the records to. Supported: [file://<absolute file path>], or [udp://<ip>:port]", 0},
+    {"output-uri", OPT_RECORD_OUTPUT_URI, "URI", 0, "URI to write the records to: file://<absolute file path>, udp://<ip>:<port>, tcp://<ip>:<port>, unix://<absolute socket path> or shm://<absolute socket path>, followed by an optional ?<option>=<value>[&...] (see the output URI options below). Repeat it, once per scheme, to write the records to several outputs at once, each from its own thread and queue of 16M. Records that do not fit in the queue of a slow output are dropped for that output only", 0},
+    {"format", OPT_FORMAT, "FORMAT", 0, "Format to write the records in (json|binary|cbor|columnar), unless set by the output URI. 'binary' writes a stream header followed by the records as is, each prefixed by its length. 'cbor' writes a schema followed by a CBOR array per record. 'columnar' writes a schema followed by batches of columns per record type, and requires file output. Default json", 0},
+    {"columnar-batch-rows", OPT_COLUMNAR_BATCH_ROWS, "N", 0, "Records of a record type in a batch with '--format columnar'. Between 1 and 65536. Default 4096", 0},
+    {"columnar-max-age", OPT_COLUMNAR_MAX_AGE, "MILLISECONDS", 0, "Max time records are buffered with '--format columnar' before their batch is written even if not full. 0 to only write full batches. Default 1000", 0},
+    {"pipeline-workers", OPT_PIPELINE_WORKERS, "N", 0, "Number of threads to serialize records on. Records are drained from the ring buffer by one thread and written in order by another. 0 (default) to do everything on one thread", 0},
+    {"ringbuf-mode", OPT_RINGBUF_MODE, "MODE", 0, "Ring buffer mode (shared|percpu). 'percpu' creates one ring buffer per CPU", 0},
+    {"ringbuf-consumers", OPT_RINGBUF_CONSUMERS, "MODE", 0, "Ring buffer consumer threads (single|numa). 'numa' consumes the ring buffers of each NUMA node on its own thread. Requires '--ringbuf-mode percpu'", 0},
+    {"ringbuf-size", OPT_RINGBUF_SIZE, "SIZE", 0, "Size of each ring buffer in bytes with optional suffix K, M, or G. Must be a power of 2 between the page size and 1G. Default 16M, or with '--ringbuf-mode percpu' 64M split between the CPUs (between 256K and 16M each)", 0},
+    {"ringbuf-wakeup-watermark", OPT_RINGBUF_WAKEUP_WATERMARK, "SIZE", 0, "Pending bytes in a ring buffer at which the consumer is woken up, with optional suffix K, M, or G. Records below it are consumed within '--ringbuf-max-latency'. 0 to wake up for every record. Must be less than the ring buffer size. Default 1/8 of the ring buffer size", 0},
+    {"ringbuf-max-latency", OPT_RINGBUF_MAX_LATENCY, "MILLISECONDS", 0, "Max time a record waits in a ring buffer before it is consumed without a wakeup. Between 1 and 10000. Default 100", 0},
+    {"stats-interval", OPT_STATS_INTERVAL, "SECONDS", 0, "Interval to report the consumer stats and ring buffer drop counters at. 0 to only report at exit. Default 60", 0},
+    {"stats-file", OPT_STATS_FILE, "PATH", 0, "Absolute path of a file to (atomically) replace with the latest stats as JSON at every report", 0},
     {"version", OPT_VERSION, 0, 0, "Show version"},
     {"help", OPT_HELP, 0, 0, "Show help"},
     {"usage", OPT_USAGE, 0, 0, "Show usage"},
+
+    {0, 0, 0, 0, "Output URI options, any scheme", 0},
+    {"format=<json|binary|cbor|columnar>", 0, 0, OPTION_DOC, "Format of the output. Default '--format'", 0},
+
+    {0, 0, 0, 0, "Output URI options, file://", 0},
+    {"buffer_size=<bytes[K|M|G]>", 0, 0, OPTION_DOC, "Coalesce records before writing. 0 (default) to disable", 0},
+    {"flush_ms=<milliseconds>", 0, 0, OPTION_DOC, "Max age of coalesced records. 0 to disable", 0},
+    {"engine=<sync|uring>", 0, 0, OPTION_DOC, "Write synchronously (default) or asynchronously using io_uring", 0},
+    {"compression=<none|zstd|lz4>", 0, 0, OPTION_DOC, "Compress on a separate thread. Default from a '.zst' or '.lz4' path extension", 0},
+    {"compression_level=<level>", 0, 0, OPTION_DOC, "0 (default) for the codec default", 0},
+    {"compression_block_size=<bytes[K|M|G]>", 0, 0, OPTION_DOC, "Records compressed at a time. Default 128K", 0},
+    {"rotate_size=<bytes[K|M|G]>", 0, 0, OPTION_DOC, "Move the file aside and start a new one once this big. 0 (default) to disable", 0},
+    {"rotate_interval_sec=<seconds>", 0, 0, OPTION_DOC, "Move the file aside and start a new one this often. 0 (default) to disable. SIGHUP also rotates the file, and an existing file is rotated at startup instead of being truncated", 0},
+    {"rotate_retain=<N>", 0, 0, OPTION_DOC, "Rotated files to keep. 0 (default) to keep all", 0},
+
+    {0, 0, 0, 0, "Output URI options, udp://", 0},
+    {"datagram_size=<bytes>", 0, 0, OPTION_DOC, "Pack records into datagrams of this size. Default to fit a 1500 byte MTU, 0 for a datagram per record", 0},
+    {"batch=<N>", 0, 0, OPTION_DOC, "Datagrams sent per syscall. Default 32", 0},
+    {"flush_ms=<milliseconds>", 0, 0, OPTION_DOC, "Max age of packed records. 0 to disable", 0},
+
+    {0, 0, 0, 0, "Output URI options, tcp://", 0},
+    {"spool_size=<bytes[K|M|G]>", 0, 0, OPTION_DOC, "Records held while the collector is slow or down. Default 64M", 0},
+    {"spool_policy=<block|drop_oldest|drop_newest>", 0, 0, OPTION_DOC, "What to do when the spool is full. Default block", 0},
+    {"flush_ms=<milliseconds>", 0, 0, OPTION_DOC, "Max age of spooled records before they are sent", 0},
+    {"reconnect_min_ms=<milliseconds>", 0, 0, OPTION_DOC, "Lower bound of the exponential reconnect backoff. Default 100", 0},
+    {"reconnect_max_ms=<milliseconds>", 0, 0, OPTION_DOC, "Upper bound of the exponential reconnect backoff. Default 30000", 0},
+    {"spill_dir=<absolute dir path>", 0, 0, OPTION_DOC, "Spill records to disk while the collector is slow or down, and replay them in order. Requires spool_policy=block. Spilled records left at exit are replayed at the next start", 0},
+    {"spill_size=<bytes[K|M|G]>", 0, 0, OPTION_DOC, "Disk reserved for the spill. Default 1G", 0},
+    {"spill_segment_size=<bytes[K|M|G]>", 0, 0, OPTION_DOC, "Size of a spill segment file. Default 16M", 0},
+    {"compression=<none|zstd|lz4>", 0, 0, OPTION_DOC, "As for file://, with compression_level and compression_block_size. Every block is compressed into a frame of its own", 0},
+
+    {0, 0, 0, 0, "Output URI options, unix:// (a SOCK_SEQPACKET socket)", 0},
+    {"message_size=<bytes[K|M]>", 0, 0, OPTION_DOC, "Pack records into messages of this size. Default 64K, 0 for a message per record", 0},
+    {"flush_ms=<milliseconds>", 0, 0, OPTION_DOC, "Max age of packed records. 0 to disable", 0},
+
+    {0, 0, 0, 0, "Output URI options, shm:// (a shared memory ring handed to a local reader connecting to the socket)", 0},
+    {"size=<bytes[K|M|G]>", 0, 0, OPTION_DOC, "Size of the ring, a power of 2. Default 64M. Records are dropped and counted in the ring while it is full", 0},
     {0}
 };
 
@@ -85,21 +147,108 @@ static void init_user_input(struct user_input *input)
     memset(input, 0, sizeof(*input));
     input->o_type = default_output_type;
     memcpy(&(input->output_file.path), default_output_file_path, strlen(default_output_file_path));
+    input->output_file.flush_policy.buffer_size = 0;
+    input->output_file.flush_policy.flush_interval_ms = default_output_flush_interval_ms;
+    input->output_file.engine = OUTPUT_FILE_ENGINE_SYNC;
+    input->output_file.compression.codec = OUTPUT_COMPRESSION_NONE;
+    input->output_file.compression.level = 0;
+    input->output_file.compression.block_size = default_output_compression_block_size;
+    input->output_file.rotation.max_size = 0;
+    input->output_file.rotation.interval_sec = 0;
+    input->output_file.rotation.retain = 0;
+    input->format = OUTPUT_FORMAT_JSON;
+    input->sinks_len = 0;
+    input->columnar.batch_rows = default_columnar_batch_rows;
+    input->columnar.max_age_ms = default_columnar_max_age_ms;
+    input->pipeline_workers = 0;
+    input->ringbuf.mode = RINGBUF_MODE_SHARED;
+    input->ringbuf.consumers = RINGBUF_CONSUMERS_SINGLE;
+    // Set from the mode once parsed.
+    input->ringbuf.size = 0;
+    input->ringbuf.wakeup_watermark = default_ringbuf_wakeup_watermark;
+    input->ringbuf.max_latency_ms = default_ringbuf_max_latency_ms;
+    input->stats.interval_sec = default_stats_interval_sec;
+    input->stats.path[0] = '\0';
     input->output_net.ip_family = 0;
     input->output_net.port = -1;
     input->output_net.ip[0] = 0;
+    input->output_net.datagram_size = default_output_udp_datagram_size_ipv4;
+    input->output_net.batch = default_output_udp_batch;
+    input->output_net.flush_interval_ms = default_output_flush_interval_ms;
+    input->output_tcp.ip_family = 0;
+    input->output_tcp.ip[0] = 0;
+    input->output_tcp.port = -1;
+    input->output_tcp.spool_size = default_output_tcp_spool_size;
+    input->output_tcp.spool_policy = OUTPUT_SPOOL_POLICY_BLOCK;
+    input->output_tcp.flush_interval_ms = default_output_flush_interval_ms;
+    input->output_tcp.reconnect_min_ms = default_output_tcp_reconnect_min_ms;
+    input->output_tcp.reconnect_max_ms = default_output_tcp_reconnect_max_ms;
+    input->output_tcp.spill.dir[0] = '\0';
+    input->output_tcp.spill.max_size = default_output_spill_size;
+    input->output_tcp.spill.segment_size = default_output_spill_segment_size;
+    input->output_tcp.compression.codec = OUTPUT_COMPRESSION_NONE;
+    input->output_tcp.compression.level = 0;
+    input->output_tcp.compression.block_size = default_output_compression_block_size;
+    input->output_unix.path[0] = '\0';
+    input->output_unix.message_size = default_output_unix_message_size;
+    input->output_unix.flush_interval_ms = default_output_flush_interval_ms;
+    input->output_shm.path[0] = '\0';
+    input->output_shm.size = default_output_shm_size;
     user_args_helper_state_init(&(input->parse_state));
 }
 
+static int has_output_sink(struct user_input *input, enum output_type o_type)
+{
+    for (int i = 0; i < input->sinks_len; i++)
+        if (input->sinks[i].o_type == o_type)
+            return 1;
+    return 0;
+}
+
+static size_t min_ringbuf_size()
+{
+    long page_size = sysconf(_SC_PAGESIZE);
+    return page_size > 0 ? (size_t)page_size : 4096;
+}
+
+/*
+    Default size of each ring buffer. The per-CPU ring buffers share a total
+    size so that the locked memory does not grow with the number of CPUs.
+*/
+static size_t default_ringbuf_size_for(enum ringbuf_mode mode)
+{
+    if (mode != RINGBUF_MODE_PERCPU)
+        return default_ringbuf_size;
+
+    long ncpus = sysconf(_SC_NPROCESSORS_CONF);
+    size_t size = default_ringbuf_size;
+    while (ncpus > 0 && size > min_default_percpu_ringbuf_size && size * ncpus > default_percpu_ringbufs_total_size)
+        size >>= 1;
+    return size < min_ringbuf_size() ? min_ringbuf_size() : size;
+}
+
 static void validate_user_input(struct user_input *input, struct argp_state *state)
 {
-    if (input->o_type == OUTPUT_NONE)
+    // Without an output URI the records go to the default output.
+    if (input->sinks_len == 0 && input->o_type != OUTPUT_NONE)
     {
-        fprintf(stderr, "Must specify exactly one output method. Use --help.\n");
+        input->sinks[0].o_type = input->o_type;
+        input->sinks[0].format = 0;
+        input->sinks_len = 1;
+    }
+    if (input->sinks_len == 0)
+    {
+        fprintf(stderr, "Must specify an output method. Use --help.\n");
         user_args_helper_state_set_exit_error(&input->parse_state, -1);
         return;
     }
-    if (input->o_type == OUTPUT_NET)
+    // Outputs without a format of their own use '--format', which may come after them.
+    for (int i = 0; i < input->sinks_len; i++)
+        if (input->sinks[i].format == 0)
+            input->sinks[i].format = input->format;
+    input->o_type = input->sinks[0].o_type;
+
+    if (has_output_sink(input, OUTPUT_NET))
     {
         if (input->output_net.ip[0] == 0)
         {
@@ -114,11 +263,359 @@ static void validate_user_input(struct user_input *input, struct argp_state *sta
             return;
         }
     }
+    for (int i = 0; i < input->sinks_len; i++)
+    {
+        if (input->sinks[i].format == OUTPUT_FORMAT_COLUMNAR && input->sinks[i].o_type != OUTPUT_FILE)
+        {
+            fprintf(stderr, "Must use file output for the columnar format. Use --help.\n");
+            user_args_helper_state_set_exit_error(&input->parse_state, -1);
+            return;
+        }
+    }
+    // The compression writer has a single instance.
+    if (has_output_sink(input, OUTPUT_FILE) && input->output_file.compression.codec != OUTPUT_COMPRESSION_NONE
+        && has_output_sink(input, OUTPUT_TCP) && input->output_tcp.compression.codec != OUTPUT_COMPRESSION_NONE)
+    {
+        fprintf(stderr, "Must compress a single output. Use --help.\n");
+        user_args_helper_state_set_exit_error(&input->parse_state, -1);
+        return;
+    }
+    if (input->sinks_len > 1 && input->pipeline_workers > 0)
+    {
+        fprintf(stderr, "Must use a single output method with pipeline workers. Use --help.\n");
+        user_args_helper_state_set_exit_error(&input->parse_state, -1);
+        return;
+    }
+    if (input->ringbuf.consumers == RINGBUF_CONSUMERS_PER_NUMA_NODE && input->ringbuf.mode != RINGBUF_MODE_PERCPU)
+    {
+        fprintf(stderr, "Must use per-CPU ring buffers for per NUMA node consumers. Use --help.\n");
+        user_args_helper_state_set_exit_error(&input->parse_state, -1);
+        return;
+    }
+    if (input->ringbuf.size == 0)
+        input->ringbuf.size = default_ringbuf_size_for(input->ringbuf.mode);
+    if (input->ringbuf.wakeup_watermark >= 0 && (size_t)input->ringbuf.wakeup_watermark >= input->ringbuf.size)
+    {
+        fprintf(stderr, "Must use a ring buffer wakeup watermark less than the ring buffer size. Use --help.\n");
+        user_args_helper_state_set_exit_error(&input->parse_state, -1);
+        return;
+    }
+}
+
+/*
+    Parse a non-negative size with an optional suffix K, M, or G (i.e. powers of 1024).
+
+    Return:
+        0  => Success
+        -1 => Invalid size
+*/
+static int parse_size(const char *str, size_t *dst)
+{
+    if (!str || *str < '0' || *str > '9')
+        return -1;
+
+    char *endptr = NULL;
+    errno = 0;
+    unsigned long long val = strtoull(str, &endptr, 10);
+    if (errno != 0)
+        return -1;
+
+    int shift = 0;
+    switch (*endptr)
+    {
+        case 'K': case 'k': shift = 10; endptr++; break;
+        case 'M': case 'm': shift = 20; endptr++; break;
+        case 'G': case 'g': shift = 30; endptr++; break;
+        default: break;
+    }
+    if (*endptr != '\0' || val > (~0ULL >> shift))
+        return -1;
+
+    *dst = (size_t)(val << shift);
+    return 0;
+}
+
+/*
+    Parse a non-negative long.
+
+    Return:
+        0  => Success
+        -1 => Invalid value
+*/
+static int parse_non_negative_long(const char *str, long *dst)
+{
+    if (!str || *str < '0' || *str > '9')
+        return -1;
+
+    char *endptr = NULL;
+    errno = 0;
+    long val = strtol(str, &endptr, 10);
+    if (errno != 0 || *endptr != '\0')
+        return -1;
+
+    *dst = val;
+    return 0;
+}
+
+/*
+    Parse a URI option that sets output_flush_policy.
+
+    Return:
+        0  => Success
+        -1 => Invalid value
+        -2 => Not a flush policy option
+*/
+static int parse_arg_output_uri_option_flush_policy(
+    struct output_flush_policy *dst, const char *key, const char *val
+)
+{
+    if (strcmp(key, "buffer_size") == 0)
+    {
+        size_t buffer_size;
+        if (parse_size(val, &buffer_size) != 0 || buffer_size > max_output_buffer_size)
+            return -1;
+        dst->buffer_size = buffer_size;
+        return 0;
+    }
+    if (strcmp(key, "flush_ms") == 0)
+    {
+        long flush_interval_ms;
+        if (parse_non_negative_long(val, &flush_interval_ms) != 0)
+            return -1;
+        dst->flush_interval_ms = flush_interval_ms;
+        return 0;
+    }
+    return -2;
+}
+
+/*
+    Parse a URI option that sets output_compression.
+
+    Return:
+        0  => Success
+        -1 => Invalid value
+        -2 => Not a compression option
+*/
+static int parse_arg_output_uri_option_compression(
+    struct output_compression *dst, const char *key, const char *val
+)
+{
+    if (strcmp(key, "compression") == 0)
+    {
+        if (strcmp(val, "none") == 0)
+            dst->codec = OUTPUT_COMPRESSION_NONE;
+        else if (strcmp(val, "zstd") == 0)
+            dst->codec = OUTPUT_COMPRESSION_ZSTD;
+        else if (strcmp(val, "lz4") == 0)
+            dst->codec = OUTPUT_COMPRESSION_LZ4;
+        else
+            return -1;
+        return 0;
+    }
+    if (strcmp(key, "compression_level") == 0)
+    {
+        long level;
+        if (parse_non_negative_long(val, &level) != 0 || level > max_output_compression_level_zstd)
+            return -1;
+        dst->level = (int)level;
+        return 0;
+    }
+    if (strcmp(key, "compression_block_size") == 0)
+    {
+        size_t block_size;
+        if (parse_size(val, &block_size) != 0
+            || block_size < min_output_compression_block_size
+            || block_size > max_output_compression_block_size)
+            return -1;
+        dst->block_size = block_size;
+        return 0;
+    }
+    return -2;
+}
+
+/*
+    Parse a URI option that sets output_rotation.
+
+    Return:
+        0  => Success
+        -1 => Invalid value
+        -2 => Not a rotation option
+*/
+static int parse_arg_output_uri_option_rotation(
+    struct output_rotation *dst, const char *key, const char *val
+)
+{
+    if (strcmp(key, "rotate_size") == 0)
+    {
+        size_t max_size;
+        if (parse_size(val, &max_size) != 0 || (max_size > 0 && max_size < min_output_rotation_size))
+            return -1;
+        dst->max_size = max_size;
+        return 0;
+    }
+    if (strcmp(key, "rotate_interval_sec") == 0)
+    {
+        long interval_sec;
+        if (parse_non_negative_long(val, &interval_sec) != 0 || interval_sec > max_output_rotation_interval_sec)
+            return -1;
+        dst->interval_sec = interval_sec;
+        return 0;
+    }
+    if (strcmp(key, "rotate_retain") == 0)
+    {
+        long retain;
+        if (parse_non_negative_long(val, &retain) != 0 || retain > max_output_rotation_retain)
+            return -1;
+        dst->retain = (int)retain;
+        return 0;
+    }
+    return -2;
+}
+
+/*
+    Pick the codec from the extension of the path i.e. '.zst' or '.lz4'.
+*/
+static void set_output_compression_from_path(struct output_compression *dst, const char *path)
+{
+    size_t len = strlen(path);
+    if (len > 4 && strcmp(path + len - 4, ".zst") == 0)
+        dst->codec = OUTPUT_COMPRESSION_ZSTD;
+    else if (len > 4 && strcmp(path + len - 4, ".lz4") == 0)
+        dst->codec = OUTPUT_COMPRESSION_LZ4;
+}
+
+/*
+    Check that the codec is available in this build and the level is valid for it.
+
+    Return:
+        0  => Valid
+        -1 => Invalid. Error printed.
+*/
+static int validate_output_compression(struct output_compression *c, const char *uri_type)
+{
+    switch (c->codec)
+    {
+        case OUTPUT_COMPRESSION_ZSTD:
+#ifndef OUTPUT_COMPRESSION_HAVE_ZSTD
+            fprintf(stderr, "Invalid %s URI: zstd compression is not supported by this build\n", uri_type);
+            return -1;
+#endif
+            break;
+        case OUTPUT_COMPRESSION_LZ4:
+#ifndef OUTPUT_COMPRESSION_HAVE_LZ4
+            fprintf(stderr, "Invalid %s URI: lz4 compression is not supported by this build\n", uri_type);
+            return -1;
+#endif
+            if (c->level > max_output_compression_level_lz4)
+            {
+                fprintf(stderr, "Invalid %s URI: lz4 compression level must be between 0 and %ld\n", uri_type, max_output_compression_level_lz4);
+                return -1;
+            }
+            break;
+        default:
+            break;
+    }
+    return 0;
+}
+
+static int parse_arg_output_uri_option_file(struct user_input *dst, const char *key, const char *val)
+{
+    int err = parse_arg_output_uri_option_compression(&(dst->output_file.compression), key, val);
+    if (err != -2)
+        return err;
+
+    err = parse_arg_output_uri_option_rotation(&(dst->output_file.rotation), key, val);
+    if (err != -2)
+        return err;
+
+    if (strcmp(key, "engine") == 0)
+    {
+        if (strcmp(val, "sync") == 0)
+            dst->output_file.engine = OUTPUT_FILE_ENGINE_SYNC;
+        else if (strcmp(val, "uring") == 0)
+            dst->output_file.engine = OUTPUT_FILE_ENGINE_URING;
+        else
+            return -1;
+        return 0;
+    }
+    return parse_arg_output_uri_option_flush_policy(&(dst->output_file.flush_policy), key, val);
+}
+
+/*
+    Parse a record format name.
+
+    Return:
+        0  => Success
+        -1 => Invalid format
+*/
+static int parse_format(const char *str, enum output_format *dst)
+{
+    if (strcmp(str, "json") == 0)
+        *dst = OUTPUT_FORMAT_JSON;
+    else if (strcmp(str, "binary") == 0)
+        *dst = OUTPUT_FORMAT_BINARY;
+    else if (strcmp(str, "cbor") == 0)
+        *dst = OUTPUT_FORMAT_CBOR;
+    else if (strcmp(str, "columnar") == 0)
+        *dst = OUTPUT_FORMAT_COLUMNAR;
+    else
+        return -1;
+    return 0;
+}
+
+/*
+    Parse the options (i.e. the URI query) given as 'key=val' pairs joined by '&'.
+
+    'parse_option' is called for each pair and must return 0 on success, -1 on
+    invalid value, and -2 on unknown key.
+*/
+static void parse_arg_output_uri_options(
+    struct user_input *dst, const char *uri_name, const char *query,
+    int (*parse_option)(struct user_input *dst, const char *key, const char *val)
+)
+{
+    char *query_copy = strdup(query);
+    if (!query_copy) {
+        fprintf(stderr, "Invalid %s URI: failed to parse options\n", uri_name);
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+        return;
+    }
+
+    char *saveptr = NULL;
+    for (char *opt = strtok_r(query_copy, "&", &saveptr); opt != NULL; opt = strtok_r(NULL, "&", &saveptr))
+    {
+        char *val = strchr(opt, '=');
+        if (!val) {
+            fprintf(stderr, "Invalid %s URI: option '%s' is not of the form key=value\n", uri_name, opt);
+            user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+            break;
+        }
+        *val = '\0';
+        val++;
+
+        // Every output can have a format of its own.
+        int err;
+        if (strcmp(opt, "format") == 0)
+            err = parse_format(val, &(dst->sinks[dst->sinks_len].format));
+        else
+            err = parse_option(dst, opt, val);
+        if (err == -2) {
+            fprintf(stderr, "Invalid %s URI: unsupported option '%s'\n", uri_name, opt);
+            user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+            break;
+        } else if (err != 0) {
+            fprintf(stderr, "Invalid %s URI: invalid value '%s' for option '%s'\n", uri_name, val, opt);
+            user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+            break;
+        }
+    }
+
+    free(query_copy);
 }
 
 static void parse_arg_output_uri_file(struct user_input *dst, struct argp_state *state, const char* path)
 {
-    if (!path || strlen(path) == 0) {
+    if (!path || strlen(path) == 0 || path[0] == '?') {
         fprintf(stderr, "Invalid file URI: missing path\n");
         user_args_helper_state_set_exit_error(&dst->parse_state, -1);
         return;
@@ -130,18 +627,77 @@ static void parse_arg_output_uri_file(struct user_input *dst, struct argp_state
         return;
     }
 
-    if (strlen(path) > PATH_MAX) {
+    const char *query = strchr(path, '?');
+    size_t path_len = query ? (size_t)(query - path) : strlen(path);
+
+    if (path_len >= PATH_MAX) {
         fprintf(stderr, "Invalid file URI: path too long\n");
         user_args_helper_state_set_exit_error(&dst->parse_state, -1);
         return;
     }
 
-    strncpy(&(dst->output_file.path[0]), path, PATH_MAX);
+    memcpy(&(dst->output_file.path[0]), path, path_len);
+    dst->output_file.path[path_len] = '\0';
+
+    // The 'compression' option overrides the extension.
+    set_output_compression_from_path(&(dst->output_file.compression), dst->output_file.path);
+
+    if (query)
+    {
+        parse_arg_output_uri_options(dst, "file", query + 1, parse_arg_output_uri_option_file);
+        if (user_args_helper_state_is_exit_set(&dst->parse_state))
+            return;
+    }
+
+    if (validate_output_compression(&(dst->output_file.compression), "file") != 0)
+    {
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+        return;
+    }
 
     dst->o_type = OUTPUT_FILE;
 }
 
-static void parse_arg_output_uri_net_udp(struct user_input *dst, struct argp_state *state, const char *uri_stripped_val)
+static int parse_arg_output_uri_option_net(struct user_input *dst, const char *key, const char *val)
+{
+    if (strcmp(key, "datagram_size") == 0)
+    {
+        size_t datagram_size;
+        if (parse_size(val, &datagram_size) != 0 || datagram_size > max_output_udp_datagram_size)
+            return -1;
+        dst->output_net.datagram_size = datagram_size;
+        return 0;
+    }
+    if (strcmp(key, "batch") == 0)
+    {
+        long batch;
+        if (parse_non_negative_long(val, &batch) != 0 || batch < 1 || batch > max_output_udp_batch)
+            return -1;
+        dst->output_net.batch = (int)batch;
+        return 0;
+    }
+    if (strcmp(key, "flush_ms") == 0)
+    {
+        long flush_interval_ms;
+        if (parse_non_negative_long(val, &flush_interval_ms) != 0)
+            return -1;
+        dst->output_net.flush_interval_ms = flush_interval_ms;
+        return 0;
+    }
+    return -2;
+}
+
+/*
+    Parse '<ipv4>:<port>' or '[<ipv6>]:<port>', optionally followed by '?<options>'.
+
+    Return:
+        The options i.e. after '?' ("" if none)
+        NULL => Invalid. Error printed and the parse state set.
+*/
+static const char *parse_arg_output_uri_net_addr(
+    struct user_input *dst, const char *uri_name, const char *uri_stripped_val,
+    int *ip_family, char *ip, int *port
+)
 {
     const char *ip_start = uri_stripped_val;
     const char *ip_end = NULL;
@@ -153,80 +709,332 @@ static void parse_arg_output_uri_net_udp(struct user_input *dst, struct argp_sta
         ip_start++; // skip '['
         ip_end = strchr(ip_start, ']');
         if (!ip_end) {
-            fprintf(stderr, "Invalid UDP URI: unmatched '['\n");
+            fprintf(stderr, "Invalid %s URI: unmatched '['\n", uri_name);
             user_args_helper_state_set_exit_error(&dst->parse_state, -1);
-            return;
+            return NULL;
         }
 
         if (*(ip_end + 1) != ':') {
-            fprintf(stderr, "Invalid UDP URI: expected ':' after ']'\n");
+            fprintf(stderr, "Invalid %s URI: expected ':' after ']'\n", uri_name);
             user_args_helper_state_set_exit_error(&dst->parse_state, -1);
-            return;
+            return NULL;
         }
 
         ip_len = ip_end - ip_start;
-        if (ip_len == 0) {
-            fprintf(stderr, "Invalid UDP URI: empty IP\n");
+        if (ip_len == 0 || ip_len >= INET6_ADDRSTRLEN) {
+            fprintf(stderr, "Invalid %s URI: %s IP\n", uri_name, ip_len == 0 ? "empty" : "invalid");
             user_args_helper_state_set_exit_error(&dst->parse_state, -1);
-            return;
+            return NULL;
         }
 
-        strncpy(&(dst->output_net.ip[0]), ip_start, ip_len);
+        memcpy(ip, ip_start, ip_len);
+        ip[ip_len] = '\0';
         struct in6_addr ipv6;
-        if (inet_pton(AF_INET6, &(dst->output_net.ip[0]), &ipv6) == 0) {
-            fprintf(stderr, "Invalid UDP URI: invalid IPv6\n");
+        if (inet_pton(AF_INET6, ip, &ipv6) == 0) {
+            fprintf(stderr, "Invalid %s URI: invalid IPv6\n", uri_name);
             user_args_helper_state_set_exit_error(&dst->parse_state, -1);
-            return;
+            return NULL;
         }
 
         port_str = ip_end + 2; // skip "]:" to point to port
-        dst->output_net.ip_family = AF_INET6;
+        *ip_family = AF_INET6;
     } else {
         // ipv4
         ip_end = strchr(ip_start, ':');
         if (!ip_end) {
-            fprintf(stderr, "Invalid UDP URI: missing port\n");
+            fprintf(stderr, "Invalid %s URI: missing port\n", uri_name);
             user_args_helper_state_set_exit_error(&dst->parse_state, -1);
-            return;
+            return NULL;
         }
 
         ip_len = ip_end - ip_start;
-        if (ip_len == 0) {
-            fprintf(stderr, "Invalid UDP URI: empty IP\n");
+        if (ip_len == 0 || ip_len >= INET6_ADDRSTRLEN) {
+            fprintf(stderr, "Invalid %s URI: %s IP\n", uri_name, ip_len == 0 ? "empty" : "invalid");
             user_args_helper_state_set_exit_error(&dst->parse_state, -1);
-            return;
+            return NULL;
         }
 
-        strncpy(&(dst->output_net.ip[0]), ip_start, ip_len);
+        memcpy(ip, ip_start, ip_len);
+        ip[ip_len] = '\0';
         struct in_addr ipv4;
-        if (inet_pton(AF_INET, &(dst->output_net.ip[0]), &ipv4) == 0) {
-            fprintf(stderr, "Invalid UDP URI: invalid IPv4\n");
+        if (inet_pton(AF_INET, ip, &ipv4) == 0) {
+            fprintf(stderr, "Invalid %s URI: invalid IPv4\n", uri_name);
             user_args_helper_state_set_exit_error(&dst->parse_state, -1);
-            return;
+            return NULL;
         }
 
         port_str = ip_end + 1;
-        dst->output_net.ip_family = AF_INET;
+        *ip_family = AF_INET;
     }
 
     if (strlen(port_str) == 0) {
-        fprintf(stderr, "Invalid UDP URI: empty port\n");
+        fprintf(stderr, "Invalid %s URI: empty port\n", uri_name);
         user_args_helper_state_set_exit_error(&dst->parse_state, -1);
-        return;
+        return NULL;
     }
 
+    const char *query = strchr(port_str, '?');
     char *endptr = NULL;
-    long port = strtol(port_str, &endptr, 10);
-    if (*endptr != '\0' || port <= 0 || port > 65535) {
-        fprintf(stderr, "Invalid UDP URI: invalid port number\n");
+    long port_val = strtol(port_str, &endptr, 10);
+    if (endptr != (query ? query : port_str + strlen(port_str)) || port_val <= 0 || port_val > 65535) {
+        fprintf(stderr, "Invalid %s URI: invalid port number\n", uri_name);
         user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+        return NULL;
+    }
+
+    *port = (int)port_val;
+    return query ? query + 1 : "";
+}
+
+static void parse_arg_output_uri_net_udp(struct user_input *dst, struct argp_state *state, const char *uri_stripped_val)
+{
+    struct output_net *o_net = &(dst->output_net);
+    const char *query = parse_arg_output_uri_net_addr(
+        dst, "UDP", uri_stripped_val, &(o_net->ip_family), &(o_net->ip[0]), &(o_net->port)
+    );
+    if (!query)
         return;
+
+    o_net->datagram_size = o_net->ip_family == AF_INET6
+        ? default_output_udp_datagram_size_ipv6
+        : default_output_udp_datagram_size_ipv4;
+
+    if (*query)
+    {
+        parse_arg_output_uri_options(dst, "UDP", query, parse_arg_output_uri_option_net);
+        if (user_args_helper_state_is_exit_set(&dst->parse_state))
+            return;
     }
 
-    dst->output_net.port = (int)port;
     dst->o_type = OUTPUT_NET;
 }
 
+static int parse_arg_output_uri_option_tcp(struct user_input *dst, const char *key, const char *val)
+{
+    struct output_tcp *o_tcp = &(dst->output_tcp);
+    int err = parse_arg_output_uri_option_compression(&(o_tcp->compression), key, val);
+    if (err != -2)
+        return err;
+
+    if (strcmp(key, "spool_size") == 0)
+    {
+        size_t spool_size;
+        if (parse_size(val, &spool_size) != 0
+            || spool_size < min_output_tcp_spool_size
+            || spool_size > max_output_tcp_spool_size)
+            return -1;
+        o_tcp->spool_size = spool_size;
+        return 0;
+    }
+    if (strcmp(key, "spool_policy") == 0)
+    {
+        if (strcmp(val, "block") == 0)
+            o_tcp->spool_policy = OUTPUT_SPOOL_POLICY_BLOCK;
+        else if (strcmp(val, "drop_oldest") == 0)
+            o_tcp->spool_policy = OUTPUT_SPOOL_POLICY_DROP_OLDEST;
+        else if (strcmp(val, "drop_newest") == 0)
+            o_tcp->spool_policy = OUTPUT_SPOOL_POLICY_DROP_NEWEST;
+        else
+            return -1;
+        return 0;
+    }
+    if (strcmp(key, "flush_ms") == 0)
+        return parse_non_negative_long(val, &(o_tcp->flush_interval_ms));
+    if (strcmp(key, "reconnect_min_ms") == 0)
+    {
+        long ms;
+        if (parse_non_negative_long(val, &ms) != 0 || ms < 1)
+            return -1;
+        o_tcp->reconnect_min_ms = ms;
+        return 0;
+    }
+    if (strcmp(key, "reconnect_max_ms") == 0)
+    {
+        long ms;
+        if (parse_non_negative_long(val, &ms) != 0 || ms < 1)
+            return -1;
+        o_tcp->reconnect_max_ms = ms;
+        return 0;
+    }
+    if (strcmp(key, "spill_dir") == 0)
+    {
+        if (val[0] != '/' || strlen(val) >= sizeof(o_tcp->spill.dir))
+            return -1;
+        strcpy(o_tcp->spill.dir, val);
+        return 0;
+    }
+    if (strcmp(key, "spill_size") == 0)
+        return parse_size(val, &(o_tcp->spill.max_size));
+    if (strcmp(key, "spill_segment_size") == 0)
+    {
+        size_t segment_size;
+        if (parse_size(val, &segment_size) != 0
+            || segment_size < min_output_spill_segment_size
+            || segment_size > max_output_spill_segment_size)
+            return -1;
+        o_tcp->spill.segment_size = segment_size;
+        return 0;
+    }
+    return -2;
+}
+
+static void parse_arg_output_uri_net_tcp(struct user_input *dst, struct argp_state *state, const char *uri_stripped_val)
+{
+    struct output_tcp *o_tcp = &(dst->output_tcp);
+    const char *query = parse_arg_output_uri_net_addr(
+        dst, "TCP", uri_stripped_val, &(o_tcp->ip_family), &(o_tcp->ip[0]), &(o_tcp->port)
+    );
+    if (!query)
+        return;
+
+    if (*query)
+    {
+        parse_arg_output_uri_options(dst, "TCP", query, parse_arg_output_uri_option_tcp);
+        if (user_args_helper_state_is_exit_set(&dst->parse_state))
+            return;
+    }
+
+    if (o_tcp->reconnect_max_ms < o_tcp->reconnect_min_ms)
+    {
+        fprintf(stderr, "Invalid TCP URI: reconnect_max_ms must not be less than reconnect_min_ms\n");
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+        return;
+    }
+
+    if (o_tcp->spill.dir[0] != '\0')
+    {
+        // Spilled records are replayed into a TCP writer that waits for the collector.
+        if (o_tcp->spool_policy != OUTPUT_SPOOL_POLICY_BLOCK)
+        {
+            fprintf(stderr, "Invalid TCP URI: spill_dir requires spool_policy=block\n");
+            user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+            return;
+        }
+        if (o_tcp->spill.max_size / o_tcp->spill.segment_size < 2)
+        {
+            fprintf(stderr, "Invalid TCP URI: spill_size must hold at least 2 segments\n");
+            user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+            return;
+        }
+    }
+
+    if (validate_output_compression(&(o_tcp->compression), "TCP") != 0)
+    {
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+        return;
+    }
+
+    dst->o_type = OUTPUT_TCP;
+}
+
+/*
+    Parse '<absolute socket path>', optionally followed by '?<options>'.
+
+    Return:
+        The options (empty if none)
+        NULL => Invalid. The parse state is set to exit.
+*/
+static const char *parse_arg_output_uri_socket_path(
+    struct user_input *dst, const char *uri_name, const char *val, char *path_dst
+)
+{
+    if (!val || val[0] != '/') {
+        fprintf(stderr, "Invalid %s URI: path is missing or not absolute\n", uri_name);
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+        return NULL;
+    }
+
+    const char *query = strchr(val, '?');
+    size_t path_len = query ? (size_t)(query - val) : strlen(val);
+
+    if (path_len >= sizeof(((struct sockaddr_un *)0)->sun_path)) {
+        fprintf(stderr, "Invalid %s URI: path too long for a unix socket\n", uri_name);
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+        return NULL;
+    }
+
+    memcpy(path_dst, val, path_len);
+    path_dst[path_len] = '\0';
+    return query ? query + 1 : "";
+}
+
+static int parse_arg_output_uri_option_unix(struct user_input *dst, const char *key, const char *val)
+{
+    if (strcmp(key, "message_size") == 0)
+    {
+        size_t message_size;
+        if (parse_size(val, &message_size) != 0 || message_size > max_output_unix_message_size)
+            return -1;
+        dst->output_unix.message_size = message_size;
+        return 0;
+    }
+    if (strcmp(key, "flush_ms") == 0)
+        return parse_non_negative_long(val, &(dst->output_unix.flush_interval_ms));
+    return -2;
+}
+
+static void parse_arg_output_uri_unix(struct user_input *dst, struct argp_state *state, const char *val)
+{
+    const char *query = parse_arg_output_uri_socket_path(dst, "unix", val, &(dst->output_unix.path[0]));
+    if (!query)
+        return;
+
+    if (*query)
+    {
+        parse_arg_output_uri_options(dst, "unix", query, parse_arg_output_uri_option_unix);
+        if (user_args_helper_state_is_exit_set(&dst->parse_state))
+            return;
+    }
+
+    dst->o_type = OUTPUT_UNIX;
+}
+
+static int parse_arg_output_uri_option_shm(struct user_input *dst, const char *key, const char *val)
+{
+    if (strcmp(key, "size") == 0)
+    {
+        size_t size;
+        if (parse_size(val, &size) != 0
+            || size < min_output_shm_size
+            || size > max_output_shm_size
+            || (size & (size - 1)) != 0)
+            return -1;
+        dst->output_shm.size = size;
+        return 0;
+    }
+    return -2;
+}
+
+static void parse_arg_output_uri_shm(struct user_input *dst, struct argp_state *state, const char *val)
+{
+    const char *query = parse_arg_output_uri_socket_path(dst, "shm", val, &(dst->output_shm.path[0]));
+    if (!query)
+        return;
+
+    if (*query)
+    {
+        parse_arg_output_uri_options(dst, "shm", query, parse_arg_output_uri_option_shm);
+        if (user_args_helper_state_is_exit_set(&dst->parse_state))
+            return;
+    }
+
+    dst->o_type = OUTPUT_SHM;
+}
+
+/*
+    Add the output of the URI just parsed i.e. 'o_type'.
+*/
+static void add_output_sink(struct user_input *dst)
+{
+    if (has_output_sink(dst, dst->o_type)) {
+        fprintf(stderr, "Invalid URI: only one output URI per scheme is supported\n");
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+        return;
+    }
+    dst->sinks[dst->sinks_len].o_type = dst->o_type;
+    dst->sinks_len++;
+}
+
 static void parse_arg_output_uri(struct user_input *dst, char *arg, struct argp_state *state)
 {
     if (!arg || strlen(arg) == 0) {
@@ -234,17 +1042,37 @@ static void parse_arg_output_uri(struct user_input *dst, char *arg, struct argp_
         return;
     }
 
+    if (dst->sinks_len == MAX_OUTPUT_SINKS) {
+        fprintf(stderr, "Invalid URI: too many output URIs\n");
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+        return;
+    }
+    // Set by the 'format' option of the URI, if any.
+    dst->sinks[dst->sinks_len].format = 0;
+
     if (strncmp(arg, "file://", 7) == 0) {
         const char *path = arg + 7;
         parse_arg_output_uri_file(dst, state, path);
     } else if (strncmp(arg, "udp://", 6) == 0) {
         const char *addr = arg + 6;
         parse_arg_output_uri_net_udp(dst, state, addr);
+    } else if (strncmp(arg, "tcp://", 6) == 0) {
+        const char *addr = arg + 6;
+        parse_arg_output_uri_net_tcp(dst, state, addr);
+    } else if (strncmp(arg, "unix://", 7) == 0) {
+        const char *path = arg + 7;
+        parse_arg_output_uri_unix(dst, state, path);
+    } else if (strncmp(arg, "shm://", 6) == 0) {
+        const char *path = arg + 6;
+        parse_arg_output_uri_shm(dst, state, path);
     } else {
-        fprintf(stderr, "Unsupported URI scheme. Use file:// or udp://\n");
+        fprintf(stderr, "Unsupported URI scheme. Use file://, udp://, tcp://, unix://, or shm://\n");
         user_args_helper_state_set_exit_error(&dst->parse_state, -1);
         return;
     }
+
+    if (!user_args_helper_state_is_exit_set(&dst->parse_state))
+        add_output_sink(dst);
 }
 
 void print_app_version()
@@ -264,6 +1092,141 @@ void print_app_version()
     fprintf(stdout, "%s\n", &dst[0]);
 }
 
+static void parse_arg_format(struct user_input *dst, char *arg, struct argp_state *state)
+{
+    if (parse_format(arg, &(dst->format)) != 0)
+    {
+        fprintf(stderr, "Invalid format: must be 'json', 'binary', 'cbor' or 'columnar'\n");
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+    }
+}
+
+static void parse_arg_columnar_batch_rows(struct user_input *dst, char *arg, struct argp_state *state)
+{
+    long batch_rows;
+    if (parse_non_negative_long(arg, &batch_rows) != 0 || batch_rows < 1 || (unsigned long)batch_rows > max_columnar_batch_rows)
+    {
+        fprintf(stderr, "Invalid columnar batch rows: must be between 1 and %lu\n", max_columnar_batch_rows);
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+        return;
+    }
+    dst->columnar.batch_rows = (unsigned long)batch_rows;
+}
+
+static void parse_arg_columnar_max_age(struct user_input *dst, char *arg, struct argp_state *state)
+{
+    long max_age_ms;
+    if (parse_non_negative_long(arg, &max_age_ms) != 0)
+    {
+        fprintf(stderr, "Invalid columnar max age: must be a non-negative number of milliseconds\n");
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+        return;
+    }
+    dst->columnar.max_age_ms = max_age_ms;
+}
+
+static void parse_arg_pipeline_workers(struct user_input *dst, char *arg, struct argp_state *state)
+{
+    long workers;
+    if (parse_non_negative_long(arg, &workers) != 0 || workers > max_pipeline_workers)
+    {
+        fprintf(stderr, "Invalid pipeline workers: must be between 0 and %d\n", max_pipeline_workers);
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+        return;
+    }
+    dst->pipeline_workers = (int)workers;
+}
+
+static void parse_arg_ringbuf_mode(struct user_input *dst, char *arg, struct argp_state *state)
+{
+    if (strcmp(arg, "shared") == 0)
+        dst->ringbuf.mode = RINGBUF_MODE_SHARED;
+    else if (strcmp(arg, "percpu") == 0)
+        dst->ringbuf.mode = RINGBUF_MODE_PERCPU;
+    else
+    {
+        fprintf(stderr, "Invalid ring buffer mode: must be 'shared' or 'percpu'\n");
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+    }
+}
+
+static void parse_arg_ringbuf_consumers(struct user_input *dst, char *arg, struct argp_state *state)
+{
+    if (strcmp(arg, "single") == 0)
+        dst->ringbuf.consumers = RINGBUF_CONSUMERS_SINGLE;
+    else if (strcmp(arg, "numa") == 0)
+        dst->ringbuf.consumers = RINGBUF_CONSUMERS_PER_NUMA_NODE;
+    else
+    {
+        fprintf(stderr, "Invalid ring buffer consumers: must be 'single' or 'numa'\n");
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+    }
+}
+
+static void parse_arg_ringbuf_size(struct user_input *dst, char *arg, struct argp_state *state)
+{
+    size_t size;
+    if (
+        parse_size(arg, &size) != 0
+        || size < min_ringbuf_size() || size > max_ringbuf_size
+        || (size & (size - 1)) != 0
+    )
+    {
+        fprintf(stderr, "Invalid ring buffer size: must be a power of 2 between %lu and %lu bytes\n", min_ringbuf_size(), max_ringbuf_size);
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+        return;
+    }
+    dst->ringbuf.size = size;
+}
+
+static void parse_arg_ringbuf_wakeup_watermark(struct user_input *dst, char *arg, struct argp_state *state)
+{
+    size_t watermark;
+    if (parse_size(arg, &watermark) != 0 || watermark >= max_ringbuf_size)
+    {
+        fprintf(stderr, "Invalid ring buffer wakeup watermark: must be a size less than %lu bytes\n", max_ringbuf_size);
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+        return;
+    }
+    dst->ringbuf.wakeup_watermark = (long)watermark;
+}
+
+static void parse_arg_ringbuf_max_latency(struct user_input *dst, char *arg, struct argp_state *state)
+{
+    long latency_ms;
+    if (parse_non_negative_long(arg, &latency_ms) != 0 || latency_ms < 1 || latency_ms > max_ringbuf_max_latency_ms)
+    {
+        fprintf(stderr, "Invalid ring buffer max latency: must be between 1 and %ld milliseconds\n", max_ringbuf_max_latency_ms);
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+        return;
+    }
+    dst->ringbuf.max_latency_ms = latency_ms;
+}
+
+static void parse_arg_stats_interval(struct user_input *dst, char *arg, struct argp_state *state)
+{
+    long interval_sec;
+    if (parse_non_negative_long(arg, &interval_sec) != 0)
+    {
+        fprintf(stderr, "Invalid stats interval: must be a non-negative number of seconds\n");
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+        return;
+    }
+    dst->stats.interval_sec = interval_sec;
+}
+
+static void parse_arg_stats_file(struct user_input *dst, char *arg, struct argp_state *state)
+{
+    // Room for the temporary file suffix used for atomic replacement.
+    if (!arg || arg[0] != '/' || strlen(arg) >= PATH_MAX - 8)
+    {
+        fprintf(stderr, "Invalid stats file: must be an absolute path\n");
+        user_args_helper_state_set_exit_error(&dst->parse_state, -1);
+        return;
+    }
+    strncpy(&(dst->stats.path[0]), arg, PATH_MAX - 1);
+}
+
 static error_t parse_opt(int key, char *arg, struct argp_state *state)
 {
     struct user_input *input = get_global_user_input();
@@ -274,6 +1237,50 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state)
         parse_arg_output_uri(input, arg, state);
         break;
 
+    case OPT_FORMAT:
+        parse_arg_format(input, arg, state);
+        break;
+
+    case OPT_COLUMNAR_BATCH_ROWS:
+        parse_arg_columnar_batch_rows(input, arg, state);
+        break;
+
+    case OPT_COLUMNAR_MAX_AGE:
+        parse_arg_columnar_max_age(input, arg, state);
+        break;
+
+    case OPT_PIPELINE_WORKERS:
+        parse_arg_pipeline_workers(input, arg, state);
+        break;
+
+    case OPT_RINGBUF_MODE:
+        parse_arg_ringbuf_mode(input, arg, state);
+        break;
+
+    case OPT_RINGBUF_CONSUMERS:
+        parse_arg_ringbuf_consumers(input, arg, state);
+        break;
+
+    case OPT_RINGBUF_SIZE:
+        parse_arg_ringbuf_size(input, arg, state);
+        break;
+
+    case OPT_RINGBUF_WAKEUP_WATERMARK:
+        parse_arg_ringbuf_wakeup_watermark(input, arg, state);
+        break;
+
+    case OPT_RINGBUF_MAX_LATENCY:
+        parse_arg_ringbuf_max_latency(input, arg, state);
+        break;
+
+    case OPT_STATS_INTERVAL:
+        parse_arg_stats_interval(input, arg, state);
+        break;
+
+    case OPT_STATS_FILE:
+        parse_arg_stats_file(input, arg, state);
+        break;
+
     case OPT_VERSION:
         print_app_version();
         user_args_helper_state_set_exit_no_error(&input->parse_state);
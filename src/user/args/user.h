@@ -32,6 +32,92 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 static enum output_type default_output_type = OUTPUT_FILE;
 static const char *default_output_file_path = "/tmp/current_prov_log.json";
+static const long default_output_flush_interval_ms = 50;
+static const size_t max_output_buffer_size = 1UL << 30;
+
+/*
+    Output compression defaults and limits
+*/
+static const size_t default_output_compression_block_size = 128UL << 10;
+static const size_t min_output_compression_block_size = 4096;
+static const size_t max_output_compression_block_size = 64UL << 20;
+static const long max_output_compression_level_zstd = 22;
+static const long max_output_compression_level_lz4 = 12;
+
+/*
+    UDP output defaults and limits
+*/
+// Fits the Ethernet MTU after the IPv4 (20) or IPv6 (40), and UDP (8) headers.
+static const size_t default_output_udp_datagram_size_ipv4 = 1472;
+static const size_t default_output_udp_datagram_size_ipv6 = 1452;
+static const size_t max_output_udp_datagram_size = 65507;
+static const int default_output_udp_batch = 32;
+static const long max_output_udp_batch = 1024;
+
+/*
+    TCP output defaults and limits
+*/
+static const size_t default_output_tcp_spool_size = 64UL << 20;
+static const size_t min_output_tcp_spool_size = 64UL << 10;
+static const size_t max_output_tcp_spool_size = 1UL << 30;
+static const long default_output_tcp_reconnect_min_ms = 100;
+static const long default_output_tcp_reconnect_max_ms = 30000;
+
+/*
+    Output spill defaults and limits
+*/
+static const size_t default_output_spill_size = 1UL << 30;
+static const size_t default_output_spill_segment_size = 16UL << 20;
+static const size_t min_output_spill_segment_size = 64UL << 10;
+static const size_t max_output_spill_segment_size = 1UL << 30;
+
+/*
+    Unix socket and shared memory output defaults and limits
+*/
+static const size_t default_output_unix_message_size = 64UL << 10;
+// Fits the default socket send buffer.
+static const size_t max_output_unix_message_size = 128UL << 10;
+static const size_t default_output_shm_size = 64UL << 20;
+static const size_t min_output_shm_size = 64UL << 10;
+static const size_t max_output_shm_size = 1UL << 32;
+
+/*
+    Output rotation limits
+*/
+static const size_t min_output_rotation_size = 64UL << 10;
+static const long max_output_rotation_interval_sec = 366L * 24 * 60 * 60;
+static const long max_output_rotation_retain = 100000;
+
+/*
+    Pipeline limits
+*/
+static const int max_pipeline_workers = 256;
+
+/*
+    Ring buffer defaults and limits
+*/
+static const size_t default_ringbuf_size = 16UL << 20;
+// Default total size of the per-CPU ring buffers (locked memory), split
+// between the CPUs. Each one within [min_default_percpu_ringbuf_size, default_ringbuf_size].
+static const size_t default_percpu_ringbufs_total_size = 64UL << 20;
+static const size_t min_default_percpu_ringbuf_size = 256UL << 10;
+// The min size is the page size.
+static const size_t max_ringbuf_size = 1UL << 30;
+static const long default_ringbuf_wakeup_watermark = -1;
+static const long default_ringbuf_max_latency_ms = OUTPUT_RINGBUF_MAX_POLL_LATENCY_MS;
+static const long max_ringbuf_max_latency_ms = 10000;
+
+/*
+    Columnar format defaults and limits
+*/
+static const unsigned long default_columnar_batch_rows = 4096;
+static const unsigned long max_columnar_batch_rows = 65536;
+static const long default_columnar_max_age_ms = 1000;
+
+/*
+    Stats defaults
+*/
+static const long default_stats_interval_sec = 60;
 
 /*
     Copy value of internal global struct user_input to dst.
@@ -25,4 +25,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #define ERR_RECORD_INVALID_HEADER -4
 #define ERR_RECORD_INVALID_MAGIC -5
 #define ERR_RECORD_SIZE_MISMATCH -6
-#define ERR_RECORD_UNKNOWN -7
\ No newline at end of file
+#define ERR_RECORD_UNKNOWN -7
+#define ERR_STREAM_INVALID_HEADER -8
+#define ERR_STREAM_UNSUPPORTED -9
+#define ERR_STREAM_IO -10
+#define ERR_STREAM_CLOSED -11
\ No newline at end of file
@@ -0,0 +1,338 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "user/fanout/fanout.h"
+#include "user/jsonify/core.h"
+
+
+/*
+    Alignment (bytes) of the entries in a queue.
+*/
+#define FANOUT_ENTRY_ALIGN 8
+
+/*
+    Length of an entry that marks the rest of the queue up to its end as unused.
+*/
+#define FANOUT_ENTRY_PAD UINT32_MAX
+
+#define ALIGN_UP(n, a) (((n) + (a) - 1) & ~((uint64_t)(a) - 1))
+
+#define STATS_ADD(stats, field, n) __atomic_fetch_add(&(stats)->field, (n), __ATOMIC_RELAXED)
+
+
+static void log_error(struct fanout *f, const char *msg)
+{
+    if (f->args.log_error)
+        f->args.log_error(msg);
+}
+
+static void deadline_after_ms(struct timespec *dst, long ms)
+{
+    clock_gettime(CLOCK_REALTIME, dst);
+    dst->tv_sec += ms / 1000;
+    dst->tv_nsec += (ms % 1000) * 1000000L;
+    dst->tv_sec += dst->tv_nsec / 1000000000L;
+    dst->tv_nsec %= 1000000000L;
+}
+
+static long elapsed_ms(struct timespec *since)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - since->tv_sec) * 1000 + (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+/*
+    Wait for records to be queued, for the sink to be stopped, or for the
+    flush interval to pass.
+*/
+static void wait_for_records(struct fanout_sink *sink)
+{
+    pthread_mutex_lock(&sink->lock);
+    // The drain thread only signals while this is set. Check again after setting it.
+    __atomic_store_n(&sink->waiting, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&sink->head, __ATOMIC_SEQ_CST) == sink->tail
+        && !__atomic_load_n(&sink->exiting, __ATOMIC_SEQ_CST))
+    {
+        if (sink->args.flush_interval_ms > 0)
+        {
+            struct timespec deadline;
+            deadline_after_ms(&deadline, sink->args.flush_interval_ms);
+            pthread_cond_timedwait(&sink->cond, &sink->lock, &deadline);
+        }
+        else
+        {
+            pthread_cond_wait(&sink->cond, &sink->lock);
+        }
+    }
+    __atomic_store_n(&sink->waiting, 0, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&sink->lock);
+}
+
+static void write_entry(struct fanout_sink *sink, struct fanout_entry *entry)
+{
+    struct fanout *f = sink->fanout;
+
+    int write_result = sink->args.writer->write(entry + 1, entry->len);
+    if (write_result < 0)
+    {
+        STATS_ADD(&sink->stats, write_errors, 1);
+        STATS_ADD(f->args.stats, write_errors, 1);
+        log_error(f, "Failed data write");
+        return;
+    }
+    STATS_ADD(&sink->stats, records, 1);
+    STATS_ADD(&sink->stats, bytes_written, write_result);
+    STATS_ADD(f->args.stats, bytes_written, write_result);
+}
+
+static void *sink_main(void *arg)
+{
+    struct fanout_sink *sink = (struct fanout_sink *)arg;
+    struct fanout *f = sink->fanout;
+    uint64_t size = f->args.queue_size;
+    long flush_interval_ms = sink->args.flush_interval_ms;
+
+    struct timespec last_flush;
+    clock_gettime(CLOCK_MONOTONIC, &last_flush);
+
+    while (1)
+    {
+        // Also while records keep coming, so that none of them waits longer.
+        if (flush_interval_ms > 0 && elapsed_ms(&last_flush) >= flush_interval_ms)
+        {
+            if (sink->args.writer->flush(0) == -1)
+                log_error(f, "Failed data flush");
+            clock_gettime(CLOCK_MONOTONIC, &last_flush);
+        }
+
+        if (__atomic_load_n(&sink->head, __ATOMIC_ACQUIRE) == sink->tail)
+        {
+            // Only set once nothing is submitted anymore. Therefore, the queue is drained.
+            if (__atomic_load_n(&sink->exiting, __ATOMIC_ACQUIRE))
+                break;
+            wait_for_records(sink);
+            continue;
+        }
+
+        uint64_t pos = sink->tail & (size - 1);
+        struct fanout_entry *entry = (struct fanout_entry *)&sink->queue[pos];
+        uint64_t entry_len = size - pos;
+        if (entry->len != FANOUT_ENTRY_PAD)
+        {
+            write_entry(sink, entry);
+            entry_len = ALIGN_UP(sizeof(*entry) + entry->len, FANOUT_ENTRY_ALIGN);
+        }
+        __atomic_store_n(&sink->tail, sink->tail + entry_len, __ATOMIC_RELEASE);
+    }
+
+    return NULL;
+}
+
+/*
+    Copy the serialized record into the queue of the sink, unless full.
+*/
+static void enqueue(struct fanout_sink *sink, const char *data, size_t data_len)
+{
+    uint64_t size = sink->fanout->args.queue_size;
+    uint64_t entry_len = ALIGN_UP(sizeof(struct fanout_entry) + data_len, FANOUT_ENTRY_ALIGN);
+    uint64_t head = sink->head;
+    uint64_t tail = __atomic_load_n(&sink->tail, __ATOMIC_ACQUIRE);
+    uint64_t pos = head & (size - 1);
+    uint64_t to_end = size - pos;
+    // A record not fitting before the end starts over at the start of the queue.
+    uint64_t need = entry_len <= to_end ? entry_len : to_end + entry_len;
+
+    if (entry_len > size || head + need - tail > size)
+    {
+        STATS_ADD(&sink->stats, dropped_records, 1);
+        STATS_ADD(&sink->stats, dropped_bytes, data_len);
+        return;
+    }
+
+    if (entry_len > to_end)
+    {
+        struct fanout_entry *pad = (struct fanout_entry *)&sink->queue[pos];
+        pad->len = FANOUT_ENTRY_PAD;
+        head += to_end;
+        pos = 0;
+    }
+
+    struct fanout_entry *entry = (struct fanout_entry *)&sink->queue[pos];
+    entry->len = (uint32_t)data_len;
+    entry->reserved = 0;
+    memcpy(entry + 1, data, data_len);
+
+    // Publish before checking for a waiting sink thread, which checks 'head' after setting 'waiting'.
+    __atomic_store_n(&sink->head, head + entry_len, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&sink->waiting, __ATOMIC_SEQ_CST))
+    {
+        pthread_mutex_lock(&sink->lock);
+        pthread_cond_signal(&sink->cond);
+        pthread_mutex_unlock(&sink->lock);
+    }
+}
+
+/*
+    Stop and join the started sink threads, and free everything.
+*/
+static void free_fanout(struct fanout *f)
+{
+    for (int i = 0; i < f->args.sinks_len; i++)
+    {
+        struct fanout_sink *sink = &f->sinks[i];
+        if (sink->thread_started)
+        {
+            pthread_mutex_lock(&sink->lock);
+            __atomic_store_n(&sink->exiting, 1, __ATOMIC_SEQ_CST);
+            pthread_cond_signal(&sink->cond);
+            pthread_mutex_unlock(&sink->lock);
+            pthread_join(sink->thread, NULL);
+            sink->thread_started = 0;
+        }
+        if (sink->queue)
+        {
+            pthread_cond_destroy(&sink->cond);
+            pthread_mutex_destroy(&sink->lock);
+            free(sink->queue);
+            sink->queue = NULL;
+        }
+    }
+
+    for (int i = 0; i < f->serializers_len; i++)
+    {
+        free(f->dst[i]);
+        f->dst[i] = NULL;
+    }
+}
+
+/*
+    Get the index of the serializer in 'serializers', adding it if new.
+*/
+static int add_serializer(struct fanout *f, const struct record_serializer *serializer)
+{
+    for (int i = 0; i < f->serializers_len; i++)
+        if (f->serializers[i] == serializer)
+            return i;
+
+    f->serializers[f->serializers_len] = serializer;
+    return f->serializers_len++;
+}
+
+int fanout_start(struct fanout *f, struct fanout_args *args)
+{
+    if (!f || !args || args->sinks_len <= 0 || args->sinks_len > FANOUT_MAX_SINKS || !args->stats)
+        return -1;
+    for (int i = 0; i < args->sinks_len; i++)
+        if (!args->sinks[i].serializer || !args->sinks[i].writer)
+            return -1;
+
+    memset(f, 0, sizeof(struct fanout));
+    memcpy(&f->args, args, sizeof(struct fanout_args));
+    if (f->args.queue_size == 0)
+        f->args.queue_size = FANOUT_DEFAULT_QUEUE_SIZE;
+    if ((f->args.queue_size & (f->args.queue_size - 1)) != 0 || f->args.queue_size < FANOUT_ENTRY_ALIGN)
+        return -1;
+
+    f->dst_slot_size = MAX_BUFFER_LEN;
+
+    for (int i = 0; i < f->args.sinks_len; i++)
+    {
+        struct fanout_sink *sink = &f->sinks[i];
+        sink->fanout = f;
+        sink->args = f->args.sinks[i];
+
+        int serialized = add_serializer(f, sink->args.serializer);
+        if (!f->dst[serialized])
+        {
+            f->dst[serialized] = malloc(f->dst_slot_size);
+            if (!f->dst[serialized])
+                goto err;
+        }
+        sink->serialized = serialized;
+
+        sink->queue = malloc(f->args.queue_size);
+        if (!sink->queue)
+            goto err;
+        pthread_mutex_init(&sink->lock, NULL);
+        pthread_cond_init(&sink->cond, NULL);
+    }
+
+    for (int i = 0; i < f->args.sinks_len; i++)
+    {
+        struct fanout_sink *sink = &f->sinks[i];
+        if (pthread_create(&sink->thread, NULL, sink_main, sink) != 0)
+            goto err;
+        sink->thread_started = 1;
+    }
+
+    return 0;
+
+err:
+    free_fanout(f);
+    return -1;
+}
+
+int fanout_submit(struct fanout *f, void *data, size_t data_len)
+{
+    int result = 0;
+
+    for (int i = 0; i < f->serializers_len; i++)
+    {
+        f->dst_len[i] = f->serializers[i]->serialize(
+            f->dst[i], f->dst_slot_size, (struct elem_common *)data, data_len
+        );
+        if (f->dst_len[i] <= 0)
+        {
+            STATS_ADD(f->args.stats, serialize_errors, 1);
+            log_error(f, "Failed data conversion");
+            result = -1;
+        }
+    }
+
+    for (int i = 0; i < f->args.sinks_len; i++)
+    {
+        struct fanout_sink *sink = &f->sinks[i];
+        if (f->dst_len[sink->serialized] > 0)
+            enqueue(sink, f->dst[sink->serialized], f->dst_len[sink->serialized]);
+    }
+
+    return result;
+}
+
+void fanout_stop(struct fanout *f)
+{
+    // The sink threads drain their queues before they stop.
+    free_fanout(f);
+}
+
+void fanout_get_sink_stats(struct fanout *f, int sink, struct output_sink_stats *dst)
+{
+    struct output_sink_stats *src = &f->sinks[sink].stats;
+    dst->records = __atomic_load_n(&src->records, __ATOMIC_RELAXED);
+    dst->bytes_written = __atomic_load_n(&src->bytes_written, __ATOMIC_RELAXED);
+    dst->write_errors = __atomic_load_n(&src->write_errors, __ATOMIC_RELAXED);
+    dst->dropped_records = __atomic_load_n(&src->dropped_records, __ATOMIC_RELAXED);
+    dst->dropped_bytes = __atomic_load_n(&src->dropped_bytes, __ATOMIC_RELAXED);
+}
\ No newline at end of file
@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/*
+
+    A module to write records to multiple outputs (sinks), each in a format
+    of its own, without a slow sink stalling the others.
+
+    The thread draining the ring buffer serializes each record once per
+    distinct serializer of the sinks and copies it into the queue of every
+    sink using that serializer (see fanout_submit). Every sink has a writer
+    thread of its own which writes the records from its queue in order. A
+    record that does not fit in a full queue is dropped for that sink only.
+
+    A queue is a byte ring with the drain thread as its only producer and the
+    sink's writer thread as its only consumer. Every record is a
+    'fanout_entry' followed by the serialized record, which never wraps
+    around the end of the ring so that it is written in place.
+
+*/
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/types.h"
+#include "user/types.h"
+#include "user/record/serializer/serializer.h"
+#include "user/record/writer/writer.h"
+
+
+#define FANOUT_MAX_SINKS MAX_OUTPUT_SINKS
+
+/*
+    Default size (bytes) of the queue of a sink. A power of 2.
+*/
+#define FANOUT_DEFAULT_QUEUE_SIZE (16 * 1024 * 1024)
+
+
+struct fanout_entry
+{
+    uint32_t len;
+    uint32_t reserved;
+};
+
+struct fanout_sink_args
+{
+    const struct record_serializer *serializer;
+    const struct record_writer *writer;
+    /*
+        Interval at which the sink thread calls writer->flush(0) when idle.
+        Ignored if <= 0.
+    */
+    long flush_interval_ms;
+};
+
+struct fanout_args
+{
+    struct fanout_sink_args sinks[FANOUT_MAX_SINKS];
+    int sinks_len;
+    /*
+        Size (bytes) of the queue of every sink. A power of 2.
+        FANOUT_DEFAULT_QUEUE_SIZE if 0.
+    */
+    size_t queue_size;
+    /*
+        Counters updated by the fanout threads, across all the sinks.
+    */
+    struct consumer_stats *stats;
+    /*
+        Called (from any fanout thread) to report an error. Optional.
+    */
+    void (*log_error)(const char *msg);
+};
+
+struct fanout;
+
+struct fanout_sink
+{
+    struct fanout *fanout;
+    struct fanout_sink_args args;
+    // Index of the serialized record written by the sink.
+    int serialized;
+
+    unsigned char *queue;
+    // Only written by the drain thread.
+    uint64_t head;
+    // Only written by the sink thread.
+    uint64_t tail;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    // Set while the sink thread waits for records.
+    int waiting;
+    int exiting;
+    pthread_t thread;
+    int thread_started;
+
+    struct output_sink_stats stats;
+};
+
+struct fanout
+{
+    struct fanout_args args;
+    struct fanout_sink sinks[FANOUT_MAX_SINKS];
+
+    // The distinct serializers of the sinks, and the record serialized by each.
+    const struct record_serializer *serializers[FANOUT_MAX_SINKS];
+    int serializers_len;
+    char *dst[FANOUT_MAX_SINKS];
+    long dst_len[FANOUT_MAX_SINKS];
+    size_t dst_slot_size;
+};
+
+
+/*
+    Allocate the queues and start a thread per sink.
+
+    Return:
+        0    => Success
+        -ive => Failure. Nothing to free.
+*/
+int fanout_start(struct fanout *f, struct fanout_args *args);
+
+/*
+    Serialize the record once per serializer and queue it for every sink.
+    Must be called from a single thread.
+
+    Never blocks. The record is dropped for the sinks with a full queue.
+
+    Return:
+        0  => Success
+        -1 => A serializer failed. The record is still queued for the sinks of the others.
+*/
+int fanout_submit(struct fanout *f, void *data, size_t data_len);
+
+/*
+    Wait for all the queued records to be written, stop the threads, and free
+    the queues. The writers are not closed.
+*/
+void fanout_stop(struct fanout *f);
+
+/*
+    Get the counters of a sink. Can be called while the fanout is running, and
+    after it is stopped.
+*/
+void fanout_get_sink_stats(struct fanout *f, int sink, struct output_sink_stats *dst);
\ No newline at end of file
@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+
+#include "user/helpers/cpu.h"
+
+
+int cpu_get_numa_node(int cpu)
+{
+    if (cpu < 0)
+        return -1;
+
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+
+    DIR *dir = opendir(path);
+    if (!dir)
+        return -1;
+
+    int node = -1;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        // The CPU directory has a link named 'node<N>' to its NUMA node.
+        if (strncmp(entry->d_name, "node", 4) != 0)
+            continue;
+
+        char *endptr = NULL;
+        long val = strtol(&entry->d_name[4], &endptr, 10);
+        if (endptr != &entry->d_name[4] && *endptr == '\0' && val >= 0)
+        {
+            node = (int)val;
+            break;
+        }
+    }
+
+    closedir(dir);
+    return node;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/*
+
+    A module to get the CPU topology.
+
+*/
+
+
+/*
+    Get the NUMA node of the CPU from sysfs.
+
+    Return:
+        >=0 => The NUMA node
+        -1  => Unknown (i.e. no NUMA support or invalid CPU)
+*/
+int cpu_get_numa_node(int cpu);
\ No newline at end of file
@@ -32,10 +32,7 @@ void __log_state(FILE *out_f, app_state_t state, struct json_buffer *js)
     m.json = js;
 
     int js_msg_buffer_size = 1024;
-    char *js_msg_buffer = malloc(sizeof(char) * js_msg_buffer_size);
-    if (!js_msg_buffer)
-        return;
-    memset(js_msg_buffer, 0, js_msg_buffer_size);
+    char js_msg_buffer[js_msg_buffer_size];
 
     struct json_buffer js_msg;
     jsonify_core_init(&js_msg, js_msg_buffer, js_msg_buffer_size);
@@ -45,8 +42,6 @@ void __log_state(FILE *out_f, app_state_t state, struct json_buffer *js)
 
     fprintf(out_f, "%s\n", js_msg_buffer);
 
-    free(js_msg_buffer);
-
     fflush(out_f);
 }
 
@@ -35,6 +35,6 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
     Write control_input to json_buffer.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_control_write_control_input(struct json_buffer *s, struct control_input *val);
\ No newline at end of file
@@ -21,9 +21,11 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
-#include <stdarg.h>
 #include <assert.h>
 #include <time.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "user/error.h"
 
@@ -31,53 +33,370 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 
 /*
-    Write the data with the specified format into the json_buffer.
+    The decimal digits of 00 to 99.
+*/
+static const char digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/*
+    The lowercase hex digits of 0x00 to 0xff.
+*/
+static const char hex_pairs[] =
+    "000102030405060708090a0b0c0d0e0f"
+    "101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f"
+    "303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f"
+    "505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f"
+    "707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f"
+    "909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeaf"
+    "b0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
+    "d0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeef"
+    "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+
+/*
+    Return the number of decimal digits in 'val'.
+*/
+static inline int count_digits(unsigned long long val)
+{
+    int digits = 1;
+    for (;;)
+    {
+        if (val < 10) return digits;
+        if (val < 100) return digits + 1;
+        if (val < 1000) return digits + 2;
+        if (val < 10000) return digits + 3;
+        val /= 10000ULL;
+        digits += 4;
+    }
+}
+
+/*
+    Write the 'digits' decimal digits of 'val' at 'dst' (two at a time, from the end).
+*/
+static inline void write_digits(char *dst, unsigned long long val, int digits)
+{
+    char *p = dst + digits;
+    while (val >= 100)
+    {
+        unsigned int pair = (unsigned int)(val % 100) * 2;
+        val /= 100;
+        p -= 2;
+        p[0] = digit_pairs[pair];
+        p[1] = digit_pairs[pair + 1];
+    }
+    if (val >= 10)
+    {
+        unsigned int pair = (unsigned int)val * 2;
+        p -= 2;
+        p[0] = digit_pairs[pair];
+        p[1] = digit_pairs[pair + 1];
+    }
+    else
+    {
+        p -= 1;
+        p[0] = (char)('0' + val);
+    }
+    // Leading zeros if 'digits' is more than required.
+    while (p > dst)
+        *--p = '0';
+}
+
+/*
+    Check that 'len' chars (and the null terminator) fit in the json_buffer.
+
+    Return:
+        NULL  => Does not fit. The json_buffer is marked overflown and is not usable anymore.
+        !NULL => Where to write the chars.
+*/
+static inline char *jsonify_core_reserve(struct json_buffer *s, int len)
+{
+    if (s->overflown)
+        return NULL;
+    if (len >= s->remBufLen)
+    {
+        s->overflown = 1;
+        s->remBufLen = 0;
+        return NULL;
+    }
+    return &(s->buf[s->bufIdx]);
+}
+
+/*
+    Account for the 'len' chars written at the pointer returned by 'jsonify_core_reserve'.
+
+    Return:
+        'len'.
+*/
+static inline int jsonify_core_commit(struct json_buffer *s, int len)
+{
+    s->bufIdx += len;
+    s->remBufLen -= len;
+    s->buf[s->bufIdx] = '\0';
+    return len;
+}
+
+/*
+    Write a single char.
+
+    Return:
+        0    => Error i.e. failed to write data to json_buffer.
+        +ive => The number of bytes written.
+*/
+static inline int jsonify_core_write_char(struct json_buffer *s, char c)
+{
+    char *p = jsonify_core_reserve(s, 1);
+    if (!p)
+        return 0;
+    p[0] = c;
+    return jsonify_core_commit(s, 1);
+}
+
+/*
+    Check if the key-val separator is needed before the next key.
+*/
+static inline int jsonify_core_needs_divider(struct json_buffer *s)
+{
+    // The separator is not needed for the first key-val in the (nested) object.
+    return s->bufIdx > 0 && s->buf[s->bufIdx - 1] != '{';
+}
+
+/*
+    The number of chars of the key-val separator (if needed) and the key i.e. [,]"key":.
+*/
+static inline int jsonify_core_key_len(struct json_buffer *s, int key_len)
+{
+    return jsonify_core_needs_divider(s) + key_len + 3;
+}
+
+/*
+    Write [,]"key": at 'p'.
+
+    Return:
+        Where to write the val.
+*/
+static inline char *jsonify_core_put_key(struct json_buffer *s, char *p, const char *key, int key_len)
+{
+    if (jsonify_core_needs_divider(s))
+        *p++ = ',';
+    *p++ = '"';
+    memcpy(p, key, key_len);
+    p += key_len;
+    *p++ = '"';
+    *p++ = ':';
+    return p;
+}
+
+/*
+    Write [,]"key":val where val is an unsigned integer, optionally negated.
+
+    Return:
+        0    => Error i.e. failed to write data to json_buffer.
+        +ive => The number of bytes written.
+*/
+static int jsonify_core_write_key_ull(struct json_buffer *s, const char *key, unsigned long long val, int negative)
+{
+    int key_len = strlen(key);
+    int digits = count_digits(val);
+    int len = jsonify_core_key_len(s, key_len) + negative + digits;
+
+    char *p = jsonify_core_reserve(s, len);
+    if (!p)
+        return 0;
+    p = jsonify_core_put_key(s, p, key, key_len);
+    if (negative)
+        *p++ = '-';
+    write_digits(p, val, digits);
+    return jsonify_core_commit(s, len);
+}
+
+/*
+    Write [,]"key":val where val is a signed integer.
+
+    Return:
+        See 'jsonify_core_write_key_ull'.
+*/
+static int jsonify_core_write_key_ll(struct json_buffer *s, const char *key, long long val)
+{
+    if (val < 0)
+        // Negate as unsigned to handle the min value.
+        return jsonify_core_write_key_ull(s, key, 0ULL - (unsigned long long)val, 1);
+    return jsonify_core_write_key_ull(s, key, (unsigned long long)val, 0);
+}
+
+/*
+    Write [,]"key":<open>val<close> where val is 'val_len' chars.
 
     Return:
         0    => Error i.e. failed to write data to json_buffer.
         +ive => The number of bytes written.
 */
-static int jsonify_core_snprintf(struct json_buffer *s, const char *format, ...)
+static int jsonify_core_write_key_chars(
+    struct json_buffer *s, const char *key, const char *val, int val_len, int quoted
+)
 {
-    va_list args;
-    int charsWritten;
+    int key_len = strlen(key);
+    int len = jsonify_core_key_len(s, key_len) + val_len + (quoted ? 2 : 0);
+
+    char *p = jsonify_core_reserve(s, len);
+    if (!p)
+        return 0;
+    p = jsonify_core_put_key(s, p, key, key_len);
+    if (quoted)
+        *p++ = '"';
+    memcpy(p, val, val_len);
+    p += val_len;
+    if (quoted)
+        *p++ = '"';
+    return jsonify_core_commit(s, len);
+}
 
-    if (s->overflown) return 0;
+/*
+    Check if the char must be escaped in a JSON string.
+*/
+static inline int needs_escape(unsigned char c)
+{
+    return c < 0x20 || c == '"' || c == '\\';
+}
 
-    va_start(args, format);
+/*
+    Find the first char in 'val' that must be escaped in a JSON string.
+    Scans 16 chars at a time if SSE2 is available.
 
-    charsWritten = vsnprintf(&(s->buf[s->bufIdx]), s->remBufLen, format, args);
-    if (charsWritten >= s->remBufLen)
+    Return:
+        Index of the char, or 'val_len' if none.
+*/
+static inline int find_escape(const char *val, int val_len)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i max_control = _mm_set1_epi8(0x1f);
+    for (; i + 16 <= val_len; i += 16)
     {
-        // i.e. the vsnprintf function truncated the result.
-        s->overflown = 1;
-        s->remBufLen = 0;
-        va_end(args);
-        return 0; // The json buffer is not usable anymore.
+        __m128i chunk = _mm_loadu_si128((const __m128i *)&val[i]);
+        // Unsigned chunk <= 0x1f iff max(chunk, 0x1f) == 0x1f.
+        __m128i is_control = _mm_cmpeq_epi8(_mm_max_epu8(chunk, max_control), max_control);
+        __m128i found = _mm_or_si128(
+            is_control,
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash))
+        );
+        int mask = _mm_movemask_epi8(found);
+        if (mask != 0)
+            return i + __builtin_ctz(mask);
     }
-    else
+#endif
+    for (; i < val_len; i++)
     {
-        s->remBufLen -= charsWritten;
-        s->bufIdx += charsWritten;
-        va_end(args);
-        return charsWritten;
+        if (needs_escape((unsigned char)val[i]))
+            return i;
     }
+    return val_len;
 }
 
 /*
-    A helper function to write the key-val pair separater ','.
+    Return the number of chars in the escaped form of the char.
+*/
+static inline int get_escaped_len(unsigned char c)
+{
+    if (!needs_escape(c))
+        return 1;
+    switch (c)
+    {
+        case '"':
+        case '\\':
+        case '\b':
+        case '\f':
+        case '\n':
+        case '\r':
+        case '\t':
+            return 2;
+        default:
+            // \u00XX
+            return 6;
+    }
+}
 
-    This function can be used to write ',' everytime any other jsonify_* function
-    is used write any key-val.
+/*
+    Write the escaped form of the char at 'p'.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        Where to write the next char.
 */
-static int jsonify_core_write_element_divider(struct json_buffer *s)
+static inline char *put_escaped(char *p, unsigned char c)
 {
-    if (s->bufIdx > 1)
-        return jsonify_core_snprintf(s, ",");
-    return 0;
+    if (!needs_escape(c))
+    {
+        *p++ = (char)c;
+        return p;
+    }
+    *p++ = '\\';
+    switch (c)
+    {
+        case '"': *p++ = '"'; break;
+        case '\\': *p++ = '\\'; break;
+        case '\b': *p++ = 'b'; break;
+        case '\f': *p++ = 'f'; break;
+        case '\n': *p++ = 'n'; break;
+        case '\r': *p++ = 'r'; break;
+        case '\t': *p++ = 't'; break;
+        default:
+            *p++ = 'u';
+            *p++ = '0';
+            *p++ = '0';
+            *p++ = hex_pairs[c * 2];
+            *p++ = hex_pairs[c * 2 + 1];
+            break;
+    }
+    return p;
+}
+
+/*
+    Write [,]"key":"val" where val is 'val_len' chars of which the chars from 'first_escape'
+    onwards may need escaping.
+
+    Return:
+        0    => Error i.e. failed to write data to json_buffer.
+        +ive => The number of bytes written.
+*/
+static int jsonify_core_write_key_escaped_str(
+    struct json_buffer *s, const char *key, const char *val, int val_len, int first_escape
+)
+{
+    int escaped_len = first_escape;
+    for (int i = first_escape; i < val_len; i++)
+        escaped_len += get_escaped_len((unsigned char)val[i]);
+
+    int key_len = strlen(key);
+    int len = jsonify_core_key_len(s, key_len) + escaped_len + 2;
+
+    char *p = jsonify_core_reserve(s, len);
+    if (!p)
+        return 0;
+    p = jsonify_core_put_key(s, p, key, key_len);
+    *p++ = '"';
+    memcpy(p, val, first_escape);
+    p += first_escape;
+    for (int i = first_escape; i < val_len; i++)
+        p = put_escaped(p, (unsigned char)val[i]);
+    *p = '"';
+    return jsonify_core_commit(s, len);
 }
 
 /*
@@ -104,7 +423,7 @@ int jsonify_core_get_total_chars_written(struct json_buffer *s)
 
 int jsonify_core_write_newline(struct json_buffer *s)
 {
-    return jsonify_core_snprintf(s, "\n");
+    return jsonify_core_write_char(s, '\n');
 }
 
 int jsonify_core_has_overflown(struct json_buffer *s)
@@ -119,101 +438,118 @@ int jsonify_core_init(struct json_buffer *s, char *dst_buf, unsigned int dst_buf
     s->bufIdx = 0;
     s->remBufLen = s->maxBufLen - s->bufIdx;
     s->overflown = 0;
-    memset(&(s->buf[0]), 0, s->maxBufLen);
+    // Every write keeps the buffer null-terminated.
+    if (dst_buf_len > 0)
+        s->buf[0] = '\0';
     return 0;
 }
 
 int jsonify_core_open_obj(struct json_buffer *s)
 {
-    return jsonify_core_snprintf(s, "{");
+    return jsonify_core_write_char(s, '{');
 }
 
 int jsonify_core_close_obj(struct json_buffer *s)
 {
-    return jsonify_core_snprintf(s, "}");
+    return jsonify_core_write_char(s, '}');
+}
+
+int jsonify_core_open_nested_obj(struct json_buffer *s, const char *key)
+{
+    return jsonify_core_write_key_chars(s, key, "{", 1, 0);
+}
+
+int jsonify_core_close_nested_obj(struct json_buffer *s)
+{
+    return jsonify_core_write_char(s, '}');
 }
 
 int jsonify_core_write_bytes(struct json_buffer *s, const char *key, unsigned char *val, int val_size)
 {
-    int total = 0;
-    total += jsonify_core_write_element_divider(s);
-    total += jsonify_core_snprintf(s, "\"%s\":\"", key);
-    for (size_t i = 0; i < val_size; i++)
+    if (val_size < 0)
+        val_size = 0;
+    int key_len = strlen(key);
+    int len = jsonify_core_key_len(s, key_len) + (val_size * 2) + 2;
+
+    char *p = jsonify_core_reserve(s, len);
+    if (!p)
+        return 0;
+    p = jsonify_core_put_key(s, p, key, key_len);
+    *p++ = '"';
+    for (int i = 0; i < val_size; i++)
     {
-        total += jsonify_core_snprintf(s, "%02x", val[i]);
+        const char *hex = &hex_pairs[val[i] * 2];
+        p[0] = hex[0];
+        p[1] = hex[1];
+        p += 2;
     }
-    total += jsonify_core_snprintf(s, "\"");
-    return total;
+    *p = '"';
+    return jsonify_core_commit(s, len);
 }
 
 int jsonify_core_write_int(struct json_buffer *s, const char *key, int val)
 {
-    int total = 0;
-    total += jsonify_core_write_element_divider(s);
-    total += jsonify_core_snprintf(s, "\"%s\":%d", key, val);
-    return total;
+    return jsonify_core_write_key_ll(s, key, val);
 }
 
 int jsonify_core_write_uint(struct json_buffer *s, const char *key, unsigned int val)
 {
-    int total = 0;
-    total += jsonify_core_write_element_divider(s);
-    total += jsonify_core_snprintf(s, "\"%s\":%u", key, val);
-    return total;
+    return jsonify_core_write_key_ull(s, key, val, 0);
 }
 
 int jsonify_core_write_str(struct json_buffer *s, const char *key, const char *val)
 {
-    int total = 0;
-    total += jsonify_core_write_element_divider(s);
-    total += jsonify_core_snprintf(s, "\"%s\":\"%s\"", key, val);
-    return total;
+    int val_len = strlen(val);
+    int first_escape = find_escape(val, val_len);
+    if (first_escape == val_len)
+        return jsonify_core_write_key_chars(s, key, val, val_len, 1);
+    return jsonify_core_write_key_escaped_str(s, key, val, val_len, first_escape);
 }
 
 int jsonify_core_write_as_literal(struct json_buffer *s, const char *key, const char *val)
 {
-    int total = 0;
-    total += jsonify_core_write_element_divider(s);
-    total += jsonify_core_snprintf(s, "\"%s\":%s", key, val);
-    return total;
+    return jsonify_core_write_key_chars(s, key, val, strlen(val), 0);
 }
 
 int jsonify_core_write_ulong(struct json_buffer *s, const char *key, unsigned long val)
 {
-    int total = 0;
-    total += jsonify_core_write_element_divider(s);
-    total += jsonify_core_snprintf(s, "\"%s\":%lu", key, val);
-    return total;
+    return jsonify_core_write_key_ull(s, key, val, 0);
 }
 
 int jsonify_core_write_ulonglong(struct json_buffer *s, const char *key, unsigned long long val)
 {
-    int total = 0;
-    total += jsonify_core_write_element_divider(s);
-    total += jsonify_core_snprintf(s, "\"%s\":%llu", key, val);
-    return total;
+    return jsonify_core_write_key_ull(s, key, val, 0);
 }
 
 int jsonify_core_write_long(struct json_buffer *s, const char *key, long val)
 {
-    int total = 0;
-    total += jsonify_core_write_element_divider(s);
-    total += jsonify_core_snprintf(s, "\"%s\":%ld", key, val);
-    return total;
+    return jsonify_core_write_key_ll(s, key, val);
 }
 
 int jsonify_core_write_short(struct json_buffer *s, const char *key, short int val)
 {
-    int total = 0;
-    total += jsonify_core_write_element_divider(s);
-    total += jsonify_core_snprintf(s, "\"%s\":%hd", key, val);
-    return total;
+    return jsonify_core_write_key_ll(s, key, val);
 }
 
 int jsonify_core_write_timespec64(struct json_buffer *s, const char *key, long long tv_sec, long tv_nsec)
 {
-    int total = 0;
-    total += jsonify_core_write_element_divider(s);
-    total += jsonify_core_snprintf(s, "\"%s\":%llu.%03lu", key, (unsigned long long)tv_sec, tv_nsec/1000000);
-    return total;
+    unsigned long long sec = (unsigned long long)tv_sec;
+    unsigned long msec = (unsigned long)(tv_nsec / 1000000);
+    int key_len = strlen(key);
+    int sec_digits = count_digits(sec);
+    int msec_digits = count_digits(msec);
+    // At least 3 digits for the milliseconds.
+    if (msec_digits < 3)
+        msec_digits = 3;
+    int len = jsonify_core_key_len(s, key_len) + sec_digits + 1 + msec_digits;
+
+    char *p = jsonify_core_reserve(s, len);
+    if (!p)
+        return 0;
+    p = jsonify_core_put_key(s, p, key, key_len);
+    write_digits(p, sec, sec_digits);
+    p += sec_digits;
+    *p++ = '.';
+    write_digits(p, msec, msec_digits);
+    return jsonify_core_commit(s, len);
 }
\ No newline at end of file
@@ -86,7 +86,7 @@ int jsonify_core_get_total_chars_written(struct json_buffer *s);
     A helper function to write newline.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_core_write_newline(struct json_buffer *s);
 
@@ -114,7 +114,8 @@ int jsonify_core_init(struct json_buffer *s, char *dst_buf, unsigned int dst_buf
     Write '{'.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        0    => Error i.e. failed to write data to json_buffer.
+        +ive => The number of bytes written.
 */
 int jsonify_core_open_obj(struct json_buffer *s);
 
@@ -122,17 +123,34 @@ int jsonify_core_open_obj(struct json_buffer *s);
     Write '}'.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_core_close_obj(struct json_buffer *s);
 
+/*
+    Write [,]"key":{ to start writing a nested object in place.
+    Must be followed by 'jsonify_core_close_nested_obj'.
+
+    Return:
+        See 'jsonify_core_open_obj'.
+*/
+int jsonify_core_open_nested_obj(struct json_buffer *s, const char *key);
+
+/*
+    Write '}' to end the nested object started by 'jsonify_core_open_nested_obj'.
+
+    Return:
+        See 'jsonify_core_open_obj'.
+*/
+int jsonify_core_close_nested_obj(struct json_buffer *s);
+
 /*
     Write [,]"key":"val".
     
     'val' as bytes (in hex) where the number of bytes are given by 'val_size'.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_core_write_bytes(struct json_buffer *s, const char *key, unsigned char *val, int val_size);
 
@@ -140,7 +158,7 @@ int jsonify_core_write_bytes(struct json_buffer *s, const char *key, unsigned ch
     Write [,]"key"=val where val is a signed integer.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_core_write_int(struct json_buffer *s, const char *key, int val);
 
@@ -148,15 +166,17 @@ int jsonify_core_write_int(struct json_buffer *s, const char *key, int val);
     Write [,]"key"=val where val is an unsigned integer.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_core_write_uint(struct json_buffer *s, const char *key, unsigned int val);
 
 /*
     Write [,]"key"="val" where val is a null-terminated string.
 
+    Quotes, backslashes, and control chars in 'val' are escaped.
+
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_core_write_str(struct json_buffer *s, const char *key, const char *val);
 
@@ -164,7 +184,7 @@ int jsonify_core_write_str(struct json_buffer *s, const char *key, const char *v
     Write [,]"key"=val where val is a null-terminated literal.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_core_write_as_literal(struct json_buffer *s, const char *key, const char *val);
 
@@ -172,7 +192,7 @@ int jsonify_core_write_as_literal(struct json_buffer *s, const char *key, const
     Write [,]"key"=val where val is an unsigned long.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_core_write_ulong(struct json_buffer *s, const char *key, unsigned long val);
 
@@ -180,7 +200,7 @@ int jsonify_core_write_ulong(struct json_buffer *s, const char *key, unsigned lo
     Write [,]"key"=val where val is an unsigned long long.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_core_write_ulonglong(struct json_buffer *s, const char *key, unsigned long long val);
 
@@ -188,7 +208,7 @@ int jsonify_core_write_ulonglong(struct json_buffer *s, const char *key, unsigne
     Write [,]"key"=val where val is a signed long.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_core_write_long(struct json_buffer *s, const char *key, long val);
 
@@ -196,7 +216,7 @@ int jsonify_core_write_long(struct json_buffer *s, const char *key, long val);
     Write [,]"key"=val where val is a short signed integer.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_core_write_short(struct json_buffer *s, const char *key, short int val);
 
@@ -205,6 +225,6 @@ int jsonify_core_write_short(struct json_buffer *s, const char *key, short int v
     tv_nsec is the number of nanoseconds.
     
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_core_write_timespec64(struct json_buffer *s, const char *key, long long tv_sec, long tv_nsec);
@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <stddef.h>
+
+#include "user/jsonify/fields.h"
+
+
+#define FIELD(st, member, field_type) \
+    { #member, offsetof(st, member), field_type, sizeof(((st *)0)->member) }
+
+#define FIELD_KEY(key, st, member, field_type) \
+    { key, offsetof(st, member), field_type, sizeof(((st *)0)->member) }
+
+#define FIELDS_LEN(fields) (sizeof(fields) / sizeof(fields[0]))
+
+#define RECORD_FIELDS(st, record_name, fields) \
+    { record_name, sizeof(st), offsetof(st, e_ts), FIELDS_LEN(fields), fields }
+
+
+static const struct jsonify_field connect_fields[] = {
+    FIELD(struct record_connect, pid, JSONIFY_FIELD_INT),
+    FIELD(struct record_connect, fd, JSONIFY_FIELD_INT),
+    FIELD(struct record_connect, ret, JSONIFY_FIELD_INT),
+    FIELD(struct record_connect, ns_net, JSONIFY_FIELD_UINT),
+    FIELD(struct record_connect, sock_type, JSONIFY_FIELD_SHORT),
+    FIELD(struct record_connect, local, JSONIFY_FIELD_SOCKADDR),
+    FIELD(struct record_connect, remote, JSONIFY_FIELD_SOCKADDR)
+};
+
+static const struct jsonify_field accept_fields[] = {
+    FIELD(struct record_accept, pid, JSONIFY_FIELD_INT),
+    FIELD(struct record_accept, sys_id, JSONIFY_FIELD_SYS_ID),
+    FIELD(struct record_accept, fd, JSONIFY_FIELD_INT),
+    FIELD(struct record_accept, ret, JSONIFY_FIELD_INT),
+    FIELD(struct record_accept, ns_net, JSONIFY_FIELD_UINT),
+    FIELD(struct record_accept, sock_type, JSONIFY_FIELD_SHORT),
+    FIELD(struct record_accept, local, JSONIFY_FIELD_SOCKADDR),
+    FIELD(struct record_accept, remote, JSONIFY_FIELD_SOCKADDR)
+};
+
+static const struct jsonify_field namespace_fields[] = {
+    FIELD(struct record_namespace, pid, JSONIFY_FIELD_INT),
+    FIELD(struct record_namespace, sys_id, JSONIFY_FIELD_SYS_ID),
+    FIELD(struct record_namespace, ns_ipc, JSONIFY_FIELD_UINT),
+    FIELD(struct record_namespace, ns_mnt, JSONIFY_FIELD_UINT),
+    FIELD(struct record_namespace, ns_pid_children, JSONIFY_FIELD_UINT),
+    FIELD(struct record_namespace, ns_pid, JSONIFY_FIELD_UINT),
+    FIELD(struct record_namespace, ns_net, JSONIFY_FIELD_UINT),
+    FIELD(struct record_namespace, ns_cgroup, JSONIFY_FIELD_UINT),
+    FIELD(struct record_namespace, ns_usr, JSONIFY_FIELD_UINT)
+};
+
+static const struct jsonify_field new_process_fields[] = {
+    FIELD(struct record_new_process, pid, JSONIFY_FIELD_INT),
+    FIELD(struct record_new_process, ppid, JSONIFY_FIELD_INT),
+    FIELD(struct record_new_process, sys_id, JSONIFY_FIELD_SYS_ID),
+    FIELD(struct record_new_process, comm, JSONIFY_FIELD_STR)
+};
+
+static const struct jsonify_field cred_fields[] = {
+    FIELD(struct record_cred, pid, JSONIFY_FIELD_INT),
+    FIELD(struct record_cred, sys_id, JSONIFY_FIELD_SYS_ID),
+    FIELD(struct record_cred, uid, JSONIFY_FIELD_UINT),
+    FIELD(struct record_cred, euid, JSONIFY_FIELD_UINT),
+    FIELD(struct record_cred, suid, JSONIFY_FIELD_UINT),
+    FIELD(struct record_cred, fsuid, JSONIFY_FIELD_UINT),
+    FIELD(struct record_cred, gid, JSONIFY_FIELD_UINT),
+    FIELD(struct record_cred, egid, JSONIFY_FIELD_UINT),
+    FIELD(struct record_cred, sgid, JSONIFY_FIELD_UINT),
+    FIELD(struct record_cred, fsgid, JSONIFY_FIELD_UINT)
+};
+
+static const struct jsonify_field send_recv_fields[] = {
+    FIELD(struct record_send_recv, pid, JSONIFY_FIELD_INT),
+    FIELD(struct record_send_recv, sys_id, JSONIFY_FIELD_SYS_ID),
+    FIELD(struct record_send_recv, fd, JSONIFY_FIELD_INT),
+    FIELD(struct record_send_recv, ret, JSONIFY_FIELD_LONG),
+    FIELD(struct record_send_recv, ns_net, JSONIFY_FIELD_UINT),
+    FIELD(struct record_send_recv, sock_type, JSONIFY_FIELD_SHORT),
+    FIELD(struct record_send_recv, local, JSONIFY_FIELD_SOCKADDR),
+    FIELD(struct record_send_recv, remote, JSONIFY_FIELD_SOCKADDR)
+};
+
+static const struct jsonify_field bind_fields[] = {
+    FIELD(struct record_bind, pid, JSONIFY_FIELD_INT),
+    FIELD(struct record_bind, fd, JSONIFY_FIELD_INT),
+    FIELD(struct record_bind, ns_net, JSONIFY_FIELD_UINT),
+    FIELD(struct record_bind, sock_type, JSONIFY_FIELD_SHORT),
+    FIELD(struct record_bind, local, JSONIFY_FIELD_SOCKADDR)
+};
+
+static const struct jsonify_field kill_fields[] = {
+    FIELD(struct record_kill, acting_pid, JSONIFY_FIELD_INT),
+    FIELD(struct record_kill, sig, JSONIFY_FIELD_INT),
+    FIELD(struct record_kill, target_pid, JSONIFY_FIELD_INT),
+    FIELD(struct record_kill, ret, JSONIFY_FIELD_INT)
+};
+
+static const struct jsonify_field audit_log_exit_fields[] = {
+    FIELD(struct record_audit_log_exit, pid, JSONIFY_FIELD_INT),
+    FIELD(struct record_audit_log_exit, syscall_number, JSONIFY_FIELD_INT),
+    FIELD_KEY("exit", struct record_audit_log_exit, ret, JSONIFY_FIELD_LONG),
+    FIELD_KEY("las_audit", struct record_audit_log_exit, e_las_ts, JSONIFY_FIELD_LAS_TIMESTAMP)
+};
+
+static const struct jsonify_fields record_fields[] = {
+    [RECORD_TYPE_NEW_PROCESS] = RECORD_FIELDS(struct record_new_process, "record_new_process", new_process_fields),
+    [RECORD_TYPE_CRED] = RECORD_FIELDS(struct record_cred, "record_cred", cred_fields),
+    [RECORD_TYPE_NAMESPACE] = RECORD_FIELDS(struct record_namespace, "record_namespace", namespace_fields),
+    [RECORD_TYPE_CONNECT] = RECORD_FIELDS(struct record_connect, "record_connect", connect_fields),
+    [RECORD_TYPE_ACCEPT] = RECORD_FIELDS(struct record_accept, "record_accept", accept_fields),
+    [RECORD_TYPE_SEND_RECV] = RECORD_FIELDS(struct record_send_recv, "record_send_recv", send_recv_fields),
+    [RECORD_TYPE_BIND] = RECORD_FIELDS(struct record_bind, "record_bind", bind_fields),
+    [RECORD_TYPE_KILL] = RECORD_FIELDS(struct record_kill, "record_kill", kill_fields),
+    [RECORD_TYPE_AUDIT_LOG_EXIT] = RECORD_FIELDS(struct record_audit_log_exit, "record_audit_log_exit", audit_log_exit_fields)
+};
+
+
+const struct jsonify_fields *jsonify_fields_get(record_type_t record_type)
+{
+    if ((unsigned int)record_type >= FIELDS_LEN(record_fields))
+        return NULL;
+    const struct jsonify_fields *f = &record_fields[record_type];
+    return f->name ? f : NULL;
+}
\ No newline at end of file
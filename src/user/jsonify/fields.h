@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/*
+
+    A module to describe the members of each record type.
+
+    The same field lists are used to write records as JSON (see 'record.h') and by the
+    other serializers e.g. 'record_serializer_cbor', so that the formats cannot drift.
+
+    The common members i.e. 'e_common' and 'e_ts' are not in the field lists.
+
+*/
+
+#include <sys/types.h>
+
+#include "common/types.h"
+
+
+typedef enum {
+    // int e.g. pid_t, a file descriptor or a return value.
+    JSONIFY_FIELD_INT = 1,
+    // unsigned int e.g. uid_t, gid_t or inode_num_t.
+    JSONIFY_FIELD_UINT,
+    JSONIFY_FIELD_SHORT,
+    // long e.g. ssize_t.
+    JSONIFY_FIELD_LONG,
+    // A NUL terminated char array of 'size' bytes.
+    JSONIFY_FIELD_STR,
+    // sys_id_t.
+    JSONIFY_FIELD_SYS_ID,
+    // struct elem_sockaddr.
+    JSONIFY_FIELD_SOCKADDR,
+    // struct elem_las_timestamp.
+    JSONIFY_FIELD_LAS_TIMESTAMP
+} jsonify_field_type_t;
+
+struct jsonify_field
+{
+    const char *key;
+    unsigned short offset;
+    // jsonify_field_type_t
+    unsigned short type;
+    // sizeof the member.
+    unsigned short size;
+};
+
+struct jsonify_fields
+{
+    // e.g. "record_connect"
+    const char *name;
+    unsigned int record_size;
+    // Offset of 'e_ts' in the record.
+    unsigned short ts_offset;
+    unsigned short fields_len;
+    const struct jsonify_field *fields;
+};
+
+
+/*
+    Get the field list of the record type.
+
+    Return:
+        The field list, or NULL if the record type is unknown.
+*/
+const struct jsonify_fields *jsonify_fields_get(record_type_t record_type);
\ No newline at end of file
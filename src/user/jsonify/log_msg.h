@@ -37,6 +37,6 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
     Write log msg to json_buffer.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_log_msg_write_log_msg(struct json_buffer *s, struct log_msg *val);
\ No newline at end of file
@@ -37,6 +37,6 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
     Set 'write_interpreted' to non-zero value to interpret the record's contents like socket address.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_record(struct json_buffer *s, struct elem_common *e_common, int data_len, int write_interpreted);
\ No newline at end of file
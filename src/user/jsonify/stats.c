@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "user/jsonify/stats.h"
+#include "common/types.h"
+
+
+int jsonify_stats_write_consumer_stats(struct json_buffer *s, struct consumer_stats *val)
+{
+    int total = 0;
+
+    total += jsonify_core_write_ulong(s, "records", val->records);
+    total += jsonify_core_write_ulong(s, "bytes_written", val->bytes_written);
+    total += jsonify_core_write_ulong(s, "serialize_errors", val->serialize_errors);
+    total += jsonify_core_write_ulong(s, "write_errors", val->write_errors);
+
+    return total;
+}
+
+static const char *get_record_type_name(int record_type)
+{
+    switch (record_type)
+    {
+        case RECORD_TYPE_NEW_PROCESS: return "record_new_process";
+        case RECORD_TYPE_CRED: return "record_cred";
+        case RECORD_TYPE_NAMESPACE: return "record_namespace";
+        case RECORD_TYPE_CONNECT: return "record_connect";
+        case RECORD_TYPE_ACCEPT: return "record_accept";
+        case RECORD_TYPE_SEND_RECV: return "record_send_recv";
+        case RECORD_TYPE_BIND: return "record_bind";
+        case RECORD_TYPE_KILL: return "record_kill";
+        case RECORD_TYPE_AUDIT_LOG_EXIT: return "record_audit_log_exit";
+        default: return NULL;
+    }
+}
+
+int jsonify_stats_write_output_drop_stats(struct json_buffer *s, struct output_drop_stats *val)
+{
+    int s_child_buf_size = 512;
+    char s_child_buf[s_child_buf_size];
+    struct json_buffer s_child;
+    jsonify_core_init(&s_child, &(s_child_buf[0]), s_child_buf_size);
+    jsonify_core_open_obj(&s_child);
+    for (int i = 0; i < OUTPUT_DROPS_MAP_SIZE; i++)
+    {
+        const char *name = get_record_type_name(i);
+        if (name)
+            jsonify_core_write_ulong(&s_child, name, val->per_record_type[i]);
+    }
+    jsonify_core_close_obj(&s_child);
+
+    int total = 0;
+
+    total += jsonify_core_write_ulong(s, "total", val->total);
+
+    char *s_child_buf_ptr;
+    int s_child_buf_ptr_size;
+    if (jsonify_core_get_internal_buf_ptr(&s_child, &s_child_buf_ptr, &s_child_buf_ptr_size) == 0)
+    {
+        total += jsonify_core_write_as_literal(s, "per_record_type", s_child_buf_ptr);
+    }
+
+    return total;
+}
+
+int jsonify_stats_write_output_spool_stats(struct json_buffer *s, struct output_spool_stats *val)
+{
+    int total = 0;
+
+    total += jsonify_core_write_ulong(s, "spool_bytes", val->spool_bytes);
+    total += jsonify_core_write_ulong(s, "spool_records", val->spool_records);
+    total += jsonify_core_write_ulong(s, "dropped_records", val->dropped_records);
+    total += jsonify_core_write_ulong(s, "dropped_bytes", val->dropped_bytes);
+    total += jsonify_core_write_ulong(s, "bytes_sent", val->bytes_sent);
+    total += jsonify_core_write_ulong(s, "connects", val->connects);
+    total += jsonify_core_write_ulong(s, "disconnects", val->disconnects);
+
+    return total;
+}
+
+int jsonify_stats_write_output_spill_stats(struct json_buffer *s, struct output_spill_stats *val)
+{
+    int total = 0;
+
+    total += jsonify_core_write_ulong(s, "spill_bytes", val->spill_bytes);
+    total += jsonify_core_write_ulong(s, "spill_segments", val->spill_segments);
+    total += jsonify_core_write_ulong(s, "replayed_bytes", val->replayed_bytes);
+    total += jsonify_core_write_ulong(s, "dropped_records", val->dropped_records);
+    total += jsonify_core_write_ulong(s, "dropped_bytes", val->dropped_bytes);
+    total += jsonify_core_write_ulong(s, "recovered_segments", val->recovered_segments);
+    total += jsonify_core_write_ulong(s, "discarded_segments", val->discarded_segments);
+
+    return total;
+}
+
+int jsonify_stats_write_output_sink_stats(struct json_buffer *s, struct output_sink_stats *val)
+{
+    int total = 0;
+
+    total += jsonify_core_write_ulong(s, "records", val->records);
+    total += jsonify_core_write_ulong(s, "bytes_written", val->bytes_written);
+    total += jsonify_core_write_ulong(s, "write_errors", val->write_errors);
+    total += jsonify_core_write_ulong(s, "dropped_records", val->dropped_records);
+    total += jsonify_core_write_ulong(s, "dropped_bytes", val->dropped_bytes);
+
+    return total;
+}
\ No newline at end of file
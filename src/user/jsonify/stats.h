@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/*
+
+    A module to help write app stats to json_buffer.
+
+    See 'core.h'.
+
+*/
+
+#include "user/jsonify/core.h"
+#include "user/types.h"
+
+
+/*
+    Write consumer_stats to json_buffer.
+
+    Return:
+        See 'jsonify_core_open_obj'.
+*/
+int jsonify_stats_write_consumer_stats(struct json_buffer *s, struct consumer_stats *val);
+
+/*
+    Write output_drop_stats to json_buffer.
+
+    Return:
+        See 'jsonify_core_open_obj'.
+*/
+int jsonify_stats_write_output_drop_stats(struct json_buffer *s, struct output_drop_stats *val);
+
+/*
+    Write output_spool_stats to json_buffer.
+
+    Return:
+        See 'jsonify_core_open_obj'.
+*/
+int jsonify_stats_write_output_spool_stats(struct json_buffer *s, struct output_spool_stats *val);
+
+/*
+    Write output_spill_stats to json_buffer.
+
+    Return:
+        See 'jsonify_core_open_obj'.
+*/
+int jsonify_stats_write_output_spill_stats(struct json_buffer *s, struct output_spill_stats *val);
+
+/*
+    Write output_sink_stats to json_buffer.
+
+    Return:
+        See 'jsonify_core_open_obj'.
+*/
+int jsonify_stats_write_output_sink_stats(struct json_buffer *s, struct output_sink_stats *val);
\ No newline at end of file
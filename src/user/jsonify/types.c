@@ -24,7 +24,6 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <linux/netlink.h>
-#include <stdlib.h>
 
 #include "user/jsonify/types.h"
 
@@ -34,13 +33,39 @@ static int jsonify_types_write_record_type(struct json_buffer *s, const char *ke
     return jsonify_core_write_int(s, key, val);
 }
 
+/*
+    Write the decimal digits of 'val' at 'dst'.
+
+    Return:
+        Where to write the next char.
+*/
+static char *put_uint(char *dst, unsigned int val)
+{
+    char digits[10];
+    int len = 0;
+    do
+    {
+        digits[len++] = '0' + (val % 10);
+        val /= 10;
+    } while (val > 0);
+    while (len > 0)
+        *dst++ = digits[--len];
+    return dst;
+}
+
 int jsonify_types_write_version(struct json_buffer *s, const char *key, const struct elem_version *version)
 {
     const int max_size = 13;
     char local_val[max_size];
-    memset(&local_val[0], 0, max_size);
 
-    snprintf(&local_val[0], max_size, "%u.%u.%u", version->major, version->minor, version->patch);
+    // i.e. "%u.%u.%u" without the cost of snprintf on every record.
+    char *p = &local_val[0];
+    p = put_uint(p, version->major);
+    *p++ = '.';
+    p = put_uint(p, version->minor);
+    *p++ = '.';
+    p = put_uint(p, version->patch);
+    *p = '\0';
 
     return jsonify_core_write_str(s, key, &local_val[0]);
 }
@@ -259,79 +284,49 @@ int jsonify_types_write_ip_family_name(struct json_buffer *s, char *key, int ip_
 
 int jsonify_types_write_elem_las_timestamp(struct json_buffer *s, struct elem_las_timestamp *e_las_ts)
 {
-    char *s_child_buf = (char *)malloc(sizeof(char) * MAX_BUFFER_LEN);
-    if (!s_child_buf)
-        return 0;
-
-    struct json_buffer s_child;
-    jsonify_core_init(&s_child, s_child_buf, MAX_BUFFER_LEN);
-    jsonify_core_open_obj(&s_child);
-
-    jsonify_core_write_ulong(&s_child, "event_id", e_las_ts->event_id);
-    jsonify_core_write_timespec64(&s_child, "time", e_las_ts->tv_sec, e_las_ts->tv_nsec);
-
-    jsonify_core_close_obj(&s_child);
-
     int total = 0;
 
-    char *s_child_buf_ptr;
-    int s_child_buf_size;
-    if (jsonify_core_get_internal_buf_ptr(&s_child, &s_child_buf_ptr, &s_child_buf_size) == 0)
-    {
-        total = jsonify_core_write_as_literal(s, "las_audit", s_child_buf_ptr);
-    }
+    total += jsonify_core_open_nested_obj(s, "las_audit");
+    total += jsonify_core_write_ulong(s, "event_id", e_las_ts->event_id);
+    total += jsonify_core_write_timespec64(s, "time", e_las_ts->tv_sec, e_las_ts->tv_nsec);
+    total += jsonify_core_close_nested_obj(s);
 
-    free(s_child_buf);
     return total;
 }
 
 int jsonify_types_write_elem_sockaddr(struct json_buffer *s, const char *key, struct elem_sockaddr *e_sa, int write_interpreted)
 {
-    char *s_child_buf = (char *)malloc(sizeof(char) * MAX_BUFFER_LEN);
-    if (!s_child_buf)
-        return 0;
+    int total = 0;
 
-    struct json_buffer s_child;
-    jsonify_core_init(&s_child, s_child_buf, MAX_BUFFER_LEN);
-    jsonify_core_open_obj(&s_child);
+    total += jsonify_core_open_nested_obj(s, key);
 
     if (!write_interpreted)
     {
-        jsonify_types_write_elem_sockaddr_generic(&s_child, e_sa);
+        total += jsonify_types_write_elem_sockaddr_generic(s, e_sa);
     }else{
         struct sockaddr *sa = (struct sockaddr *)(e_sa->addr);
         switch (sa->sa_family)
         {
             case AF_INET:
-                jsonify_types_write_ip4_sockaddr_in(&s_child, (struct sockaddr_in *)sa, e_sa->byte_order);
+                total += jsonify_types_write_ip4_sockaddr_in(s, (struct sockaddr_in *)sa, e_sa->byte_order);
                 break;
             case AF_INET6:
-                jsonify_types_write_ip6_sockaddr_in(&s_child, (struct sockaddr_in6 *)sa, e_sa->byte_order);
+                total += jsonify_types_write_ip6_sockaddr_in(s, (struct sockaddr_in6 *)sa, e_sa->byte_order);
                 break;
             case AF_UNIX:
-                jsonify_types_write_sockaddr_un(&s_child, (struct sockaddr_un *)sa);
+                total += jsonify_types_write_sockaddr_un(s, (struct sockaddr_un *)sa);
                 break;
             case AF_NETLINK:
-                jsonify_types_write_sockaddr_nl(&s_child, (struct sockaddr_nl *)sa);
+                total += jsonify_types_write_sockaddr_nl(s, (struct sockaddr_nl *)sa);
                 break;
             default:
-                jsonify_types_write_elem_sockaddr_generic(&s_child, e_sa);
+                total += jsonify_types_write_elem_sockaddr_generic(s, e_sa);
                 break;
         }
     }
 
-    jsonify_core_close_obj(&s_child);
-
-    int total = 0;
-
-    char *s_child_buf_ptr;
-    int s_child_buf_size;
-    if (jsonify_core_get_internal_buf_ptr(&s_child, &s_child_buf_ptr, &s_child_buf_size) == 0)
-    {
-        total = jsonify_core_write_as_literal(s, key, s_child_buf_ptr);
-    }
+    total += jsonify_core_close_nested_obj(s);
 
-    free(s_child_buf);
     return total;
 }
 
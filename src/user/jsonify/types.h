@@ -38,7 +38,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
     Write [,]"key":val where val is a file descriptor.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_types_write_fd(struct json_buffer *s, const char *key, int val);
 
@@ -46,7 +46,7 @@ int jsonify_types_write_fd(struct json_buffer *s, const char *key, int val);
     Write [,]"key":val where val is a return value.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_types_write_return(struct json_buffer *s, const char *key, int val);
 
@@ -54,7 +54,7 @@ int jsonify_types_write_return(struct json_buffer *s, const char *key, int val);
     Write [,]"key":val where val is ssize_t.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_types_write_ssize(struct json_buffer *s, const char *key, ssize_t val);
 
@@ -62,7 +62,7 @@ int jsonify_types_write_ssize(struct json_buffer *s, const char *key, ssize_t va
     Write [,]"key":val where val is pid_t.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_types_write_pid(struct json_buffer *s, const char *key, pid_t val);
 
@@ -70,7 +70,7 @@ int jsonify_types_write_pid(struct json_buffer *s, const char *key, pid_t val);
     Write [,]"key":val where val is uid_t.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_types_write_uid(struct json_buffer *s, const char *key, uid_t val);
 
@@ -78,7 +78,7 @@ int jsonify_types_write_uid(struct json_buffer *s, const char *key, uid_t val);
     Write [,]"key":val where val is gid_t.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_types_write_gid(struct json_buffer *s, const char *key, gid_t val);
 
@@ -86,7 +86,7 @@ int jsonify_types_write_gid(struct json_buffer *s, const char *key, gid_t val);
     Write [,]"key":val where val is inode_num_t.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_types_write_inode(struct json_buffer *s, const char *key, inode_num_t val);
 
@@ -94,7 +94,7 @@ int jsonify_types_write_inode(struct json_buffer *s, const char *key, inode_num_
     Write [,]"event_id":val where val is event_id_t.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_types_write_event_id(struct json_buffer *s, event_id_t val);
 
@@ -104,7 +104,7 @@ int jsonify_types_write_event_id(struct json_buffer *s, event_id_t val);
     Set 'write_interpreted' to non-zero value to write the interpreted value of sys_id as well.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_types_write_sys_id(struct json_buffer *s, sys_id_t sys_id, int write_interpreted);
 
@@ -112,7 +112,7 @@ int jsonify_types_write_sys_id(struct json_buffer *s, sys_id_t sys_id, int write
     Write [,]"sys_name":"val_sys_name" where val_sys_name is interpreted from sys_id.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_types_write_sys_name(struct json_buffer *s, sys_id_t sys_id);
 
@@ -120,7 +120,7 @@ int jsonify_types_write_sys_name(struct json_buffer *s, sys_id_t sys_id);
     Write [,]"key":"val_ip_family_name" where val_ip_family_name is interpreted from ip_family.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_types_write_ip_family_name(struct json_buffer *s, char *key, int ip_family);
 
@@ -134,7 +134,7 @@ int jsonify_types_write_ip_family_name(struct json_buffer *s, char *key, int ip_
         , where val is elem_las_timestamp.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_types_write_elem_las_timestamp(struct json_buffer *s, struct elem_las_timestamp *e_las_ts);
 
@@ -145,7 +145,7 @@ int jsonify_types_write_elem_las_timestamp(struct json_buffer *s, struct elem_la
     Set 'write_interpreted' to non-zero value to write the interpreted value of e_sa as well.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_types_write_elem_sockaddr(struct json_buffer *s, const char *key, struct elem_sockaddr *e_sa, int write_interpreted);
 
@@ -154,7 +154,7 @@ int jsonify_types_write_elem_sockaddr(struct json_buffer *s, const char *key, st
         [,]"key":version.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_types_write_version(struct json_buffer *s, const char *key, const struct elem_version *version);
 
@@ -167,7 +167,7 @@ int jsonify_types_write_version(struct json_buffer *s, const char *key, const st
         [,"task_ctx_id":e_common->task_ctx_id]
     
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
 int jsonify_types_write_common(
     struct json_buffer *s, struct elem_common *e_common, 
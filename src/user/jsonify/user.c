@@ -24,14 +24,59 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "user/jsonify/user.h"
 
 
+static const char *jsonify_user_format_name(enum output_format format)
+{
+    switch (format)
+    {
+        case OUTPUT_FORMAT_BINARY:
+            return "binary";
+        case OUTPUT_FORMAT_CBOR:
+            return "cbor";
+        case OUTPUT_FORMAT_COLUMNAR:
+            return "columnar";
+        default:
+            return "json";
+    }
+}
+
+static int jsonify_user_write_format(struct json_buffer *s, enum output_format format)
+{
+    return jsonify_core_write_str(s, "format", jsonify_user_format_name(format));
+}
+
+static const char *jsonify_user_compression_codec_name(enum output_compression_codec codec)
+{
+    switch (codec)
+    {
+        case OUTPUT_COMPRESSION_ZSTD:
+            return "zstd";
+        case OUTPUT_COMPRESSION_LZ4:
+            return "lz4";
+        default:
+            return "none";
+    }
+}
+
 int jsonify_user_write_output_file(struct json_buffer *s, struct output_file *o_file)
 {
-    int s_child_buf_size = PATH_MAX + 50;
+    int s_child_buf_size = PATH_MAX + 256;
     char s_child_buf[s_child_buf_size];
     struct json_buffer s_child;
     jsonify_core_init(&s_child, &(s_child_buf[0]), s_child_buf_size);
     jsonify_core_open_obj(&s_child);
     jsonify_core_write_str(&s_child, "path", o_file->path);
+    jsonify_core_write_ulong(&s_child, "buffer_size", o_file->flush_policy.buffer_size);
+    jsonify_core_write_long(&s_child, "flush_ms", o_file->flush_policy.flush_interval_ms);
+    jsonify_core_write_str(&s_child, "engine", o_file->engine == OUTPUT_FILE_ENGINE_URING ? "uring" : "sync");
+    jsonify_core_write_str(&s_child, "compression", jsonify_user_compression_codec_name(o_file->compression.codec));
+    if (o_file->compression.codec != OUTPUT_COMPRESSION_NONE)
+    {
+        jsonify_core_write_int(&s_child, "compression_level", o_file->compression.level);
+        jsonify_core_write_ulong(&s_child, "compression_block_size", o_file->compression.block_size);
+    }
+    jsonify_core_write_ulong(&s_child, "rotate_size", o_file->rotation.max_size);
+    jsonify_core_write_long(&s_child, "rotate_interval_sec", o_file->rotation.interval_sec);
+    jsonify_core_write_int(&s_child, "rotate_retain", o_file->rotation.retain);
     jsonify_core_close_obj(&s_child);
 
     int total = 0;
@@ -56,6 +101,9 @@ int jsonify_user_write_output_net(struct json_buffer *s, struct output_net *o_ne
     jsonify_core_write_str(&s_child, "ip", o_net->ip);
     jsonify_core_write_int(&s_child, "port", o_net->port);
     jsonify_types_write_ip_family_name(&s_child, "ip_family", o_net->ip_family);
+    jsonify_core_write_ulong(&s_child, "datagram_size", o_net->datagram_size);
+    jsonify_core_write_int(&s_child, "batch", o_net->batch);
+    jsonify_core_write_long(&s_child, "flush_ms", o_net->flush_interval_ms);
     jsonify_core_close_obj(&s_child);
 
 
@@ -71,28 +119,261 @@ int jsonify_user_write_output_net(struct json_buffer *s, struct output_net *o_ne
     return total;
 }
 
-int jsonify_user_write_output(struct json_buffer *s, struct user_input *val)
+static const char *jsonify_user_spool_policy_name(enum output_spool_policy policy)
+{
+    switch (policy)
+    {
+        case OUTPUT_SPOOL_POLICY_DROP_OLDEST:
+            return "drop_oldest";
+        case OUTPUT_SPOOL_POLICY_DROP_NEWEST:
+            return "drop_newest";
+        default:
+            return "block";
+    }
+}
+
+int jsonify_user_write_output_tcp(struct json_buffer *s, struct output_tcp *o_tcp)
+{
+    int s_child_buf_size = PATH_MAX + 512;
+    char s_child_buf[s_child_buf_size];
+    struct json_buffer s_child;
+    jsonify_core_init(&s_child, &(s_child_buf[0]), s_child_buf_size);
+    jsonify_core_open_obj(&s_child);
+    jsonify_core_write_str(&s_child, "ip", o_tcp->ip);
+    jsonify_core_write_int(&s_child, "port", o_tcp->port);
+    jsonify_types_write_ip_family_name(&s_child, "ip_family", o_tcp->ip_family);
+    jsonify_core_write_ulong(&s_child, "spool_size", o_tcp->spool_size);
+    jsonify_core_write_str(&s_child, "spool_policy", jsonify_user_spool_policy_name(o_tcp->spool_policy));
+    jsonify_core_write_long(&s_child, "flush_ms", o_tcp->flush_interval_ms);
+    jsonify_core_write_long(&s_child, "reconnect_min_ms", o_tcp->reconnect_min_ms);
+    jsonify_core_write_long(&s_child, "reconnect_max_ms", o_tcp->reconnect_max_ms);
+    if (o_tcp->spill.dir[0] != '\0')
+    {
+        jsonify_core_write_str(&s_child, "spill_dir", o_tcp->spill.dir);
+        jsonify_core_write_ulong(&s_child, "spill_size", o_tcp->spill.max_size);
+        jsonify_core_write_ulong(&s_child, "spill_segment_size", o_tcp->spill.segment_size);
+    }
+    jsonify_core_write_str(&s_child, "compression", jsonify_user_compression_codec_name(o_tcp->compression.codec));
+    if (o_tcp->compression.codec != OUTPUT_COMPRESSION_NONE)
+    {
+        jsonify_core_write_int(&s_child, "compression_level", o_tcp->compression.level);
+        jsonify_core_write_ulong(&s_child, "compression_block_size", o_tcp->compression.block_size);
+    }
+    jsonify_core_close_obj(&s_child);
+
+    int total = 0;
+
+    char *s_child_buf_ptr;
+    int s_child_buf_ptr_size;
+    if (jsonify_core_get_internal_buf_ptr(&s_child, &s_child_buf_ptr, &s_child_buf_ptr_size) == 0)
+    {
+        total += jsonify_core_write_as_literal(s, "output_tcp", s_child_buf_ptr);
+    }
+
+    return total;
+}
+
+int jsonify_user_write_output_unix(struct json_buffer *s, struct output_unix *o_unix)
 {
+    int s_child_buf_size = PATH_MAX + 256;
+    char s_child_buf[s_child_buf_size];
+    struct json_buffer s_child;
+    jsonify_core_init(&s_child, &(s_child_buf[0]), s_child_buf_size);
+    jsonify_core_open_obj(&s_child);
+    jsonify_core_write_str(&s_child, "path", o_unix->path);
+    jsonify_core_write_ulong(&s_child, "message_size", o_unix->message_size);
+    jsonify_core_write_long(&s_child, "flush_ms", o_unix->flush_interval_ms);
+    jsonify_core_close_obj(&s_child);
+
     int total = 0;
-    char *v;
-    switch (val->o_type)
+
+    char *s_child_buf_ptr;
+    int s_child_buf_ptr_size;
+    if (jsonify_core_get_internal_buf_ptr(&s_child, &s_child_buf_ptr, &s_child_buf_ptr_size) == 0)
+    {
+        total += jsonify_core_write_as_literal(s, "output_unix", s_child_buf_ptr);
+    }
+
+    return total;
+}
+
+int jsonify_user_write_output_shm(struct json_buffer *s, struct output_shm *o_shm)
+{
+    int s_child_buf_size = PATH_MAX + 256;
+    char s_child_buf[s_child_buf_size];
+    struct json_buffer s_child;
+    jsonify_core_init(&s_child, &(s_child_buf[0]), s_child_buf_size);
+    jsonify_core_open_obj(&s_child);
+    jsonify_core_write_str(&s_child, "path", o_shm->path);
+    jsonify_core_write_ulong(&s_child, "size", o_shm->size);
+    jsonify_core_close_obj(&s_child);
+
+    int total = 0;
+
+    char *s_child_buf_ptr;
+    int s_child_buf_ptr_size;
+    if (jsonify_core_get_internal_buf_ptr(&s_child, &s_child_buf_ptr, &s_child_buf_ptr_size) == 0)
+    {
+        total += jsonify_core_write_as_literal(s, "output_shm", s_child_buf_ptr);
+    }
+
+    return total;
+}
+
+const char *jsonify_user_output_type_name(enum output_type o_type)
+{
+    switch (o_type)
     {
         case OUTPUT_NONE:
-            v = "none";
-            break;
+            return "none";
+        case OUTPUT_FILE:
+            return "file";
+        case OUTPUT_NET:
+            return "net";
+        case OUTPUT_TCP:
+            return "tcp";
+        case OUTPUT_UNIX:
+            return "unix";
+        case OUTPUT_SHM:
+            return "shm";
+        default:
+            return "unknown";
+    }
+}
+
+static int jsonify_user_write_output_of_type(struct json_buffer *s, struct user_input *val, enum output_type o_type)
+{
+    switch (o_type)
+    {
         case OUTPUT_FILE:
-            total += jsonify_user_write_output_file(s, &(val->output_file));
-            v = "file";
-            break;
+            return jsonify_user_write_output_file(s, &(val->output_file));
         case OUTPUT_NET:
-            total += jsonify_user_write_output_net(s, &(val->output_net));
-            v = "net";
-            break;
+            return jsonify_user_write_output_net(s, &(val->output_net));
+        case OUTPUT_TCP:
+            return jsonify_user_write_output_tcp(s, &(val->output_tcp));
+        case OUTPUT_UNIX:
+            return jsonify_user_write_output_unix(s, &(val->output_unix));
+        case OUTPUT_SHM:
+            return jsonify_user_write_output_shm(s, &(val->output_shm));
         default:
-            v = "unknown";
-            break;
+            return 0;
+    }
+}
+
+/*
+    Write the format of every output.
+*/
+static int jsonify_user_write_output_sinks(struct json_buffer *s, struct user_input *val)
+{
+    int s_child_buf_size = 256;
+    char s_child_buf[s_child_buf_size];
+    struct json_buffer s_child;
+    jsonify_core_init(&s_child, &(s_child_buf[0]), s_child_buf_size);
+    jsonify_core_open_obj(&s_child);
+    for (int i = 0; i < val->sinks_len; i++)
+    {
+        jsonify_core_write_str(
+            &s_child,
+            jsonify_user_output_type_name(val->sinks[i].o_type),
+            jsonify_user_format_name(val->sinks[i].format)
+        );
+    }
+    jsonify_core_close_obj(&s_child);
+
+    int total = 0;
+
+    char *s_child_buf_ptr;
+    int s_child_buf_ptr_size;
+    if (jsonify_core_get_internal_buf_ptr(&s_child, &s_child_buf_ptr, &s_child_buf_ptr_size) == 0)
+    {
+        total += jsonify_core_write_as_literal(s, "output_sinks", s_child_buf_ptr);
+    }
+
+    return total;
+}
+
+int jsonify_user_write_output(struct json_buffer *s, struct user_input *val)
+{
+    int total = 0;
+    if (val->sinks_len == 0)
+        total += jsonify_user_write_output_of_type(s, val, val->o_type);
+    for (int i = 0; i < val->sinks_len; i++)
+        total += jsonify_user_write_output_of_type(s, val, val->sinks[i].o_type);
+    total += jsonify_core_write_str(s, "output_type", jsonify_user_output_type_name(val->o_type));
+    if (val->sinks_len > 1)
+        total += jsonify_user_write_output_sinks(s, val);
+    return total;
+}
+
+int jsonify_user_write_ringbuf(struct json_buffer *s, struct ringbuf_config *val)
+{
+    int s_child_buf_size = 256;
+    char s_child_buf[s_child_buf_size];
+    struct json_buffer s_child;
+    jsonify_core_init(&s_child, &(s_child_buf[0]), s_child_buf_size);
+    jsonify_core_open_obj(&s_child);
+    jsonify_core_write_str(&s_child, "mode", val->mode == RINGBUF_MODE_PERCPU ? "percpu" : "shared");
+    jsonify_core_write_str(&s_child, "consumers", val->consumers == RINGBUF_CONSUMERS_PER_NUMA_NODE ? "numa" : "single");
+    jsonify_core_write_ulong(&s_child, "size", val->size);
+    jsonify_core_write_long(&s_child, "wakeup_watermark", val->wakeup_watermark);
+    jsonify_core_write_long(&s_child, "max_latency_ms", val->max_latency_ms);
+    jsonify_core_close_obj(&s_child);
+
+    int total = 0;
+
+    char *s_child_buf_ptr;
+    int s_child_buf_ptr_size;
+    if (jsonify_core_get_internal_buf_ptr(&s_child, &s_child_buf_ptr, &s_child_buf_ptr_size) == 0)
+    {
+        total = jsonify_core_write_as_literal(s, "ringbuf", s_child_buf_ptr);
     }
-    total += jsonify_core_write_str(s, "output_type", v);
+
+    return total;
+}
+
+int jsonify_user_write_stats(struct json_buffer *s, struct stats_config *val)
+{
+    int s_child_buf_size = PATH_MAX + 64;
+    char s_child_buf[s_child_buf_size];
+    struct json_buffer s_child;
+    jsonify_core_init(&s_child, &(s_child_buf[0]), s_child_buf_size);
+    jsonify_core_open_obj(&s_child);
+    jsonify_core_write_long(&s_child, "interval_sec", val->interval_sec);
+    jsonify_core_write_str(&s_child, "path", val->path);
+    jsonify_core_close_obj(&s_child);
+
+    int total = 0;
+
+    char *s_child_buf_ptr;
+    int s_child_buf_ptr_size;
+    if (jsonify_core_get_internal_buf_ptr(&s_child, &s_child_buf_ptr, &s_child_buf_ptr_size) == 0)
+    {
+        total = jsonify_core_write_as_literal(s, "stats", s_child_buf_ptr);
+    }
+
+    return total;
+}
+
+static int jsonify_user_write_columnar(struct json_buffer *s, struct columnar_config *val)
+{
+    int s_child_buf_size = 128;
+    char s_child_buf[s_child_buf_size];
+    struct json_buffer s_child;
+    jsonify_core_init(&s_child, &(s_child_buf[0]), s_child_buf_size);
+    jsonify_core_open_obj(&s_child);
+    jsonify_core_write_ulong(&s_child, "batch_rows", val->batch_rows);
+    jsonify_core_write_long(&s_child, "max_age_ms", val->max_age_ms);
+    jsonify_core_close_obj(&s_child);
+
+    int total = 0;
+
+    char *s_child_buf_ptr;
+    int s_child_buf_ptr_size;
+    if (jsonify_core_get_internal_buf_ptr(&s_child, &s_child_buf_ptr, &s_child_buf_ptr_size) == 0)
+    {
+        total = jsonify_core_write_as_literal(s, "columnar", s_child_buf_ptr);
+    }
+
     return total;
 }
 
@@ -116,5 +397,11 @@ int jsonify_user_write_user_input(struct json_buffer *s, struct user_input *val)
     }
 
     total += jsonify_user_write_output(s, val);
+    total += jsonify_user_write_format(s, val->format);
+    if (val->format == OUTPUT_FORMAT_COLUMNAR)
+        total += jsonify_user_write_columnar(s, &(val->columnar));
+    total += jsonify_core_write_int(s, "pipeline_workers", val->pipeline_workers);
+    total += jsonify_user_write_ringbuf(s, &(val->ringbuf));
+    total += jsonify_user_write_stats(s, &(val->stats));
     return total;
 }
\ No newline at end of file
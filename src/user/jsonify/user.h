@@ -35,6 +35,14 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
     Write user_input to json_buffer.
 
     Return:
-        See 'jsonify_core_snprintf'.
+        See 'jsonify_core_open_obj'.
 */
-int jsonify_user_write_user_input(struct json_buffer *s, struct user_input *val);
\ No newline at end of file
+int jsonify_user_write_user_input(struct json_buffer *s, struct user_input *val);
+
+/*
+    Get the name of an output type as used in the json.
+
+    Return:
+        Static string. "unknown" if not a valid type.
+*/
+const char *jsonify_user_output_type_name(enum output_type o_type);
\ No newline at end of file
@@ -0,0 +1,358 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "user/pipeline/pipeline.h"
+#include "user/jsonify/core.h"
+
+
+/*
+    Used to size the raw record slots to the largest record.
+*/
+union pipeline_any_record
+{
+    struct record_new_process new_process;
+    struct record_cred cred;
+    struct record_namespace namespace;
+    struct record_connect connect;
+    struct record_accept accept;
+    struct record_send_recv send_recv;
+    struct record_bind bind;
+    struct record_kill kill;
+    struct record_audit_log_exit audit_log_exit;
+};
+
+
+#define STATS_ADD(stats, field, n) __atomic_fetch_add(&(stats)->field, (n), __ATOMIC_RELAXED)
+
+
+static void log_error(struct pipeline *p, const char *msg)
+{
+    if (p->args.log_error)
+        p->args.log_error(msg);
+}
+
+static int is_exiting(struct pipeline *p)
+{
+    return __atomic_load_n(&p->exiting, __ATOMIC_ACQUIRE);
+}
+
+static int has_free_slot(struct pipeline *p)
+{
+    return p->submit_seq - __atomic_load_n(&p->write_seq, __ATOMIC_SEQ_CST) < p->args.slots_len;
+}
+
+static int is_all_written(struct pipeline *p)
+{
+    return __atomic_load_n(&p->write_seq, __ATOMIC_SEQ_CST) == p->submit_seq;
+}
+
+static int has_filled_slot_or_exiting(struct pipeline *p)
+{
+    return __atomic_load_n(&p->claim_seq, __ATOMIC_SEQ_CST) != __atomic_load_n(&p->submit_seq, __ATOMIC_SEQ_CST)
+        || is_exiting(p);
+}
+
+static int is_serialized_or_exiting(struct pipeline *p)
+{
+    struct pipeline_slot *slot = &p->slots[p->write_seq % p->args.slots_len];
+    return __atomic_load_n(&slot->serialized, __ATOMIC_SEQ_CST) || is_exiting(p);
+}
+
+/*
+    Wait on 'cond' until 'ready' or for at most 'timeout_ms'. Wait indefinitely if <= 0.
+    'waiting' is set meanwhile so that the other threads only signal when needed.
+
+    Return:
+        0  => Woken up (or already ready)
+        -1 => Timed out
+*/
+static int wait_until(
+    struct pipeline *p, pthread_cond_t *cond, int *waiting, int (*ready)(struct pipeline *p), long timeout_ms
+)
+{
+    int result = 0;
+
+    pthread_mutex_lock(&p->lock);
+    // The other threads only signal while this is set. Check again after setting it.
+    __atomic_add_fetch(waiting, 1, __ATOMIC_SEQ_CST);
+    if (!ready(p))
+    {
+        if (timeout_ms > 0)
+        {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += timeout_ms / 1000;
+            deadline.tv_nsec += (timeout_ms % 1000) * 1000000;
+            if (deadline.tv_nsec >= 1000000000)
+            {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000;
+            }
+            if (pthread_cond_timedwait(cond, &p->lock, &deadline) == ETIMEDOUT)
+                result = -1;
+        }
+        else
+        {
+            pthread_cond_wait(cond, &p->lock);
+        }
+    }
+    __atomic_sub_fetch(waiting, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&p->lock);
+    return result;
+}
+
+/*
+    Wake up a thread waiting on 'cond', if any. Must be called after publishing
+    what the thread waits for.
+*/
+static void wake_up(struct pipeline *p, pthread_cond_t *cond, int *waiting)
+{
+    if (!__atomic_load_n(waiting, __ATOMIC_SEQ_CST))
+        return;
+    pthread_mutex_lock(&p->lock);
+    pthread_cond_signal(cond);
+    pthread_mutex_unlock(&p->lock);
+}
+
+static void *worker_main(void *arg)
+{
+    struct pipeline *p = (struct pipeline *)arg;
+
+    while (1)
+    {
+        unsigned long seq = __atomic_load_n(&p->claim_seq, __ATOMIC_ACQUIRE);
+        if (seq == __atomic_load_n(&p->submit_seq, __ATOMIC_ACQUIRE))
+        {
+            // Only set once all the submitted records are written.
+            if (is_exiting(p))
+                break;
+            wait_until(p, &p->filled_cond, &p->workers_waiting, has_filled_slot_or_exiting, 0);
+            continue;
+        }
+        if (!__atomic_compare_exchange_n(&p->claim_seq, &seq, seq + 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            continue;
+
+        struct pipeline_slot *slot = &p->slots[seq % p->args.slots_len];
+
+        slot->dst_len = p->args.serializer->serialize(
+            slot->dst, p->dst_slot_size, (struct elem_common *)slot->raw, slot->raw_len
+        );
+        if (slot->dst_len <= 0)
+        {
+            STATS_ADD(p->args.stats, serialize_errors, 1);
+            log_error(p, "Failed data conversion");
+        }
+
+        __atomic_store_n(&slot->serialized, 1, __ATOMIC_SEQ_CST);
+        wake_up(p, &p->serialized_cond, &p->writer_waiting);
+    }
+
+    return NULL;
+}
+
+static void *writer_main(void *arg)
+{
+    struct pipeline *p = (struct pipeline *)arg;
+
+    while (1)
+    {
+        struct pipeline_slot *slot = &p->slots[p->write_seq % p->args.slots_len];
+
+        if (!__atomic_load_n(&slot->serialized, __ATOMIC_ACQUIRE))
+        {
+            // Only set once all the submitted records are written.
+            if (is_exiting(p))
+                break;
+            if (wait_until(p, &p->serialized_cond, &p->writer_waiting, is_serialized_or_exiting,
+                           p->args.flush_interval_ms) != 0)
+            {
+                if (p->args.writer->flush(0) == -1)
+                    log_error(p, "Failed data flush");
+            }
+            continue;
+        }
+
+        if (slot->dst_len > 0)
+        {
+            int write_result = p->args.writer->write(slot->dst, slot->dst_len);
+            if (write_result < 0)
+            {
+                STATS_ADD(p->args.stats, write_errors, 1);
+                log_error(p, "Failed data write");
+            }
+            else
+            {
+                STATS_ADD(p->args.stats, bytes_written, write_result);
+            }
+        }
+
+        __atomic_store_n(&slot->serialized, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&p->write_seq, p->write_seq + 1, __ATOMIC_SEQ_CST);
+        wake_up(p, &p->free_cond, &p->drain_waiting);
+    }
+
+    return NULL;
+}
+
+static void free_slots(struct pipeline *p)
+{
+    if (!p->slots)
+        return;
+
+    for (size_t i = 0; i < p->args.slots_len; i++)
+    {
+        free(p->slots[i].raw);
+        free(p->slots[i].dst);
+    }
+    free(p->slots);
+    p->slots = NULL;
+}
+
+static int alloc_slots(struct pipeline *p)
+{
+    p->slots = calloc(p->args.slots_len, sizeof(struct pipeline_slot));
+    if (!p->slots)
+        return -1;
+
+    for (size_t i = 0; i < p->args.slots_len; i++)
+    {
+        struct pipeline_slot *slot = &p->slots[i];
+        slot->raw = malloc(p->raw_slot_size);
+        slot->dst = malloc(p->dst_slot_size);
+        if (!slot->raw || !slot->dst)
+        {
+            free_slots(p);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+    Wake up and join all the started threads.
+*/
+static void join_threads(struct pipeline *p)
+{
+    pthread_mutex_lock(&p->lock);
+    __atomic_store_n(&p->exiting, 1, __ATOMIC_SEQ_CST);
+    pthread_cond_broadcast(&p->filled_cond);
+    pthread_cond_broadcast(&p->serialized_cond);
+    pthread_mutex_unlock(&p->lock);
+
+    for (int i = 0; i < p->worker_threads_len; i++)
+        pthread_join(p->worker_threads[i], NULL);
+
+    if (p->writer_thread_started)
+        pthread_join(p->writer_thread, NULL);
+
+    free(p->worker_threads);
+    p->worker_threads = NULL;
+    p->worker_threads_len = 0;
+    p->writer_thread_started = 0;
+}
+
+static void destroy_sync(struct pipeline *p)
+{
+    pthread_cond_destroy(&p->free_cond);
+    pthread_cond_destroy(&p->filled_cond);
+    pthread_cond_destroy(&p->serialized_cond);
+    pthread_mutex_destroy(&p->lock);
+}
+
+int pipeline_start(struct pipeline *p, struct pipeline_args *args)
+{
+    if (!p || !args || args->workers <= 0 || !args->serializer || !args->writer || !args->stats)
+        return -1;
+
+    memset(p, 0, sizeof(struct pipeline));
+    memcpy(&p->args, args, sizeof(struct pipeline_args));
+    if (p->args.slots_len == 0)
+        p->args.slots_len = PIPELINE_DEFAULT_SLOTS_LEN;
+
+    p->raw_slot_size = sizeof(union pipeline_any_record);
+    p->dst_slot_size = MAX_BUFFER_LEN;
+
+    if (alloc_slots(p) != 0)
+        return -1;
+
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->free_cond, NULL);
+    pthread_cond_init(&p->filled_cond, NULL);
+    pthread_cond_init(&p->serialized_cond, NULL);
+
+    p->worker_threads = calloc(p->args.workers, sizeof(pthread_t));
+    if (!p->worker_threads)
+        goto slots_free;
+
+    for (int i = 0; i < p->args.workers; i++)
+    {
+        if (pthread_create(&p->worker_threads[i], NULL, worker_main, p) != 0)
+            goto threads_join;
+        p->worker_threads_len++;
+    }
+
+    if (pthread_create(&p->writer_thread, NULL, writer_main, p) != 0)
+        goto threads_join;
+    p->writer_thread_started = 1;
+
+    return 0;
+
+threads_join:
+    join_threads(p);
+
+slots_free:
+    destroy_sync(p);
+    free_slots(p);
+    return -1;
+}
+
+int pipeline_submit(struct pipeline *p, void *data, size_t data_len)
+{
+    if (data_len > p->raw_slot_size)
+        return -1;
+
+    while (!has_free_slot(p))
+        wait_until(p, &p->free_cond, &p->drain_waiting, has_free_slot, 0);
+
+    struct pipeline_slot *slot = &p->slots[p->submit_seq % p->args.slots_len];
+    memcpy(slot->raw, data, data_len);
+    slot->raw_len = data_len;
+
+    // Publish before checking for waiting workers, which check 'submit_seq' after setting 'workers_waiting'.
+    __atomic_store_n(&p->submit_seq, p->submit_seq + 1, __ATOMIC_SEQ_CST);
+    wake_up(p, &p->filled_cond, &p->workers_waiting);
+    return 0;
+}
+
+void pipeline_stop(struct pipeline *p)
+{
+    // Wait for the writer to free all the slots i.e. write all the records.
+    while (!is_all_written(p))
+        wait_until(p, &p->free_cond, &p->drain_waiting, is_all_written, 0);
+
+    join_threads(p);
+
+    destroy_sync(p);
+    free_slots(p);
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/*
+
+    A module to serialize and write records on multiple threads.
+
+    The thread draining the ring buffer only copies each raw record into a
+    slot of a bounded ring (see pipeline_submit). 'workers' threads claim
+    filled slots and serialize them, and a single writer thread writes the
+    serialized slots in the order they were submitted.
+
+    Slot 's % slots_len' holds the record with sequence number 's'. A slot
+    moves through: free -> filled (drain thread) -> serialized (a worker) ->
+    written and free again (writer thread).
+
+    The slots are handed over through atomic sequence numbers (and a flag per
+    slot for serialized), so that no system call is made per record. A thread
+    only sleeps on a condition variable when it has nothing to do, and is only
+    signalled while it sleeps.
+
+*/
+
+#include <pthread.h>
+#include <stddef.h>
+
+#include "common/types.h"
+#include "user/types.h"
+#include "user/record/serializer/serializer.h"
+#include "user/record/writer/writer.h"
+
+
+/*
+    Default number of slots in the pipeline ring.
+*/
+#define PIPELINE_DEFAULT_SLOTS_LEN 4096
+
+
+struct pipeline_slot
+{
+    size_t raw_len;
+    char *raw;
+    long dst_len;
+    char *dst;
+    /*
+        Set by a worker when the slot is serialized (or failed to be), and
+        cleared by the writer thread once written.
+    */
+    int serialized;
+};
+
+struct pipeline_args
+{
+    int workers;
+    size_t slots_len;
+    const struct record_serializer *serializer;
+    const struct record_writer *writer;
+    /*
+        Interval at which the writer thread calls writer->flush(0) when idle.
+        Ignored if <= 0.
+    */
+    long flush_interval_ms;
+    /*
+        Counters updated by the pipeline threads.
+    */
+    struct consumer_stats *stats;
+    /*
+        Called (from any pipeline thread) to report an error. Optional.
+    */
+    void (*log_error)(const char *msg);
+};
+
+struct pipeline
+{
+    struct pipeline_args args;
+
+    struct pipeline_slot *slots;
+    size_t raw_slot_size;
+    size_t dst_slot_size;
+
+    // Only written by the drain thread. Slots before it are filled.
+    unsigned long submit_seq;
+    // Claimed atomically by workers. Slots before it are claimed.
+    unsigned long claim_seq;
+    // Only written by the writer thread. Slots before it are free.
+    unsigned long write_seq;
+
+    pthread_mutex_t lock;
+    // Signalled when a slot is free, filled, or serialized respectively.
+    pthread_cond_t free_cond;
+    pthread_cond_t filled_cond;
+    pthread_cond_t serialized_cond;
+    // Set while the threads wait on the conditions above (number of workers for 'filled').
+    int drain_waiting;
+    int workers_waiting;
+    int writer_waiting;
+    int exiting;
+
+    pthread_t *worker_threads;
+    int worker_threads_len;
+    pthread_t writer_thread;
+    int writer_thread_started;
+};
+
+
+/*
+    Allocate all the slots and start the threads.
+
+    Return:
+        0    => Success
+        -ive => Failure. Nothing to free.
+*/
+int pipeline_start(struct pipeline *p, struct pipeline_args *args);
+
+/*
+    Copy the raw record into the next slot. Must be called from a single thread.
+
+    Blocks while all slots are in use.
+
+    Return:
+        0  => Success
+        -1 => Record too large for a slot
+*/
+int pipeline_submit(struct pipeline *p, void *data, size_t data_len);
+
+/*
+    Wait for all the submitted records to be written, stop the threads, and
+    free the slots. The writer is not closed.
+*/
+void pipeline_stop(struct pipeline *p);
\ No newline at end of file
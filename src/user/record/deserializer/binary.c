@@ -21,52 +21,123 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <string.h>
 #include "user/error.h"
 #include "user/record/deserializer/deserializer.h"
+#include "user/record/deserializer/reader.h"
 
-/*
-static const int max_buff_len = 1024;
-static const unsigned char buf[max_buff_len];
-static int current_buf_index = 0;
-static int expected_data_size = 0;
+
+static struct record_reader reader;
+// The record returned by the reader but not yet read by the caller.
+static struct elem_common *ready_record = NULL;
+static size_t ready_record_len = 0;
 
 
-static void reset_state()
+static void reset_state(void)
 {
-    current_buf_index = 0;
-    expected_data_size = 0;
-    memset(&buf[0], 0, max_buff_len);
+    reader.start = 0;
+    reader.end = 0;
+    reader.header_read = 0;
+    ready_record = NULL;
+    ready_record_len = 0;
 }
+
+/*
+    Put the ready record back into the reader so that it is not overwritten when the
+    reader moves its data.
 */
+static void unread_ready_record(void)
+{
+    if (ready_record == NULL)
+        return;
+    reader.start -= sizeof(size_t) + ready_record_len;
+    ready_record = NULL;
+    ready_record_len = 0;
+}
+
+static int get_ready_record(void)
+{
+    if (ready_record)
+        return ready_record_len;
+
+    int ret = record_reader_next(&reader, &ready_record, &ready_record_len);
+    if (ret < 0)
+    {
+        reset_state();
+        return ret;
+    }
+    if (ret == 0)
+    {
+        ready_record = NULL;
+        return 0;
+    }
+    return ready_record_len;
+}
+
+static int record_deserializer_binary_deserialize(void *data, size_t data_len)
+{
+    if (reader.buf == NULL && record_reader_init(&reader, RECORD_READER_DEFAULT_BUF_LEN) != 0)
+        return ERR_DST_INVALID;
+
+    if (data_len > 0)
+    {
+        if (data == NULL)
+        {
+            reset_state();
+            return ERR_RECORD_INVALID;
+        }
+
+        unread_ready_record();
+
+        void *space;
+        size_t space_len;
+        if (record_reader_get_space(&reader, &space, &space_len) != 0 || space_len < data_len)
+        {
+            reset_state();
+            return ERR_DST_INSUFFICIENT;
+        }
+        memcpy(space, data, data_len);
+        record_reader_commit(&reader, data_len);
+    }
+
+    return get_ready_record();
+}
+
+static int record_deserializer_binary_read(void *dst, int dst_len)
+{
+    if (dst == NULL)
+        return ERR_DST_INVALID;
+    if (reader.buf == NULL)
+        return 0;
+
+    int ret = get_ready_record();
+    if (ret <= 0)
+        return ret;
+    if ((size_t)dst_len < ready_record_len)
+        return ERR_DST_INSUFFICIENT;
+
+    memcpy(dst, ready_record, ready_record_len);
+    ready_record = NULL;
+    ready_record_len = 0;
+    return ret;
+}
+
+static int record_deserializer_binary_get_available_space(void)
+{
+    if (reader.buf == NULL)
+        return RECORD_READER_DEFAULT_BUF_LEN;
+
+    // Same as the space 'record_reader_get_space' would give.
+    size_t start = reader.start;
+    if (ready_record)
+        start -= sizeof(size_t) + ready_record_len;
+    if (start == reader.end)
+        return reader.buf_len;
+    if (start > 0 && reader.buf_len - reader.end < sizeof(size_t) + RECORD_READER_MAX_RECORD_LEN)
+        return reader.buf_len - (reader.end - start);
+    return reader.buf_len - reader.end;
+}
+
 
-// static int data_deserializer_binary_deserialize(void *data, size_t data_len)
-// {
-//     if (!data)
-//     {
-//         reset_state();
-//         return ERR_DATA_INVALID;
-//     }
-
-//     if (data_len + current_buf_index > max_buff_len)
-//     {
-//         reset_state();
-//         return ERR_DST_INSUFFICIENT;
-//     }
-    
-//     if (current_buf_index == 0)
-//     {
-//         int size_t_len = sizeof(size_t);
-//         if (data_len)
-//         memcpy(&dst_c[i], &data_len, sizeof(size_t));
-//     }
-//     return 0;
-// }
-
-// static int data_deserializer_binary_read(void *dst, int dst_len)
-// {
-//     return 0;
-// }
-
-
-// const struct data_deserializer data_deserializer_binary = {
-//     .deserialize = data_deserializer_binary_deserialize,
-//     .read = data_deserializer_binary_read
-// };
+const struct record_deserializer record_deserializer_binary = {
+    .deserialize = record_deserializer_binary_deserialize,
+    .read = record_deserializer_binary_read,
+    .get_available_space = record_deserializer_binary_get_available_space
+};
\ No newline at end of file
@@ -51,6 +51,8 @@ struct record_deserializer {
             -ive -> Error and any incomplete data is discarded.
             0    -> Not ready.
 
+        Call with 'data_len' 0 to check for another ready record without adding data.
+
     */
     int (*deserialize)(void *data, size_t data_len);
 
@@ -60,7 +62,7 @@ struct record_deserializer {
         Return:
             +ive -> Data written into dst
             -ive -> Error
-            0    -> Undefined
+            0    -> No record is ready
     */
     int (*read)(void *dst, int dst_len);
 
@@ -0,0 +1,310 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "common/constants.h"
+#include "user/error.h"
+#include "user/record/deserializer/reader.h"
+
+
+/*
+    Max size (bytes) of a stream header. Larger sizes are treated as corruption.
+*/
+#define RECORD_READER_MAX_HEADER_LEN 4096
+
+
+long record_reader_check_stream_header(const void *data, size_t data_len, struct record_stream_header *header)
+{
+    if (data == NULL || header == NULL)
+        return ERR_STREAM_INVALID_HEADER;
+
+    // The header before 'header_size' is known to be read.
+    size_t min_len = offsetof(struct record_stream_header, record_version);
+    if (data_len < min_len)
+        return 0;
+
+    struct record_stream_header h;
+    memcpy(&h, data, min_len);
+
+    if (h.magic != AMEBA_MAGIC)
+        return ERR_STREAM_INVALID_HEADER;
+    if (h.header_version < 1)
+        return ERR_STREAM_INVALID_HEADER;
+    // Later header versions only append members. Version 1 ends before 'audit_arch'.
+    if (h.header_size < offsetof(struct record_stream_header, audit_arch)
+        || h.header_size > RECORD_READER_MAX_HEADER_LEN)
+        return ERR_STREAM_INVALID_HEADER;
+    if (data_len < h.header_size)
+        return 0;
+
+    // Members not in the header are 0.
+    size_t header_size = h.header_size;
+    memset(&h, 0, sizeof(h));
+    memcpy(&h, data, header_size < sizeof(h) ? header_size : sizeof(h));
+
+    struct record_stream_header own;
+    record_serializer_init_stream_header(&own);
+
+    if (h.endianness != own.endianness)
+        return ERR_STREAM_UNSUPPORTED;
+    if (h.length_size != own.length_size)
+        return ERR_STREAM_UNSUPPORTED;
+    if (h.has_task_ctx_id != own.has_task_ctx_id)
+        return ERR_STREAM_UNSUPPORTED;
+    if (h.record_version.major > own.record_version.major)
+        return ERR_STREAM_UNSUPPORTED;
+    if (h.record_types > RECORD_STREAM_MAX_RECORD_TYPES)
+        return ERR_STREAM_INVALID_HEADER;
+
+    // Sizes of older majors are handled by the version in each record.
+    if (h.record_version.major == own.record_version.major)
+    {
+        for (int i = 0; i < h.record_types; i++)
+        {
+            if (h.record_sizes[i] == 0 || own.record_sizes[i] == 0)
+                continue;
+            if (h.record_sizes[i] != own.record_sizes[i])
+                return ERR_STREAM_UNSUPPORTED;
+        }
+    }
+
+    memcpy(header, &h, sizeof(h));
+    return h.header_size;
+}
+
+
+int record_reader_init(struct record_reader *r, size_t buf_len)
+{
+    if (r == NULL)
+        return -1;
+    if (buf_len < sizeof(size_t) + RECORD_READER_MAX_RECORD_LEN || buf_len < RECORD_READER_MAX_HEADER_LEN)
+        return -1;
+
+    memset(r, 0, sizeof(*r));
+    r->buf = malloc(buf_len);
+    if (r->buf == NULL)
+        return -1;
+    r->buf_len = buf_len;
+    return 0;
+}
+
+void record_reader_free(struct record_reader *r)
+{
+    if (r == NULL)
+        return;
+    free(r->buf);
+    memset(r, 0, sizeof(*r));
+}
+
+int record_reader_get_space(struct record_reader *r, void **ptr, size_t *len)
+{
+    if (r == NULL || r->buf == NULL || ptr == NULL || len == NULL)
+        return -1;
+
+    if (r->start == r->end)
+    {
+        r->start = 0;
+        r->end = 0;
+    } else if (r->start > 0 && r->buf_len - r->end < sizeof(size_t) + RECORD_READER_MAX_RECORD_LEN)
+    {
+        /*
+            Only the partial record at the end is moved, and only when there may not be
+            space for the rest of it.
+        */
+        memmove(&r->buf[0], &r->buf[r->start], r->end - r->start);
+        r->end -= r->start;
+        r->start = 0;
+    }
+
+    if (r->end == r->buf_len)
+        return -1;
+
+    *ptr = &r->buf[r->end];
+    *len = r->buf_len - r->end;
+    return 0;
+}
+
+void record_reader_commit(struct record_reader *r, size_t len)
+{
+    if (r == NULL)
+        return;
+    if (len > r->buf_len - r->end)
+        len = r->buf_len - r->end;
+    r->end += len;
+}
+
+long record_reader_read_fd(struct record_reader *r, int fd)
+{
+    void *ptr;
+    size_t len;
+    if (record_reader_get_space(r, &ptr, &len) != 0)
+    {
+        errno = ENOBUFS;
+        return -1;
+    }
+
+    ssize_t ret;
+    do
+    {
+        ret = read(fd, ptr, len);
+    } while (ret < 0 && errno == EINTR);
+
+    if (ret > 0)
+        record_reader_commit(r, ret);
+    return ret;
+}
+
+/*
+    Get the record at the start of 'data'.
+
+    Return:
+        1    -> 'record_len' is set to the size of the record
+        0    -> Not enough data for the record
+        -ive -> The error
+*/
+static int get_record(const unsigned char *data, size_t data_len, size_t *record_len)
+{
+    if (data_len < sizeof(size_t))
+        return 0;
+
+    size_t len;
+    memcpy(&len, data, sizeof(size_t));
+    if (len < sizeof(struct elem_common) || len > RECORD_READER_MAX_RECORD_LEN)
+        return ERR_RECORD_INVALID;
+    if (data_len - sizeof(size_t) < len)
+        return 0;
+
+    magic_t magic;
+    memcpy(&magic, &data[sizeof(size_t)], sizeof(magic));
+    if (magic != AMEBA_MAGIC)
+        return ERR_RECORD_INVALID_MAGIC;
+
+    *record_len = len;
+    return 1;
+}
+
+int record_reader_next(struct record_reader *r, struct elem_common **record, size_t *record_len)
+{
+    if (r == NULL || r->buf == NULL || record == NULL || record_len == NULL)
+        return ERR_DST_INVALID;
+
+    if (!r->header_read)
+    {
+        long ret = record_reader_check_stream_header(&r->buf[r->start], r->end - r->start, &r->header);
+        if (ret <= 0)
+            return ret;
+        r->start += ret;
+        r->header_read = 1;
+    }
+
+    size_t len;
+    int ret = get_record(&r->buf[r->start], r->end - r->start, &len);
+    if (ret <= 0)
+        return ret;
+
+    *record = (struct elem_common *)&r->buf[r->start + sizeof(size_t)];
+    *record_len = len;
+    r->start += sizeof(size_t) + len;
+    return 1;
+}
+
+
+int record_file_reader_open(struct record_file_reader *r, const char *path)
+{
+    if (r == NULL || path == NULL)
+        return ERR_DST_INVALID;
+
+    memset(r, 0, sizeof(*r));
+    r->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (r->fd < 0)
+        return ERR_STREAM_IO;
+
+    struct stat st;
+    if (fstat(r->fd, &st) != 0)
+        goto err_io;
+    if (st.st_size == 0)
+    {
+        close(r->fd);
+        r->fd = -1;
+        return ERR_STREAM_INVALID_HEADER;
+    }
+
+    // Private and writable so that records can be modified in place by the caller.
+    void *data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, r->fd, 0);
+    if (data == MAP_FAILED)
+        goto err_io;
+    r->data = data;
+    r->data_len = st.st_size;
+    madvise(r->data, r->data_len, MADV_SEQUENTIAL);
+
+    long ret = record_reader_check_stream_header(r->data, r->data_len, &r->header);
+    if (ret <= 0)
+    {
+        record_file_reader_close(r);
+        return ret == 0 ? ERR_STREAM_INVALID_HEADER : ret;
+    }
+    r->offset = ret;
+    return 0;
+
+err_io:
+    {
+        int saved_errno = errno;
+        close(r->fd);
+        r->fd = -1;
+        errno = saved_errno;
+    }
+    return ERR_STREAM_IO;
+}
+
+int record_file_reader_next(struct record_file_reader *r, struct elem_common **record, size_t *record_len)
+{
+    if (r == NULL || r->data == NULL || record == NULL || record_len == NULL)
+        return ERR_DST_INVALID;
+
+    size_t len;
+    int ret = get_record(&r->data[r->offset], r->data_len - r->offset, &len);
+    if (ret <= 0)
+        return ret;
+
+    *record = (struct elem_common *)&r->data[r->offset + sizeof(size_t)];
+    *record_len = len;
+    r->offset += sizeof(size_t) + len;
+    return 1;
+}
+
+void record_file_reader_close(struct record_file_reader *r)
+{
+    if (r == NULL)
+        return;
+    if (r->data)
+        munmap(r->data, r->data_len);
+    if (r->fd >= 0)
+        close(r->fd);
+    r->data = NULL;
+    r->data_len = 0;
+    r->offset = 0;
+    r->fd = -1;
+}
\ No newline at end of file
@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/*
+
+    A module to read records from a binary stream (see 'record_serializer_binary')
+    without copying them.
+
+    1. record_reader: Reads from a stream (e.g. a pipe or a socket) into its own buffer
+       and returns records in place. Records split across reads are completed by the
+       following reads.
+    2. record_file_reader: Maps a whole file and returns records in place.
+
+    NOTE: Records are returned as pointers into the buffer/map which are not necessarily
+    aligned for the record structs.
+
+*/
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "common/types.h"
+#include "user/record/serializer/serializer.h"
+
+
+/*
+    Max size (bytes) of a record in a stream. Larger lengths are treated as corruption.
+*/
+#define RECORD_READER_MAX_RECORD_LEN (64 * 1024)
+
+/*
+    Default size (bytes) of the buffer of a record_reader.
+*/
+#define RECORD_READER_DEFAULT_BUF_LEN (1024 * 1024)
+
+
+/*
+    Check the stream header at the start of 'data' against the records known to this build.
+
+    Return:
+        -ive -> The error i.e. ERR_STREAM_INVALID_HEADER or ERR_STREAM_UNSUPPORTED
+        0    -> Not enough data for the header
+        +ive -> The size of the header. The header is copied into 'header' with the
+                members not in its version set to 0
+*/
+long record_reader_check_stream_header(const void *data, size_t data_len, struct record_stream_header *header);
+
+
+struct record_reader
+{
+    unsigned char *buf;
+    size_t buf_len;
+    // Data not yet returned is in [start, end).
+    size_t start;
+    size_t end;
+    // Set once the stream header is read.
+    int header_read;
+    struct record_stream_header header;
+};
+
+/*
+    Initialize the reader with a buffer of 'buf_len' bytes.
+    'buf_len' must be at least the size of the header and RECORD_READER_MAX_RECORD_LEN.
+
+    Return:
+        0  -> Success
+        -1 -> Error
+*/
+int record_reader_init(struct record_reader *r, size_t buf_len);
+
+/*
+    Free the buffer of the reader.
+*/
+void record_reader_free(struct record_reader *r);
+
+/*
+    Get the space to read the next data of the stream into. Records previously returned
+    by 'record_reader_next' are invalid after this.
+
+    Return:
+        0  -> Success
+        -1 -> Error i.e. no space
+*/
+int record_reader_get_space(struct record_reader *r, void **ptr, size_t *len);
+
+/*
+    Mark 'len' bytes written into the space from 'record_reader_get_space' as read.
+*/
+void record_reader_commit(struct record_reader *r, size_t len);
+
+/*
+    Read the next data of the stream from the fd into the reader.
+    Records previously returned by 'record_reader_next' are invalid after this.
+
+    Return:
+        +ive -> The number of bytes read
+        0    -> End of stream
+        -1   -> Error. See errno
+*/
+long record_reader_read_fd(struct record_reader *r, int fd);
+
+/*
+    Get the next complete record read so far. The stream header is checked before the
+    first record.
+
+    Return:
+        1    -> 'record' and 'record_len' are set to the record
+        0    -> No complete record yet. Read more data
+        -ive -> The error. The stream cannot be read any further
+*/
+int record_reader_next(struct record_reader *r, struct elem_common **record, size_t *record_len);
+
+
+struct record_file_reader
+{
+    int fd;
+    unsigned char *data;
+    size_t data_len;
+    size_t offset;
+    struct record_stream_header header;
+};
+
+/*
+    Map the file and check its stream header.
+
+    Return:
+        0    -> Success
+        -ive -> The error i.e. ERR_STREAM_IO (see errno), or see 'record_reader_check_stream_header'
+*/
+int record_file_reader_open(struct record_file_reader *r, const char *path);
+
+/*
+    Get the next record in the file. The records are valid until the reader is closed.
+    An incomplete record at the end (i.e. the file is still being written) is treated
+    as the end.
+
+    Return:
+        1    -> 'record' and 'record_len' are set to the record
+        0    -> No more records
+        -ive -> The error. The file cannot be read any further
+*/
+int record_file_reader_next(struct record_file_reader *r, struct elem_common **record, size_t *record_len);
+
+/*
+    Unmap and close the file.
+*/
+void record_file_reader_close(struct record_file_reader *r);
\ No newline at end of file
@@ -0,0 +1,275 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+
+#include "common/constants.h"
+#include "user/error.h"
+#include "user/record/deserializer/reader.h"
+#include "user/record/deserializer/shm.h"
+
+
+#define ALIGN_UP(n, a) (((n) + (a) - 1) & ~((uint64_t)(a) - 1))
+
+
+/*
+    Receive the memfd of the ring from the writer.
+
+    Return:
+        >=0 -> The memfd
+        -1  -> Error. See errno
+*/
+static int recv_memfd(int fd)
+{
+    char byte;
+    struct iovec iov = { .iov_base = &byte, .iov_len = 1 };
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    ssize_t n;
+    while ((n = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC)) < 0 && errno == EINTR)
+        ;
+    if (n < 0)
+        return -1;
+    // The writer closes the connection if another reader is attached.
+    if (n == 0)
+    {
+        errno = EBUSY;
+        return -1;
+    }
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS ||
+        cmsg->cmsg_len != CMSG_LEN(sizeof(int)))
+    {
+        errno = EPROTO;
+        return -1;
+    }
+
+    int memfd;
+    memcpy(&memfd, CMSG_DATA(cmsg), sizeof(int));
+    return memfd;
+}
+
+static int is_valid_ring(const struct shm_ring_header *ring, size_t map_len)
+{
+    return ring->magic == SHM_RING_MAGIC &&
+        ring->version == SHM_RING_VERSION &&
+        ring->size >= SHM_RING_ALIGN && (ring->size & (ring->size - 1)) == 0 &&
+        ring->data_offset >= sizeof(*ring) && ring->data_offset % SHM_RING_ALIGN == 0 &&
+        ring->data_offset + ring->size <= map_len &&
+        ring->header_len <= sizeof(ring->header);
+}
+
+int record_shm_reader_open(struct record_shm_reader *r, const char *path)
+{
+    if (r == NULL || path == NULL)
+        return ERR_DST_INVALID;
+
+    memset(r, 0, sizeof(*r));
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return ERR_STREAM_IO;
+    }
+    strcpy(addr.sun_path, path);
+
+    r->fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (r->fd < 0)
+        return ERR_STREAM_IO;
+    if (connect(r->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+        goto err_io;
+
+    int memfd = recv_memfd(r->fd);
+    if (memfd < 0)
+        goto err_io;
+
+    struct stat st;
+    if (fstat(memfd, &st) != 0 || (size_t)st.st_size < sizeof(struct shm_ring_header))
+    {
+        int saved_errno = errno;
+        close(memfd);
+        errno = saved_errno;
+        goto err_io;
+    }
+
+    // Writable for the reader's own members of the ring header.
+    void *map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    close(memfd);
+    if (map == MAP_FAILED)
+        goto err_io;
+    r->map = map;
+    r->map_len = st.st_size;
+    r->ring = (struct shm_ring_header *)map;
+
+    if (!is_valid_ring(r->ring, r->map_len))
+    {
+        record_shm_reader_close(r);
+        return ERR_STREAM_INVALID_HEADER;
+    }
+    r->data = r->map + r->ring->data_offset;
+    // Continue after the entries released by a previous reader.
+    r->next = __atomic_load_n(&r->ring->tail, __ATOMIC_ACQUIRE);
+    return 0;
+
+err_io:
+    {
+        int saved_errno = errno;
+        close(r->fd);
+        r->fd = -1;
+        errno = saved_errno;
+    }
+    return ERR_STREAM_IO;
+}
+
+int record_shm_reader_next(struct record_shm_reader *r, void **data, size_t *data_len)
+{
+    if (r == NULL || r->ring == NULL || data == NULL || data_len == NULL)
+        return ERR_DST_INVALID;
+
+    uint64_t size = r->ring->size;
+    uint64_t head = __atomic_load_n(&r->ring->head, __ATOMIC_ACQUIRE);
+
+    while (r->next != head)
+    {
+        if (head - r->next > size)
+            return ERR_RECORD_INVALID;
+
+        uint64_t pos = r->next & (size - 1);
+        struct shm_ring_entry *entry = (struct shm_ring_entry *)&r->data[pos];
+        if (entry->len == SHM_RING_ENTRY_PAD)
+        {
+            r->next += size - pos;
+            continue;
+        }
+        if (entry->len > size - pos - sizeof(*entry))
+            return ERR_RECORD_INVALID;
+
+        *data = entry + 1;
+        *data_len = entry->len;
+        r->next += ALIGN_UP(sizeof(*entry) + entry->len, SHM_RING_ALIGN);
+        return 1;
+    }
+    return 0;
+}
+
+int record_shm_reader_next_record(struct record_shm_reader *r, struct elem_common **record, size_t *record_len)
+{
+    if (r == NULL || r->ring == NULL || record == NULL || record_len == NULL)
+        return ERR_DST_INVALID;
+
+    if (!r->header_read)
+    {
+        long ret = record_reader_check_stream_header(r->ring->header, r->ring->header_len, &r->header);
+        if (ret <= 0)
+            return ret == 0 ? ERR_STREAM_INVALID_HEADER : ret;
+        r->header_read = 1;
+    }
+
+    void *data;
+    size_t data_len;
+    int ret = record_shm_reader_next(r, &data, &data_len);
+    if (ret <= 0)
+        return ret;
+
+    // Every entry is a single length-prefixed record.
+    size_t len;
+    if (data_len < sizeof(size_t))
+        return ERR_RECORD_INVALID;
+    memcpy(&len, data, sizeof(size_t));
+    if (len != data_len - sizeof(size_t))
+        return ERR_RECORD_SIZE_MISMATCH;
+    if (len < sizeof(struct elem_common))
+        return ERR_RECORD_INVALID;
+
+    unsigned char *rec = (unsigned char *)data + sizeof(size_t);
+    magic_t magic;
+    memcpy(&magic, rec, sizeof(magic));
+    if (magic != AMEBA_MAGIC)
+        return ERR_RECORD_INVALID_MAGIC;
+
+    *record = (struct elem_common *)rec;
+    *record_len = len;
+    return 1;
+}
+
+void record_shm_reader_release(struct record_shm_reader *r)
+{
+    if (r == NULL || r->ring == NULL)
+        return;
+    __atomic_store_n(&r->ring->tail, r->next, __ATOMIC_RELEASE);
+}
+
+int record_shm_reader_wait(struct record_shm_reader *r, long timeout_ms)
+{
+    if (r == NULL || r->ring == NULL)
+        return ERR_DST_INVALID;
+
+    struct shm_ring_header *ring = r->ring;
+    uint32_t seq = __atomic_load_n(&ring->wake_seq, __ATOMIC_SEQ_CST);
+
+    // Announce the wait before checking 'head', which the writer publishes before checking 'reader_waiting'.
+    __atomic_store_n(&ring->reader_waiting, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) == r->next &&
+        !__atomic_load_n(&ring->closed, __ATOMIC_SEQ_CST))
+    {
+        struct timespec timeout = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000 };
+        syscall(SYS_futex, &ring->wake_seq, FUTEX_WAIT, seq, timeout_ms < 0 ? NULL : &timeout, NULL, 0);
+    }
+    __atomic_store_n(&ring->reader_waiting, 0, __ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) != r->next)
+        return 1;
+    return __atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE) ? ERR_STREAM_CLOSED : 0;
+}
+
+void record_shm_reader_close(struct record_shm_reader *r)
+{
+    if (r == NULL)
+        return;
+    if (r->map != NULL)
+        munmap(r->map, r->map_len);
+    if (r->fd >= 0)
+        close(r->fd);
+    r->map = NULL;
+    r->ring = NULL;
+    r->data = NULL;
+    r->fd = -1;
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/*
+
+    A module to read records from the shared-memory ring of 'record_writer_shm'
+    in place, i.e. without copying them.
+
+    The reader attaches to the writer through its unix socket, maps the ring,
+    and returns its entries as pointers into the map. Entries stay valid until
+    they are released, which hands their space back to the writer, so a
+    reader should release once it is done with a batch of entries.
+
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/types.h"
+#include "user/record/writer/shm.h"
+
+
+struct record_shm_reader
+{
+    // The connection to the writer. The reader stays attached while it is open.
+    int fd;
+    unsigned char *map;
+    size_t map_len;
+    struct shm_ring_header *ring;
+    unsigned char *data;
+    // Position of the next entry. Entries before it are released by 'record_shm_reader_release'.
+    uint64_t next;
+    // Set once the stream header is checked by 'record_shm_reader_next_record'.
+    int header_read;
+    struct record_stream_header header;
+};
+
+/*
+    Attach to the writer listening at 'path' and map its ring.
+
+    Return:
+        0    -> Success
+        -ive -> The error i.e. ERR_STREAM_IO (see errno, EBUSY if another reader is
+                attached), or ERR_STREAM_INVALID_HEADER if the ring is not valid
+*/
+int record_shm_reader_open(struct record_shm_reader *r, const char *path);
+
+/*
+    Get the next entry of the ring, as written by the writer.
+
+    Return:
+        1    -> 'data' and 'data_len' are set to the entry
+        0    -> No entry yet. See 'record_shm_reader_wait'
+        -ive -> The error i.e. ERR_RECORD_INVALID. The ring cannot be read any further
+*/
+int record_shm_reader_next(struct record_shm_reader *r, void **data, size_t *data_len);
+
+/*
+    Get the next record of the ring written by 'record_serializer_binary'. The stream
+    header is checked before the first record.
+
+    Return:
+        1    -> 'record' and 'record_len' are set to the record
+        0    -> No record yet. See 'record_shm_reader_wait'
+        -ive -> The error. The ring cannot be read any further
+*/
+int record_shm_reader_next_record(struct record_shm_reader *r, struct elem_common **record, size_t *record_len);
+
+/*
+    Release the entries returned so far to the writer. They are invalid after this.
+*/
+void record_shm_reader_release(struct record_shm_reader *r);
+
+/*
+    Wait up to 'timeout_ms' (-1 for no limit) for entries.
+
+    Return:
+        1                 -> Entries are available
+        0                 -> Timed out
+        ERR_STREAM_CLOSED -> The writer is closed and all its entries are read
+*/
+int record_shm_reader_wait(struct record_shm_reader *r, long timeout_ms);
+
+/*
+    Detach from the writer and unmap the ring. Entries not released are kept
+    for the next reader.
+*/
+void record_shm_reader_close(struct record_shm_reader *r);
\ No newline at end of file
@@ -50,6 +50,22 @@ static long record_serializer_binary_serialize(void *dst, size_t dst_len, struct
 }
 
 
+static long record_serializer_binary_serialize_header(void *dst, size_t dst_len)
+{
+    if (dst == NULL)
+        return ERR_DST_INVALID;
+
+    struct record_stream_header header;
+    if (sizeof(header) > dst_len)
+        return ERR_DST_INSUFFICIENT;
+
+    record_serializer_init_stream_header(&header);
+    memcpy(dst, &header, sizeof(header));
+    return sizeof(header);
+}
+
+
 const struct record_serializer record_serializer_binary = {
-    .serialize = record_serializer_binary_serialize
+    .serialize = record_serializer_binary_serialize,
+    .serialize_header = record_serializer_binary_serialize_header
 };
\ No newline at end of file
@@ -0,0 +1,291 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include "user/error.h"
+#include "user/jsonify/fields.h"
+#include "user/record/serializer/serializer.h"
+
+
+/*
+    CBOR (RFC 8949) major types.
+*/
+#define CBOR_MAJOR_UINT 0
+#define CBOR_MAJOR_NEGINT 1
+#define CBOR_MAJOR_BYTES 2
+#define CBOR_MAJOR_TEXT 3
+#define CBOR_MAJOR_ARRAY 4
+#define CBOR_MAJOR_MAP 5
+#define CBOR_MAJOR_TAG 6
+#define CBOR_MAJOR_SIMPLE 7
+
+#define CBOR_SIMPLE_FALSE 20
+#define CBOR_SIMPLE_TRUE 21
+
+#define CBOR_TAG_SELF_DESCRIBED 55799
+
+
+struct cbor_buffer
+{
+    unsigned char *p;
+    unsigned char *end;
+    int overflown;
+};
+
+
+/*
+    Size (bytes) of the head of a data item with the argument 'val'.
+*/
+static int cbor_head_len(unsigned long long val)
+{
+    if (val < 24)
+        return 1;
+    if (val <= 0xff)
+        return 2;
+    if (val <= 0xffff)
+        return 3;
+    if (val <= 0xffffffffULL)
+        return 5;
+    return 9;
+}
+
+static void cbor_put_head(struct cbor_buffer *b, unsigned char major, unsigned long long val)
+{
+    if (b->end - b->p < cbor_head_len(val))
+    {
+        b->overflown = 1;
+        return;
+    }
+
+    unsigned char *p = b->p;
+    major <<= 5;
+    if (val < 24)
+    {
+        *p++ = major | val;
+    } else if (val <= 0xff)
+    {
+        *p++ = major | 24;
+        *p++ = val;
+    } else if (val <= 0xffff)
+    {
+        *p++ = major | 25;
+        *p++ = val >> 8;
+        *p++ = val;
+    } else if (val <= 0xffffffffULL)
+    {
+        *p++ = major | 26;
+        for (int shift = 24; shift >= 0; shift -= 8)
+            *p++ = val >> shift;
+    } else {
+        *p++ = major | 27;
+        for (int shift = 56; shift >= 0; shift -= 8)
+            *p++ = val >> shift;
+    }
+    b->p = p;
+}
+
+static void cbor_put_uint(struct cbor_buffer *b, unsigned long long val)
+{
+    cbor_put_head(b, CBOR_MAJOR_UINT, val);
+}
+
+static void cbor_put_int(struct cbor_buffer *b, long long val)
+{
+    if (val < 0)
+        cbor_put_head(b, CBOR_MAJOR_NEGINT, (unsigned long long)(-(val + 1)));
+    else
+        cbor_put_head(b, CBOR_MAJOR_UINT, val);
+}
+
+static void cbor_put_data(struct cbor_buffer *b, unsigned char major, const void *data, size_t len)
+{
+    cbor_put_head(b, major, len);
+    if (b->overflown || (size_t)(b->end - b->p) < len)
+    {
+        b->overflown = 1;
+        return;
+    }
+    memcpy(b->p, data, len);
+    b->p += len;
+}
+
+static void cbor_put_text(struct cbor_buffer *b, const char *s)
+{
+    cbor_put_data(b, CBOR_MAJOR_TEXT, s, strlen(s));
+}
+
+
+static void cbor_put_field(struct cbor_buffer *b, const struct jsonify_field *f, const char *record)
+{
+    const void *val = record + f->offset;
+
+    switch (f->type)
+    {
+        case JSONIFY_FIELD_INT:
+            cbor_put_int(b, *(const int *)val);
+            break;
+        case JSONIFY_FIELD_UINT:
+            cbor_put_uint(b, *(const unsigned int *)val);
+            break;
+        case JSONIFY_FIELD_SHORT:
+            cbor_put_int(b, *(const short *)val);
+            break;
+        case JSONIFY_FIELD_LONG:
+            cbor_put_int(b, *(const long *)val);
+            break;
+        case JSONIFY_FIELD_STR:
+            cbor_put_data(b, CBOR_MAJOR_TEXT, val, strnlen((const char *)val, f->size));
+            break;
+        case JSONIFY_FIELD_SYS_ID:
+            cbor_put_int(b, *(const sys_id_t *)val);
+            break;
+        case JSONIFY_FIELD_SOCKADDR:
+        {
+            unsigned char addr[SOCKADDR_MAX_SIZE];
+            size_t len = record_serializer_copy_sockaddr_network(addr, (const struct elem_sockaddr *)val);
+            cbor_put_data(b, CBOR_MAJOR_BYTES, addr, len);
+            break;
+        }
+        case JSONIFY_FIELD_LAS_TIMESTAMP:
+        {
+            const struct elem_las_timestamp *ts = val;
+            cbor_put_head(b, CBOR_MAJOR_ARRAY, 3);
+            cbor_put_uint(b, ts->event_id);
+            cbor_put_int(b, ts->tv_sec);
+            cbor_put_int(b, ts->tv_nsec);
+            break;
+        }
+        default:
+            // Keep the array length in line with the schema.
+            cbor_put_head(b, CBOR_MAJOR_SIMPLE, CBOR_SIMPLE_FALSE);
+            break;
+    }
+}
+
+static long record_serializer_cbor_serialize(void *dst, size_t dst_len, struct elem_common *record, size_t record_len)
+{
+    int err = record_serializer_common(dst, dst_len, record, record_len);
+    if (err != 0)
+        return err;
+
+    union record_expanded expanded;
+    long expanded_len = record_serializer_expand_compact(&expanded, record, record_len);
+    if (expanded_len < 0)
+        return expanded_len;
+    if (expanded_len > 0)
+    {
+        record = &(expanded.e_common);
+        record_len = expanded_len;
+    }
+
+    const struct jsonify_fields *fields = jsonify_fields_get(record->record_type);
+    if (!fields)
+        return ERR_RECORD_UNKNOWN;
+    if (record_len != fields->record_size)
+        return ERR_RECORD_SIZE_MISMATCH;
+
+    const char *r = (const char *)record;
+    const struct elem_timestamp *e_ts = (const struct elem_timestamp *)(r + fields->ts_offset);
+
+    struct cbor_buffer b = {
+        .p = dst,
+        .end = (unsigned char *)dst + dst_len,
+        .overflown = 0
+    };
+
+#ifdef INCLUDE_TASK_CTX_ID
+    const int common_len = 4;
+#else
+    const int common_len = 3;
+#endif
+    cbor_put_head(&b, CBOR_MAJOR_ARRAY, common_len + fields->fields_len);
+    cbor_put_uint(&b, record->record_type);
+    cbor_put_head(&b, CBOR_MAJOR_ARRAY, 3);
+    cbor_put_uint(&b, record->version.major);
+    cbor_put_uint(&b, record->version.minor);
+    cbor_put_uint(&b, record->version.patch);
+    cbor_put_uint(&b, e_ts->event_id);
+#ifdef INCLUDE_TASK_CTX_ID
+    cbor_put_uint(&b, record->task_ctx_id);
+#endif
+    for (int i = 0; i < fields->fields_len; i++)
+        cbor_put_field(&b, &fields->fields[i], r);
+
+    if (b.overflown)
+        return ERR_DST_INSUFFICIENT;
+    return b.p - (unsigned char *)dst;
+}
+
+
+static long record_serializer_cbor_serialize_header(void *dst, size_t dst_len)
+{
+    if (dst == NULL)
+        return ERR_DST_INVALID;
+
+    struct cbor_buffer b = {
+        .p = dst,
+        .end = (unsigned char *)dst + dst_len,
+        .overflown = 0
+    };
+
+    int record_types = 0;
+    for (int t = 0; t < RECORD_STREAM_MAX_RECORD_TYPES; t++)
+    {
+        if (jsonify_fields_get(t))
+            record_types++;
+    }
+
+    cbor_put_head(&b, CBOR_MAJOR_TAG, CBOR_TAG_SELF_DESCRIBED);
+    cbor_put_head(&b, CBOR_MAJOR_MAP, 4);
+    cbor_put_text(&b, "magic");
+    cbor_put_uint(&b, AMEBA_MAGIC);
+    cbor_put_text(&b, "version");
+    cbor_put_uint(&b, RECORD_CBOR_SCHEMA_VERSION);
+    cbor_put_text(&b, "task_ctx_id");
+#ifdef INCLUDE_TASK_CTX_ID
+    cbor_put_head(&b, CBOR_MAJOR_SIMPLE, CBOR_SIMPLE_TRUE);
+#else
+    cbor_put_head(&b, CBOR_MAJOR_SIMPLE, CBOR_SIMPLE_FALSE);
+#endif
+    cbor_put_text(&b, "records");
+    cbor_put_head(&b, CBOR_MAJOR_MAP, record_types);
+    for (int t = 0; t < RECORD_STREAM_MAX_RECORD_TYPES; t++)
+    {
+        const struct jsonify_fields *fields = jsonify_fields_get(t);
+        if (!fields)
+            continue;
+        cbor_put_uint(&b, t);
+        cbor_put_head(&b, CBOR_MAJOR_ARRAY, 2);
+        cbor_put_text(&b, fields->name);
+        cbor_put_head(&b, CBOR_MAJOR_ARRAY, fields->fields_len);
+        for (int i = 0; i < fields->fields_len; i++)
+            cbor_put_text(&b, fields->fields[i].key);
+    }
+
+    if (b.overflown)
+        return ERR_DST_INSUFFICIENT;
+    return b.p - (unsigned char *)dst;
+}
+
+
+const struct record_serializer record_serializer_cbor = {
+    .serialize = record_serializer_cbor_serialize,
+    .serialize_header = record_serializer_cbor_serialize_header
+};
\ No newline at end of file
@@ -29,6 +29,16 @@ static long record_serializer_json_serialize(void *dst, size_t dst_len, struct e
     if (err != 0)
         return err;
 
+    union record_expanded expanded;
+    long expanded_len = record_serializer_expand_compact(&expanded, record, record_len);
+    if (expanded_len < 0)
+        return expanded_len;
+    if (expanded_len > 0)
+    {
+        record = &(expanded.e_common);
+        record_len = expanded_len;
+    }
+
     int write_interpreted = 0;
 
     struct json_buffer s;
@@ -56,5 +66,6 @@ static long record_serializer_json_serialize(void *dst, size_t dst_len, struct e
 
 
 const struct record_serializer record_serializer_json = {
-    .serialize = record_serializer_json_serialize
+    .serialize = record_serializer_json_serialize,
+    .serialize_header = NULL
 };
\ No newline at end of file
@@ -18,13 +18,37 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
 #include <stddef.h>
+#include <string.h>
 #include <sys/types.h>
+#include <netinet/in.h>
+#include <linux/audit.h>
 
 #include "user/error.h"
 #include "common/types.h"
 #include "user/record/serializer/serializer.h"
 
 
+/*
+    AUDIT_ARCH_* of this build. 0 if not known.
+*/
+#if defined(__x86_64__)
+#define RECORD_STREAM_AUDIT_ARCH AUDIT_ARCH_X86_64
+#elif defined(__aarch64__)
+#define RECORD_STREAM_AUDIT_ARCH AUDIT_ARCH_AARCH64
+#elif defined(__i386__)
+#define RECORD_STREAM_AUDIT_ARCH AUDIT_ARCH_I386
+#elif defined(__arm__)
+#define RECORD_STREAM_AUDIT_ARCH AUDIT_ARCH_ARM
+#elif defined(__riscv) && __riscv_xlen == 64
+#define RECORD_STREAM_AUDIT_ARCH AUDIT_ARCH_RISCV64
+#elif defined(__powerpc64__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define RECORD_STREAM_AUDIT_ARCH AUDIT_ARCH_PPC64LE
+#elif defined(__s390x__)
+#define RECORD_STREAM_AUDIT_ARCH AUDIT_ARCH_S390X
+#else
+#define RECORD_STREAM_AUDIT_ARCH 0
+#endif
+
 long record_serializer_common(void *dst, size_t dst_len, struct elem_common *record, size_t record_len)
 {
     if (dst == NULL)
@@ -43,4 +67,175 @@ long record_serializer_common(void *dst, size_t dst_len, struct elem_common *rec
         return ERR_RECORD_INVALID_MAGIC;
 
     return 0;
+}
+
+int record_serializer_is_compact(struct elem_common *record)
+{
+    if (record->version.major < RECORD_VERSION_MAJOR_COMPACT_SOCKADDR)
+        return 0;
+    switch (record->record_type)
+    {
+        case RECORD_TYPE_CONNECT:
+        case RECORD_TYPE_ACCEPT:
+        case RECORD_TYPE_SEND_RECV:
+        case RECORD_TYPE_BIND:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/*
+    Read a compact sockaddr at '*offset' in 'src' into 'dst' and move '*offset' past it.
+
+    Return:
+        -ive -> The error
+        0    -> No error
+*/
+static long expand_compact_sockaddr(struct elem_sockaddr *dst, const unsigned char *src, size_t src_len, size_t *offset)
+{
+    struct elem_sockaddr_compact header;
+    if (*offset + sizeof(header) > src_len)
+        return ERR_RECORD_SIZE_MISMATCH;
+    memcpy(&header, &src[*offset], sizeof(header));
+    *offset += sizeof(header);
+
+    if (header.addrlen > SOCKADDR_MAX_SIZE || *offset + header.addrlen > src_len)
+        return ERR_RECORD_SIZE_MISMATCH;
+
+    memset(dst, 0, sizeof(*dst));
+    memcpy(&(dst->addr[0]), &src[*offset], header.addrlen);
+    dst->addrlen = header.addrlen;
+    dst->byte_order = header.byte_order;
+    *offset += header.addrlen;
+    return 0;
+}
+
+size_t record_serializer_copy_sockaddr_network(unsigned char *dst, const struct elem_sockaddr *src)
+{
+    size_t len = src->addrlen < SOCKADDR_MAX_SIZE ? src->addrlen : SOCKADDR_MAX_SIZE;
+    memcpy(dst, &(src->addr[0]), len);
+    if (src->byte_order != BYTE_ORDER_HOST || len < sizeof(sa_family_t))
+        return len;
+
+    // Only the port of a local address is in host byte order.
+    sa_family_t family;
+    memcpy(&family, dst, sizeof(family));
+    size_t port_offset;
+    if (family == AF_INET && len >= sizeof(struct sockaddr_in))
+        port_offset = offsetof(struct sockaddr_in, sin_port);
+    else if (family == AF_INET6 && len >= sizeof(struct sockaddr_in6))
+        port_offset = offsetof(struct sockaddr_in6, sin6_port);
+    else
+        return len;
+
+    in_port_t port;
+    memcpy(&port, dst + port_offset, sizeof(port));
+    port = htons(port);
+    memcpy(dst + port_offset, &port, sizeof(port));
+    return len;
+}
+
+long record_serializer_expand_compact(union record_expanded *dst, struct elem_common *record, size_t record_len)
+{
+    if (!record_serializer_is_compact(record))
+        return 0;
+
+    size_t prefix_size;
+    size_t record_size;
+    struct elem_sockaddr *local;
+    struct elem_sockaddr *remote;
+    switch (record->record_type)
+    {
+        case RECORD_TYPE_CONNECT:
+            prefix_size = RECORD_COMPACT_PREFIX_SIZE_CONNECT;
+            record_size = RECORD_SIZE_CONNECT;
+            local = &(dst->connect.local);
+            remote = &(dst->connect.remote);
+            break;
+        case RECORD_TYPE_ACCEPT:
+            prefix_size = RECORD_COMPACT_PREFIX_SIZE_ACCEPT;
+            record_size = RECORD_SIZE_ACCEPT;
+            local = &(dst->accept.local);
+            remote = &(dst->accept.remote);
+            break;
+        case RECORD_TYPE_SEND_RECV:
+            prefix_size = RECORD_COMPACT_PREFIX_SIZE_SEND_RECV;
+            record_size = RECORD_SIZE_SEND_RECV;
+            local = &(dst->send_recv.local);
+            remote = &(dst->send_recv.remote);
+            break;
+        case RECORD_TYPE_BIND:
+            prefix_size = RECORD_COMPACT_PREFIX_SIZE_BIND;
+            record_size = RECORD_SIZE_BIND;
+            local = &(dst->bind.local);
+            remote = NULL;
+            break;
+        default:
+            return 0;
+    }
+
+    if (record_len < prefix_size)
+        return ERR_RECORD_SIZE_MISMATCH;
+
+    const unsigned char *src = (const unsigned char *)record;
+    memcpy(dst, src, prefix_size);
+
+    size_t offset = prefix_size;
+    long err = expand_compact_sockaddr(local, src, record_len, &offset);
+    if (err != 0)
+        return err;
+    if (remote)
+    {
+        err = expand_compact_sockaddr(remote, src, record_len, &offset);
+        if (err != 0)
+            return err;
+    }
+    if (offset != record_len)
+        return ERR_RECORD_SIZE_MISMATCH;
+
+    return record_size;
+}
+
+_Static_assert(
+    RECORD_TYPE_AUDIT_LOG_EXIT < RECORD_STREAM_MAX_RECORD_TYPES,
+    "RECORD_STREAM_MAX_RECORD_TYPES must be greater than the max record_type_t"
+);
+
+void record_serializer_init_stream_header(struct record_stream_header *header)
+{
+    memset(header, 0, sizeof(*header));
+    header->magic = AMEBA_MAGIC;
+    header->header_version = RECORD_STREAM_HEADER_VERSION;
+    header->header_size = sizeof(*header);
+    header->record_version.major = RECORD_VERSION_MAJOR;
+    header->record_version.minor = RECORD_VERSION_MINOR;
+    header->record_version.patch = RECORD_VERSION_PATCH;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    header->endianness = RECORD_STREAM_ENDIANNESS_BIG;
+#else
+    header->endianness = RECORD_STREAM_ENDIANNESS_LITTLE;
+#endif
+    header->length_size = sizeof(size_t);
+#ifdef INCLUDE_TASK_CTX_ID
+    header->has_task_ctx_id = 1;
+#endif
+    header->record_types = RECORD_STREAM_MAX_RECORD_TYPES;
+
+    header->record_sizes[RECORD_TYPE_NEW_PROCESS] = RECORD_SIZE_NEW_PROCESS;
+    header->record_sizes[RECORD_TYPE_CRED] = RECORD_SIZE_CRED;
+    header->record_sizes[RECORD_TYPE_NAMESPACE] = RECORD_SIZE_NAMESPACE;
+    header->record_sizes[RECORD_TYPE_CONNECT] = RECORD_SIZE_CONNECT;
+    header->record_sizes[RECORD_TYPE_ACCEPT] = RECORD_SIZE_ACCEPT;
+    header->record_sizes[RECORD_TYPE_SEND_RECV] = RECORD_SIZE_SEND_RECV;
+    header->record_sizes[RECORD_TYPE_BIND] = RECORD_SIZE_BIND;
+    header->record_sizes[RECORD_TYPE_KILL] = RECORD_SIZE_KILL;
+    header->record_sizes[RECORD_TYPE_AUDIT_LOG_EXIT] = RECORD_SIZE_AUDIT_LOG_EXIT;
+
+    header->record_compact_prefix_sizes[RECORD_TYPE_CONNECT] = RECORD_COMPACT_PREFIX_SIZE_CONNECT;
+    header->record_compact_prefix_sizes[RECORD_TYPE_ACCEPT] = RECORD_COMPACT_PREFIX_SIZE_ACCEPT;
+    header->record_compact_prefix_sizes[RECORD_TYPE_SEND_RECV] = RECORD_COMPACT_PREFIX_SIZE_SEND_RECV;
+    header->record_compact_prefix_sizes[RECORD_TYPE_BIND] = RECORD_COMPACT_PREFIX_SIZE_BIND;
+
+    header->audit_arch = RECORD_STREAM_AUDIT_ARCH;
 }
\ No newline at end of file
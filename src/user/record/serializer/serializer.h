@@ -47,6 +47,129 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 long record_serializer_common(void *dst, size_t dst_len, struct elem_common *record, size_t record_len);
 
+/*
+    A union of the record structs that can be in compact form.
+    See 'record_compact_prefix_size_t'.
+*/
+union record_expanded {
+    struct elem_common e_common;
+    struct record_connect connect;
+    struct record_accept accept;
+    struct record_send_recv send_recv;
+    struct record_bind bind;
+};
+
+/*
+    Check if the record is in compact form i.e. a record with sockaddrs and
+    version major at least RECORD_VERSION_MAJOR_COMPACT_SOCKADDR.
+
+    Return:
+        1 -> Compact
+        0 -> Not compact
+*/
+int record_serializer_is_compact(struct elem_common *record);
+
+/*
+    Expand the record in compact form to its record struct in 'dst'.
+    Must have passed 'record_serializer_common'.
+
+    Return:
+        -ive -> The error
+        0    -> Not compact. Nothing written to 'dst'
+        +ive -> The size of the record struct written to 'dst'
+*/
+long record_serializer_expand_compact(union record_expanded *dst, struct elem_common *record, size_t record_len);
+
+/*
+    Copy the sockaddr to 'dst' (SOCKADDR_MAX_SIZE bytes) with its port in network
+    byte order whatever its 'byte_order', so that it can be read without it.
+
+    Return:
+        The length (bytes) of the sockaddr copied
+*/
+size_t record_serializer_copy_sockaddr_network(unsigned char *dst, const struct elem_sockaddr *src);
+
+
+/*
+    Version of 'struct record_stream_header'. Incremented on any change to it.
+*/
+#define RECORD_STREAM_HEADER_VERSION 2
+
+/*
+    Entries in 'record_stream_header.record_sizes'. Must be greater than the max record_type_t.
+*/
+#define RECORD_STREAM_MAX_RECORD_TYPES 16
+
+typedef enum {
+    RECORD_STREAM_ENDIANNESS_LITTLE = 1,
+    RECORD_STREAM_ENDIANNESS_BIG
+} record_stream_endianness_t;
+
+/*
+    Written once at the start of a binary stream so that a reader can check that it
+    can read the records that follow.
+
+    All members are in the endianness given by 'endianness', except 'endianness' itself
+    which is a single byte.
+*/
+struct record_stream_header
+{
+    // AMEBA_MAGIC
+    magic_t magic;
+    // RECORD_STREAM_HEADER_VERSION
+    unsigned short header_version;
+    // sizeof(struct record_stream_header)
+    unsigned short header_size;
+    // The version of the records that follow.
+    struct elem_version record_version;
+    // record_stream_endianness_t
+    unsigned char endianness;
+    // Size (bytes) of the length before each record.
+    unsigned char length_size;
+    // 1 if 'elem_common' has 'task_ctx_id', otherwise 0.
+    unsigned char has_task_ctx_id;
+    // Entries used in 'record_sizes' and 'record_compact_prefix_sizes'.
+    unsigned short record_types;
+    // Size of the record struct. Index is record_type_t. 0 if no such record type.
+    unsigned int record_sizes[RECORD_STREAM_MAX_RECORD_TYPES];
+    // See 'record_compact_prefix_size_t'. Index is record_type_t. 0 if never compact.
+    unsigned int record_compact_prefix_sizes[RECORD_STREAM_MAX_RECORD_TYPES];
+    /*
+        AUDIT_ARCH_* of the writer i.e. the table of the syscall numbers in the records.
+        0 if unknown (i.e. header version 1).
+    */
+    unsigned int audit_arch;
+};
+
+/*
+    Fill the header with the values of this build.
+*/
+void record_serializer_init_stream_header(struct record_stream_header *header);
+
+/*
+    Max size (bytes) of the header written by 'serialize_header' of any serializer.
+*/
+#define RECORD_SERIALIZER_MAX_HEADER_LEN 4096
+
+/*
+    Version of the CBOR schema written by 'record_serializer_cbor'. Incremented on any
+    change to the layout below.
+
+    The stream is a CBOR sequence (RFC 8742) of:
+        1. The schema: tag 55799 (self-described CBOR) and a map of
+               "magic"       -> AMEBA_MAGIC
+               "version"     -> RECORD_CBOR_SCHEMA_VERSION
+               "task_ctx_id" -> true if records have 'task_ctx_id'
+               "records"     -> map of record_type -> [record name, [field keys]]
+        2. An array per record of
+               record_type, [major, minor, patch], event_id, [task_ctx_id,] fields...
+           The fields are in the order of the field keys in the schema. A sockaddr is a
+           byte string of the sockaddr with its port in network byte order (see
+           'record_serializer_copy_sockaddr_network'), a string is a text string, and
+           'las_audit' is an array of [event_id, tv_sec, tv_nsec]. All other fields
+           are integers.
+*/
+#define RECORD_CBOR_SCHEMA_VERSION 2
 
 struct record_serializer {
 
@@ -62,4 +185,16 @@ struct record_serializer {
     */
     long (*serialize)(void *dst, size_t dst_len, struct elem_common *record, size_t record_len);
 
+    /*
+        Serialize the header to write once before all records.
+        NULL if the format has no header.
+
+        Return:
+            +ive -> The actual size of 'dst'
+            -ive -> Error
+            0    -> Undefined
+
+    */
+    long (*serialize_header)(void *dst, size_t dst_len);
+
 };
\ No newline at end of file
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "user/record/writer/buffer.h"
+
+
+static long elapsed_ms(struct timespec *since)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - since->tv_sec) * 1000 + (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+int write_buffer_init(struct write_buffer *b, size_t size, long flush_interval_ms)
+{
+    if (!b || size == 0)
+        return -1;
+
+    size_t aligned_size = (size + WRITE_BUFFER_ALIGNMENT - 1) & ~((size_t)WRITE_BUFFER_ALIGNMENT - 1);
+
+    void *buf = NULL;
+    if (posix_memalign(&buf, WRITE_BUFFER_ALIGNMENT, aligned_size) != 0)
+        return -1;
+
+    b->buf = (char *)buf;
+    b->size = aligned_size;
+    b->len = 0;
+    b->flush_interval_ms = flush_interval_ms;
+    memset(&b->first_append, 0, sizeof(b->first_append));
+    return 0;
+}
+
+void write_buffer_free(struct write_buffer *b)
+{
+    if (!b)
+        return;
+    free(b->buf);
+    b->buf = NULL;
+    b->size = 0;
+    b->len = 0;
+}
+
+int write_buffer_append(struct write_buffer *b, const void *data, size_t data_len)
+{
+    if (data_len > b->size - b->len)
+        return -1;
+
+    if (b->len == 0)
+        clock_gettime(CLOCK_MONOTONIC, &b->first_append);
+
+    memcpy(&b->buf[b->len], data, data_len);
+    b->len += data_len;
+    return 0;
+}
+
+int write_buffer_is_flush_due(struct write_buffer *b)
+{
+    if (b->len == 0 || b->flush_interval_ms <= 0)
+        return 0;
+    return elapsed_ms(&b->first_append) >= b->flush_interval_ms;
+}
+
+void write_buffer_reset(struct write_buffer *b)
+{
+    b->len = 0;
+}
+
+void write_buffer_consume(struct write_buffer *b, size_t len)
+{
+    if (len >= b->len)
+    {
+        b->len = 0;
+        return;
+    }
+    memmove(b->buf, &b->buf[len], b->len - len);
+    b->len -= len;
+}
\ No newline at end of file
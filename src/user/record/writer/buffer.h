@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/*
+
+    A module to coalesce serialized records into a large buffer before
+    handing them over to the underlying output.
+
+*/
+
+#include <stddef.h>
+#include <time.h>
+
+
+/*
+    Alignment of the memory allocated for write_buffer.
+*/
+#define WRITE_BUFFER_ALIGNMENT 4096
+
+
+/*
+    A struct to hold the state of a write buffer.
+
+    API usage:
+        1. write_buffer_init
+        2. write_buffer_append until it fails, or write_buffer_is_flush_due
+        3. Write write_buffer.buf[0:write_buffer.len] to the output
+        4. write_buffer_reset (or write_buffer_consume the part written) and continue from 2
+        5. write_buffer_free
+*/
+struct write_buffer
+{
+    char *buf;
+    size_t size;
+    size_t len;
+    long flush_interval_ms;
+    struct timespec first_append;
+};
+
+
+/*
+    Initialize the write buffer.
+
+    'size' is rounded up to a multiple of WRITE_BUFFER_ALIGNMENT.
+    'flush_interval_ms' is the max age of buffered data. Age is ignored if <= 0.
+
+    Return:
+        0    => Success
+        -ive => Failure
+*/
+int write_buffer_init(struct write_buffer *b, size_t size, long flush_interval_ms);
+
+/*
+    Free the memory allocated by write_buffer_init.
+*/
+void write_buffer_free(struct write_buffer *b);
+
+/*
+    Append data to the write buffer.
+
+    Return:
+        0    => Success
+        -1   => Not enough space. Nothing appended.
+*/
+int write_buffer_append(struct write_buffer *b, const void *data, size_t data_len);
+
+/*
+    Check if the buffered data must be flushed because of its age.
+
+    Return:
+        1 => Yes
+        0 => No
+*/
+int write_buffer_is_flush_due(struct write_buffer *b);
+
+/*
+    Mark the write buffer as empty.
+*/
+void write_buffer_reset(struct write_buffer *b);
+
+/*
+    Remove the first 'len' bytes of the buffered data e.g. the part written
+    before the output failed. The rest moves to the start of the buffer and
+    keeps its age.
+*/
+void write_buffer_consume(struct write_buffer *b, size_t len);
\ No newline at end of file
@@ -0,0 +1,611 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "user/record/writer/columnar.h"
+#include "user/record/serializer/serializer.h"
+#include "user/jsonify/fields.h"
+
+
+struct columnar_column
+{
+    columnar_type_t type;
+    unsigned short width;
+    // Offset and size of the value in the record struct.
+    unsigned short src_offset;
+    unsigned short src_size;
+    // Max size of a value of a variable width type.
+    unsigned short max_size;
+    char name[COLUMNAR_NAME_LEN];
+    // Buffered values.
+    unsigned char *data;
+    size_t data_len;
+    // Offsets of the buffered values of a variable width type.
+    unsigned int *offsets;
+};
+
+struct columnar_batch
+{
+    const struct jsonify_fields *fields;
+    unsigned int rows;
+    struct timespec first_row;
+    int columns_len;
+    struct columnar_column columns[COLUMNAR_MAX_COLUMNS];
+};
+
+static struct {
+    int initialized;
+    struct columnar_writer_args init_args;
+    struct columnar_batch batches[RECORD_STREAM_MAX_RECORD_TYPES];
+    // Buffer to encode a batch into.
+    unsigned char *out;
+    size_t out_size;
+} state = {0};
+
+
+#define PAD8(len) (((len) + 7) & ~((size_t)7))
+
+
+static int columnar_is_variable_width(columnar_type_t type)
+{
+    return type == COLUMNAR_TYPE_STRING || type == COLUMNAR_TYPE_BINARY;
+}
+
+static struct columnar_column *add_column(
+    struct columnar_batch *b, const char *name, columnar_type_t type, size_t src_offset, size_t src_size
+)
+{
+    if (b->columns_len >= COLUMNAR_MAX_COLUMNS)
+        return NULL;
+
+    struct columnar_column *c = &b->columns[b->columns_len++];
+    memset(c, 0, sizeof(*c));
+    c->type = type;
+    c->src_offset = src_offset;
+    c->src_size = src_size;
+    switch (type)
+    {
+        case COLUMNAR_TYPE_INT16:
+            c->width = 2;
+            break;
+        case COLUMNAR_TYPE_INT32:
+        case COLUMNAR_TYPE_UINT32:
+            c->width = 4;
+            break;
+        case COLUMNAR_TYPE_INT64:
+        case COLUMNAR_TYPE_UINT64:
+            c->width = 8;
+            break;
+        case COLUMNAR_TYPE_STRING:
+            c->max_size = src_size;
+            break;
+        case COLUMNAR_TYPE_BINARY:
+            c->max_size = SOCKADDR_MAX_SIZE;
+            break;
+    }
+    snprintf(c->name, sizeof(c->name), "%s", name);
+    return c;
+}
+
+/*
+    Derive the columns of the record type from its fields.
+
+    Return:
+        0  => Success
+        -1 => Too many columns
+*/
+static int init_columns(struct columnar_batch *b, const struct jsonify_fields *fields)
+{
+    b->fields = fields;
+    b->columns_len = 0;
+
+    add_column(b, "event_id", COLUMNAR_TYPE_UINT64, fields->ts_offset, sizeof(event_id_t));
+#ifdef INCLUDE_TASK_CTX_ID
+    add_column(
+        b, "task_ctx_id", COLUMNAR_TYPE_UINT64,
+        offsetof(struct elem_common, task_ctx_id), sizeof(task_ctx_id_t)
+    );
+#endif
+
+    for (int i = 0; i < fields->fields_len; i++)
+    {
+        const struct jsonify_field *f = &fields->fields[i];
+        struct columnar_column *c = NULL;
+        char name[COLUMNAR_NAME_LEN];
+
+        switch (f->type)
+        {
+            case JSONIFY_FIELD_INT:
+            case JSONIFY_FIELD_SYS_ID:
+                c = add_column(b, f->key, COLUMNAR_TYPE_INT32, f->offset, f->size);
+                break;
+            case JSONIFY_FIELD_UINT:
+                c = add_column(b, f->key, COLUMNAR_TYPE_UINT32, f->offset, f->size);
+                break;
+            case JSONIFY_FIELD_SHORT:
+                c = add_column(b, f->key, COLUMNAR_TYPE_INT16, f->offset, f->size);
+                break;
+            case JSONIFY_FIELD_LONG:
+                c = add_column(b, f->key, COLUMNAR_TYPE_INT64, f->offset, f->size);
+                break;
+            case JSONIFY_FIELD_STR:
+                c = add_column(b, f->key, COLUMNAR_TYPE_STRING, f->offset, f->size);
+                break;
+            case JSONIFY_FIELD_SOCKADDR:
+                c = add_column(b, f->key, COLUMNAR_TYPE_BINARY, f->offset, f->size);
+                break;
+            case JSONIFY_FIELD_LAS_TIMESTAMP:
+                snprintf(name, sizeof(name), "%s.event_id", f->key);
+                add_column(
+                    b, name, COLUMNAR_TYPE_UINT64,
+                    f->offset + offsetof(struct elem_las_timestamp, event_id),
+                    sizeof(((struct elem_las_timestamp *)0)->event_id)
+                );
+                snprintf(name, sizeof(name), "%s.tv_sec", f->key);
+                add_column(
+                    b, name, COLUMNAR_TYPE_INT64,
+                    f->offset + offsetof(struct elem_las_timestamp, tv_sec),
+                    sizeof(((struct elem_las_timestamp *)0)->tv_sec)
+                );
+                snprintf(name, sizeof(name), "%s.tv_nsec", f->key);
+                c = add_column(
+                    b, name, COLUMNAR_TYPE_INT64,
+                    f->offset + offsetof(struct elem_las_timestamp, tv_nsec),
+                    sizeof(((struct elem_las_timestamp *)0)->tv_nsec)
+                );
+                break;
+            default:
+                return -1;
+        }
+        if (!c)
+            return -1;
+    }
+    return 0;
+}
+
+/*
+    Size (bytes) of the data of the column with 'rows' values.
+*/
+static size_t column_data_size(struct columnar_column *c, unsigned int rows)
+{
+    if (columnar_is_variable_width(c->type))
+        return (rows + 1) * sizeof(unsigned int) + c->data_len;
+    return (size_t)rows * c->width;
+}
+
+static void free_batch(struct columnar_batch *b)
+{
+    for (int i = 0; i < b->columns_len; i++)
+    {
+        free(b->columns[i].data);
+        free(b->columns[i].offsets);
+        b->columns[i].data = NULL;
+        b->columns[i].offsets = NULL;
+    }
+    b->fields = NULL;
+    b->columns_len = 0;
+    b->rows = 0;
+}
+
+/*
+    Allocate the columns for 'rows' values.
+
+    Return:
+        The max size (bytes) of the encoded batch
+        0 => Failure
+*/
+static size_t alloc_batch(struct columnar_batch *b, unsigned long rows)
+{
+    size_t batch_size = sizeof(struct columnar_batch_header);
+    for (int i = 0; i < b->columns_len; i++)
+    {
+        struct columnar_column *c = &b->columns[i];
+        size_t data_size;
+        if (columnar_is_variable_width(c->type))
+        {
+            data_size = rows * c->max_size;
+            c->offsets = malloc((rows + 1) * sizeof(unsigned int));
+            if (!c->offsets)
+                return 0;
+            c->offsets[0] = 0;
+            batch_size += (rows + 1) * sizeof(unsigned int);
+        } else {
+            data_size = rows * c->width;
+        }
+        c->data = malloc(data_size > 0 ? data_size : 1);
+        if (!c->data)
+            return 0;
+        batch_size += sizeof(unsigned long long) + PAD8(data_size);
+    }
+    return batch_size;
+}
+
+static long long read_signed(const void *src, size_t size)
+{
+    switch (size)
+    {
+        case sizeof(short):
+            return *(const short *)src;
+        case sizeof(int):
+            return *(const int *)src;
+        default:
+            return *(const long long *)src;
+    }
+}
+
+static unsigned long long read_unsigned(const void *src, size_t size)
+{
+    switch (size)
+    {
+        case sizeof(unsigned short):
+            return *(const unsigned short *)src;
+        case sizeof(unsigned int):
+            return *(const unsigned int *)src;
+        default:
+            return *(const unsigned long long *)src;
+    }
+}
+
+static void append_value(struct columnar_column *c, unsigned int row, const char *record)
+{
+    const void *src = record + c->src_offset;
+    unsigned char *dst = c->data + (size_t)row * c->width;
+    size_t len;
+
+    switch (c->type)
+    {
+        case COLUMNAR_TYPE_INT16:
+        {
+            short v = read_signed(src, c->src_size);
+            memcpy(dst, &v, sizeof(v));
+            break;
+        }
+        case COLUMNAR_TYPE_INT32:
+        {
+            int v = read_signed(src, c->src_size);
+            memcpy(dst, &v, sizeof(v));
+            break;
+        }
+        case COLUMNAR_TYPE_UINT32:
+        {
+            unsigned int v = read_unsigned(src, c->src_size);
+            memcpy(dst, &v, sizeof(v));
+            break;
+        }
+        case COLUMNAR_TYPE_INT64:
+        {
+            long long v = read_signed(src, c->src_size);
+            memcpy(dst, &v, sizeof(v));
+            break;
+        }
+        case COLUMNAR_TYPE_UINT64:
+        {
+            unsigned long long v = read_unsigned(src, c->src_size);
+            memcpy(dst, &v, sizeof(v));
+            break;
+        }
+        case COLUMNAR_TYPE_STRING:
+            len = strnlen((const char *)src, c->src_size);
+            memcpy(c->data + c->data_len, src, len);
+            c->data_len += len;
+            c->offsets[row + 1] = c->data_len;
+            break;
+        case COLUMNAR_TYPE_BINARY:
+        {
+            len = record_serializer_copy_sockaddr_network(
+                c->data + c->data_len, (const struct elem_sockaddr *)src
+            );
+            c->data_len += len;
+            c->offsets[row + 1] = c->data_len;
+            break;
+        }
+    }
+}
+
+static void put_bytes(unsigned char **p, const void *data, size_t len)
+{
+    memcpy(*p, data, len);
+    *p += len;
+}
+
+/*
+    Encode the buffered rows of the batch and write them to the underlying writer.
+    The batch is empty afterwards, even on failure.
+
+    Return:
+        -1  => The underlying write failed
+        >=0 => The bytes written
+*/
+static int write_batch(record_type_t record_type, struct columnar_batch *b)
+{
+    if (b->rows == 0)
+        return 0;
+
+    unsigned char *p = state.out;
+    struct columnar_batch_header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = AMEBA_MAGIC;
+    header.record_type = record_type;
+    header.rows = b->rows;
+    header.columns_len = b->columns_len;
+    p += sizeof(header);
+
+    for (int i = 0; i < b->columns_len; i++)
+    {
+        struct columnar_column *c = &b->columns[i];
+        unsigned long long data_size = column_data_size(c, b->rows);
+        put_bytes(&p, &data_size, sizeof(data_size));
+        if (columnar_is_variable_width(c->type))
+        {
+            put_bytes(&p, c->offsets, (b->rows + 1) * sizeof(unsigned int));
+            put_bytes(&p, c->data, c->data_len);
+        } else {
+            put_bytes(&p, c->data, data_size);
+        }
+        size_t padding = PAD8(data_size) - data_size;
+        memset(p, 0, padding);
+        p += padding;
+
+        c->data_len = 0;
+    }
+
+    header.batch_size = p - state.out;
+    memcpy(state.out, &header, sizeof(header));
+    b->rows = 0;
+
+    return state.init_args.writer->write(state.out, header.batch_size) < 0 ? -1 : (int)header.batch_size;
+}
+
+static int write_schema()
+{
+    struct columnar_file_header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = AMEBA_MAGIC;
+    header.format_version = COLUMNAR_FORMAT_VERSION;
+    header.header_size = sizeof(header);
+    header.record_version.major = RECORD_VERSION_MAJOR;
+    header.record_version.minor = RECORD_VERSION_MINOR;
+    header.record_version.patch = RECORD_VERSION_PATCH;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    header.endianness = RECORD_STREAM_ENDIANNESS_BIG;
+#else
+    header.endianness = RECORD_STREAM_ENDIANNESS_LITTLE;
+#endif
+#ifdef INCLUDE_TASK_CTX_ID
+    header.has_task_ctx_id = 1;
+#endif
+
+    size_t len = sizeof(header);
+    for (int t = 0; t < RECORD_STREAM_MAX_RECORD_TYPES; t++)
+    {
+        struct columnar_batch *b = &state.batches[t];
+        if (!b->fields)
+            continue;
+        header.record_types++;
+        len += sizeof(struct columnar_schema_record) + b->columns_len * sizeof(struct columnar_schema_column);
+    }
+    if (len > state.out_size)
+        return -1;
+
+    unsigned char *p = state.out;
+    put_bytes(&p, &header, sizeof(header));
+    for (int t = 0; t < RECORD_STREAM_MAX_RECORD_TYPES; t++)
+    {
+        struct columnar_batch *b = &state.batches[t];
+        if (!b->fields)
+            continue;
+
+        struct columnar_schema_record s_record;
+        memset(&s_record, 0, sizeof(s_record));
+        s_record.record_type = t;
+        s_record.columns_len = b->columns_len;
+        snprintf(s_record.name, sizeof(s_record.name), "%s", b->fields->name);
+        put_bytes(&p, &s_record, sizeof(s_record));
+
+        for (int i = 0; i < b->columns_len; i++)
+        {
+            struct columnar_schema_column s_column;
+            memset(&s_column, 0, sizeof(s_column));
+            s_column.type = b->columns[i].type;
+            s_column.width = b->columns[i].width;
+            memcpy(s_column.name, b->columns[i].name, sizeof(s_column.name));
+            put_bytes(&p, &s_column, sizeof(s_column));
+        }
+    }
+
+    return state.init_args.writer->write(state.out, len) < 0 ? -1 : 0;
+}
+
+static long elapsed_ms(struct timespec *from, struct timespec *to)
+{
+    return (to->tv_sec - from->tv_sec) * 1000 + (to->tv_nsec - from->tv_nsec) / 1000000;
+}
+
+
+static int set_init_args_columnar(void *ptr, size_t ptr_len) {
+    if (ptr_len != sizeof(struct columnar_writer_args))
+        return -1;
+
+    struct columnar_writer_args *in = (struct columnar_writer_args *)ptr;
+
+    if (!in->writer)
+        return -1;
+
+    if (in->batch_rows < 1 || in->batch_rows > COLUMNAR_MAX_BATCH_ROWS)
+        return -1;
+
+    if (in->max_age_ms < 0)
+        return -1;
+
+    memcpy(&state.init_args, in, sizeof(struct columnar_writer_args));
+    return 0;
+}
+
+static void free_columnar() {
+    for (int t = 0; t < RECORD_STREAM_MAX_RECORD_TYPES; t++)
+        free_batch(&state.batches[t]);
+    free(state.out);
+    state.out = NULL;
+    state.out_size = 0;
+}
+
+static int init_columnar() {
+    if (state.initialized)
+        return 0;
+
+    state.out_size = sizeof(struct columnar_file_header);
+    for (int t = 0; t < RECORD_STREAM_MAX_RECORD_TYPES; t++)
+    {
+        struct columnar_batch *b = &state.batches[t];
+        memset(b, 0, sizeof(*b));
+
+        const struct jsonify_fields *fields = jsonify_fields_get(t);
+        if (!fields)
+            continue;
+
+        size_t batch_size;
+        if (init_columns(b, fields) != 0 || (batch_size = alloc_batch(b, state.init_args.batch_rows)) == 0)
+        {
+            free_columnar();
+            return -1;
+        }
+        if (batch_size > state.out_size)
+            state.out_size = batch_size;
+
+        size_t schema_size = sizeof(struct columnar_schema_record) + b->columns_len * sizeof(struct columnar_schema_column);
+        state.out_size += schema_size;
+    }
+
+    state.out = malloc(state.out_size);
+    if (!state.out || write_schema() != 0)
+    {
+        free_columnar();
+        return -1;
+    }
+
+    state.initialized = 1;
+    return 0;
+}
+
+/*
+    Write the batches that are due, or all non-empty batches if 'force'.
+
+    Return:
+        -1  => The underlying write failed
+        >=0 => The bytes written
+*/
+static int write_due_batches(int force) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    int result = 0;
+    for (int t = 0; t < RECORD_STREAM_MAX_RECORD_TYPES; t++)
+    {
+        struct columnar_batch *b = &state.batches[t];
+        if (b->rows == 0)
+            continue;
+        if (!force && (state.init_args.max_age_ms == 0 || elapsed_ms(&b->first_row, &now) < state.init_args.max_age_ms))
+            continue;
+
+        int written = write_batch(t, b);
+        if (written < 0)
+            result = -1;
+        else if (result >= 0)
+            result += written;
+    }
+    return result;
+}
+
+static int flush_columnar(int force) {
+    if (!state.initialized)
+        return -2;
+
+    int result = write_due_batches(force);
+    if (state.init_args.writer->flush(force) == -1)
+        return -1;
+    return result;
+}
+
+static int close_columnar() {
+    if (state.initialized) {
+        flush_columnar(1);
+        free_columnar();
+        state.init_args.writer->close();
+        state.initialized = 0;
+    }
+    return 0;
+}
+
+static int write_columnar(void *data, size_t data_len) {
+    if (!state.initialized)
+        return -2;
+
+    size_t record_len;
+    if (data_len < sizeof(record_len) + sizeof(struct elem_common))
+        return -1;
+    memcpy(&record_len, data, sizeof(record_len));
+    if (record_len != data_len - sizeof(record_len))
+        return -1;
+
+    struct elem_common *record = (struct elem_common *)((char *)data + sizeof(record_len));
+
+    union record_expanded expanded;
+    long expanded_len = record_serializer_expand_compact(&expanded, record, record_len);
+    if (expanded_len < 0)
+        return -1;
+    if (expanded_len > 0)
+    {
+        record = &(expanded.e_common);
+        record_len = expanded_len;
+    }
+
+    if ((unsigned int)record->record_type >= RECORD_STREAM_MAX_RECORD_TYPES)
+        return -1;
+    struct columnar_batch *b = &state.batches[record->record_type];
+    if (!b->fields || record_len != b->fields->record_size)
+        return -1;
+
+    if (b->rows == 0)
+        clock_gettime(CLOCK_MONOTONIC, &b->first_row);
+    for (int i = 0; i < b->columns_len; i++)
+        append_value(&b->columns[i], b->rows, (const char *)record);
+    b->rows++;
+
+    if (b->rows >= state.init_args.batch_rows && write_batch(record->record_type, b) < 0)
+        return -1;
+
+    // Batches of rare record types are written once old enough, as with a write buffer.
+    if (state.init_args.max_age_ms > 0 && write_due_batches(0) < 0)
+        return -1;
+
+    return (int)data_len;
+}
+
+
+const struct record_writer record_writer_columnar = {
+    .set_init_args = set_init_args_columnar,
+    .init = init_columnar,
+    .close = close_columnar,
+    .write = write_columnar,
+    .flush = flush_columnar
+};
\ No newline at end of file
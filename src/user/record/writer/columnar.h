@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/*
+
+    A module to write records as column batches, i.e. the values of a field
+    of consecutive records of a record type are stored next to each other.
+
+    'record_writer_columnar' wraps another writer. Its input is a record
+    serialized by 'record_serializer_binary'. The records are buffered per
+    record type in a column per field (see 'jsonify_fields_get') until
+    'batch_rows' records of that type are buffered, the first buffered record
+    is older than 'max_age_ms', or the writer is flushed with force.
+
+    Layout of the output (in the endianness given by the header):
+        1. struct columnar_file_header
+        2. 'record_types' times:
+               struct columnar_schema_record, followed by
+               'columns_len' times struct columnar_schema_column
+        3. Any number of batches:
+               struct columnar_batch_header, followed by
+               'columns_len' columns in schema order. A column is an unsigned
+               long long with the size (bytes) of its data, followed by the
+               data padded with zeros to a multiple of 8 bytes.
+
+    Data of a column with 'rows' values:
+        Fixed width types: 'rows' values of 'width' bytes.
+        Variable width types: 'rows' + 1 unsigned int offsets, followed by the
+        values. Value i is at [offsets[i], offsets[i + 1]) after the offsets.
+
+    The columns of a record type are 'event_id', 'task_ctx_id' (if
+    'has_task_ctx_id'), then the fields of the record struct. 'las_audit' is
+    split into 'las_audit.event_id', 'las_audit.tv_sec' and 'las_audit.tv_nsec'.
+
+*/
+
+#include <stddef.h>
+
+#include "common/types.h"
+#include "user/record/writer/writer.h"
+
+
+/*
+    Version of the layout above. Incremented on any change to it.
+*/
+#define COLUMNAR_FORMAT_VERSION 2
+
+/*
+    Size of the names in the schema, including the terminating null byte.
+*/
+#define COLUMNAR_NAME_LEN 32
+
+/*
+    Max columns of a record type.
+*/
+#define COLUMNAR_MAX_COLUMNS 24
+
+/*
+    Max of 'batch_rows'.
+*/
+#define COLUMNAR_MAX_BATCH_ROWS 65536
+
+
+typedef enum {
+    COLUMNAR_TYPE_INT16 = 1,
+    COLUMNAR_TYPE_INT32,
+    COLUMNAR_TYPE_UINT32,
+    COLUMNAR_TYPE_INT64,
+    COLUMNAR_TYPE_UINT64,
+    // A string without the terminating null byte.
+    COLUMNAR_TYPE_STRING,
+    // Raw bytes i.e. the sockaddr with its port in network byte order.
+    COLUMNAR_TYPE_BINARY
+} columnar_type_t;
+
+
+struct columnar_file_header
+{
+    // AMEBA_MAGIC
+    magic_t magic;
+    // COLUMNAR_FORMAT_VERSION
+    unsigned short format_version;
+    // sizeof(struct columnar_file_header)
+    unsigned short header_size;
+    // The version of the records in the batches.
+    struct elem_version record_version;
+    // record_stream_endianness_t
+    unsigned char endianness;
+    // 1 if there is a 'task_ctx_id' column, otherwise 0.
+    unsigned char has_task_ctx_id;
+    // Number of struct columnar_schema_record that follow.
+    unsigned short record_types;
+};
+
+struct columnar_schema_record
+{
+    // record_type_t
+    unsigned int record_type;
+    unsigned short columns_len;
+    char name[COLUMNAR_NAME_LEN];
+};
+
+struct columnar_schema_column
+{
+    // columnar_type_t
+    unsigned short type;
+    // Size (bytes) of a value of a fixed width type. 0 for variable width types.
+    unsigned short width;
+    char name[COLUMNAR_NAME_LEN];
+};
+
+struct columnar_batch_header
+{
+    // AMEBA_MAGIC
+    magic_t magic;
+    // record_type_t
+    unsigned int record_type;
+    unsigned int rows;
+    unsigned int columns_len;
+    // Size (bytes) of the batch, including this header.
+    unsigned long long batch_size;
+};
+
+
+/*
+    Init args of 'record_writer_columnar'.
+*/
+struct columnar_writer_args
+{
+    // The writer to write the header and batches to. Must be initialized.
+    // Closed by 'record_writer_columnar.close'.
+    const struct record_writer *writer;
+    // Records of a record type in a batch. Between 1 and COLUMNAR_MAX_BATCH_ROWS.
+    unsigned long batch_rows;
+    // Max age (ms) of buffered records when flushed without force. 0 to only
+    // write full batches.
+    long max_age_ms;
+};
\ No newline at end of file
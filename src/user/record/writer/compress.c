@@ -0,0 +1,591 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "user/record/writer/compress.h"
+
+#ifdef OUTPUT_COMPRESSION_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef OUTPUT_COMPRESSION_HAVE_LZ4
+#include <lz4frame.h>
+#endif
+
+
+typedef enum {
+    // Compress as much as the codec likes. The rest stays buffered in the codec.
+    COMPRESS_MODE_CONTINUE = 1,
+    // Also compress everything buffered so that all data so far can be decompressed.
+    COMPRESS_MODE_FLUSH,
+    // Also end the frame.
+    COMPRESS_MODE_END
+} compress_mode_t;
+
+struct compress_codec
+{
+    /*
+        Create the compression context.
+
+        Return:
+            0  => Success
+            -1 => Failure
+    */
+    int (*init)(struct output_compression *c);
+    /*
+        Size (bytes) of the output buffer to compress a block of 'block_size' bytes with.
+    */
+    size_t (*out_size)(size_t block_size);
+    /*
+        Compress the data and write the output to the wrapped writer.
+
+        Return:
+            0  => Success
+            -1 => Compression or the underlying write failed
+    */
+    int (*compress)(const void *in, size_t in_len, compress_mode_t mode);
+    /*
+        Size (bytes) of the output buffer to compress a block of 'block_size'
+        bytes into a frame of its own with.
+    */
+    size_t (*frame_size)(size_t block_size);
+    /*
+        Compress the data into a frame of its own and write it to the wrapped
+        writer with a single write.
+
+        Return:
+            0  => Success
+            -1 => Compression or the underlying write failed
+    */
+    int (*compress_frame)(const void *in, size_t in_len);
+    /*
+        Free the compression context.
+    */
+    void (*free)();
+};
+
+struct compress_block
+{
+    char *buf;
+    size_t len;
+    compress_mode_t mode;
+    // 1 to force flush the wrapped writer after the block is written.
+    int force_flush;
+};
+
+static struct {
+    int initialized;
+    struct compress_writer_args init_args;
+    const struct compress_codec *codec;
+
+    struct compress_block blocks[COMPRESS_WRITER_BLOCKS];
+    // Sequence number of the block being filled. Only written by the writing thread.
+    unsigned long fill_seq;
+    // Sequence number of the next block to compress. Blocks [done_seq, fill_seq)
+    // are queued. Only written by the compression thread.
+    unsigned long done_seq;
+    struct timespec first_append;
+
+    // Compressed output. Only used by the compression thread.
+    char *out;
+    size_t out_size;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    int exiting;
+    // Set by the compression thread. Reported by the next write or flush.
+    // Written under the lock, and read without it by a write.
+    int write_failed;
+} state = {0};
+
+
+#if defined(OUTPUT_COMPRESSION_HAVE_ZSTD) || defined(OUTPUT_COMPRESSION_HAVE_LZ4)
+static int write_out(const void *data, size_t data_len)
+{
+    return state.init_args.writer->write((void *)data, data_len) < 0 ? -1 : 0;
+}
+#endif
+
+
+#ifdef OUTPUT_COMPRESSION_HAVE_ZSTD
+
+static ZSTD_CCtx *zstd_cctx = NULL;
+
+static ZSTD_CCtx *zstd_create_cctx(const struct output_compression *c)
+{
+    ZSTD_CCtx *cctx = ZSTD_createCCtx();
+    if (!cctx)
+        return NULL;
+
+    if ((c->level != 0 && ZSTD_isError(ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, c->level)))
+        || ZSTD_isError(ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 1)))
+    {
+        ZSTD_freeCCtx(cctx);
+        return NULL;
+    }
+    return cctx;
+}
+
+static int zstd_init(struct output_compression *c)
+{
+    zstd_cctx = zstd_create_cctx(c);
+    return zstd_cctx ? 0 : -1;
+}
+
+static size_t zstd_out_size(size_t block_size)
+{
+    (void)block_size;
+    // Output is written whenever the buffer is full, so any size works.
+    return ZSTD_CStreamOutSize();
+}
+
+static int zstd_compress(const void *in, size_t in_len, compress_mode_t mode)
+{
+    ZSTD_EndDirective directive = ZSTD_e_continue;
+    if (mode == COMPRESS_MODE_FLUSH)
+        directive = ZSTD_e_flush;
+    else if (mode == COMPRESS_MODE_END)
+        directive = ZSTD_e_end;
+
+    ZSTD_inBuffer input = {in, in_len, 0};
+    int finished;
+    do
+    {
+        ZSTD_outBuffer output = {state.out, state.out_size, 0};
+        size_t remaining = ZSTD_compressStream2(zstd_cctx, &output, &input, directive);
+        if (ZSTD_isError(remaining))
+            return -1;
+        if (output.pos > 0 && write_out(state.out, output.pos) != 0)
+            return -1;
+        finished = directive == ZSTD_e_continue ? input.pos == input.size : remaining == 0;
+    } while (!finished);
+
+    return 0;
+}
+
+static size_t zstd_frame_size(size_t block_size)
+{
+    return ZSTD_compressBound(block_size);
+}
+
+static int zstd_compress_frame(const void *in, size_t in_len)
+{
+    size_t len = ZSTD_compress2(zstd_cctx, state.out, state.out_size, in, in_len);
+    if (ZSTD_isError(len))
+        return -1;
+    return write_out(state.out, len);
+}
+
+static void zstd_free()
+{
+    ZSTD_freeCCtx(zstd_cctx);
+    zstd_cctx = NULL;
+}
+
+static const struct compress_codec compress_codec_zstd = {
+    .init = zstd_init,
+    .out_size = zstd_out_size,
+    .compress = zstd_compress,
+    .frame_size = zstd_frame_size,
+    .compress_frame = zstd_compress_frame,
+    .free = zstd_free
+};
+
+#endif
+
+
+#ifdef OUTPUT_COMPRESSION_HAVE_LZ4
+
+static LZ4F_cctx *lz4_cctx = NULL;
+static LZ4F_preferences_t lz4_prefs;
+static int lz4_frame_started = 0;
+
+static void lz4_set_prefs(LZ4F_preferences_t *prefs, const struct output_compression *c)
+{
+    memset(prefs, 0, sizeof(*prefs));
+    prefs->compressionLevel = c->level;
+    prefs->frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+}
+
+static int lz4_init(struct output_compression *c)
+{
+    if (LZ4F_isError(LZ4F_createCompressionContext(&lz4_cctx, LZ4F_VERSION)))
+        return -1;
+
+    lz4_set_prefs(&lz4_prefs, c);
+    lz4_frame_started = 0;
+    return 0;
+}
+
+static size_t lz4_out_size(size_t block_size)
+{
+    // Compressing a block must fit in the buffer.
+    return LZ4F_HEADER_SIZE_MAX + LZ4F_compressBound(block_size, &lz4_prefs);
+}
+
+static int lz4_write_out(size_t len)
+{
+    if (LZ4F_isError(len))
+        return -1;
+    if (len > 0 && write_out(state.out, len) != 0)
+        return -1;
+    return 0;
+}
+
+static int lz4_compress(const void *in, size_t in_len, compress_mode_t mode)
+{
+    if (!lz4_frame_started)
+    {
+        if (lz4_write_out(LZ4F_compressBegin(lz4_cctx, state.out, state.out_size, &lz4_prefs)) != 0)
+            return -1;
+        lz4_frame_started = 1;
+    }
+
+    if (in_len > 0 && lz4_write_out(LZ4F_compressUpdate(lz4_cctx, state.out, state.out_size, in, in_len, NULL)) != 0)
+        return -1;
+
+    if (mode == COMPRESS_MODE_FLUSH)
+        return lz4_write_out(LZ4F_flush(lz4_cctx, state.out, state.out_size, NULL));
+
+    if (mode == COMPRESS_MODE_END)
+    {
+        lz4_frame_started = 0;
+        return lz4_write_out(LZ4F_compressEnd(lz4_cctx, state.out, state.out_size, NULL));
+    }
+
+    return 0;
+}
+
+static size_t lz4_frame_size(size_t block_size)
+{
+    return LZ4F_compressFrameBound(block_size, &lz4_prefs);
+}
+
+static int lz4_compress_frame(const void *in, size_t in_len)
+{
+    return lz4_write_out(LZ4F_compressFrame(state.out, state.out_size, in, in_len, &lz4_prefs));
+}
+
+static void lz4_free()
+{
+    LZ4F_freeCompressionContext(lz4_cctx);
+    lz4_cctx = NULL;
+}
+
+static const struct compress_codec compress_codec_lz4 = {
+    .init = lz4_init,
+    .out_size = lz4_out_size,
+    .compress = lz4_compress,
+    .frame_size = lz4_frame_size,
+    .compress_frame = lz4_compress_frame,
+    .free = lz4_free
+};
+
+#endif
+
+
+static const struct compress_codec *select_codec(enum output_compression_codec codec)
+{
+    switch (codec)
+    {
+#ifdef OUTPUT_COMPRESSION_HAVE_ZSTD
+        case OUTPUT_COMPRESSION_ZSTD:
+            return &compress_codec_zstd;
+#endif
+#ifdef OUTPUT_COMPRESSION_HAVE_LZ4
+        case OUTPUT_COMPRESSION_LZ4:
+            return &compress_codec_lz4;
+#endif
+        default:
+            return NULL;
+    }
+}
+
+static long elapsed_ms(struct timespec *since)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - since->tv_sec) * 1000 + (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+static void *compress_main(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&state.lock);
+    while (1)
+    {
+        while (state.done_seq == state.fill_seq && !state.exiting)
+            pthread_cond_wait(&state.cond, &state.lock);
+        if (state.done_seq == state.fill_seq)
+            break;
+
+        struct compress_block *b = &state.blocks[state.done_seq % COMPRESS_WRITER_BLOCKS];
+        pthread_mutex_unlock(&state.lock);
+
+        int err = 0;
+        if (!state.init_args.frame_per_block)
+            err = state.codec->compress(b->buf, b->len, b->mode);
+        else if (b->len > 0)
+            err = state.codec->compress_frame(b->buf, b->len);
+        // Without force the wrapped writer only flushes if its flush policy requires it.
+        if (state.init_args.writer->flush(b->force_flush) == -1)
+            err = -1;
+
+        pthread_mutex_lock(&state.lock);
+        if (err != 0)
+            __atomic_store_n(&state.write_failed, 1, __ATOMIC_RELAXED);
+        b->len = 0;
+        state.done_seq++;
+        pthread_cond_broadcast(&state.cond);
+    }
+    pthread_mutex_unlock(&state.lock);
+    return NULL;
+}
+
+/*
+    Hand the block being filled over to the compression thread, and wait for
+    the next block to be free.
+*/
+static void submit_block(compress_mode_t mode, int force_flush)
+{
+    struct compress_block *b = &state.blocks[state.fill_seq % COMPRESS_WRITER_BLOCKS];
+    b->mode = mode;
+    b->force_flush = force_flush;
+
+    pthread_mutex_lock(&state.lock);
+    state.fill_seq++;
+    pthread_cond_broadcast(&state.cond);
+    while (state.fill_seq - state.done_seq >= COMPRESS_WRITER_BLOCKS)
+        pthread_cond_wait(&state.cond, &state.lock);
+    pthread_mutex_unlock(&state.lock);
+}
+
+/*
+    Wait for all the submitted blocks to be written if 'wait'.
+
+    Return:
+        1 => A write failed since the last call
+        0 => No write failed
+*/
+static int wait_blocks_done(int wait)
+{
+    pthread_mutex_lock(&state.lock);
+    while (wait && state.done_seq != state.fill_seq)
+        pthread_cond_wait(&state.cond, &state.lock);
+    int write_failed = state.write_failed;
+    __atomic_store_n(&state.write_failed, 0, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&state.lock);
+    return write_failed;
+}
+
+static void free_blocks()
+{
+    for (int i = 0; i < COMPRESS_WRITER_BLOCKS; i++)
+    {
+        free(state.blocks[i].buf);
+        state.blocks[i].buf = NULL;
+    }
+    free(state.out);
+    state.out = NULL;
+}
+
+
+static int set_init_args_compress(void *ptr, size_t ptr_len) {
+    if (ptr_len != sizeof(struct compress_writer_args))
+        return -1;
+
+    struct compress_writer_args *in = (struct compress_writer_args *)ptr;
+
+    if (!in->writer || in->compression.codec == OUTPUT_COMPRESSION_NONE || in->compression.block_size == 0)
+        return -1;
+
+    memcpy(&state.init_args, in, sizeof(struct compress_writer_args));
+    return 0;
+}
+
+static int init_compress() {
+    if (state.initialized)
+        return 0;
+
+    state.codec = select_codec(state.init_args.compression.codec);
+    if (!state.codec || state.codec->init(&state.init_args.compression) != 0)
+        return -1;
+
+    int alloc_failed = 0;
+    size_t block_size = state.init_args.compression.block_size;
+    for (int i = 0; i < COMPRESS_WRITER_BLOCKS; i++)
+    {
+        state.blocks[i].buf = malloc(block_size);
+        state.blocks[i].len = 0;
+        if (!state.blocks[i].buf)
+            alloc_failed = 1;
+    }
+    state.out_size = state.init_args.frame_per_block
+        ? state.codec->frame_size(block_size)
+        : state.codec->out_size(block_size);
+    state.out = malloc(state.out_size);
+    if (!state.out || alloc_failed)
+    {
+        free_blocks();
+        state.codec->free();
+        return -1;
+    }
+
+    state.fill_seq = 0;
+    state.done_seq = 0;
+    state.exiting = 0;
+    state.write_failed = 0;
+    pthread_mutex_init(&state.lock, NULL);
+    pthread_cond_init(&state.cond, NULL);
+    if (pthread_create(&state.thread, NULL, compress_main, NULL) != 0)
+    {
+        pthread_cond_destroy(&state.cond);
+        pthread_mutex_destroy(&state.lock);
+        free_blocks();
+        state.codec->free();
+        return -1;
+    }
+
+    state.initialized = 1;
+    return 0;
+}
+
+static int close_compress() {
+    if (state.initialized) {
+        submit_block(COMPRESS_MODE_END, 1);
+
+        pthread_mutex_lock(&state.lock);
+        state.exiting = 1;
+        pthread_cond_broadcast(&state.cond);
+        pthread_mutex_unlock(&state.lock);
+        pthread_join(state.thread, NULL);
+
+        pthread_cond_destroy(&state.cond);
+        pthread_mutex_destroy(&state.lock);
+        state.codec->free();
+        free_blocks();
+        state.init_args.writer->close();
+        state.initialized = 0;
+    }
+    return 0;
+}
+
+static int write_compress(void *data, size_t data_len) {
+    if (!state.initialized)
+        return -2;
+
+    const char *ptr = (const char *)data;
+    size_t remaining = data_len;
+    size_t block_size = state.init_args.compression.block_size;
+
+    while (remaining > 0)
+    {
+        struct compress_block *b = &state.blocks[state.fill_seq % COMPRESS_WRITER_BLOCKS];
+        if (b->len == 0)
+            clock_gettime(CLOCK_MONOTONIC, &state.first_append);
+
+        size_t len = block_size - b->len;
+        if (len > remaining)
+            len = remaining;
+        memcpy(b->buf + b->len, ptr, len);
+        b->len += len;
+        ptr += len;
+        remaining -= len;
+
+        if (b->len == block_size)
+            submit_block(COMPRESS_MODE_CONTINUE, 0);
+    }
+
+    // Failures of earlier blocks are only known now.
+    if (__atomic_load_n(&state.write_failed, __ATOMIC_RELAXED) && wait_blocks_done(0))
+        return -1;
+
+    return (int)data_len;
+}
+
+static int flush_compress(int force) {
+    if (!state.initialized)
+        return -2;
+
+    struct compress_block *b = &state.blocks[state.fill_seq % COMPRESS_WRITER_BLOCKS];
+    size_t len = b->len;
+    long flush_interval_ms = state.init_args.flush_interval_ms;
+
+    if (force)
+        submit_block(COMPRESS_MODE_FLUSH, 1);
+    else if (len > 0 && flush_interval_ms > 0 && elapsed_ms(&state.first_append) >= flush_interval_ms)
+        submit_block(COMPRESS_MODE_FLUSH, 0);
+    else
+        len = 0;
+
+    if (wait_blocks_done(force))
+        return -1;
+
+    return (int)len;
+}
+
+
+long record_writer_compress_frame(
+    const struct output_compression *c, const void *in, size_t in_len, void *dst, size_t dst_len
+)
+{
+    switch (c->codec)
+    {
+#ifdef OUTPUT_COMPRESSION_HAVE_ZSTD
+        case OUTPUT_COMPRESSION_ZSTD:
+        {
+            ZSTD_CCtx *cctx = zstd_create_cctx(c);
+            if (!cctx)
+                return -1;
+            size_t len = ZSTD_compress2(cctx, dst, dst_len, in, in_len);
+            ZSTD_freeCCtx(cctx);
+            return ZSTD_isError(len) ? -1 : (long)len;
+        }
+#endif
+#ifdef OUTPUT_COMPRESSION_HAVE_LZ4
+        case OUTPUT_COMPRESSION_LZ4:
+        {
+            LZ4F_preferences_t prefs;
+            lz4_set_prefs(&prefs, c);
+            size_t len = LZ4F_compressFrame(dst, dst_len, in, in_len, &prefs);
+            return LZ4F_isError(len) ? -1 : (long)len;
+        }
+#endif
+        default:
+            (void)in;
+            (void)in_len;
+            (void)dst;
+            (void)dst_len;
+            return -1;
+    }
+}
+
+
+const struct record_writer record_writer_compress = {
+    .set_init_args = set_init_args_compress,
+    .init = init_compress,
+    .close = close_compress,
+    .write = write_compress,
+    .flush = flush_compress
+};
\ No newline at end of file
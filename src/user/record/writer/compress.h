@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/*
+
+    A module to compress the output of another writer on a separate thread.
+
+    'record_writer_compress' wraps another writer. Data written to it is copied
+    into blocks of 'block_size' bytes. A full block is handed over to the
+    compression thread, which compresses it into a single frame (zstd or lz4
+    frame format) that spans the whole output, and writes the compressed
+    bytes to the wrapped writer. Therefore the thread writing the records
+    only pays for a copy.
+
+    The wrapped writer must only be used through 'record_writer_compress' once
+    wrapped since it is written from the compression thread.
+
+    A partial block is handed over (and the frame flushed so that a reader can
+    decompress everything written so far) when it is older than
+    'flush_interval_ms' at a flush, or on a forced flush. The frame is ended
+    when the writer is closed.
+
+    With 'frame_per_block', every block is compressed into a frame of its own
+    instead, written with a single write. A reader can then start decoding at
+    any write boundary of the wrapped writer, e.g. after a TCP reconnect.
+    Frames that follow each other decompress as a single stream.
+
+*/
+
+#include <stddef.h>
+
+#include "user/types.h"
+#include "user/record/writer/writer.h"
+
+
+/*
+    Blocks in flight between the writer and the compression thread.
+*/
+#define COMPRESS_WRITER_BLOCKS 4
+
+
+/*
+    Init args of 'record_writer_compress'.
+*/
+struct compress_writer_args
+{
+    // The writer to write the compressed data to. Must be initialized.
+    // Closed by 'record_writer_compress.close'.
+    const struct record_writer *writer;
+    // Must not be OUTPUT_COMPRESSION_NONE. 'block_size' must be positive.
+    struct output_compression compression;
+    // Max age (ms) of a partial block when flushed without force. Ignored if <= 0.
+    long flush_interval_ms;
+    // 1 to compress every block into a frame of its own.
+    int frame_per_block;
+};
+
+
+/*
+    Compress 'in' into a frame of its own, e.g. for a header sent ahead of
+    the frames of 'record_writer_compress' with 'frame_per_block'. Can be
+    called from any thread.
+
+    Return:
+        >= 0 => Size of the frame in 'dst'
+        -1   => Error e.g. the codec is not supported or 'dst' is too small
+*/
+long record_writer_compress_frame(
+    const struct output_compression *c, const void *in, size_t in_len, void *dst, size_t dst_len
+);
\ No newline at end of file
@@ -23,14 +23,18 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <unistd.h>
 #include <limits.h>
 #include <fcntl.h>
+#include <errno.h>
 
 #include "user/record/writer/writer.h"
+#include "user/record/writer/buffer.h"
 #include "user/types.h"
 
 
 static struct {
     int fd;
     int initialized;
+    int buffered;
+    struct write_buffer w_buf;
     struct output_file init_args;
 } state = {0};
 
@@ -44,17 +48,83 @@ static int set_init_args_file(void *ptr, size_t ptr_len) {
     if (strlen(in->path) == 0 || strlen(in->path) >= PATH_MAX)
         return -1;
 
+    if (in->flush_policy.flush_interval_ms < 0)
+        return -1;
+
     memcpy(&state.init_args, in, sizeof(struct output_file));
     return 0;
 }
 
+/*
+    Write all of data to the file. Retry on partial writes.
+    'written_len' (if set) gets the bytes written, even on failure.
+
+    Return:
+        -1  => The underlying write failed
+        >=0 => The bytes written
+*/
+static int write_fully(const void *data, size_t data_len, size_t *written_len) {
+    const char *ptr = (const char *)data;
+    size_t remaining = data_len;
+
+    while (remaining > 0)
+    {
+        ssize_t written = write(state.fd, ptr, remaining);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        ptr += written;
+        remaining -= written;
+    }
+
+    if (written_len)
+        *written_len = data_len - remaining;
+    return remaining > 0 ? -1 : (int)data_len;
+}
+
+/*
+    Write the buffered data to the file. On failure, the part that was not
+    written stays buffered for the next flush.
+
+    Return:
+        -1  => The underlying write failed
+        >=0 => The bytes written
+*/
+static int flush_buffer() {
+    if (state.w_buf.len == 0)
+        return 0;
+
+    size_t written_len;
+    int result = write_fully(state.w_buf.buf, state.w_buf.len, &written_len);
+    write_buffer_consume(&state.w_buf, written_len);
+    return result;
+}
+
 static int init_file() {
     if (state.initialized)
         return 0;
 
-    state.fd = open(state.init_args.path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    state.buffered = state.init_args.flush_policy.buffer_size > 0;
+    if (state.buffered)
+    {
+        if (write_buffer_init(
+                &state.w_buf,
+                state.init_args.flush_policy.buffer_size,
+                state.init_args.flush_policy.flush_interval_ms) != 0)
+            return -1;
+    }
+
+    // Never truncate earlier output. See 'record_writer_rotate'.
+    state.fd = open(state.init_args.path, O_RDWR | O_CREAT | O_APPEND, 0600);
     if (state.fd == -1)
+    {
+        if (state.buffered)
+            write_buffer_free(&state.w_buf);
         return -1;
+    }
 
     state.initialized = 1;
     return 0;
@@ -62,6 +132,11 @@ static int init_file() {
 
 static int close_file() {
     if (state.initialized) {
+        if (state.buffered)
+        {
+            flush_buffer();
+            write_buffer_free(&state.w_buf);
+        }
         close(state.fd);
         state.fd = 0;
         state.initialized = 0;
@@ -73,11 +148,46 @@ static int write_file(void *data, size_t data_len) {
     if (!state.initialized)
         return -2;
 
-    size_t written = write(state.fd, data, data_len);
-    if (written != data_len)
-        return -1;
+    if (!state.buffered)
+    {
+        size_t written = write(state.fd, data, data_len);
+        if (written != data_len)
+            return -1;
 
-    return (int)written;
+        return (int)written;
+    }
+
+    if (write_buffer_append(&state.w_buf, data, data_len) != 0)
+    {
+        if (flush_buffer() < 0)
+            return -1;
+        if (write_buffer_append(&state.w_buf, data, data_len) != 0)
+        {
+            // Larger than the whole buffer.
+            return write_fully(data, data_len, NULL);
+        }
+    }
+
+    if (write_buffer_is_flush_due(&state.w_buf))
+    {
+        if (flush_buffer() < 0)
+            return -1;
+    }
+
+    return (int)data_len;
+}
+
+static int flush_file(int force) {
+    if (!state.initialized)
+        return -2;
+
+    if (!state.buffered)
+        return 0;
+
+    if (force || write_buffer_is_flush_due(&state.w_buf))
+        return flush_buffer();
+
+    return 0;
 }
 
 const struct record_writer record_writer_file = {
@@ -85,4 +195,5 @@ const struct record_writer record_writer_file = {
     .init = init_file,
     .close = close_file,
     .write = write_file,
+    .flush = flush_file,
 };
\ No newline at end of file
@@ -17,15 +17,33 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+/*
+    Records are packed into datagrams of up to 'datagram_size' bytes without
+    being split, since the serialized records are self-delimiting (i.e. JSON
+    lines, or length-prefixed binary). Up to 'batch' datagrams are sent with a
+    single 'sendmmsg' call when all are filled, or at a flush once the oldest
+    packed record is older than 'flush_interval_ms'.
+
+    A record larger than 'datagram_size' is sent on its own.
+
+    Every datagram starts with the stream header (if any). Datagrams may be
+    lost or reordered, and a receiver may start at any of them, so each one
+    must be readable on its own.
+*/
+
+// For sendmmsg and struct mmsghdr.
+#define _GNU_SOURCE
+
+#include <errno.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
 
-#include "user/record/writer/writer.h"
-#include "user/types.h"
+#include "user/record/writer/net.h"
 
 
 static struct {
@@ -33,15 +51,31 @@ static struct {
     struct sockaddr_storage addr;
     socklen_t addr_len;
     int initialized;
-    struct output_net init_args;
+    struct net_writer_args init_args;
+
+    // 'batch' datagrams of 'datagram_size' bytes each.
+    char *bufs;
+    struct iovec *iovecs;
+    struct mmsghdr *msgs;
+    // The datagram being filled.
+    int current;
+    // Bytes packed in all the datagrams.
+    size_t packed;
+    struct timespec first_pack;
 } state = {0};
 
 
 static int set_init_args_net(void *ptr, size_t ptr_len) {
-    if (ptr_len != sizeof(struct output_net))
+    if (ptr_len != sizeof(struct net_writer_args))
         return -1;
 
-    struct output_net *in = (struct output_net *)ptr;
+    struct net_writer_args *args = (struct net_writer_args *)ptr;
+    struct output_net *in = &(args->output);
+
+    if (args->header_len > sizeof(args->header))
+        return -1;
+    if (in->datagram_size > 0 && (in->batch < 1 || in->datagram_size <= args->header_len))
+        return -1;
 
     if (in->ip_family == AF_INET)
     {
@@ -67,10 +101,100 @@ static int set_init_args_net(void *ptr, size_t ptr_len) {
         return -2;
     }
 
-    memcpy(&state.init_args, in, sizeof(struct output_net));
+    memcpy(&state.init_args, args, sizeof(struct net_writer_args));
     return 0;
 }
 
+static long elapsed_ms(struct timespec *since)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - since->tv_sec) * 1000 + (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+/*
+    Check if a send failed only because nobody is listening. An unconnected
+    socket would not have noticed, so the datagram just counts as sent.
+*/
+static int is_send_error(int err)
+{
+    return err != ECONNREFUSED;
+}
+
+static void free_datagrams()
+{
+    free(state.bufs);
+    free(state.iovecs);
+    free(state.msgs);
+    state.bufs = NULL;
+    state.iovecs = NULL;
+    state.msgs = NULL;
+}
+
+static int alloc_datagrams()
+{
+    int batch = state.init_args.output.batch;
+    state.bufs = malloc((size_t)batch * state.init_args.output.datagram_size);
+    state.iovecs = calloc(batch, sizeof(struct iovec));
+    state.msgs = calloc(batch, sizeof(struct mmsghdr));
+    if (!state.bufs || !state.iovecs || !state.msgs)
+    {
+        free_datagrams();
+        return -1;
+    }
+
+    for (int i = 0; i < batch; i++)
+    {
+        state.iovecs[i].iov_base = state.bufs + (size_t)i * state.init_args.output.datagram_size;
+        state.iovecs[i].iov_len = 0;
+        state.msgs[i].msg_hdr.msg_iov = &state.iovecs[i];
+        state.msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    state.current = 0;
+    state.packed = 0;
+    return 0;
+}
+
+/*
+    Send all the packed datagrams.
+
+    Return:
+        -1  => A datagram could not be sent. The rest are dropped.
+        >=0 => The bytes sent
+*/
+static int send_datagrams()
+{
+    if (state.packed == 0)
+        return 0;
+
+    unsigned int count = state.current + (state.iovecs[state.current].iov_len > 0 ? 1 : 0);
+    unsigned int sent = 0;
+    int result = (int)state.packed;
+    while (sent < count)
+    {
+        int n = sendmmsg(state.sockfd, &state.msgs[sent], count - sent, 0);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (is_send_error(errno))
+            {
+                result = -1;
+                break;
+            }
+            // The datagram was dropped. Carry on with the next one.
+            n = 1;
+        }
+        sent += n;
+    }
+
+    for (unsigned int i = 0; i < count; i++)
+        state.iovecs[i].iov_len = 0;
+    state.current = 0;
+    state.packed = 0;
+    return result;
+}
+
 static int init_net() {
     if (state.initialized) return 0;
 
@@ -78,28 +202,110 @@ static int init_net() {
     if (state.sockfd < 0)
         return -1;
 
+    // A connected socket skips the route lookup for every datagram.
+    if (connect(state.sockfd, (struct sockaddr *)&state.addr, state.addr_len) != 0)
+    {
+        close(state.sockfd);
+        return -1;
+    }
+
+    if (state.init_args.output.datagram_size > 0 && alloc_datagrams() != 0)
+    {
+        close(state.sockfd);
+        return -1;
+    }
+
     state.initialized = 1;
     return 0;
 }
 
 static int close_net() {
     if (state.initialized) {
+        if (state.bufs)
+        {
+            send_datagrams();
+            free_datagrams();
+        }
         close(state.sockfd);
         state.initialized = 0;
     }
     return 0;
 }
 
+static int send_record(void *data, size_t data_len) {
+    struct iovec iov[2] = {
+        { .iov_base = state.init_args.header, .iov_len = state.init_args.header_len },
+        { .iov_base = data, .iov_len = data_len }
+    };
+    struct msghdr msg = {0};
+    msg.msg_iov = iov[0].iov_len > 0 ? &iov[0] : &iov[1];
+    msg.msg_iovlen = iov[0].iov_len > 0 ? 2 : 1;
+
+    ssize_t sent = sendmsg(state.sockfd, &msg, 0);
+    if (sent < 0 && is_send_error(errno))
+        return -1;
+
+    return (int)data_len;
+}
+
 static int write_net(void *data, size_t data_len) {
     if (!state.initialized)
         return -2;
 
-    ssize_t sent = sendto(state.sockfd, data, data_len, 0,
-                          (struct sockaddr *)&state.addr, state.addr_len);
-    if (sent < 0)
-        return -1;
+    size_t datagram_size = state.init_args.output.datagram_size;
+    size_t header_len = state.init_args.header_len;
+    if (datagram_size == 0)
+        return send_record(data, data_len);
 
-    return (int)sent;
+    if (header_len + data_len > datagram_size)
+    {
+        // Keep the records in order.
+        if (send_datagrams() < 0)
+            return -1;
+        return send_record(data, data_len);
+    }
+
+    struct iovec *iov = &state.iovecs[state.current];
+    if (iov->iov_len + data_len > datagram_size)
+    {
+        if (state.current + 1 == state.init_args.output.batch)
+        {
+            if (send_datagrams() < 0)
+                return -1;
+        }
+        else
+        {
+            state.current++;
+        }
+        iov = &state.iovecs[state.current];
+    }
+
+    if (iov->iov_len == 0)
+    {
+        memcpy(iov->iov_base, state.init_args.header, header_len);
+        iov->iov_len = header_len;
+    }
+    if (state.packed == 0)
+        clock_gettime(CLOCK_MONOTONIC, &state.first_pack);
+    memcpy((char *)iov->iov_base + iov->iov_len, data, data_len);
+    iov->iov_len += data_len;
+    state.packed += data_len;
+
+    return (int)data_len;
+}
+
+static int flush_net(int force) {
+    if (!state.initialized)
+        return -2;
+
+    if (state.packed == 0)
+        return 0;
+
+    long flush_interval_ms = state.init_args.output.flush_interval_ms;
+    if (force || (flush_interval_ms > 0 && elapsed_ms(&state.first_pack) >= flush_interval_ms))
+        return send_datagrams();
+
+    return 0;
 }
 
 const struct record_writer record_writer_net = {
@@ -107,4 +313,5 @@ const struct record_writer record_writer_net = {
     .init = init_net,
     .close = close_net,
     .write = write_net,
+    .flush = flush_net,
 };
\ No newline at end of file
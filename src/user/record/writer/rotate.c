@@ -0,0 +1,639 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "user/record/writer/rotate.h"
+
+
+/*
+    Min time between attempts to open the writers again after it failed.
+*/
+#define ROTATE_WRITER_REOPEN_INTERVAL_MS 1000
+
+/*
+    Max bytes of the records kept in memory while the helper thread rotates the
+    file. Writes wait for the rotation beyond it.
+*/
+#define ROTATE_WRITER_PENDING_MAX_SIZE (64 * 1024 * 1024)
+
+
+static volatile sig_atomic_t rotate_requested = 0;
+
+static struct {
+    int initialized;
+    struct rotate_writer_args init_args;
+    // NULL if the writers could not be opened after a rotation.
+    const struct record_writer *writer;
+    // Bytes written to the current file.
+    size_t bytes_written;
+    // When the current file was opened (or last tried to).
+    struct timespec opened_at;
+    // Set if a rotation failed. Reported by the next flush.
+    int rotate_failed;
+
+    // Set while the helper thread rotates the file. Only used by the writing thread.
+    int in_rotation;
+    /*
+        Records written during a rotation, each as a size_t length followed by
+        the record. Written to the new file once it is open.
+    */
+    char *pending;
+    size_t pending_len;
+    size_t pending_cap;
+
+    // Path of the pre-created next file.
+    char next_path[PATH_MAX];
+    int precreate;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t helper;
+    // Guarded by 'lock'.
+    int helper_pending;
+    int next_ready;
+    int exiting;
+    // Set to have the helper thread close 'old_writer', move the file and reopen.
+    int rotate_pending;
+    // Cleared by the helper thread once the rotation is done. Signalled on 'rotated_cond'.
+    int rotating;
+    // Writers to close. NULL if none.
+    const struct record_writer *old_writer;
+    // Writers opened by the helper thread. NULL on failure.
+    const struct record_writer *new_writer;
+    int new_failed;
+    pthread_cond_t rotated_cond;
+} state = {0};
+
+
+/*
+    Get the name of the file at 'path' and the extension of the name i.e.
+    everything from its first '.' (excluding a leading '.').
+*/
+static void split_path(const char *path, const char **name, const char **ext)
+{
+    const char *slash = strrchr(path, '/');
+    *name = slash ? slash + 1 : path;
+
+    const char *dot = (*name)[0] != '\0' ? strchr(*name + 1, '.') : NULL;
+    *ext = dot ? dot : *name + strlen(*name);
+}
+
+int record_writer_rotate_path(const char *path, long long now_ms, char *dst, size_t dst_len)
+{
+    const char *name, *ext;
+    split_path(path, &name, &ext);
+
+    time_t now_sec = (time_t)(now_ms / 1000);
+    struct tm tm;
+    char stamp[ROTATE_WRITER_STAMP_LEN + 8];
+    if (!gmtime_r(&now_sec, &tm) || strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm) == 0)
+        return -1;
+    snprintf(&stamp[15], sizeof(stamp) - 15, "-%03u", (unsigned int)(now_ms % 1000));
+
+    int len = snprintf(dst, dst_len, "%.*s.%s%s", (int)(ext - path), path, stamp, ext);
+    if (len < 0 || (size_t)len >= dst_len)
+        return -1;
+    return 0;
+}
+
+void record_writer_rotate_request()
+{
+    rotate_requested = 1;
+}
+
+static long elapsed_ms(struct timespec *since)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - since->tv_sec) * 1000 + (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+/*
+    Check if 's' is a stamp written by 'record_writer_rotate_path'.
+*/
+static int is_stamp(const char *s)
+{
+    for (int i = 0; i < ROTATE_WRITER_STAMP_LEN; i++)
+    {
+        if (i == 8 || i == 15)
+        {
+            if (s[i] != '-')
+                return 0;
+        }
+        else if (s[i] < '0' || s[i] > '9')
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int compare_names(const void *a, const void *b)
+{
+    return strcmp(*(const char **)a, *(const char **)b);
+}
+
+/*
+    Delete the oldest rotated files such that 'retain' are left.
+    The stamps sort by time so the names sort by age.
+*/
+static void remove_old_rotated_files()
+{
+    const char *path = state.init_args.path;
+    const char *name, *ext;
+    split_path(path, &name, &ext);
+
+    size_t dir_len = name - path;
+    size_t prefix_len = ext - name;
+    size_t ext_len = strlen(ext);
+
+    char dir[PATH_MAX];
+    if (dir_len == 0)
+        strcpy(dir, ".");
+    else
+    {
+        memcpy(dir, path, dir_len);
+        dir[dir_len] = '\0';
+    }
+
+    DIR *d = opendir(dir);
+    if (!d)
+        return;
+
+    char **names = NULL;
+    size_t names_len = 0, names_cap = 0;
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL)
+    {
+        const char *n = e->d_name;
+        if (strlen(n) != prefix_len + 1 + ROTATE_WRITER_STAMP_LEN + ext_len
+            || strncmp(n, name, prefix_len) != 0
+            || n[prefix_len] != '.'
+            || !is_stamp(&n[prefix_len + 1])
+            || strcmp(&n[prefix_len + 1 + ROTATE_WRITER_STAMP_LEN], ext) != 0)
+            continue;
+
+        if (names_len == names_cap)
+        {
+            size_t cap = names_cap ? names_cap * 2 : 64;
+            char **grown = realloc(names, cap * sizeof(char *));
+            if (!grown)
+                break;
+            names = grown;
+            names_cap = cap;
+        }
+        names[names_len] = strdup(n);
+        if (!names[names_len])
+            break;
+        names_len++;
+    }
+    closedir(d);
+
+    size_t retain = (size_t)state.init_args.rotation.retain;
+    if (names_len > retain)
+    {
+        qsort(names, names_len, sizeof(char *), compare_names);
+        char rotated_path[PATH_MAX];
+        for (size_t i = 0; i < names_len - retain; i++)
+        {
+            int len = snprintf(rotated_path, sizeof(rotated_path), "%.*s%s", (int)dir_len, path, names[i]);
+            if (len > 0 && (size_t)len < sizeof(rotated_path))
+                unlink(rotated_path);
+        }
+    }
+
+    for (size_t i = 0; i < names_len; i++)
+        free(names[i]);
+    free(names);
+}
+
+static int create_next_file()
+{
+    int fd = open(state.next_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd == -1)
+        return -1;
+    close(fd);
+    return 0;
+}
+
+static void rotate_on_helper(const struct record_writer *old_writer);
+
+static void *rotate_helper_main(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&state.lock);
+    while (1)
+    {
+        while (!state.rotate_pending && !state.helper_pending && !state.exiting)
+            pthread_cond_wait(&state.cond, &state.lock);
+        if (state.exiting)
+            break;
+        if (state.rotate_pending)
+        {
+            state.rotate_pending = 0;
+            const struct record_writer *old_writer = state.old_writer;
+            state.old_writer = NULL;
+            pthread_mutex_unlock(&state.lock);
+
+            rotate_on_helper(old_writer);
+
+            pthread_mutex_lock(&state.lock);
+            state.helper_pending = 1;
+            continue;
+        }
+        state.helper_pending = 0;
+        int next_ready = state.next_ready;
+        pthread_mutex_unlock(&state.lock);
+
+        if (state.init_args.rotation.retain > 0)
+            remove_old_rotated_files();
+        if (state.precreate && !next_ready)
+            next_ready = create_next_file() == 0;
+
+        pthread_mutex_lock(&state.lock);
+        state.next_ready = next_ready;
+    }
+    pthread_mutex_unlock(&state.lock);
+    return NULL;
+}
+
+/*
+    Start the helper thread with all signals blocked so that they are handled
+    by the threads of the caller.
+*/
+static int start_helper()
+{
+    sigset_t mask, old_mask;
+    sigfillset(&mask);
+    pthread_sigmask(SIG_BLOCK, &mask, &old_mask);
+    int err = pthread_create(&state.helper, NULL, rotate_helper_main, NULL);
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+    return err == 0 ? 0 : -1;
+}
+
+/*
+    Rename the file to its rotated path unless it is empty or missing (i.e.
+    already moved by someone else).
+
+    Return:
+        0  => Success
+        -1 => Failure
+*/
+static int move_file_aside()
+{
+    struct stat st;
+    if (stat(state.init_args.path, &st) != 0 || st.st_size == 0)
+        return 0;
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    long long now_ms = (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+
+    char rotated_path[PATH_MAX];
+    for (int i = 0; i < 1000; i++)
+    {
+        if (record_writer_rotate_path(state.init_args.path, now_ms + i, rotated_path, sizeof(rotated_path)) != 0)
+            return -1;
+        if (access(rotated_path, F_OK) != 0)
+            return rename(state.init_args.path, rotated_path) == 0 ? 0 : -1;
+    }
+    return -1;
+}
+
+/*
+    Move the pre-created file (if any) to the path of the file.
+*/
+static void use_next_file()
+{
+    if (!state.precreate)
+        return;
+
+    pthread_mutex_lock(&state.lock);
+    if (state.next_ready && access(state.init_args.path, F_OK) != 0)
+    {
+        if (rename(state.next_path, state.init_args.path) == 0)
+            state.next_ready = 0;
+    }
+    pthread_mutex_unlock(&state.lock);
+}
+
+static void open_writers()
+{
+    clock_gettime(CLOCK_MONOTONIC, &state.opened_at);
+    state.bytes_written = 0;
+    state.writer = state.init_args.open(state.init_args.ctx);
+}
+
+/*
+    Close 'old_writer', move the file aside and reopen the writers. Runs on the
+    helper thread so that writes go on (into 'pending') meanwhile.
+*/
+static void rotate_on_helper(const struct record_writer *old_writer)
+{
+    int failed = 0;
+    if (old_writer)
+        old_writer->close();
+
+    // The writers are opened even if the file could not be moved so that no records are lost.
+    if (move_file_aside() != 0)
+        failed = 1;
+    use_next_file();
+    const struct record_writer *new_writer = state.init_args.open(state.init_args.ctx);
+
+    pthread_mutex_lock(&state.lock);
+    state.new_writer = new_writer;
+    state.new_failed = failed || !new_writer;
+    state.rotating = 0;
+    pthread_cond_broadcast(&state.rotated_cond);
+    pthread_mutex_unlock(&state.lock);
+}
+
+/*
+    Hand the writers over to the helper thread to rotate the file.
+*/
+static void start_rotation()
+{
+    rotate_requested = 0;
+
+    pthread_mutex_lock(&state.lock);
+    state.old_writer = state.writer;
+    state.new_writer = NULL;
+    state.new_failed = 0;
+    state.rotating = 1;
+    state.rotate_pending = 1;
+    pthread_cond_signal(&state.cond);
+    pthread_mutex_unlock(&state.lock);
+
+    state.writer = NULL;
+    state.in_rotation = 1;
+}
+
+/*
+    Take the writers reopened by the helper thread and write the records kept
+    meanwhile. Wait for the rotation if 'wait' is set.
+*/
+static void finish_rotation(int wait)
+{
+    if (!state.in_rotation)
+        return;
+
+    pthread_mutex_lock(&state.lock);
+    while (wait && state.rotating)
+        pthread_cond_wait(&state.rotated_cond, &state.lock);
+    int done = !state.rotating;
+    const struct record_writer *new_writer = state.new_writer;
+    int failed = state.new_failed;
+    pthread_mutex_unlock(&state.lock);
+    if (!done)
+        return;
+
+    state.in_rotation = 0;
+    clock_gettime(CLOCK_MONOTONIC, &state.opened_at);
+    state.bytes_written = 0;
+    state.writer = new_writer;
+    if (failed)
+        state.rotate_failed = 1;
+
+    size_t offset = 0;
+    while (state.writer && offset < state.pending_len)
+    {
+        size_t len;
+        memcpy(&len, &state.pending[offset], sizeof(size_t));
+        offset += sizeof(size_t);
+        int result = state.writer->write(&state.pending[offset], len);
+        if (result > 0)
+            state.bytes_written += result;
+        offset += len;
+    }
+    state.pending_len = 0;
+}
+
+/*
+    Keep a record written during a rotation.
+
+    Return:
+        0  => Success
+        -1 => Failure (the buffer is full)
+*/
+static int keep_pending(void *data, size_t data_len)
+{
+    size_t needed = state.pending_len + sizeof(size_t) + data_len;
+    if (needed > ROTATE_WRITER_PENDING_MAX_SIZE)
+        return -1;
+
+    if (needed > state.pending_cap)
+    {
+        size_t cap = state.pending_cap ? state.pending_cap : 64 * 1024;
+        while (cap < needed)
+            cap *= 2;
+        char *grown = realloc(state.pending, cap);
+        if (!grown)
+            return -1;
+        state.pending = grown;
+        state.pending_cap = cap;
+    }
+
+    memcpy(&state.pending[state.pending_len], &data_len, sizeof(size_t));
+    memcpy(&state.pending[state.pending_len + sizeof(size_t)], data, data_len);
+    state.pending_len = needed;
+    return 0;
+}
+
+static int is_rotation_due(size_t data_len)
+{
+    if (!state.writer)
+        return elapsed_ms(&state.opened_at) >= ROTATE_WRITER_REOPEN_INTERVAL_MS;
+
+    if (rotate_requested)
+        return 1;
+
+    struct output_rotation *r = &state.init_args.rotation;
+    if (r->max_size > 0 && state.bytes_written > 0 && state.bytes_written + data_len > r->max_size)
+        return 1;
+    if (r->interval_sec > 0 && elapsed_ms(&state.opened_at) >= r->interval_sec * 1000)
+        return 1;
+    return 0;
+}
+
+
+static int set_init_args_rotate(void *ptr, size_t ptr_len) {
+    if (ptr_len != sizeof(struct rotate_writer_args))
+        return -1;
+
+    struct rotate_writer_args *in = (struct rotate_writer_args *)ptr;
+
+    if (!in->open || strlen(in->path) == 0 || strlen(in->path) >= PATH_MAX)
+        return -1;
+
+    if (in->rotation.interval_sec < 0 || in->rotation.retain < 0)
+        return -1;
+
+    memcpy(&state.init_args, in, sizeof(struct rotate_writer_args));
+    return 0;
+}
+
+static int init_rotate() {
+    if (state.initialized)
+        return 0;
+
+    const char *path = state.init_args.path;
+    const char *name, *ext;
+    split_path(path, &name, &ext);
+    int len = snprintf(state.next_path, sizeof(state.next_path), "%.*s.%s.next", (int)(name - path), path, name);
+    if (len < 0 || (size_t)len >= sizeof(state.next_path))
+        return -1;
+
+    // Never truncate or append to the output of an earlier run.
+    if (move_file_aside() != 0)
+        return -1;
+
+    rotate_requested = 0;
+    state.rotate_failed = 0;
+    open_writers();
+    if (!state.writer)
+        return -1;
+
+    struct output_rotation *r = &state.init_args.rotation;
+    state.precreate = r->max_size > 0 || r->interval_sec > 0;
+    state.next_ready = 0;
+    state.exiting = 0;
+    state.helper_pending = state.precreate || r->retain > 0;
+    state.rotate_pending = 0;
+    state.rotating = 0;
+    state.in_rotation = 0;
+    state.pending_len = 0;
+    pthread_mutex_init(&state.lock, NULL);
+    pthread_cond_init(&state.cond, NULL);
+    pthread_cond_init(&state.rotated_cond, NULL);
+    // Always started as a rotation can be requested at any time.
+    if (start_helper() != 0)
+    {
+        pthread_cond_destroy(&state.rotated_cond);
+        pthread_cond_destroy(&state.cond);
+        pthread_mutex_destroy(&state.lock);
+        state.writer->close();
+        state.writer = NULL;
+        return -1;
+    }
+
+    state.initialized = 1;
+    return 0;
+}
+
+static int close_rotate() {
+    if (state.initialized) {
+        finish_rotation(1);
+        if (state.writer)
+            state.writer->close();
+        state.writer = NULL;
+
+        pthread_mutex_lock(&state.lock);
+        state.exiting = 1;
+        pthread_cond_broadcast(&state.cond);
+        pthread_mutex_unlock(&state.lock);
+        pthread_join(state.helper, NULL);
+        if (state.precreate)
+            unlink(state.next_path);
+
+        free(state.pending);
+        state.pending = NULL;
+        state.pending_len = 0;
+        state.pending_cap = 0;
+
+        pthread_cond_destroy(&state.rotated_cond);
+        pthread_cond_destroy(&state.cond);
+        pthread_mutex_destroy(&state.lock);
+        state.initialized = 0;
+    }
+    return 0;
+}
+
+static int write_rotate(void *data, size_t data_len) {
+    if (!state.initialized)
+        return -2;
+
+    finish_rotation(0);
+    if (!state.in_rotation && is_rotation_due(data_len))
+        start_rotation();
+
+    if (state.in_rotation)
+    {
+        if (keep_pending(data, data_len) == 0)
+            return (int)data_len;
+        finish_rotation(1);
+    }
+
+    if (!state.writer)
+        return -1;
+
+    int result = state.writer->write(data, data_len);
+    if (result > 0)
+        state.bytes_written += result;
+    return result;
+}
+
+static int flush_rotate(int force) {
+    if (!state.initialized)
+        return -2;
+
+    finish_rotation(force);
+    if (!state.in_rotation && is_rotation_due(0))
+    {
+        start_rotation();
+        finish_rotation(force);
+    }
+
+    // Flushed once the rotation is done.
+    if (state.in_rotation)
+        return 0;
+
+    if (!state.writer)
+    {
+        state.rotate_failed = 0;
+        return -1;
+    }
+
+    int result = state.writer->flush(force);
+    if (state.rotate_failed)
+    {
+        state.rotate_failed = 0;
+        return -1;
+    }
+    return result;
+}
+
+
+const struct record_writer record_writer_rotate = {
+    .set_init_args = set_init_args_rotate,
+    .init = init_rotate,
+    .close = close_rotate,
+    .write = write_rotate,
+    .flush = flush_rotate
+};
\ No newline at end of file
@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/*
+
+    A module to rotate the output file without stalling the writer.
+
+    'record_writer_rotate' sits in front of the writers of an output file. It
+    opens them through the 'open' callback, which also writes any header (i.e.
+    serializer header or columnar schema), so that every file can be read on
+    its own.
+
+    A rotation closes the writers, which ends any compression frame, renames
+    the file to '<dir>/<name>.<YYYYmmdd-HHMMSS-mmm><ext>' where '<ext>' is
+    everything from the first '.' of the file name, and opens the writers again
+    over a new file. Since the file is only renamed once it is complete, a
+    reader never sees a partial rotated file.
+
+    A rotation is started before a write when the bytes written to the current
+    file would exceed 'max_size', or at a write or flush once the file is older
+    than 'interval_sec' or a rotation was requested (i.e. on SIGHUP). If the
+    file was already moved by someone else (e.g. logrotate) it is just opened
+    again.
+
+    A non-empty file found at 'path' on init is rotated first so that a restart
+    never truncates or appends to earlier output.
+
+    The rotation itself runs on a helper thread so that the writes never wait
+    for the close (i.e. end of compression, pending io_uring writes) or the
+    reopen. The writes made meanwhile are kept in memory (up to 64 MiB, beyond
+    which they wait for the rotation) and written to the new file once it is
+    open, so a file can exceed 'max_size' by them. A forced flush waits for the
+    rotation. The helper thread also pre-creates the next file (as
+    '<dir>/.<name>.next') and deletes the rotated files beyond 'retain'.
+
+*/
+
+#include <limits.h>
+#include <stddef.h>
+
+#include "user/types.h"
+#include "user/record/writer/writer.h"
+
+
+/*
+    Length of the timestamp in the name of a rotated file i.e. 'YYYYmmdd-HHMMSS-mmm' (UTC).
+*/
+#define ROTATE_WRITER_STAMP_LEN 19
+
+
+/*
+    Init args of 'record_writer_rotate'.
+*/
+struct rotate_writer_args
+{
+    /*
+        Open the writers of the file at 'path' and write any header.
+        Called with 'ctx' on init and, on the helper thread, after every
+        rotation.
+
+        Return:
+            The outermost writer. Closed by 'record_writer_rotate'.
+            NULL => Failure
+    */
+    const struct record_writer *(*open)(void *ctx);
+    void *ctx;
+    char path[PATH_MAX];
+    struct output_rotation rotation;
+};
+
+
+/*
+    Request a rotation at the next write or flush. Async-signal-safe.
+*/
+void record_writer_rotate_request();
+
+/*
+    Get the path a file rotated at 'now_ms' (ms since epoch) is renamed to.
+
+    Return:
+        0  => Success
+        -1 => The path does not fit in 'dst'
+*/
+int record_writer_rotate_path(const char *path, long long now_ms, char *dst, size_t dst_len);
\ No newline at end of file
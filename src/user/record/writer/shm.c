@@ -0,0 +1,369 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// For memfd_create and accept4.
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+
+#include "user/record/writer/shm.h"
+
+
+#define SHM_WRITER_PAGE_SIZE 4096
+
+#define ALIGN_UP(n, a) (((n) + (a) - 1) & ~((uint64_t)(a) - 1))
+
+
+static struct {
+    int initialized;
+    struct shm_writer_args init_args;
+
+    int memfd;
+    unsigned char *map;
+    size_t map_len;
+    struct shm_ring_header *ring;
+    unsigned char *data;
+    // Own copy of 'ring->head'.
+    uint64_t head;
+
+    int listen_fd;
+    // The connection of the attached reader, if any. Only used by the listener.
+    int reader_fd;
+    // Written to stop the listener.
+    int stop_fd;
+    pthread_t listener;
+} state = {0};
+
+
+static void wake_reader()
+{
+    __atomic_fetch_add(&state.ring->wake_seq, 1, __ATOMIC_SEQ_CST);
+    syscall(SYS_futex, &state.ring->wake_seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/*
+    Send the memfd to a reader.
+
+    Return:
+        0  => Success
+        -1 => Error
+*/
+static int send_memfd(int fd)
+{
+    char byte = 0;
+    struct iovec iov = { .iov_base = &byte, .iov_len = 1 };
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    memset(&control, 0, sizeof(control));
+
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &state.memfd, sizeof(int));
+
+    return sendmsg(fd, &msg, MSG_NOSIGNAL) == 1 ? 0 : -1;
+}
+
+static void accept_reader()
+{
+    int fd = accept4(state.listen_fd, NULL, NULL, SOCK_CLOEXEC);
+    if (fd < 0)
+        return;
+
+    // One reader at a time. Others are turned away by closing the connection.
+    if (state.reader_fd >= 0 || send_memfd(fd) != 0)
+    {
+        close(fd);
+        return;
+    }
+    state.reader_fd = fd;
+}
+
+static void detach_reader()
+{
+    close(state.reader_fd);
+    state.reader_fd = -1;
+    // A reader gone while waiting must not cost the writer wakeups.
+    __atomic_store_n(&state.ring->reader_waiting, 0, __ATOMIC_SEQ_CST);
+}
+
+/*
+    Hand the ring to readers, and notice when they are gone.
+*/
+static void *listener_main(void *arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        struct pollfd fds[3] = {
+            { .fd = state.stop_fd, .events = POLLIN },
+            { .fd = state.listen_fd, .events = POLLIN },
+            { .fd = state.reader_fd, .events = POLLIN },
+        };
+        int nfds = state.reader_fd >= 0 ? 3 : 2;
+        if (poll(fds, nfds, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        if (fds[0].revents)
+            break;
+        if (fds[1].revents & POLLIN)
+            accept_reader();
+        if (nfds == 3 && fds[2].revents)
+        {
+            // Readers send nothing, so anything but data means the reader is gone.
+            char byte;
+            ssize_t n = recv(state.reader_fd, &byte, 1, MSG_DONTWAIT);
+            if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR))
+                detach_reader();
+        }
+    }
+    return NULL;
+}
+
+static int set_init_args_shm(void *ptr, size_t ptr_len) {
+    if (ptr_len != sizeof(struct shm_writer_args))
+        return -1;
+
+    struct shm_writer_args *in = (struct shm_writer_args *)ptr;
+
+    struct sockaddr_un addr;
+    if (in->output.path[0] != '/' || strlen(in->output.path) >= sizeof(addr.sun_path))
+        return -1;
+    if (in->output.size < SHM_WRITER_PAGE_SIZE || (in->output.size & (in->output.size - 1)) != 0)
+        return -1;
+    if (in->header_len > sizeof(in->header))
+        return -1;
+
+    memcpy(&state.init_args, in, sizeof(struct shm_writer_args));
+    return 0;
+}
+
+static int open_listener()
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, state.init_args.output.path);
+
+    // Replace a socket left behind by a previous run, but nothing else.
+    struct stat st;
+    if (lstat(addr.sun_path, &st) == 0 && S_ISSOCK(st.st_mode))
+        unlink(addr.sun_path);
+
+    state.listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (state.listen_fd < 0)
+        return -1;
+    if (bind(state.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(state.listen_fd, 4) != 0)
+    {
+        close(state.listen_fd);
+        state.listen_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+static int open_ring()
+{
+    size_t size = state.init_args.output.size;
+    size_t data_offset = ALIGN_UP(sizeof(struct shm_ring_header), SHM_WRITER_PAGE_SIZE);
+
+    state.memfd = memfd_create("ameba-shm", MFD_CLOEXEC);
+    if (state.memfd < 0)
+        return -1;
+
+    state.map_len = data_offset + size;
+    if (ftruncate(state.memfd, state.map_len) != 0)
+        goto err;
+    state.map = mmap(NULL, state.map_len, PROT_READ | PROT_WRITE, MAP_SHARED, state.memfd, 0);
+    if (state.map == MAP_FAILED)
+        goto err;
+
+    state.ring = (struct shm_ring_header *)state.map;
+    state.data = state.map + data_offset;
+    state.ring->magic = SHM_RING_MAGIC;
+    state.ring->version = SHM_RING_VERSION;
+    state.ring->size = size;
+    state.ring->data_offset = data_offset;
+    state.ring->header_len = state.init_args.header_len;
+    memcpy(state.ring->header, state.init_args.header, state.init_args.header_len);
+    state.head = 0;
+    return 0;
+
+err:
+    close(state.memfd);
+    state.memfd = -1;
+    state.map = NULL;
+    return -1;
+}
+
+static void close_ring()
+{
+    munmap(state.map, state.map_len);
+    close(state.memfd);
+    state.map = NULL;
+    state.ring = NULL;
+    state.data = NULL;
+    state.memfd = -1;
+}
+
+static int init_shm() {
+    if (state.initialized) return 0;
+
+    if (open_ring() != 0)
+        return -1;
+    if (open_listener() != 0)
+        goto err_ring;
+
+    state.reader_fd = -1;
+    state.stop_fd = eventfd(0, EFD_CLOEXEC);
+    if (state.stop_fd < 0)
+        goto err_listener;
+    if (pthread_create(&state.listener, NULL, listener_main, NULL) != 0)
+        goto err_stop;
+
+    state.initialized = 1;
+    return 0;
+
+err_stop:
+    close(state.stop_fd);
+err_listener:
+    close(state.listen_fd);
+    unlink(state.init_args.output.path);
+err_ring:
+    close_ring();
+    return -1;
+}
+
+static int close_shm() {
+    if (state.initialized) {
+        __atomic_store_n(&state.ring->closed, 1, __ATOMIC_SEQ_CST);
+        wake_reader();
+
+        uint64_t one = 1;
+        if (write(state.stop_fd, &one, sizeof(one)) != sizeof(one))
+            pthread_cancel(state.listener);
+        pthread_join(state.listener, NULL);
+
+        if (state.reader_fd >= 0)
+            close(state.reader_fd);
+        close(state.stop_fd);
+        close(state.listen_fd);
+        unlink(state.init_args.output.path);
+        // An attached reader keeps its own map of the ring.
+        close_ring();
+        state.initialized = 0;
+    }
+    return 0;
+}
+
+static void drop(size_t data_len)
+{
+    __atomic_store_n(&state.ring->dropped_records, state.ring->dropped_records + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&state.ring->dropped_bytes, state.ring->dropped_bytes + data_len, __ATOMIC_RELAXED);
+}
+
+static int write_shm(void *data, size_t data_len) {
+    if (!state.initialized)
+        return -2;
+
+    uint64_t size = state.ring->size;
+    uint64_t entry_len = ALIGN_UP(sizeof(struct shm_ring_entry) + data_len, SHM_RING_ALIGN);
+    if (data_len >= SHM_RING_ENTRY_PAD || entry_len > size)
+    {
+        drop(data_len);
+        return (int)data_len;
+    }
+
+    uint64_t head = state.head;
+    uint64_t tail = __atomic_load_n(&state.ring->tail, __ATOMIC_ACQUIRE);
+    uint64_t pos = head & (size - 1);
+    uint64_t to_end = size - pos;
+    // An entry not fitting before the end starts over at the start of the ring.
+    uint64_t need = entry_len <= to_end ? entry_len : to_end + entry_len;
+    if (head + need - tail > size)
+    {
+        drop(data_len);
+        return (int)data_len;
+    }
+
+    if (entry_len > to_end)
+    {
+        struct shm_ring_entry *pad = (struct shm_ring_entry *)(state.data + pos);
+        pad->len = SHM_RING_ENTRY_PAD;
+        pad->reserved = 0;
+        head += to_end;
+        pos = 0;
+    }
+
+    struct shm_ring_entry *entry = (struct shm_ring_entry *)(state.data + pos);
+    entry->len = (uint32_t)data_len;
+    entry->reserved = 0;
+    memcpy(entry + 1, data, data_len);
+    state.head = head + entry_len;
+
+    // Publish before checking for a waiting reader, which checks 'head' after setting 'reader_waiting'.
+    __atomic_store_n(&state.ring->head, state.head, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&state.ring->reader_waiting, __ATOMIC_SEQ_CST))
+        wake_reader();
+
+    return (int)data_len;
+}
+
+static int flush_shm(int force) {
+    (void)force;
+    if (!state.initialized)
+        return -2;
+    // Entries are visible to the reader once written.
+    return 0;
+}
+
+const struct record_writer record_writer_shm = {
+    .set_init_args = set_init_args_shm,
+    .init = init_shm,
+    .close = close_shm,
+    .write = write_shm,
+    .flush = flush_shm,
+};
\ No newline at end of file
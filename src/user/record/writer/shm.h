@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/*
+
+    A module to write records to a ring in shared memory that a co-located
+    consumer reads in place (see 'record_shm_reader').
+
+    'record_writer_shm' creates the ring in a memfd and listens on a unix
+    socket at 'path'. A reader connecting to it is sent the memfd (SCM_RIGHTS)
+    and maps the ring. One reader is attached at a time, for as long as its
+    connection stays open. A reader attaching later continues after the last
+    entry released by the previous one.
+
+    Every record written is one entry of the ring, stored as it was serialized
+    (i.e. binary records are passed through untouched). An entry is a
+    'struct shm_ring_entry' followed by the record, padded to SHM_RING_ALIGN
+    bytes, and never wraps around the end of the ring so that it can be read in
+    place. A record that does not fit while the ring is full is dropped and
+    counted in the ring header, so a stalled reader never stalls the writer.
+
+    The writer publishes entries by advancing 'head' and the reader releases
+    them by advancing 'tail', both byte positions that only grow. A reader
+    waiting for entries sets 'reader_waiting' and waits on the 'wake_seq'
+    futex, which the writer bumps once it has published.
+
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "user/types.h"
+#include "user/record/writer/writer.h"
+#include "user/record/serializer/serializer.h"
+
+
+#define SHM_RING_MAGIC 0x474e5241
+#define SHM_RING_VERSION 1
+
+/*
+    Alignment (bytes) of the entries in the ring.
+*/
+#define SHM_RING_ALIGN 8
+
+/*
+    Length of an entry that marks the rest of the ring up to its end as unused.
+*/
+#define SHM_RING_ENTRY_PAD UINT32_MAX
+
+
+struct shm_ring_entry
+{
+    uint32_t len;
+    uint32_t reserved;
+};
+
+/*
+    The start of the memfd. The ring follows at 'data_offset'.
+*/
+struct shm_ring_header
+{
+    uint32_t magic;
+    uint32_t version;
+    // Size (bytes) of the ring, a power of 2.
+    uint64_t size;
+    uint64_t data_offset;
+    // Stream header of the records, if any (e.g. 'record_stream_header').
+    uint64_t header_len;
+    char header[RECORD_SERIALIZER_MAX_HEADER_LEN];
+
+    // Written by the writer.
+    uint64_t head __attribute__((aligned(64)));
+    uint64_t dropped_records;
+    uint64_t dropped_bytes;
+    uint32_t wake_seq;
+    // Set once the writer is closed i.e. no more entries follow.
+    uint32_t closed;
+
+    // Written by the reader.
+    uint64_t tail __attribute__((aligned(64)));
+    uint32_t reader_waiting;
+};
+
+
+/*
+    Init args of 'record_writer_shm'.
+*/
+struct shm_writer_args
+{
+    struct output_shm output;
+    // Stored in the ring header.
+    char header[RECORD_SERIALIZER_MAX_HEADER_LEN];
+    size_t header_len;
+};
\ No newline at end of file
@@ -0,0 +1,957 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "user/record/writer/spill.h"
+
+
+#define SPILL_SEGMENT_MAGIC 0x4c505341
+#define SPILL_SEGMENT_VERSION 1
+
+// Alignment of the records in the queue, and length marking the padding at its end.
+#define SPILL_MEM_ALIGN 8
+#define SPILL_MEM_PAD UINT32_MAX
+
+#define STATS_ADD(field, n) __atomic_fetch_add(&state.stats.field, (n), __ATOMIC_RELAXED)
+#define STATS_SUB(field, n) __atomic_fetch_sub(&state.stats.field, (n), __ATOMIC_RELAXED)
+#define STATS_SET(field, v) __atomic_store_n(&state.stats.field, (v), __ATOMIC_RELAXED)
+
+
+/*
+    Length prefix of a record in a segment or in the queue.
+*/
+typedef uint32_t spill_len_t;
+
+/*
+    Start of a segment file. The records follow at SPILL_WRITER_SEGMENT_HEADER_SIZE.
+*/
+struct spill_segment_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;
+    // 1 once 'used', 'records' and 'checksum' are final.
+    uint32_t sealed;
+    // Order of the segment. 0 if the segment holds no records.
+    uint64_t seq;
+    // Bytes (with the length prefixes) and records in the segment.
+    uint64_t used;
+    uint64_t records;
+    // Bytes at the start of the segment already replayed.
+    uint64_t start;
+    uint64_t checksum;
+};
+
+struct spill_segment
+{
+    int fd;
+    char *map;
+    struct spill_segment_header *hdr;
+    char *data;
+    // Bytes written. Read by the replay thread while the segment is written.
+    unsigned long used;
+    // Records written.
+    unsigned long written;
+    // Records, and their bytes without the length prefixes, not replayed.
+    unsigned long records;
+    unsigned long data_bytes;
+    // Bytes at the start of the segment already replayed in a previous run.
+    unsigned long start;
+    // Set under 'lock' once nothing is written to the segment anymore.
+    int sealed;
+};
+
+static struct {
+    int initialized;
+    struct spill_writer_args init_args;
+
+    struct spill_segment *segments;
+    size_t count;
+    // Bytes of a segment after its header.
+    size_t capacity;
+    uint64_t next_seq;
+
+    // Segments with records, oldest first. The first one is replayed, and the
+    // last one is written if not sealed. Under 'lock'.
+    size_t *queue;
+    size_t queue_head;
+    size_t queue_len;
+    // Segments without records. Under 'lock'.
+    size_t *free;
+    size_t free_len;
+    // Segment being written. Only used by the writing thread.
+    struct spill_segment *active;
+    // Records in segments not replayed or dropped yet. Records only go through
+    // the queue while 0, so that they are passed in order.
+    unsigned long spilled;
+
+    // Records passed to the replay thread in memory. 'mem_head' is only
+    // written by the writing thread, 'mem_tail' by the replay thread.
+    char *mem;
+    size_t mem_size;
+    uint64_t mem_head;
+    uint64_t mem_tail;
+    // Offset of the next record to replay in the first queued segment. Only
+    // used by the replay thread.
+    unsigned long replay_off;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    // Set while the replay thread waits for records.
+    int replay_waiting;
+    int flush_requested;
+    int exiting;
+    // Set by the replay thread. Reported by the next write or flush.
+    int write_failed;
+
+    struct output_spill_stats stats;
+} state = {0};
+
+
+void record_writer_spill_get_stats(struct output_spill_stats *dst)
+{
+    dst->spill_bytes = __atomic_load_n(&state.stats.spill_bytes, __ATOMIC_RELAXED);
+    dst->spill_segments = __atomic_load_n(&state.stats.spill_segments, __ATOMIC_RELAXED);
+    dst->replayed_bytes = __atomic_load_n(&state.stats.replayed_bytes, __ATOMIC_RELAXED);
+    dst->dropped_records = __atomic_load_n(&state.stats.dropped_records, __ATOMIC_RELAXED);
+    dst->dropped_bytes = __atomic_load_n(&state.stats.dropped_bytes, __ATOMIC_RELAXED);
+    dst->recovered_segments = __atomic_load_n(&state.stats.recovered_segments, __ATOMIC_RELAXED);
+    dst->discarded_segments = __atomic_load_n(&state.stats.discarded_segments, __ATOMIC_RELAXED);
+}
+
+/*
+    Fletcher-4 checksum of the 32-bit words of the data (the last one zero padded).
+*/
+static uint64_t checksum(const char *data, size_t len)
+{
+    uint64_t a = 0, b = 0, c = 0, d = 0;
+    for (size_t off = 0; off < len; off += sizeof(uint32_t))
+    {
+        uint32_t w = 0;
+        memcpy(&w, data + off, len - off < sizeof(w) ? len - off : sizeof(w));
+        a += w;
+        b += a;
+        c += b;
+        d += c;
+    }
+    return a ^ (b << 16) ^ (c << 32) ^ (d << 48) ^ (d >> 16);
+}
+
+static void deadline_after_ms(struct timespec *dst, long ms)
+{
+    clock_gettime(CLOCK_REALTIME, dst);
+    dst->tv_sec += ms / 1000;
+    dst->tv_nsec += (ms % 1000) * 1000000L;
+    dst->tv_sec += dst->tv_nsec / 1000000000L;
+    dst->tv_nsec %= 1000000000L;
+}
+
+static spill_len_t record_len(struct spill_segment *seg, unsigned long off)
+{
+    spill_len_t len;
+    memcpy(&len, seg->data + off, sizeof(len));
+    return len;
+}
+
+
+static struct spill_segment *queued_segment(size_t i)
+{
+    return &state.segments[state.queue[(state.queue_head + i) % state.count]];
+}
+
+static void queue_push(struct spill_segment *seg)
+{
+    state.queue[(state.queue_head + state.queue_len) % state.count] = seg - state.segments;
+    state.queue_len++;
+    STATS_SET(spill_segments, state.queue_len);
+}
+
+/*
+    Mark the segment as holding no records and make it reusable.
+*/
+static void release_segment(struct spill_segment *seg)
+{
+    seg->hdr->sealed = 0;
+    seg->hdr->seq = 0;
+    seg->used = 0;
+    seg->written = 0;
+    seg->records = 0;
+    seg->data_bytes = 0;
+    seg->start = 0;
+    seg->sealed = 0;
+    state.free[state.free_len++] = seg - state.segments;
+}
+
+/*
+    Release the first queued segment once replayed. Called with 'lock' held.
+*/
+static void release_head()
+{
+    release_segment(queued_segment(0));
+    state.queue_head = (state.queue_head + 1) % state.count;
+    state.queue_len--;
+    STATS_SET(spill_segments, state.queue_len);
+    state.replay_off = state.queue_len > 0 ? queued_segment(0)->start : 0;
+    pthread_cond_broadcast(&state.cond);
+}
+
+/*
+    Drop the oldest segment that is not being replayed to bound the disk usage.
+    Called with 'lock' held when no segment is free, so at least 2 are queued.
+*/
+static void drop_oldest()
+{
+    struct spill_segment *seg = queued_segment(1);
+    for (size_t i = 1; i + 1 < state.queue_len; i++)
+        state.queue[(state.queue_head + i) % state.count] = state.queue[(state.queue_head + i + 1) % state.count];
+    state.queue_len--;
+    STATS_SET(spill_segments, state.queue_len);
+
+    __atomic_fetch_sub(&state.spilled, seg->records, __ATOMIC_RELAXED);
+    STATS_ADD(dropped_records, seg->records);
+    STATS_ADD(dropped_bytes, seg->data_bytes);
+    STATS_SUB(spill_bytes, seg->data_bytes);
+    release_segment(seg);
+}
+
+/*
+    Seal the segment being written so that it is kept across runs.
+*/
+static void seal_active()
+{
+    struct spill_segment *seg = state.active;
+    state.active = NULL;
+
+    seg->hdr->used = seg->used;
+    seg->hdr->records = seg->written;
+    seg->hdr->start = 0;
+    seg->hdr->checksum = checksum(seg->data, seg->used);
+
+    pthread_mutex_lock(&state.lock);
+    seg->hdr->sealed = 1;
+    seg->sealed = 1;
+    pthread_cond_broadcast(&state.cond);
+    pthread_mutex_unlock(&state.lock);
+}
+
+/*
+    Start writing to a free segment, dropping the oldest records if none is.
+*/
+static void open_active()
+{
+    pthread_mutex_lock(&state.lock);
+    if (state.free_len == 0)
+        drop_oldest();
+    struct spill_segment *seg = &state.segments[state.free[--state.free_len]];
+
+    memset(seg->hdr, 0, sizeof(*seg->hdr));
+    seg->hdr->magic = SPILL_SEGMENT_MAGIC;
+    seg->hdr->version = SPILL_SEGMENT_VERSION;
+    seg->hdr->format = state.init_args.format;
+    seg->hdr->seq = state.next_seq++;
+    queue_push(seg);
+    pthread_mutex_unlock(&state.lock);
+
+    state.active = seg;
+}
+
+/*
+    Append the record to the segment being written and publish it to the replay thread.
+*/
+static void append_record(const void *data, size_t data_len)
+{
+    struct spill_segment *seg = state.active;
+    spill_len_t len = (spill_len_t)data_len;
+    memcpy(seg->data + seg->used, &len, sizeof(len));
+    memcpy(seg->data + seg->used + sizeof(len), data, data_len);
+    seg->written++;
+    __atomic_fetch_add(&seg->records, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&seg->data_bytes, data_len, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&state.spilled, 1, __ATOMIC_RELAXED);
+    STATS_ADD(spill_bytes, data_len);
+    __atomic_store_n(&seg->used, seg->used + sizeof(len) + data_len, __ATOMIC_SEQ_CST);
+}
+
+/*
+    Spill the record, starting a new segment if it does not fit in the one
+    being written.
+
+    Return:
+        0  => Success
+        -1 => The record never fits in a segment
+*/
+static int spill_record(const void *data, size_t data_len)
+{
+    size_t need = sizeof(spill_len_t) + data_len;
+    if (need > state.capacity)
+        return -1;
+
+    if (state.active && state.active->used + need > state.capacity)
+        seal_active();
+    if (!state.active)
+        open_active();
+    append_record(data, data_len);
+    return 0;
+}
+
+
+static uint64_t mem_entry_len(size_t data_len)
+{
+    return (sizeof(spill_len_t) + data_len + SPILL_MEM_ALIGN - 1) & ~(uint64_t)(SPILL_MEM_ALIGN - 1);
+}
+
+/*
+    Queue the record in memory for the replay thread.
+
+    Return:
+        0  => Success
+        -1 => The queue is full
+*/
+static int mem_push(const void *data, size_t data_len)
+{
+    uint64_t entry_len = mem_entry_len(data_len);
+    uint64_t head = state.mem_head;
+    uint64_t tail = __atomic_load_n(&state.mem_tail, __ATOMIC_ACQUIRE);
+    size_t pos = head & (state.mem_size - 1);
+    size_t to_end = state.mem_size - pos;
+
+    // A record never wraps: the rest of the queue is skipped if it does not fit.
+    uint64_t need = entry_len <= to_end ? entry_len : to_end + entry_len;
+    if (data_len >= SPILL_MEM_PAD || entry_len > state.mem_size || head + need - tail > state.mem_size)
+        return -1;
+
+    if (entry_len > to_end)
+    {
+        spill_len_t pad = SPILL_MEM_PAD;
+        memcpy(state.mem + pos, &pad, sizeof(pad));
+        head += to_end;
+        pos = 0;
+    }
+    spill_len_t len = (spill_len_t)data_len;
+    memcpy(state.mem + pos, &len, sizeof(len));
+    memcpy(state.mem + pos + sizeof(len), data, data_len);
+    // Publish the record to the replay thread.
+    __atomic_store_n(&state.mem_head, head + entry_len, __ATOMIC_SEQ_CST);
+    return 0;
+}
+
+/*
+    Get the record at 'tail' in the queue.
+
+    Return:
+        The offset of the next record. 'data' is NULL if 'tail' is at the padding.
+*/
+static uint64_t mem_record(uint64_t tail, char **data, spill_len_t *len)
+{
+    size_t pos = tail & (state.mem_size - 1);
+    memcpy(len, state.mem + pos, sizeof(*len));
+    if (*len == SPILL_MEM_PAD)
+    {
+        *data = NULL;
+        return tail + (state.mem_size - pos);
+    }
+    *data = state.mem + pos + sizeof(*len);
+    return tail + mem_entry_len(*len);
+}
+
+static int mem_empty()
+{
+    return __atomic_load_n(&state.mem_head, __ATOMIC_SEQ_CST) == __atomic_load_n(&state.mem_tail, __ATOMIC_SEQ_CST);
+}
+
+
+/*
+    Replay the records of the first queued segment up to 'end' to the wrapped writer.
+
+    Return:
+        0  => Success
+        -1 => A write to the wrapped writer failed
+*/
+static int replay(struct spill_segment *seg, unsigned long end)
+{
+    int err = 0;
+    unsigned long off = state.replay_off;
+    while (off < end && !__atomic_load_n(&state.exiting, __ATOMIC_RELAXED))
+    {
+        spill_len_t len = record_len(seg, off);
+        if (state.init_args.writer->write(seg->data + off + sizeof(len), len) < 0)
+            err = -1;
+        off += sizeof(len) + len;
+
+        // The records of the first queued segment are never dropped.
+        __atomic_fetch_sub(&seg->records, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_sub(&seg->data_bytes, len, __ATOMIC_RELAXED);
+        // The writing thread goes back to the queue once this is 0.
+        __atomic_fetch_sub(&state.spilled, 1, __ATOMIC_RELEASE);
+        STATS_SUB(spill_bytes, len);
+        STATS_ADD(replayed_bytes, len);
+    }
+    state.replay_off = off;
+    return err;
+}
+
+/*
+    Pass the records of the queue up to 'head' to the wrapped writer.
+
+    Return:
+        0  => Success
+        -1 => A write to the wrapped writer failed
+*/
+static int replay_mem(uint64_t head)
+{
+    int err = 0;
+    uint64_t tail = state.mem_tail;
+    while (tail != head && !__atomic_load_n(&state.exiting, __ATOMIC_RELAXED))
+    {
+        char *data;
+        spill_len_t len;
+        uint64_t next = mem_record(tail, &data, &len);
+        if (data && state.init_args.writer->write(data, len) < 0)
+            err = -1;
+        tail = next;
+        // Give the space back to the writing thread.
+        __atomic_store_n(&state.mem_tail, tail, __ATOMIC_RELEASE);
+    }
+    return err;
+}
+
+static void *spill_main(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&state.lock);
+    while (!state.exiting)
+    {
+        struct spill_segment *seg = state.queue_len > 0 ? queued_segment(0) : NULL;
+        unsigned long end = seg ? __atomic_load_n(&seg->used, __ATOMIC_SEQ_CST) : 0;
+        uint64_t head = __atomic_load_n(&state.mem_head, __ATOMIC_SEQ_CST);
+        int force = state.flush_requested;
+        state.flush_requested = 0;
+
+        // The records in memory are older than those not replayed in the segments.
+        if (head != state.mem_tail)
+        {
+            pthread_mutex_unlock(&state.lock);
+            int err = replay_mem(head);
+            if (state.init_args.writer->flush(force) == -1)
+                err = -1;
+            pthread_mutex_lock(&state.lock);
+            if (err)
+                __atomic_store_n(&state.write_failed, 1, __ATOMIC_RELAXED);
+            // Wake up close waiting for the records in memory to be passed.
+            pthread_cond_broadcast(&state.cond);
+            continue;
+        }
+
+        if (seg && state.replay_off < end)
+        {
+            pthread_mutex_unlock(&state.lock);
+            int err = replay(seg, end);
+            // Without force the wrapped writer only flushes if its flush policy requires it.
+            if (state.init_args.writer->flush(force) == -1)
+                err = -1;
+            pthread_mutex_lock(&state.lock);
+            if (err)
+                __atomic_store_n(&state.write_failed, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        if (seg && seg->sealed)
+        {
+            release_head();
+            state.flush_requested |= force;
+            continue;
+        }
+
+        if (!force)
+        {
+            // The writing thread only signals while this is set. Check again after setting it.
+            __atomic_store_n(&state.replay_waiting, 1, __ATOMIC_SEQ_CST);
+            int timed_out = 0;
+            if ((!seg || __atomic_load_n(&seg->used, __ATOMIC_SEQ_CST) == state.replay_off) && mem_empty())
+            {
+                struct timespec deadline;
+                deadline_after_ms(&deadline, SPILL_WRITER_IDLE_MS);
+                timed_out = pthread_cond_timedwait(&state.cond, &state.lock, &deadline) == ETIMEDOUT;
+            }
+            __atomic_store_n(&state.replay_waiting, 0, __ATOMIC_SEQ_CST);
+            if (!timed_out)
+                continue;
+        }
+
+        pthread_mutex_unlock(&state.lock);
+        int err = state.init_args.writer->flush(force) == -1;
+        pthread_mutex_lock(&state.lock);
+        if (err)
+            __atomic_store_n(&state.write_failed, 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&state.lock);
+    return NULL;
+}
+
+/*
+    Wake up the replay thread if it waits for records.
+*/
+static void notify_replay()
+{
+    if (__atomic_load_n(&state.replay_waiting, __ATOMIC_SEQ_CST))
+    {
+        pthread_mutex_lock(&state.lock);
+        pthread_cond_broadcast(&state.cond);
+        pthread_mutex_unlock(&state.lock);
+    }
+}
+
+/*
+    Return:
+        1 => A write failed since the last call
+        0 => No write failed
+*/
+static int take_write_failed()
+{
+    if (!__atomic_load_n(&state.write_failed, __ATOMIC_RELAXED))
+        return 0;
+    pthread_mutex_lock(&state.lock);
+    int write_failed = state.write_failed;
+    __atomic_store_n(&state.write_failed, 0, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&state.lock);
+    return write_failed;
+}
+
+
+/*
+    Check the records of a sealed segment of a previous run, and count those
+    not replayed yet.
+
+    Return:
+        0  => The segment is valid
+        -1 => The segment must be discarded
+*/
+static int check_segment(struct spill_segment *seg)
+{
+    struct spill_segment_header *hdr = seg->hdr;
+    if (hdr->magic != SPILL_SEGMENT_MAGIC || hdr->version != SPILL_SEGMENT_VERSION
+        || hdr->format != state.init_args.format || !hdr->sealed || hdr->seq == 0
+        || hdr->used > state.capacity || hdr->start > hdr->used)
+        return -1;
+
+    if (checksum(seg->data, hdr->used) != hdr->checksum)
+        return -1;
+
+    // The records must fill the segment, and 'start' must be at one of them (or the end).
+    unsigned long off = 0;
+    int start_found = 0;
+    seg->written = 0;
+    seg->records = 0;
+    seg->data_bytes = 0;
+    while (1)
+    {
+        if (off == hdr->start)
+            start_found = 1;
+        if (off == hdr->used)
+            break;
+        if (hdr->used - off < sizeof(spill_len_t))
+            return -1;
+        spill_len_t len = record_len(seg, off);
+        if (len > hdr->used - off - sizeof(spill_len_t))
+            return -1;
+        if (start_found)
+        {
+            seg->records++;
+            seg->data_bytes += len;
+        }
+        off += sizeof(spill_len_t) + len;
+        seg->written++;
+    }
+    if (!start_found || seg->written != hdr->records)
+        return -1;
+
+    seg->used = hdr->used;
+    seg->start = hdr->start;
+    seg->sealed = 1;
+    return 0;
+}
+
+static int compare_segment_seq(const void *a, const void *b)
+{
+    uint64_t seq_a = state.segments[*(const size_t *)a].hdr->seq;
+    uint64_t seq_b = state.segments[*(const size_t *)b].hdr->seq;
+    return seq_a < seq_b ? -1 : seq_a > seq_b;
+}
+
+/*
+    Queue the segments of a previous run that hold records not replayed, oldest
+    first, and free the others.
+*/
+static void recover_segments()
+{
+    state.queue_head = 0;
+    state.queue_len = 0;
+    state.free_len = 0;
+    state.next_seq = 1;
+    state.spilled = 0;
+
+    size_t recovered = 0;
+    for (size_t i = 0; i < state.count; i++)
+    {
+        struct spill_segment *seg = &state.segments[i];
+        if (check_segment(seg) != 0)
+        {
+            if (seg->hdr->seq != 0)
+                STATS_ADD(discarded_segments, 1);
+            memset(seg->hdr, 0, sizeof(*seg->hdr));
+            release_segment(seg);
+        }
+        else if (seg->records == 0)
+        {
+            release_segment(seg);
+        }
+        else
+        {
+            state.queue[recovered++] = i;
+            if (seg->hdr->seq >= state.next_seq)
+                state.next_seq = seg->hdr->seq + 1;
+            STATS_ADD(spill_bytes, seg->data_bytes);
+            state.spilled += seg->records;
+        }
+    }
+
+    qsort(state.queue, recovered, sizeof(size_t), compare_segment_seq);
+    state.queue_len = recovered;
+    STATS_SET(spill_segments, state.queue_len);
+    STATS_SET(recovered_segments, recovered);
+    state.replay_off = recovered > 0 ? queued_segment(0)->start : 0;
+}
+
+static void close_segments()
+{
+    for (size_t i = 0; state.segments && i < state.count; i++)
+    {
+        struct spill_segment *seg = &state.segments[i];
+        if (seg->map)
+            munmap(seg->map, state.init_args.spill.segment_size);
+        if (seg->fd >= 0)
+            close(seg->fd);
+    }
+    free(state.segments);
+    free(state.queue);
+    free(state.free);
+    state.segments = NULL;
+    state.queue = NULL;
+    state.free = NULL;
+}
+
+/*
+    Open the segment file, creating it as needed, and map it.
+
+    Return:
+        0  => Success
+        -1 => Failure
+*/
+static int open_segment(struct spill_segment *seg, size_t i)
+{
+    struct output_spill *spill = &state.init_args.spill;
+    char path[PATH_MAX];
+    if (snprintf(path, sizeof(path), "%s/spill-%05zu.seg", spill->dir, i) >= (int)sizeof(path))
+        return -1;
+
+    seg->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0640);
+    if (seg->fd < 0)
+        return -1;
+
+    // Another process spilling to the same files would corrupt them.
+    if (flock(seg->fd, LOCK_EX | LOCK_NB) != 0)
+        return -1;
+
+    // Allocate the disk space now. Writing to a hole through the mapping
+    // raises SIGBUS when the disk is full.
+    if (ftruncate(seg->fd, spill->segment_size) != 0
+        || posix_fallocate(seg->fd, 0, spill->segment_size) != 0)
+        return -1;
+
+    char *map = mmap(NULL, spill->segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, seg->fd, 0);
+    if (map == MAP_FAILED)
+        return -1;
+    seg->map = map;
+    seg->hdr = (struct spill_segment_header *)map;
+    seg->data = map + SPILL_WRITER_SEGMENT_HEADER_SIZE;
+    return 0;
+}
+
+/*
+    Open all the segment files.
+
+    Return:
+        0  => Success
+        -1 => Failure. Everything is closed.
+*/
+static int open_segments()
+{
+    struct output_spill *spill = &state.init_args.spill;
+    if (mkdir(spill->dir, 0750) != 0 && errno != EEXIST)
+        return -1;
+
+    state.count = spill->max_size / spill->segment_size;
+    state.capacity = spill->segment_size - SPILL_WRITER_SEGMENT_HEADER_SIZE;
+    state.segments = calloc(state.count, sizeof(struct spill_segment));
+    state.queue = calloc(state.count, sizeof(size_t));
+    state.free = calloc(state.count, sizeof(size_t));
+    if (!state.segments || !state.queue || !state.free)
+    {
+        close_segments();
+        return -1;
+    }
+    for (size_t i = 0; i < state.count; i++)
+        state.segments[i].fd = -1;
+
+    for (size_t i = 0; i < state.count; i++)
+    {
+        if (open_segment(&state.segments[i], i) != 0)
+        {
+            close_segments();
+            return -1;
+        }
+    }
+    return 0;
+}
+
+
+static int set_init_args_spill(void *ptr, size_t ptr_len) {
+    if (ptr_len != sizeof(struct spill_writer_args))
+        return -1;
+
+    struct spill_writer_args *in = (struct spill_writer_args *)ptr;
+    struct output_spill *spill = &(in->spill);
+
+    if (!in->writer || spill->dir[0] != '/'
+        || spill->segment_size <= SPILL_WRITER_SEGMENT_HEADER_SIZE + sizeof(spill_len_t)
+        || spill->segment_size - SPILL_WRITER_SEGMENT_HEADER_SIZE > UINT32_MAX
+        || spill->max_size / spill->segment_size < 2)
+        return -1;
+
+    // A power of 2 so that the offsets of the queue wrap around.
+    if (in->queue_size != 0 && (in->queue_size < 64 || (in->queue_size & (in->queue_size - 1)) != 0))
+        return -1;
+
+    memcpy(&state.init_args, in, sizeof(struct spill_writer_args));
+    if (state.init_args.queue_size == 0)
+        state.init_args.queue_size = SPILL_WRITER_DEFAULT_QUEUE_SIZE;
+    return 0;
+}
+
+static int init_spill() {
+    if (state.initialized)
+        return 0;
+
+    memset(&state.stats, 0, sizeof(state.stats));
+    state.mem_size = state.init_args.queue_size;
+    state.mem = malloc(state.mem_size);
+    if (!state.mem)
+        return -1;
+    state.mem_head = 0;
+    state.mem_tail = 0;
+    if (open_segments() != 0)
+    {
+        free(state.mem);
+        state.mem = NULL;
+        return -1;
+    }
+    recover_segments();
+
+    state.active = NULL;
+    state.replay_waiting = 0;
+    state.flush_requested = 0;
+    state.exiting = 0;
+    state.write_failed = 0;
+    pthread_mutex_init(&state.lock, NULL);
+    pthread_cond_init(&state.cond, NULL);
+    if (pthread_create(&state.thread, NULL, spill_main, NULL) != 0)
+    {
+        pthread_cond_destroy(&state.cond);
+        pthread_mutex_destroy(&state.lock);
+        close_segments();
+        free(state.mem);
+        state.mem = NULL;
+        return -1;
+    }
+
+    state.initialized = 1;
+    return 0;
+}
+
+static void swap_queued(size_t i, size_t j)
+{
+    size_t *a = &state.queue[(state.queue_head + i) % state.count];
+    size_t *b = &state.queue[(state.queue_head + j) % state.count];
+    size_t tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+static void reverse_queued(size_t from, size_t to)
+{
+    while (from + 1 < to)
+        swap_queued(from++, --to);
+}
+
+/*
+    Spill the records left in memory once the replay thread is stopped, so that
+    they are replayed at the next init. They are older than the spilled ones,
+    so their segments are queued first. They are dropped if no segment is free.
+*/
+static void spill_mem()
+{
+    size_t old_len = state.queue_len;
+    uint64_t tail = state.mem_tail;
+    while (tail != state.mem_head)
+    {
+        char *data;
+        spill_len_t len;
+        tail = mem_record(tail, &data, &len);
+        if (!data)
+            continue;
+
+        if (state.active && state.active->used + sizeof(len) + len > state.capacity)
+            seal_active();
+        if ((!state.active && state.free_len == 0) || spill_record(data, len) != 0)
+        {
+            STATS_ADD(dropped_records, 1);
+            STATS_ADD(dropped_bytes, len);
+        }
+    }
+    state.mem_tail = tail;
+    if (state.active)
+        seal_active();
+
+    // Move the new segments before the old ones, and renumber them in that order.
+    if (state.queue_len == old_len)
+        return;
+    reverse_queued(0, old_len);
+    reverse_queued(old_len, state.queue_len);
+    reverse_queued(0, state.queue_len);
+    for (size_t i = 0; i < state.queue_len; i++)
+        queued_segment(i)->hdr->seq = i + 1;
+}
+
+static int close_spill() {
+    if (state.initialized) {
+        if (state.active)
+            seal_active();
+
+        struct timespec deadline;
+        deadline_after_ms(&deadline, SPILL_WRITER_CLOSE_TIMEOUT_MS);
+
+        pthread_mutex_lock(&state.lock);
+        state.flush_requested = 1;
+        pthread_cond_broadcast(&state.cond);
+        while (state.queue_len > 0 || !mem_empty())
+        {
+            if (pthread_cond_timedwait(&state.cond, &state.lock, &deadline) == ETIMEDOUT)
+                break;
+        }
+        __atomic_store_n(&state.exiting, 1, __ATOMIC_RELAXED);
+        pthread_cond_broadcast(&state.cond);
+        pthread_mutex_unlock(&state.lock);
+
+        if (state.init_args.stop_writer)
+            state.init_args.stop_writer();
+        pthread_join(state.thread, NULL);
+
+        // Replay the rest from there at the next init.
+        if (state.queue_len > 0)
+            queued_segment(0)->hdr->start = state.replay_off;
+        spill_mem();
+
+        pthread_cond_destroy(&state.cond);
+        pthread_mutex_destroy(&state.lock);
+        close_segments();
+        free(state.mem);
+        state.mem = NULL;
+        state.init_args.writer->close();
+        state.initialized = 0;
+    }
+    return 0;
+}
+
+static int write_spill(void *data, size_t data_len) {
+    if (!state.initialized)
+        return -2;
+
+    if (data_len == 0)
+        return 0;
+
+    // Only spill while the wrapped writer does not keep up with the queue.
+    if (__atomic_load_n(&state.spilled, __ATOMIC_ACQUIRE) > 0 || mem_push(data, data_len) != 0)
+    {
+        if (spill_record(data, data_len) != 0)
+        {
+            STATS_ADD(dropped_records, 1);
+            STATS_ADD(dropped_bytes, data_len);
+            return (int)data_len;
+        }
+    }
+    notify_replay();
+
+    // Failures of the wrapped writer are only known now.
+    if (take_write_failed())
+        return -1;
+
+    return (int)data_len;
+}
+
+static int flush_spill(int force) {
+    if (!state.initialized)
+        return -2;
+
+    // The records are replayed as soon as they are written. The wrapped
+    // writer is flushed by the replay thread.
+    if (force)
+    {
+        pthread_mutex_lock(&state.lock);
+        state.flush_requested = 1;
+        pthread_cond_broadcast(&state.cond);
+        pthread_mutex_unlock(&state.lock);
+    }
+
+    if (take_write_failed())
+        return -1;
+
+    return 0;
+}
+
+
+const struct record_writer record_writer_spill = {
+    .set_init_args = set_init_args_spill,
+    .init = init_spill,
+    .close = close_spill,
+    .write = write_spill,
+    .flush = flush_spill
+};
\ No newline at end of file
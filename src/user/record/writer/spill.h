@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/*
+
+    A module to spill records to disk while another writer does not take them.
+
+    'record_writer_spill' wraps another writer. Records written to it are
+    passed in order to the wrapped writer by a separate thread, through a queue
+    in memory. Therefore the thread writing the records only pays for a copy,
+    even while the wrapped writer waits for its output (e.g. the TCP writer for
+    its collector).
+
+    Once the queue is full, i.e. the wrapped writer does not keep up, records
+    are appended to segment files mapped in memory instead, and replayed from
+    there. Records are spilled until all the spilled ones are replayed, so that
+    they stay in order.
+
+    'max_size / segment_size' segment files are created in 'dir' when the
+    writer is initialized, with their disk space allocated up front, and are
+    reused in turn. When all of them are full, the oldest segment that is not
+    being replayed is dropped.
+
+    A full segment is sealed with a checksum of its records. On close, the
+    writer waits up to 'SPILL_WRITER_CLOSE_TIMEOUT_MS' for the records to be
+    passed, the segment being written is sealed too, and the records left in
+    the queue are spilled ahead of the other segments. Sealed segments that
+    are left are replayed when the writer is next initialized, starting from
+    the first record that was not replayed. Segments that are not sealed (e.g.
+    after a crash), fail the checksum, or hold another format are discarded.
+
+    The wrapped writer must only be used through 'record_writer_spill' once
+    wrapped since it is written from the replay thread. Records handed to it
+    are not spilled again if they are lost afterwards.
+
+*/
+
+#include <stddef.h>
+
+#include "user/types.h"
+#include "user/record/writer/writer.h"
+
+
+/*
+    Bytes at the start of a segment file before its records.
+*/
+#define SPILL_WRITER_SEGMENT_HEADER_SIZE 64
+
+/*
+    Default size (bytes) of the queue of records passed to the wrapped writer.
+*/
+#define SPILL_WRITER_DEFAULT_QUEUE_SIZE (4 * 1024 * 1024)
+
+/*
+    Max time (ms) the replay thread waits for records before it flushes the
+    wrapped writer without force.
+*/
+#define SPILL_WRITER_IDLE_MS 50
+
+/*
+    Max time (ms) waited on close for the spilled records to be replayed.
+*/
+#define SPILL_WRITER_CLOSE_TIMEOUT_MS 2000
+
+
+/*
+    Init args of 'record_writer_spill'.
+*/
+struct spill_writer_args
+{
+    // The writer to replay the records to. Must be initialized.
+    // Closed by 'record_writer_spill.close'.
+    const struct record_writer *writer;
+    // Called on close (if set) so that a write to 'writer' waiting for its
+    // output returns. Must be safe to call from any thread.
+    void (*stop_writer)();
+    // 'dir' must be an absolute path. Holds at least 2 segments.
+    struct output_spill spill;
+    // Format of the records. Segments spilled with another format are discarded.
+    unsigned int format;
+    // Size (bytes) of the queue in memory. A power of 2, at least 64.
+    // 'SPILL_WRITER_DEFAULT_QUEUE_SIZE' if 0.
+    size_t queue_size;
+};
+
+
+/*
+    Get the counters of the writer. Can be called from any thread.
+*/
+void record_writer_spill_get_stats(struct output_spill_stats *dst);
\ No newline at end of file
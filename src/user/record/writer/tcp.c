@@ -0,0 +1,548 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "user/record/writer/tcp.h"
+
+
+/*
+    Length prefix of a record in the spool.
+*/
+typedef uint32_t spool_len_t;
+
+/*
+    Max iovecs sent with a single 'sendmsg'.
+*/
+#define TCP_WRITER_IOVECS 64
+
+/*
+    Max time (ms) a blocked write waits for the socket at once.
+*/
+#define TCP_WRITER_BLOCK_POLL_MS 100
+
+#define STATS_ADD(field, n) __atomic_fetch_add(&state.stats.field, (n), __ATOMIC_RELAXED)
+#define STATS_SET(field, v) __atomic_store_n(&state.stats.field, (v), __ATOMIC_RELAXED)
+
+
+typedef enum {
+    TCP_CONN_DISCONNECTED = 1,
+    TCP_CONN_CONNECTING,
+    TCP_CONN_CONNECTED
+} tcp_conn_t;
+
+static volatile sig_atomic_t stop_blocking = 0;
+
+static struct {
+    int initialized;
+    struct tcp_writer_args init_args;
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+
+    int fd;
+    tcp_conn_t conn;
+    long backoff_ms;
+    long long next_connect_ms;
+    // Bytes of the header sent on the current connection.
+    size_t header_sent;
+
+    // Records, each prefixed by its spool_len_t, between positions 'head' and 'tail'.
+    char *spool;
+    size_t spool_size;
+    unsigned long long head;
+    unsigned long long tail;
+    unsigned long records;
+    // Bytes of the first record sent on the current connection.
+    size_t head_sent;
+    // When the spool last went from empty to not empty.
+    struct timespec first_spooled;
+
+    struct output_spool_stats stats;
+} state = {0};
+
+
+void record_writer_tcp_stop_blocking()
+{
+    stop_blocking = 1;
+}
+
+void record_writer_tcp_get_stats(struct output_spool_stats *dst)
+{
+    dst->spool_bytes = __atomic_load_n(&state.stats.spool_bytes, __ATOMIC_RELAXED);
+    dst->spool_records = __atomic_load_n(&state.stats.spool_records, __ATOMIC_RELAXED);
+    dst->dropped_records = __atomic_load_n(&state.stats.dropped_records, __ATOMIC_RELAXED);
+    dst->dropped_bytes = __atomic_load_n(&state.stats.dropped_bytes, __ATOMIC_RELAXED);
+    dst->bytes_sent = __atomic_load_n(&state.stats.bytes_sent, __ATOMIC_RELAXED);
+    dst->connects = __atomic_load_n(&state.stats.connects, __ATOMIC_RELAXED);
+    dst->disconnects = __atomic_load_n(&state.stats.disconnects, __ATOMIC_RELAXED);
+}
+
+static long long monotonic_ms()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static long elapsed_ms(struct timespec *since)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - since->tv_sec) * 1000 + (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+
+static size_t spool_used()
+{
+    return (size_t)(state.tail - state.head);
+}
+
+static void spool_copy_in(unsigned long long pos, const void *src, size_t len)
+{
+    size_t off = pos % state.spool_size;
+    size_t first = state.spool_size - off < len ? state.spool_size - off : len;
+    memcpy(state.spool + off, src, first);
+    memcpy(state.spool, (const char *)src + first, len - first);
+}
+
+static void spool_copy_out(unsigned long long pos, void *dst, size_t len)
+{
+    size_t off = pos % state.spool_size;
+    size_t first = state.spool_size - off < len ? state.spool_size - off : len;
+    memcpy(dst, state.spool + off, first);
+    memcpy((char *)dst + first, state.spool, len - first);
+}
+
+static spool_len_t spool_record_len(unsigned long long pos)
+{
+    spool_len_t len;
+    spool_copy_out(pos, &len, sizeof(len));
+    return len;
+}
+
+static void spool_pop()
+{
+    state.head += sizeof(spool_len_t) + spool_record_len(state.head);
+    state.head_sent = 0;
+    state.records--;
+}
+
+static void update_spool_stats()
+{
+    STATS_SET(spool_bytes, spool_used() - state.records * sizeof(spool_len_t));
+    STATS_SET(spool_records, state.records);
+}
+
+
+static void schedule_connect()
+{
+    state.next_connect_ms = monotonic_ms() + state.backoff_ms;
+    state.backoff_ms *= 2;
+    if (state.backoff_ms > state.init_args.output.reconnect_max_ms)
+        state.backoff_ms = state.init_args.output.reconnect_max_ms;
+}
+
+static void disconnect()
+{
+    if (state.fd >= 0)
+        close(state.fd);
+    state.fd = -1;
+    state.conn = TCP_CONN_DISCONNECTED;
+    STATS_ADD(disconnects, 1);
+    schedule_connect();
+}
+
+static void on_connected()
+{
+    state.conn = TCP_CONN_CONNECTED;
+    state.backoff_ms = state.init_args.output.reconnect_min_ms;
+    // A new stream. A partially sent record is sent again as a whole.
+    state.header_sent = 0;
+    state.head_sent = 0;
+    STATS_ADD(connects, 1);
+}
+
+static void start_connect()
+{
+    state.fd = socket(state.addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (state.fd < 0)
+    {
+        disconnect();
+        return;
+    }
+
+    // Records are already coalesced in the spool.
+    int one = 1;
+    setsockopt(state.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    if (connect(state.fd, (struct sockaddr *)&state.addr, state.addr_len) == 0)
+        on_connected();
+    else if (errno == EINPROGRESS)
+        state.conn = TCP_CONN_CONNECTING;
+    else
+        disconnect();
+}
+
+static void check_connect()
+{
+    struct pollfd p = { .fd = state.fd, .events = POLLOUT };
+    if (poll(&p, 1, 0) <= 0)
+        return;
+
+    int err = 0;
+    socklen_t err_len = sizeof(err);
+    if (getsockopt(state.fd, SOL_SOCKET, SO_ERROR, &err, &err_len) != 0 || err != 0)
+        disconnect();
+    else
+        on_connected();
+}
+
+/*
+    Make progress on (re)connecting without blocking.
+*/
+static void update_connection()
+{
+    if (state.conn == TCP_CONN_DISCONNECTED && monotonic_ms() >= state.next_connect_ms)
+        start_connect();
+    if (state.conn == TCP_CONN_CONNECTING)
+        check_connect();
+}
+
+/*
+    Advance past the 'sent' bytes of the header and the spool.
+*/
+static void consume_sent(size_t sent)
+{
+    size_t header_left = state.init_args.header_len - state.header_sent;
+    size_t n = sent < header_left ? sent : header_left;
+    state.header_sent += n;
+    sent -= n;
+
+    while (sent > 0)
+    {
+        size_t left = spool_record_len(state.head) - state.head_sent;
+        if (sent < left)
+        {
+            state.head_sent += sent;
+            break;
+        }
+        sent -= left;
+        spool_pop();
+    }
+}
+
+/*
+    Send as much of the header and the spool as the socket takes without blocking.
+*/
+static void send_spool()
+{
+    while (state.conn == TCP_CONN_CONNECTED)
+    {
+        struct iovec iov[TCP_WRITER_IOVECS];
+        int iovcnt = 0;
+
+        size_t header_left = state.init_args.header_len - state.header_sent;
+        if (header_left > 0)
+        {
+            iov[iovcnt].iov_base = &state.init_args.header[state.header_sent];
+            iov[iovcnt].iov_len = header_left;
+            iovcnt++;
+        }
+
+        // A record takes 2 iovecs if it wraps around the end of the spool.
+        unsigned long long pos = state.head;
+        size_t skip = state.head_sent;
+        while (iovcnt < TCP_WRITER_IOVECS - 1 && pos < state.tail)
+        {
+            spool_len_t len = spool_record_len(pos);
+            size_t off = (pos + sizeof(spool_len_t) + skip) % state.spool_size;
+            size_t left = len - skip;
+            size_t first = state.spool_size - off < left ? state.spool_size - off : left;
+            iov[iovcnt].iov_base = state.spool + off;
+            iov[iovcnt].iov_len = first;
+            iovcnt++;
+            if (left > first)
+            {
+                iov[iovcnt].iov_base = state.spool;
+                iov[iovcnt].iov_len = left - first;
+                iovcnt++;
+            }
+            pos += sizeof(spool_len_t) + len;
+            skip = 0;
+        }
+        if (iovcnt == 0)
+            break;
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovcnt;
+        ssize_t sent = sendmsg(state.fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                disconnect();
+            break;
+        }
+        STATS_ADD(bytes_sent, (unsigned long)sent);
+        consume_sent((size_t)sent);
+    }
+    update_spool_stats();
+}
+
+/*
+    Wait up to 'timeout_ms' for the socket to take data, or until the next
+    reconnect attempt is due. Returns early on a signal.
+*/
+static void wait_for_progress(long timeout_ms)
+{
+    if (state.conn == TCP_CONN_DISCONNECTED)
+    {
+        long long wait_ms = state.next_connect_ms - monotonic_ms();
+        if (wait_ms <= 0)
+            return;
+        if (wait_ms > timeout_ms)
+            wait_ms = timeout_ms;
+        struct timespec ts = { .tv_sec = wait_ms / 1000, .tv_nsec = (wait_ms % 1000) * 1000000 };
+        nanosleep(&ts, NULL);
+        return;
+    }
+
+    struct pollfd p = { .fd = state.fd, .events = POLLOUT };
+    poll(&p, 1, (int)timeout_ms);
+}
+
+/*
+    Make room for 'need' bytes in the spool as required by the spool policy.
+
+    Return:
+        0  => There is room
+        -1 => The new record must be dropped
+*/
+static int make_room(size_t need)
+{
+    while (state.spool_size - spool_used() < need)
+    {
+        enum output_spool_policy policy = state.init_args.output.spool_policy;
+        if (policy == OUTPUT_SPOOL_POLICY_BLOCK && stop_blocking)
+            policy = OUTPUT_SPOOL_POLICY_DROP_NEWEST;
+
+        switch (policy)
+        {
+            case OUTPUT_SPOOL_POLICY_BLOCK:
+                wait_for_progress(TCP_WRITER_BLOCK_POLL_MS);
+                update_connection();
+                send_spool();
+                break;
+            case OUTPUT_SPOOL_POLICY_DROP_OLDEST:
+                // The rest of a partially sent record must follow on the stream.
+                if (state.records == 0 || state.head_sent > 0)
+                    return -1;
+                STATS_ADD(dropped_records, 1);
+                STATS_ADD(dropped_bytes, spool_record_len(state.head));
+                spool_pop();
+                break;
+            default:
+                return -1;
+        }
+    }
+    return 0;
+}
+
+
+static int set_init_args_tcp(void *ptr, size_t ptr_len) {
+    if (ptr_len != sizeof(struct tcp_writer_args))
+        return -1;
+
+    struct tcp_writer_args *in = (struct tcp_writer_args *)ptr;
+    struct output_tcp *o_tcp = &(in->output);
+
+    if (o_tcp->spool_size < sizeof(spool_len_t) + 1 || in->header_len > sizeof(in->header))
+        return -1;
+
+    if (o_tcp->reconnect_min_ms < 1 || o_tcp->reconnect_max_ms < o_tcp->reconnect_min_ms)
+        return -1;
+
+    switch (o_tcp->spool_policy)
+    {
+        case OUTPUT_SPOOL_POLICY_BLOCK:
+        case OUTPUT_SPOOL_POLICY_DROP_OLDEST:
+        case OUTPUT_SPOOL_POLICY_DROP_NEWEST:
+            break;
+        default:
+            return -1;
+    }
+
+    memset(&state.addr, 0, sizeof(state.addr));
+    if (o_tcp->ip_family == AF_INET)
+    {
+        struct sockaddr_in *addr4 = (struct sockaddr_in *)&state.addr;
+        if (!inet_pton(AF_INET, &(o_tcp->ip[0]), &(addr4->sin_addr)))
+            return -1;
+        addr4->sin_family = AF_INET;
+        addr4->sin_port = htons(o_tcp->port);
+        state.addr_len = sizeof(struct sockaddr_in);
+    }
+    else if (o_tcp->ip_family == AF_INET6)
+    {
+        struct sockaddr_in6 *addr6 = (struct sockaddr_in6 *)&state.addr;
+        if (!inet_pton(AF_INET6, &(o_tcp->ip[0]), &(addr6->sin6_addr)))
+            return -1;
+        addr6->sin6_family = AF_INET6;
+        addr6->sin6_port = htons(o_tcp->port);
+        state.addr_len = sizeof(struct sockaddr_in6);
+    }
+    else
+    {
+        return -2;
+    }
+
+    memcpy(&state.init_args, in, sizeof(struct tcp_writer_args));
+    return 0;
+}
+
+static int init_tcp() {
+    if (state.initialized)
+        return 0;
+
+    state.spool_size = state.init_args.output.spool_size;
+    state.spool = malloc(state.spool_size);
+    if (!state.spool)
+        return -1;
+
+    state.head = 0;
+    state.tail = 0;
+    state.records = 0;
+    state.head_sent = 0;
+    memset(&state.stats, 0, sizeof(state.stats));
+    stop_blocking = 0;
+
+    // The collector may not be up yet. Records are spooled until it is.
+    state.fd = -1;
+    state.conn = TCP_CONN_DISCONNECTED;
+    state.backoff_ms = state.init_args.output.reconnect_min_ms;
+    state.next_connect_ms = monotonic_ms();
+    update_connection();
+
+    state.initialized = 1;
+    return 0;
+}
+
+static int close_tcp() {
+    if (state.initialized) {
+        long long deadline_ms = monotonic_ms() + TCP_WRITER_CLOSE_TIMEOUT_MS;
+        while (state.records > 0)
+        {
+            update_connection();
+            send_spool();
+            long long left_ms = deadline_ms - monotonic_ms();
+            if (state.records == 0 || left_ms <= 0)
+                break;
+            wait_for_progress(left_ms < TCP_WRITER_BLOCK_POLL_MS ? left_ms : TCP_WRITER_BLOCK_POLL_MS);
+        }
+
+        // Whatever is left is lost.
+        STATS_ADD(dropped_records, state.records);
+        STATS_ADD(dropped_bytes, spool_used() - state.records * sizeof(spool_len_t));
+        state.head = state.tail;
+        state.records = 0;
+        update_spool_stats();
+
+        if (state.fd >= 0)
+            close(state.fd);
+        state.fd = -1;
+        free(state.spool);
+        state.spool = NULL;
+        state.initialized = 0;
+    }
+    return 0;
+}
+
+static int write_tcp(void *data, size_t data_len) {
+    if (!state.initialized)
+        return -2;
+
+    if (data_len == 0)
+        return 0;
+
+    update_connection();
+
+    size_t need = sizeof(spool_len_t) + data_len;
+    if (need > state.spool_size || make_room(need) != 0)
+    {
+        STATS_ADD(dropped_records, 1);
+        STATS_ADD(dropped_bytes, data_len);
+        return (int)data_len;
+    }
+
+    if (state.records == 0)
+        clock_gettime(CLOCK_MONOTONIC, &state.first_spooled);
+
+    spool_len_t len = (spool_len_t)data_len;
+    spool_copy_in(state.tail, &len, sizeof(len));
+    spool_copy_in(state.tail + sizeof(len), data, data_len);
+    state.tail += need;
+    state.records++;
+
+    if (spool_used() >= TCP_WRITER_SEND_SIZE)
+        send_spool();
+    else
+        update_spool_stats();
+
+    return (int)data_len;
+}
+
+static int flush_tcp(int force) {
+    if (!state.initialized)
+        return -2;
+
+    update_connection();
+    if (state.records == 0)
+        return 0;
+
+    unsigned long bytes_sent = state.stats.bytes_sent;
+    long flush_interval_ms = state.init_args.output.flush_interval_ms;
+    if (force || (flush_interval_ms > 0 && elapsed_ms(&state.first_spooled) >= flush_interval_ms))
+        send_spool();
+
+    return (int)(state.stats.bytes_sent - bytes_sent);
+}
+
+
+const struct record_writer record_writer_tcp = {
+    .set_init_args = set_init_args_tcp,
+    .init = init_tcp,
+    .close = close_tcp,
+    .write = write_tcp,
+    .flush = flush_tcp
+};
\ No newline at end of file
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/*
+
+    A module to write records to a TCP collector without losing them over
+    short outages.
+
+    'record_writer_tcp' appends records to an in-memory spool and sends them
+    from it over a non-blocking socket, so a slow collector does not stall the
+    writer until the spool is full. Then 'spool_policy' decides whether the
+    writer waits for the collector, or drops the oldest spooled or the new
+    record.
+
+    Spooled records are sent once 'TCP_WRITER_SEND_SIZE' bytes are spooled, or
+    at a flush once they are older than 'flush_interval_ms'. When the
+    connection is lost, or cannot be established, the writer reconnects with an
+    exponential backoff between 'reconnect_min_ms' and 'reconnect_max_ms'
+    while the spool fills up.
+
+    Every connection starts with the stream header (if any), followed by the
+    spooled records starting from the first one that was not completely sent.
+    Records handed to the kernel before a connection is lost may still be lost.
+
+*/
+
+#include <stddef.h>
+
+#include "user/types.h"
+#include "user/record/writer/writer.h"
+#include "user/record/serializer/serializer.h"
+
+
+/*
+    Spooled bytes at which they are sent without waiting for a flush.
+*/
+#define TCP_WRITER_SEND_SIZE (64 * 1024)
+
+/*
+    Max time (ms) waited on close for the spool to be sent.
+*/
+#define TCP_WRITER_CLOSE_TIMEOUT_MS 2000
+
+
+/*
+    Init args of 'record_writer_tcp'.
+*/
+struct tcp_writer_args
+{
+    struct output_tcp output;
+    // Written at the start of every connection.
+    char header[RECORD_SERIALIZER_MAX_HEADER_LEN];
+    size_t header_len;
+};
+
+
+/*
+    Stop waiting for the collector i.e. behave as OUTPUT_SPOOL_POLICY_DROP_NEWEST
+    from now on, so that a shutdown is not stalled by a dead collector.
+    Async-signal-safe.
+*/
+void record_writer_tcp_stop_blocking();
+
+/*
+    Get the counters of the writer. Can be called from any thread.
+*/
+void record_writer_tcp_get_stats(struct output_spool_stats *dst);
\ No newline at end of file
@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Records are sent over a SOCK_SEQPACKET unix socket connected to a local
+    consumer, so they arrive reliably, in order, and with message boundaries
+    at record boundaries. Records are packed into messages of up to
+    'message_size' bytes without being split, since the serialized records
+    are self-delimiting. A message is sent when the next record does not fit,
+    or at a flush once the oldest packed record is older than
+    'flush_interval_ms'. A record larger than 'message_size' is sent on its own.
+
+    Sends wait while the consumer does not keep up. Once the consumer is gone,
+    writes fail until it is connected to again, which is attempted at most
+    every UNIX_WRITER_RECONNECT_MS. Every connection starts with a message
+    holding the stream header (if any).
+*/
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "user/record/writer/unix.h"
+
+
+#define UNIX_WRITER_RECONNECT_MS 1000
+
+
+static struct {
+    int sockfd;
+    struct sockaddr_un addr;
+    int initialized;
+    struct unix_writer_args init_args;
+    struct timespec last_connect;
+
+    // Packed records.
+    char *buf;
+    size_t packed;
+    struct timespec first_pack;
+} state = {0};
+
+
+static int set_init_args_unix(void *ptr, size_t ptr_len) {
+    if (ptr_len != sizeof(struct unix_writer_args))
+        return -1;
+
+    struct unix_writer_args *in = (struct unix_writer_args *)ptr;
+    struct output_unix *o_unix = &(in->output);
+
+    if (o_unix->path[0] != '/' || strlen(o_unix->path) >= sizeof(state.addr.sun_path)
+        || in->header_len > sizeof(in->header))
+        return -1;
+
+    memset(&state.addr, 0, sizeof(state.addr));
+    state.addr.sun_family = AF_UNIX;
+    strcpy(state.addr.sun_path, o_unix->path);
+
+    memcpy(&state.init_args, in, sizeof(struct unix_writer_args));
+    return 0;
+}
+
+static long elapsed_ms(struct timespec *since)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - since->tv_sec) * 1000 + (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+static void disconnect()
+{
+    close(state.sockfd);
+    state.sockfd = -1;
+}
+
+/*
+    Send the data as a single message on the current connection.
+
+    Return:
+        0  => Success
+        -1 => The send failed. Disconnected.
+*/
+static int send_connected(const void *data, size_t data_len)
+{
+    while (send(state.sockfd, data, data_len, MSG_NOSIGNAL) < 0)
+    {
+        if (errno == EINTR)
+            continue;
+        disconnect();
+        return -1;
+    }
+    return 0;
+}
+
+/*
+    Connect to the consumer unless connected, or attempted too recently, and
+    send it the header.
+
+    Return:
+        0  => Connected
+        -1 => Not connected
+*/
+static int ensure_connected()
+{
+    if (state.sockfd >= 0)
+        return 0;
+    if (elapsed_ms(&state.last_connect) < UNIX_WRITER_RECONNECT_MS)
+        return -1;
+
+    clock_gettime(CLOCK_MONOTONIC, &state.last_connect);
+    state.sockfd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (state.sockfd < 0)
+        return -1;
+    if (connect(state.sockfd, (struct sockaddr *)&state.addr, sizeof(state.addr)) != 0)
+    {
+        disconnect();
+        return -1;
+    }
+
+    // A new consumer cannot read the records without it.
+    if (state.init_args.header_len > 0)
+        return send_connected(state.init_args.header, state.init_args.header_len);
+    return 0;
+}
+
+/*
+    Send the data as a single message.
+
+    Return:
+        -1  => Not connected, or the send failed. The consumer is reconnected to later.
+        >=0 => The bytes sent
+*/
+static int send_message(const void *data, size_t data_len)
+{
+    if (ensure_connected() != 0 || send_connected(data, data_len) != 0)
+        return -1;
+    return (int)data_len;
+}
+
+/*
+    Send the packed records. They are dropped if they cannot be sent.
+
+    Return:
+        See 'send_message'.
+*/
+static int send_packed()
+{
+    if (state.packed == 0)
+        return 0;
+
+    int result = send_message(state.buf, state.packed);
+    state.packed = 0;
+    return result;
+}
+
+static int init_unix() {
+    if (state.initialized) return 0;
+
+    if (state.init_args.output.message_size > 0)
+    {
+        state.buf = malloc(state.init_args.output.message_size);
+        if (!state.buf)
+            return -1;
+    }
+    state.packed = 0;
+
+    // The consumer must be up at the start.
+    state.sockfd = -1;
+    state.last_connect.tv_sec = 0;
+    state.last_connect.tv_nsec = 0;
+    if (ensure_connected() != 0)
+    {
+        free(state.buf);
+        state.buf = NULL;
+        return -1;
+    }
+
+    state.initialized = 1;
+    return 0;
+}
+
+static int close_unix() {
+    if (state.initialized) {
+        send_packed();
+        free(state.buf);
+        state.buf = NULL;
+        if (state.sockfd >= 0)
+            close(state.sockfd);
+        state.sockfd = -1;
+        state.initialized = 0;
+    }
+    return 0;
+}
+
+static int write_unix(void *data, size_t data_len) {
+    if (!state.initialized)
+        return -2;
+
+    size_t message_size = state.init_args.output.message_size;
+    if (message_size == 0)
+        return send_message(data, data_len);
+
+    if (state.packed + data_len > message_size && send_packed() < 0)
+        return -1;
+
+    if (data_len > message_size)
+        return send_message(data, data_len);
+
+    if (state.packed == 0)
+        clock_gettime(CLOCK_MONOTONIC, &state.first_pack);
+    memcpy(state.buf + state.packed, data, data_len);
+    state.packed += data_len;
+
+    return (int)data_len;
+}
+
+static int flush_unix(int force) {
+    if (!state.initialized)
+        return -2;
+
+    if (state.packed == 0)
+        return 0;
+
+    long flush_interval_ms = state.init_args.output.flush_interval_ms;
+    if (force || (flush_interval_ms > 0 && elapsed_ms(&state.first_pack) >= flush_interval_ms))
+        return send_packed();
+
+    return 0;
+}
+
+const struct record_writer record_writer_unix = {
+    .set_init_args = set_init_args_unix,
+    .init = init_unix,
+    .close = close_unix,
+    .write = write_unix,
+    .flush = flush_unix,
+};
\ No newline at end of file
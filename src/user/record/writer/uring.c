@@ -0,0 +1,627 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+
+    A file record writer that submits writes asynchronously using io_uring.
+
+    Records are coalesced into a small ring of buffers registered with the
+    kernel. A full (or old enough) buffer is submitted as a single
+    IORING_OP_WRITE_FIXED at an explicit file offset, and the next buffer is
+    used for new records while the kernel writes the previous one. Therefore,
+    the ring buffer consumer only waits on the disk if all buffers are still
+    being written.
+
+*/
+
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#include "common/config.h"
+#include "user/record/writer/writer.h"
+#include "user/record/writer/buffer.h"
+#include "user/types.h"
+
+#ifdef HAVE_LINUX_IO_URING_H
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+
+#define URING_NUM_BUFFERS 8
+#define URING_DEFAULT_BUFFER_SIZE (256 * 1024)
+
+
+struct uring_buffer
+{
+    struct write_buffer w_buf;
+    int in_flight;
+    // Bytes of w_buf confirmed written by the kernel.
+    size_t completed;
+    // File offset of w_buf.buf[0].
+    off_t offset;
+};
+
+static struct {
+    int fd;
+    int ring_fd;
+    int initialized;
+    struct output_file init_args;
+
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    struct uring_buffer bufs[URING_NUM_BUFFERS];
+    int current;
+    int in_flight;
+    off_t offset;
+    int error;
+} state = {0};
+
+
+static int sys_io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int sys_io_uring_register(int ring_fd, unsigned opcode, void *arg, unsigned nr_args)
+{
+    return (int)syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+static int set_init_args_file_uring(void *ptr, size_t ptr_len) {
+    if (!ptr || ptr_len != sizeof(struct output_file))
+        return -1;
+
+    struct output_file *in = (struct output_file *)ptr;
+    if (strlen(in->path) == 0 || strlen(in->path) >= PATH_MAX)
+        return -1;
+
+    if (in->flush_policy.flush_interval_ms < 0)
+        return -1;
+
+    memcpy(&state.init_args, in, sizeof(struct output_file));
+    return 0;
+}
+
+static void unmap_ring() {
+    if (state.sqes)
+        munmap(state.sqes, state.sqes_size);
+    if (state.cq_ring && state.cq_ring != state.sq_ring)
+        munmap(state.cq_ring, state.cq_ring_size);
+    if (state.sq_ring)
+        munmap(state.sq_ring, state.sq_ring_size);
+    state.sqes = NULL;
+    state.cq_ring = NULL;
+    state.sq_ring = NULL;
+}
+
+static int map_ring(struct io_uring_params *p) {
+    state.sq_ring_size = p->sq_off.array + p->sq_entries * sizeof(unsigned);
+    state.cq_ring_size = p->cq_off.cqes + p->cq_entries * sizeof(struct io_uring_cqe);
+    if (p->features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (state.cq_ring_size > state.sq_ring_size)
+            state.sq_ring_size = state.cq_ring_size;
+        state.cq_ring_size = state.sq_ring_size;
+    }
+
+    state.sq_ring = mmap(NULL, state.sq_ring_size, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, state.ring_fd, IORING_OFF_SQ_RING);
+    if (state.sq_ring == MAP_FAILED)
+    {
+        state.sq_ring = NULL;
+        return -1;
+    }
+
+    if (p->features & IORING_FEAT_SINGLE_MMAP)
+    {
+        state.cq_ring = state.sq_ring;
+    }
+    else
+    {
+        state.cq_ring = mmap(NULL, state.cq_ring_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, state.ring_fd, IORING_OFF_CQ_RING);
+        if (state.cq_ring == MAP_FAILED)
+        {
+            state.cq_ring = NULL;
+            unmap_ring();
+            return -1;
+        }
+    }
+
+    state.sqes_size = p->sq_entries * sizeof(struct io_uring_sqe);
+    state.sqes = mmap(NULL, state.sqes_size, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, state.ring_fd, IORING_OFF_SQES);
+    if (state.sqes == MAP_FAILED)
+    {
+        state.sqes = NULL;
+        unmap_ring();
+        return -1;
+    }
+
+    char *sq = (char *)state.sq_ring;
+    state.sq_tail = (unsigned *)(sq + p->sq_off.tail);
+    state.sq_mask = (unsigned *)(sq + p->sq_off.ring_mask);
+    state.sq_array = (unsigned *)(sq + p->sq_off.array);
+
+    char *cq = (char *)state.cq_ring;
+    state.cq_head = (unsigned *)(cq + p->cq_off.head);
+    state.cq_tail = (unsigned *)(cq + p->cq_off.tail);
+    state.cq_mask = (unsigned *)(cq + p->cq_off.ring_mask);
+    state.cqes = (struct io_uring_cqe *)(cq + p->cq_off.cqes);
+
+    return 0;
+}
+
+static void free_buffers() {
+    for (int i = 0; i < URING_NUM_BUFFERS; i++)
+        write_buffer_free(&state.bufs[i].w_buf);
+}
+
+static int alloc_buffers(struct iovec *iovecs) {
+    size_t buffer_size = state.init_args.flush_policy.buffer_size;
+    if (buffer_size == 0)
+        buffer_size = URING_DEFAULT_BUFFER_SIZE;
+
+    for (int i = 0; i < URING_NUM_BUFFERS; i++)
+    {
+        struct uring_buffer *b = &state.bufs[i];
+        memset(b, 0, sizeof(struct uring_buffer));
+        if (write_buffer_init(&b->w_buf, buffer_size, state.init_args.flush_policy.flush_interval_ms) != 0)
+        {
+            free_buffers();
+            return -1;
+        }
+        iovecs[i].iov_base = b->w_buf.buf;
+        iovecs[i].iov_len = b->w_buf.size;
+    }
+    return 0;
+}
+
+/*
+    Queue a write of the unwritten part of the buffer and submit it to the kernel.
+
+    Return:
+        0  => Success
+        -1 => Failure
+*/
+static int submit_buffer(int index) {
+    struct uring_buffer *b = &state.bufs[index];
+
+    unsigned tail = *state.sq_tail;
+    unsigned sqe_index = tail & *state.sq_mask;
+    struct io_uring_sqe *sqe = &state.sqes[sqe_index];
+
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->opcode = IORING_OP_WRITE_FIXED;
+    sqe->flags = IOSQE_FIXED_FILE;
+    sqe->fd = 0;
+    sqe->addr = (unsigned long)(b->w_buf.buf + b->completed);
+    sqe->len = (unsigned)(b->w_buf.len - b->completed);
+    sqe->off = (unsigned long long)(b->offset + b->completed);
+    sqe->buf_index = (unsigned short)index;
+    sqe->user_data = (unsigned long long)index;
+
+    state.sq_array[sqe_index] = sqe_index;
+    __atomic_store_n(state.sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    int ret;
+    do {
+        ret = sys_io_uring_enter(state.ring_fd, 1, 0, 0);
+    } while (ret < 0 && errno == EINTR);
+
+    if (ret < 0)
+    {
+        // Take back the unsubmitted entry.
+        __atomic_store_n(state.sq_tail, tail, __ATOMIC_RELEASE);
+        return -1;
+    }
+
+    if (!b->in_flight)
+    {
+        b->in_flight = 1;
+        state.in_flight++;
+    }
+    return 0;
+}
+
+/*
+    Write all of 'buf' at 'offset' synchronously, continuing after short writes.
+
+    Return:
+        Bytes written. Less than 'len' on error.
+*/
+static size_t pwrite_all(const char *buf, size_t len, off_t offset) {
+    size_t done = 0;
+    while (done < len)
+    {
+        ssize_t written = pwrite(state.fd, buf + done, len - done, offset + done);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            break;
+        done += written;
+    }
+    return done;
+}
+
+/*
+    Hand over the buffer with the given index to the kernel at the current end
+    of the file.
+*/
+static int start_buffer_write(int index) {
+    struct uring_buffer *b = &state.bufs[index];
+    if (b->w_buf.len == 0 || b->in_flight)
+        return 0;
+
+    b->offset = state.offset;
+    b->completed = 0;
+    if (submit_buffer(index) != 0)
+    {
+        // Write synchronously to not lose the records.
+        size_t len = b->w_buf.len;
+        size_t written = pwrite_all(b->w_buf.buf, len, b->offset);
+        write_buffer_reset(&b->w_buf);
+        state.offset += written;
+        return written == len ? 0 : -1;
+    }
+    state.offset += b->w_buf.len;
+    return 0;
+}
+
+static void complete_buffer(struct uring_buffer *b) {
+    b->in_flight = 0;
+    b->completed = 0;
+    write_buffer_reset(&b->w_buf);
+    state.in_flight--;
+}
+
+/*
+    Process all available completions.
+*/
+static void reap_completions() {
+    unsigned head = *state.cq_head;
+    unsigned tail = __atomic_load_n(state.cq_tail, __ATOMIC_ACQUIRE);
+
+    while (head != tail)
+    {
+        struct io_uring_cqe *cqe = &state.cqes[head & *state.cq_mask];
+        int index = (int)cqe->user_data;
+        int res = cqe->res;
+        head++;
+        __atomic_store_n(state.cq_head, head, __ATOMIC_RELEASE);
+
+        if (index < 0 || index >= URING_NUM_BUFFERS)
+            continue;
+
+        struct uring_buffer *b = &state.bufs[index];
+        if (res == -EINTR || res == -EAGAIN)
+        {
+            if (submit_buffer(index) != 0)
+            {
+                state.error = 1;
+                complete_buffer(b);
+            }
+        }
+        else if (res <= 0)
+        {
+            state.error = 1;
+            complete_buffer(b);
+        }
+        else
+        {
+            b->completed += res;
+            if (b->completed < b->w_buf.len)
+            {
+                // Short write. Write the rest.
+                if (submit_buffer(index) != 0)
+                {
+                    state.error = 1;
+                    complete_buffer(b);
+                }
+            }
+            else
+            {
+                complete_buffer(b);
+            }
+        }
+
+        tail = __atomic_load_n(state.cq_tail, __ATOMIC_ACQUIRE);
+    }
+}
+
+/*
+    Block until at least one completion is available and process all.
+
+    Return:
+        0  => Success
+        -1 => Failed to wait
+*/
+static int wait_completions() {
+    int ret = sys_io_uring_enter(state.ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+    if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+    {
+        state.error = 1;
+        return -1;
+    }
+    reap_completions();
+    return 0;
+}
+
+/*
+    Make the buffer after the current one the current buffer. Waits if it
+    is still being written.
+
+    Return:
+        0  => Success
+        -1 => The current buffer is still being written
+*/
+static int advance_current_buffer() {
+    state.current = (state.current + 1) % URING_NUM_BUFFERS;
+    while (state.bufs[state.current].in_flight)
+    {
+        if (wait_completions() != 0)
+            return -1;
+    }
+    return 0;
+}
+
+static void drain() {
+    while (state.in_flight > 0)
+    {
+        if (wait_completions() != 0)
+            return;
+    }
+}
+
+static int take_error() {
+    int error = state.error;
+    state.error = 0;
+    return error;
+}
+
+static int init_file_uring() {
+    if (state.initialized)
+        return 0;
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    state.ring_fd = sys_io_uring_setup(URING_NUM_BUFFERS, &params);
+    if (state.ring_fd < 0)
+        return -1;
+
+    if (map_ring(&params) != 0)
+        goto close_ring;
+
+    struct iovec iovecs[URING_NUM_BUFFERS];
+    if (alloc_buffers(&iovecs[0]) != 0)
+        goto unmap;
+
+    if (sys_io_uring_register(state.ring_fd, IORING_REGISTER_BUFFERS, &iovecs[0], URING_NUM_BUFFERS) != 0)
+        goto buffers_free;
+
+    // Never truncate earlier output. See 'record_writer_rotate'.
+    state.fd = open(state.init_args.path, O_RDWR | O_CREAT, 0600);
+    if (state.fd == -1)
+        goto buffers_free;
+
+    off_t end = lseek(state.fd, 0, SEEK_END);
+    if (end == -1)
+        goto file_close;
+
+    if (sys_io_uring_register(state.ring_fd, IORING_REGISTER_FILES, &state.fd, 1) != 0)
+        goto file_close;
+
+    state.current = 0;
+    state.in_flight = 0;
+    state.offset = end;
+    state.error = 0;
+    state.initialized = 1;
+    return 0;
+
+file_close:
+    close(state.fd);
+    state.fd = 0;
+
+buffers_free:
+    free_buffers();
+
+unmap:
+    unmap_ring();
+
+close_ring:
+    close(state.ring_fd);
+    state.ring_fd = 0;
+    return -1;
+}
+
+static int close_file_uring() {
+    if (state.initialized) {
+        start_buffer_write(state.current);
+        drain();
+        close(state.ring_fd);
+        unmap_ring();
+        free_buffers();
+        close(state.fd);
+        state.fd = 0;
+        state.ring_fd = 0;
+        state.initialized = 0;
+    }
+    return 0;
+}
+
+static int write_file_uring(void *data, size_t data_len) {
+    if (!state.initialized)
+        return -2;
+
+    reap_completions();
+
+    struct uring_buffer *b = &state.bufs[state.current];
+    if (b->in_flight)
+    {
+        if (advance_current_buffer() != 0)
+        {
+            take_error();
+            return -1;
+        }
+        // Never append to the buffer the kernel is writing.
+        b = &state.bufs[state.current];
+    }
+
+    if (write_buffer_append(&b->w_buf, data, data_len) != 0)
+    {
+        if (start_buffer_write(state.current) != 0)
+            state.error = 1;
+        if (advance_current_buffer() != 0)
+        {
+            take_error();
+            return -1;
+        }
+
+        b = &state.bufs[state.current];
+        if (write_buffer_append(&b->w_buf, data, data_len) != 0)
+        {
+            // Larger than a whole buffer. Write it in order after everything before it.
+            drain();
+            size_t written = pwrite_all(data, data_len, state.offset);
+            state.offset += written;
+            if (written != data_len)
+                return -1;
+        }
+    }
+
+    if (write_buffer_is_flush_due(&b->w_buf))
+    {
+        if (start_buffer_write(state.current) != 0)
+            state.error = 1;
+        advance_current_buffer();
+    }
+
+    if (take_error())
+        return -1;
+
+    return (int)data_len;
+}
+
+static int flush_file_uring(int force) {
+    if (!state.initialized)
+        return -2;
+
+    reap_completions();
+
+    struct write_buffer *w_buf = &state.bufs[state.current].w_buf;
+    int flushed = (int)w_buf->len;
+    if (force || write_buffer_is_flush_due(w_buf))
+    {
+        if (start_buffer_write(state.current) != 0)
+            state.error = 1;
+        advance_current_buffer();
+        if (force)
+            drain();
+    }
+    else
+    {
+        flushed = 0;
+    }
+
+    if (take_error())
+        return -1;
+
+    return flushed;
+}
+
+#else
+
+static struct {
+    struct output_file init_args;
+} state = {0};
+
+/*
+    Accept the args as the io_uring writer does, so that 'init' fails instead and
+    ameba falls back to the synchronous file writer.
+*/
+static int set_init_args_file_uring(void *ptr, size_t ptr_len) {
+    if (!ptr || ptr_len != sizeof(struct output_file))
+        return -1;
+
+    struct output_file *in = (struct output_file *)ptr;
+    if (strlen(in->path) == 0 || strlen(in->path) >= PATH_MAX)
+        return -1;
+
+    if (in->flush_policy.flush_interval_ms < 0)
+        return -1;
+
+    memcpy(&state.init_args, in, sizeof(struct output_file));
+    return 0;
+}
+
+static int init_file_uring() {
+    // io_uring is not supported by this build.
+    return -1;
+}
+
+static int close_file_uring() {
+    return 0;
+}
+
+static int write_file_uring(void *data, size_t data_len) {
+    (void)data;
+    (void)data_len;
+    return -2;
+}
+
+static int flush_file_uring(int force) {
+    (void)force;
+    return -2;
+}
+
+#endif
+
+const struct record_writer record_writer_file_uring = {
+    .set_init_args = set_init_args_file_uring,
+    .init = init_file_uring,
+    .close = close_file_uring,
+    .write = write_file_uring,
+    .flush = flush_file_uring,
+};
\ No newline at end of file
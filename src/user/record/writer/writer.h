@@ -63,4 +63,16 @@ struct record_writer
             >=0 => The bytes written
     */
     int (*write) (void *data, size_t data_len);
+    /*
+        Flush the records buffered by the writer (if any) to the underlying output.
+
+        If 'force' is 0 then the records are only flushed if the flush policy
+        of the writer requires it (i.e. buffered records are too old).
+
+        Return:
+            -2  => The writer is not initialized
+            -1  => The underlying write failed
+            >=0 => The bytes flushed
+    */
+    int (*flush) (int force);
 };
@@ -25,7 +25,9 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <linux/limits.h>
 #include <netinet/in.h>
 
+#include "common/config.h"
 #include "common/control.h"
+#include "common/constants.h"
 
 #include "user/jsonify/core.h"
 
@@ -51,9 +53,85 @@ struct log_msg
 };
 
 
+/*
+    Policy to coalesce records before writing them to the output.
+
+    'buffer_size' of 0 means every record is written as is.
+*/
+struct output_flush_policy
+{
+    size_t buffer_size;
+    long flush_interval_ms;
+};
+
+
+/*
+    How the file writer issues writes.
+
+    OUTPUT_FILE_ENGINE_URING submits writes asynchronously through io_uring
+    and falls back to OUTPUT_FILE_ENGINE_SYNC if io_uring is unavailable.
+*/
+enum output_file_engine {
+    OUTPUT_FILE_ENGINE_SYNC = 1,
+    OUTPUT_FILE_ENGINE_URING
+};
+
+
+/*
+    Codec to compress the output with.
+
+    A codec is only available if ameba is built with its library. See
+    OUTPUT_COMPRESSION_HAVE_*.
+*/
+enum output_compression_codec {
+    OUTPUT_COMPRESSION_NONE = 1,
+    // zstd frame format.
+    OUTPUT_COMPRESSION_ZSTD,
+    // lz4 frame format.
+    OUTPUT_COMPRESSION_LZ4
+};
+
+#if defined(HAVE_ZSTD_H) && defined(HAVE_LIBZSTD)
+#define OUTPUT_COMPRESSION_HAVE_ZSTD 1
+#endif
+
+#if defined(HAVE_LZ4FRAME_H) && defined(HAVE_LIBLZ4)
+#define OUTPUT_COMPRESSION_HAVE_LZ4 1
+#endif
+
+
+struct output_compression
+{
+    enum output_compression_codec codec;
+    // Level of the codec. 0 for the default level of the codec.
+    int level;
+    // Size (bytes) of the uncompressed blocks handed over to the compression thread.
+    size_t block_size;
+};
+
+
+/*
+    When to move the output file aside and continue in a new one.
+    A rotation is also requested by SIGHUP.
+*/
+struct output_rotation
+{
+    // Bytes written (before compression) after which the file is rotated. 0 to disable.
+    size_t max_size;
+    // Age (seconds) of the file after which it is rotated. 0 to disable.
+    long interval_sec;
+    // Number of rotated files to keep. 0 to keep all.
+    int retain;
+};
+
+
 struct output_file
 {
     char path[PATH_MAX];
+    struct output_flush_policy flush_policy;
+    enum output_file_engine engine;
+    struct output_compression compression;
+    struct output_rotation rotation;
 };
 
 
@@ -62,13 +140,238 @@ struct output_net
     int ip_family;
     char ip[INET6_ADDRSTRLEN];
     int port;
+    // Max size (bytes) of a datagram that records are packed into. 0 to send each record in its own datagram.
+    size_t datagram_size;
+    // Max datagrams sent per syscall.
+    int batch;
+    // Max age (ms) of packed records before they are sent. 0 to only send full batches.
+    long flush_interval_ms;
+};
+
+
+/*
+    What the TCP writer does with a record when its spool is full.
+*/
+enum output_spool_policy {
+    // Wait for the collector to take data. Stalls the ring buffer consumer.
+    OUTPUT_SPOOL_POLICY_BLOCK = 1,
+    // Drop the oldest spooled records to make room.
+    OUTPUT_SPOOL_POLICY_DROP_OLDEST,
+    // Drop the record.
+    OUTPUT_SPOOL_POLICY_DROP_NEWEST
+};
+
+
+/*
+    Where records are spilled to while the output does not take them.
+*/
+struct output_spill
+{
+    // Directory of the segment files. Empty to disable spilling.
+    char dir[PATH_MAX];
+    // Disk space (bytes) taken by the segment files.
+    size_t max_size;
+    // Size (bytes) of a segment file.
+    size_t segment_size;
+};
+
+
+struct output_tcp
+{
+    int ip_family;
+    char ip[INET6_ADDRSTRLEN];
+    int port;
+    // Size (bytes) of the in-memory spool that holds records until they are sent.
+    size_t spool_size;
+    enum output_spool_policy spool_policy;
+    // Max age (ms) of spooled records before they are sent. 0 to only send when enough is spooled.
+    long flush_interval_ms;
+    // Delay (ms) before the first reconnect attempt. Doubled after every failed attempt.
+    long reconnect_min_ms;
+    // Max delay (ms) between reconnect attempts.
+    long reconnect_max_ms;
+    struct output_spill spill;
+    // Every block is compressed into a frame of its own, so that the stream
+    // stays valid across reconnects.
+    struct output_compression compression;
+};
+
+
+struct output_unix
+{
+    // Path of the SOCK_SEQPACKET socket the consumer listens on.
+    char path[PATH_MAX];
+    // Max size (bytes) of a message that records are packed into. 0 to send each record in its own message.
+    size_t message_size;
+    // Max age (ms) of packed records before they are sent. 0 to only send full messages.
+    long flush_interval_ms;
+};
+
+
+struct output_shm
+{
+    // Path of the unix socket that a reader gets the shared memory ring from.
+    char path[PATH_MAX];
+    // Size (bytes) of the ring. A power of 2.
+    size_t size;
+};
+
+
+/*
+    Counters of a writer that spools records until its output takes them.
+*/
+struct output_spool_stats
+{
+    // Bytes and records currently in the spool.
+    unsigned long spool_bytes;
+    unsigned long spool_records;
+    // Records dropped by the spool policy (or too large for the spool).
+    unsigned long dropped_records;
+    unsigned long dropped_bytes;
+    unsigned long bytes_sent;
+    // Connections established, and lost or failed to establish.
+    unsigned long connects;
+    unsigned long disconnects;
+};
+
+
+/*
+    Counters of the disk spill of the output.
+*/
+struct output_spill_stats
+{
+    // Record bytes and segments spilled and not replayed yet.
+    unsigned long spill_bytes;
+    unsigned long spill_segments;
+    unsigned long replayed_bytes;
+    // Records dropped to bound the disk usage (or too large for a segment).
+    unsigned long dropped_records;
+    unsigned long dropped_bytes;
+    // Segments of a previous run queued for replay, and discarded as incomplete or corrupt.
+    unsigned long recovered_segments;
+    unsigned long discarded_segments;
+};
+
+
+/*
+    Counters of an output the records are fanned out to.
+*/
+struct output_sink_stats
+{
+    unsigned long records;
+    unsigned long bytes_written;
+    unsigned long write_errors;
+    // Records dropped while the queue of the output was full.
+    unsigned long dropped_records;
+    unsigned long dropped_bytes;
 };
 
 
 enum output_type {
     OUTPUT_NONE,
     OUTPUT_FILE,
-    OUTPUT_NET
+    OUTPUT_NET,
+    OUTPUT_TCP,
+    OUTPUT_UNIX,
+    OUTPUT_SHM
+};
+
+enum output_format {
+    // A JSON object per line.
+    OUTPUT_FORMAT_JSON = 1,
+    // A stream header followed by the length-prefixed records as is.
+    OUTPUT_FORMAT_BINARY,
+    // A CBOR schema header followed by a CBOR array per record.
+    OUTPUT_FORMAT_CBOR,
+    // A schema header followed by batches of columns. See 'user/record/writer/columnar.h'.
+    OUTPUT_FORMAT_COLUMNAR
+};
+
+/*
+    Max outputs written to at once. One per output type, since the writers are singletons.
+*/
+#define MAX_OUTPUT_SINKS 5
+
+/*
+    An output the records are written to, in a format of its own.
+*/
+struct output_sink
+{
+    enum output_type o_type;
+    enum output_format format;
+};
+
+enum ringbuf_mode {
+    // One ring buffer shared by all CPUs.
+    RINGBUF_MODE_SHARED = 1,
+    // One ring buffer per CPU.
+    RINGBUF_MODE_PERCPU
+};
+
+
+enum ringbuf_consumers {
+    // All ring buffers are consumed by the main thread.
+    RINGBUF_CONSUMERS_SINGLE = 1,
+    // The ring buffers of the CPUs of each NUMA node are consumed by a thread.
+    RINGBUF_CONSUMERS_PER_NUMA_NODE
+};
+
+
+struct ringbuf_config
+{
+    enum ringbuf_mode mode;
+    enum ringbuf_consumers consumers;
+    // Size (bytes) of each ring buffer. A power of 2 multiple of page size.
+    size_t size;
+    // Pending bytes in a ring buffer at which the consumer is woken up.
+    // 0 => Woken up for every record. -1 => 'size' / OUTPUT_RINGBUF_WAKEUP_DIVISOR.
+    long wakeup_watermark;
+    // Max time (ms) a record waits in a ring buffer without a wakeup.
+    long max_latency_ms;
+};
+
+
+/*
+    Counters maintained by a ring buffer consumer.
+*/
+struct consumer_stats
+{
+    unsigned long records;
+    unsigned long bytes_written;
+    unsigned long serialize_errors;
+    unsigned long write_errors;
+};
+
+/*
+    Records that could not be written to a ring buffer (i.e. ring buffer full).
+    Index of 'per_record_type' is record_type_t.
+*/
+struct output_drop_stats
+{
+    unsigned long total;
+    unsigned long per_record_type[OUTPUT_DROPS_MAP_SIZE];
+};
+
+/*
+    How often the stats are reported, and where to (besides the log).
+
+    'interval_sec' of 0 disables periodic reporting. Empty 'path' disables the stats file.
+*/
+struct stats_config
+{
+    long interval_sec;
+    char path[PATH_MAX];
+};
+
+/*
+    How records are batched with OUTPUT_FORMAT_COLUMNAR.
+*/
+struct columnar_config
+{
+    // Records of a record type in a batch.
+    unsigned long batch_rows;
+    // Max age (ms) of a batch before it is written. 0 to only write full batches.
+    long max_age_ms;
 };
 
 struct user_input
@@ -76,6 +379,23 @@ struct user_input
     struct control_input c_in;
     struct output_file output_file;
     struct output_net output_net;
+    struct output_tcp output_tcp;
+    struct output_unix output_unix;
+    struct output_shm output_shm;
+    // Type of the first output.
     enum output_type o_type;
+    // Format of the outputs without a format of their own.
+    enum output_format format;
+    // Every output, in the order given.
+    struct output_sink sinks[MAX_OUTPUT_SINKS];
+    int sinks_len;
+    struct columnar_config columnar;
+    /*
+        Number of serializer threads. 0 means records are serialized and
+        written inline by the ring buffer polling thread.
+    */
+    int pipeline_workers;
+    struct ringbuf_config ringbuf;
+    struct stats_config stats;
     struct arg_parse_state parse_state;
 };
\ No newline at end of file
@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+/*
+
+    A benchmark of the JSON record serializer.
+
+    Usage: bench_json [iterations]
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "common/types.h"
+#include "user/jsonify/core.h"
+#include "user/record/serializer/serializer.h"
+
+
+extern const struct record_serializer record_serializer_json;
+
+
+static const long default_iterations = 1000000;
+
+
+static void init_common(struct elem_common *e_common, record_type_t record_type)
+{
+    e_common->magic = AMEBA_MAGIC;
+    e_common->record_type = record_type;
+    // The last version with fixed size sockaddrs.
+    e_common->version.major = RECORD_VERSION_MAJOR_COMPACT_SOCKADDR - 1;
+    e_common->version.minor = 0;
+    e_common->version.patch = 0;
+}
+
+static void init_sockaddr_in(struct elem_sockaddr *e_sa, const char *ip, int port)
+{
+    struct sockaddr_in *sa_in = (struct sockaddr_in *)&(e_sa->addr[0]);
+    sa_in->sin_family = AF_INET;
+    sa_in->sin_port = htons(port);
+    inet_pton(AF_INET, ip, &(sa_in->sin_addr));
+    e_sa->addrlen = sizeof(struct sockaddr_in);
+    e_sa->byte_order = BYTE_ORDER_NETWORK;
+}
+
+static void init_record_send_recv(struct record_send_recv *r)
+{
+    memset(r, 0, sizeof(*r));
+    init_common(&(r->e_common), RECORD_TYPE_SEND_RECV);
+    r->e_ts.event_id = 123456789;
+    r->pid = 4242;
+    r->sys_id = SYS_ID_SENDTO;
+    r->fd = 17;
+    r->ret = 1448;
+    r->ns_net = 4026531840U;
+    r->sock_type = SOCK_STREAM;
+    init_sockaddr_in(&(r->local), "10.0.0.1", 43512);
+    init_sockaddr_in(&(r->remote), "10.0.0.2", 443);
+}
+
+static void init_record_new_process(struct record_new_process *r)
+{
+    memset(r, 0, sizeof(*r));
+    init_common(&(r->e_common), RECORD_TYPE_NEW_PROCESS);
+    r->e_ts.event_id = 123456790;
+    r->ppid = 1;
+    r->pid = 4243;
+    r->sys_id = SYS_ID_CLONE;
+    strncpy(&(r->comm[0]), "bench_json", COMM_MAX_SIZE - 1);
+}
+
+static void init_record_audit_log_exit(struct record_audit_log_exit *r)
+{
+    memset(r, 0, sizeof(*r));
+    init_common(&(r->e_common), RECORD_TYPE_AUDIT_LOG_EXIT);
+    r->e_ts.event_id = 123456791;
+    r->pid = 4243;
+    r->syscall_number = 59;
+    r->ret = 0;
+    r->e_las_ts.event_id = 987654;
+    r->e_las_ts.tv_sec = 1700000000;
+    r->e_las_ts.tv_nsec = 123456789;
+}
+
+static double get_elapsed_sec(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/*
+    Serialize the record 'iterations' times and print the time taken.
+
+    Return:
+        0  => Success
+        -1 => Serialization failed
+*/
+static int bench_record(const char *name, struct elem_common *record, size_t record_len, long iterations)
+{
+    char dst[MAX_BUFFER_LEN];
+    unsigned long long bytes = 0;
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < iterations; i++)
+    {
+        long len = record_serializer_json.serialize(dst, sizeof(dst), record, record_len);
+        if (len <= 0)
+        {
+            fprintf(stderr, "Failed to serialize %s: %ld\n", name, len);
+            return -1;
+        }
+        bytes += len;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double elapsed = get_elapsed_sec(&start, &end);
+    printf(
+        "%-24s %10.1f ns/record %10.2f Mrecords/s %10.1f MB/s\n",
+        name, elapsed * 1e9 / iterations, iterations / elapsed / 1e6, bytes / elapsed / 1e6
+    );
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    long iterations = default_iterations;
+    if (argc > 1)
+    {
+        iterations = strtol(argv[1], NULL, 10);
+        if (iterations <= 0)
+        {
+            fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    struct record_send_recv send_recv;
+    struct record_new_process new_process;
+    struct record_audit_log_exit audit_log_exit;
+    init_record_send_recv(&send_recv);
+    init_record_new_process(&new_process);
+    init_record_audit_log_exit(&audit_log_exit);
+
+    int result = 0;
+    result |= bench_record("record_send_recv", &(send_recv.e_common), sizeof(send_recv), iterations);
+    result |= bench_record("record_new_process", &(new_process.e_common), sizeof(new_process), iterations);
+    result |= bench_record("record_audit_log_exit", &(audit_log_exit.e_common), sizeof(audit_log_exit), iterations);
+    return result == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,661 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+/*
+
+    Convert the output of ameba (JSON or binary) to SPADE audit records.
+    A native replacement for 'bin/transform_log_to_spade.py'.
+
+    Usage: ameba-convert --input FILE [--output FILE] [--format auto|json|binary]
+                         [--threads N] [--window N]
+
+    The input is parsed in chunks by multiple threads. The records are then correlated
+    in order (see 'convert_window') and the SPADE records formatted by multiple threads.
+
+    Syscall numbers are those of this build (<sys/syscall.h>). Binary input written on
+    another architecture (see 'audit_arch' of the stream header) is rejected. JSON input
+    has no header so it must be converted on the architecture it was written on.
+
+*/
+
+#include <argp.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "user/error.h"
+#include "user/record/deserializer/reader.h"
+#include "utils/convert/convert.h"
+
+
+/*
+    Size (bytes) of the input parsed by a thread at a time.
+*/
+#define CONVERT_CHUNK_LEN (4 * 1024 * 1024)
+
+#define CONVERT_MAX_THREADS 64
+
+
+typedef enum {
+    INPUT_FORMAT_AUTO = 0,
+    INPUT_FORMAT_JSON,
+    INPUT_FORMAT_BINARY
+} input_format_t;
+
+struct convert_options
+{
+    const char *input_path;
+    const char *output_path;
+    input_format_t format;
+    int threads;
+    int window_size;
+};
+
+struct convert_input
+{
+    input_format_t format;
+    // JSON
+    int fd;
+    const char *data;
+    size_t data_len;
+    size_t offset;
+    // Binary
+    struct record_file_reader reader;
+    // Set when an invalid record is found at 'error_offset'.
+    int failed;
+    size_t error_offset;
+};
+
+/*
+    Input parsed by a thread. Records are whole lines (JSON) or whole length prefixed
+    records (binary).
+*/
+struct convert_chunk
+{
+    input_format_t format;
+    const char *start;
+    const char *end;
+    struct convert_record *records;
+    size_t len;
+    size_t cap;
+    // Where the parsing stopped on an invalid record, otherwise NULL.
+    const char *error;
+    size_t skipped;
+};
+
+/*
+    Matches formatted by a thread.
+*/
+struct convert_slice
+{
+    const struct convert_match *matches;
+    size_t len;
+    char *buf;
+    size_t buf_len;
+    size_t buf_cap;
+    int error;
+};
+
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state);
+
+enum
+{
+    OPT_INPUT = 'i',
+    OPT_OUTPUT = 'o',
+    OPT_FORMAT = 'f',
+    OPT_THREADS = 't',
+    OPT_WINDOW = 'w'
+};
+
+static struct argp_option options[] = {
+    {"input", OPT_INPUT, "FILE", 0, "Ameba output file to convert", 0},
+    {"output", OPT_OUTPUT, "FILE", 0, "File to write SPADE records to. Default: stdout", 0},
+    {"format", OPT_FORMAT, "FORMAT", 0, "Format of the input (auto|json|binary). Default: auto", 0},
+    {"threads", OPT_THREADS, "N", 0, "Number of threads. Default: number of CPUs", 0},
+    {"window", OPT_WINDOW, "N", 0, "Number of records to correlate in. Default: 50", 0},
+    {0}
+};
+
+static struct argp convert_argp = {
+    .options = options,
+    .parser = parse_opt,
+    .args_doc = "",
+    .doc = "Convert ameba output to SPADE audit records",
+    .children = 0,
+    .help_filter = 0,
+    .argp_domain = 0
+};
+
+static int parse_positive_int(const char *arg, int max, int *dst)
+{
+    char *endptr;
+    long val = strtol(arg, &endptr, 10);
+    if (*arg == '\0' || *endptr != '\0' || val < 1 || val > max)
+        return -1;
+    *dst = (int)val;
+    return 0;
+}
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state)
+{
+    struct convert_options *opts = state->input;
+    switch (key)
+    {
+        case OPT_INPUT:
+            opts->input_path = arg;
+            break;
+        case OPT_OUTPUT:
+            opts->output_path = arg;
+            break;
+        case OPT_FORMAT:
+            if (strcmp(arg, "auto") == 0)
+                opts->format = INPUT_FORMAT_AUTO;
+            else if (strcmp(arg, "json") == 0)
+                opts->format = INPUT_FORMAT_JSON;
+            else if (strcmp(arg, "binary") == 0)
+                opts->format = INPUT_FORMAT_BINARY;
+            else
+                argp_error(state, "Invalid format '%s'. Use 'auto', 'json' or 'binary'", arg);
+            break;
+        case OPT_THREADS:
+            if (parse_positive_int(arg, CONVERT_MAX_THREADS, &opts->threads) != 0)
+                argp_error(state, "Invalid threads '%s'. Must be 1-%d", arg, CONVERT_MAX_THREADS);
+            break;
+        case OPT_WINDOW:
+            if (parse_positive_int(arg, 1000000, &opts->window_size) != 0)
+                argp_error(state, "Invalid window '%s'", arg);
+            break;
+        case ARGP_KEY_END:
+            if (!opts->input_path)
+                argp_error(state, "Missing --input");
+            break;
+        default:
+            return ARGP_ERR_UNKNOWN;
+    }
+    return 0;
+}
+
+
+static int open_json_input(struct convert_input *in, const char *path)
+{
+    in->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (in->fd < 0)
+        return -1;
+
+    struct stat st;
+    if (fstat(in->fd, &st) != 0)
+        return -1;
+    in->data_len = st.st_size;
+    in->offset = 0;
+    if (in->data_len == 0)
+        return 0;
+
+    void *data = mmap(NULL, in->data_len, PROT_READ, MAP_PRIVATE, in->fd, 0);
+    if (data == MAP_FAILED)
+        return -1;
+    in->data = data;
+    madvise(data, in->data_len, MADV_SEQUENTIAL);
+    return 0;
+}
+
+static input_format_t detect_format(const char *path)
+{
+    input_format_t format = INPUT_FORMAT_JSON;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return format;
+
+    magic_t magic;
+    if (read(fd, &magic, sizeof(magic)) == sizeof(magic) && magic == AMEBA_MAGIC)
+        format = INPUT_FORMAT_BINARY;
+    close(fd);
+    return format;
+}
+
+static int open_input(struct convert_input *in, const char *path, input_format_t format)
+{
+    memset(in, 0, sizeof(*in));
+    in->fd = -1;
+    in->reader.fd = -1;
+    in->format = format == INPUT_FORMAT_AUTO ? detect_format(path) : format;
+
+    if (in->format == INPUT_FORMAT_JSON)
+    {
+        if (open_json_input(in, path) != 0)
+        {
+            fprintf(stderr, "Failed to read '%s': %s\n", path, strerror(errno));
+            return -1;
+        }
+        return 0;
+    }
+
+    int err = record_file_reader_open(&in->reader, path);
+    switch (err)
+    {
+        case 0:
+            break;
+        case ERR_STREAM_IO:
+            fprintf(stderr, "Failed to read '%s': %s\n", path, strerror(errno));
+            return -1;
+        case ERR_STREAM_UNSUPPORTED:
+            fprintf(stderr, "Unsupported records in '%s'. Convert with the ameba version that wrote them\n", path);
+            return -1;
+        default:
+            fprintf(stderr, "Invalid binary stream header in '%s'\n", path);
+            return -1;
+    }
+    if (!in->reader.header.has_task_ctx_id)
+    {
+        fprintf(stderr, "Records in '%s' have no task_ctx_id to correlate with\n", path);
+        return -1;
+    }
+
+    struct record_stream_header own;
+    record_serializer_init_stream_header(&own);
+    // Header version 1 did not have it.
+    if (in->reader.header.audit_arch == 0)
+    {
+        fprintf(stderr, "Records in '%s' do not tell their architecture. Assuming the syscall numbers of this host\n", path);
+    }
+    else if (in->reader.header.audit_arch != own.audit_arch)
+    {
+        fprintf(stderr, "Records in '%s' were written on another architecture (audit arch 0x%x). Convert them there\n",
+                path, in->reader.header.audit_arch);
+        return -1;
+    }
+    return 0;
+}
+
+static void close_input(struct convert_input *in)
+{
+    if (in->format == INPUT_FORMAT_BINARY)
+    {
+        record_file_reader_close(&in->reader);
+        return;
+    }
+    if (in->data)
+        munmap((void *)in->data, in->data_len);
+    if (in->fd >= 0)
+        close(in->fd);
+}
+
+/*
+    Set the next chunk of the input. The input before an invalid record is the last chunk.
+
+    Return:
+        1  -> The chunk is set
+        0  -> End of input
+*/
+static int next_chunk(struct convert_input *in, struct convert_chunk *chunk)
+{
+    chunk->format = in->format;
+    chunk->len = 0;
+    chunk->error = NULL;
+    chunk->skipped = 0;
+
+    if (in->format == INPUT_FORMAT_JSON)
+    {
+        if (in->offset >= in->data_len)
+            return 0;
+        size_t end = in->offset + CONVERT_CHUNK_LEN;
+        if (end >= in->data_len)
+        {
+            end = in->data_len;
+        } else {
+            const char *nl = memchr(&in->data[end], '\n', in->data_len - end);
+            end = nl ? (size_t)(nl - in->data) + 1 : in->data_len;
+        }
+        chunk->start = &in->data[in->offset];
+        chunk->end = &in->data[end];
+        in->offset = end;
+        return 1;
+    }
+
+    struct record_file_reader *r = &in->reader;
+    size_t start = r->offset;
+    while (!in->failed && r->offset - start < CONVERT_CHUNK_LEN)
+    {
+        struct elem_common *record;
+        size_t record_len;
+        int ret = record_file_reader_next(r, &record, &record_len);
+        if (ret == 0)
+            break;
+        if (ret < 0)
+        {
+            in->failed = 1;
+            in->error_offset = r->offset;
+        }
+    }
+    if (r->offset == start)
+        return 0;
+    chunk->start = (const char *)&r->data[start];
+    chunk->end = (const char *)&r->data[r->offset];
+    return 1;
+}
+
+
+static int chunk_add_record(struct convert_chunk *chunk)
+{
+    if (chunk->len < chunk->cap)
+        return 0;
+    size_t cap = chunk->cap ? chunk->cap * 2 : 4096;
+    struct convert_record *records = realloc(chunk->records, cap * sizeof(*records));
+    if (!records)
+        return -1;
+    chunk->records = records;
+    chunk->cap = cap;
+    return 0;
+}
+
+static void parse_json_chunk(struct convert_chunk *chunk)
+{
+    const char *p = chunk->start;
+    while (p < chunk->end)
+    {
+        const char *nl = memchr(p, '\n', chunk->end - p);
+        const char *line_end = nl ? nl : chunk->end;
+        const char *q = p;
+        while (q < line_end && (*q == ' ' || *q == '\t' || *q == '\r'))
+            q++;
+
+        if (q < line_end)
+        {
+            if (chunk_add_record(chunk) != 0
+                || convert_json_parse(p, line_end - p, &chunk->records[chunk->len]) != 0)
+            {
+                chunk->error = p;
+                return;
+            }
+            chunk->len++;
+        }
+        p = nl ? nl + 1 : chunk->end;
+    }
+}
+
+static void parse_binary_chunk(struct convert_chunk *chunk)
+{
+    // Framing is checked by 'record_file_reader_next'.
+    const char *p = chunk->start;
+    while (p < chunk->end)
+    {
+        size_t record_len;
+        memcpy(&record_len, p, sizeof(record_len));
+        if (chunk_add_record(chunk) != 0)
+        {
+            chunk->error = p;
+            return;
+        }
+        int ret = convert_binary_parse(p + sizeof(size_t), record_len, &chunk->records[chunk->len]);
+        if (ret < 0)
+        {
+            chunk->error = p;
+            return;
+        }
+        if (ret == 0)
+            chunk->skipped++;
+        else
+            chunk->len++;
+        p += sizeof(size_t) + record_len;
+    }
+}
+
+static void *parse_chunk(void *arg)
+{
+    struct convert_chunk *chunk = arg;
+    if (chunk->format == INPUT_FORMAT_JSON)
+        parse_json_chunk(chunk);
+    else
+        parse_binary_chunk(chunk);
+    return NULL;
+}
+
+static void *format_slice(void *arg)
+{
+    struct convert_slice *slice = arg;
+    slice->buf_len = 0;
+    for (size_t i = 0; i < slice->len; i++)
+    {
+        if (slice->buf_cap - slice->buf_len < CONVERT_SPADE_MAX_LINE_LEN)
+        {
+            size_t cap = slice->buf_cap ? slice->buf_cap * 2 : CONVERT_CHUNK_LEN;
+            char *buf = realloc(slice->buf, cap);
+            if (!buf)
+            {
+                slice->error = 1;
+                return NULL;
+            }
+            slice->buf = buf;
+            slice->buf_cap = cap;
+        }
+        slice->buf_len += convert_spade_format(&slice->matches[i], &slice->buf[slice->buf_len]);
+    }
+    return NULL;
+}
+
+/*
+    Call 'fn' for each of the 'n' args, each in its own thread.
+
+    Return:
+        0  -> Success
+        -1 -> Failed to create a thread
+*/
+static int run_threads(void *(*fn)(void *), void *args, size_t arg_size, int n)
+{
+    pthread_t threads[CONVERT_MAX_THREADS];
+    int started = 0;
+    int err = 0;
+
+    // The last one in this thread.
+    for (int i = 0; i < n - 1; i++)
+    {
+        if (pthread_create(&threads[i], NULL, fn, (char *)args + i * arg_size) != 0)
+        {
+            err = -1;
+            break;
+        }
+        started++;
+    }
+    if (!err && n > 0)
+        fn((char *)args + (n - 1) * arg_size);
+    for (int i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+    return err;
+}
+
+/*
+    Format the matches and write them in order.
+*/
+static int write_matches(struct convert_matches *matches, struct convert_slice *slices, int threads, FILE *out)
+{
+    if (matches->len == 0)
+        return 0;
+
+    size_t per_slice = (matches->len + threads - 1) / threads;
+    int n = 0;
+    for (size_t i = 0; i < matches->len; i += per_slice, n++)
+    {
+        slices[n].matches = &matches->items[i];
+        slices[n].len = matches->len - i < per_slice ? matches->len - i : per_slice;
+        slices[n].error = 0;
+    }
+    if (run_threads(format_slice, slices, sizeof(*slices), n) != 0)
+        return -1;
+
+    for (int i = 0; i < n; i++)
+    {
+        if (slices[i].error)
+            return -1;
+        if (fwrite(slices[i].buf, 1, slices[i].buf_len, out) != slices[i].buf_len)
+            return -1;
+    }
+    matches->len = 0;
+    return 0;
+}
+
+static size_t get_line_number(const char *data, const char *p)
+{
+    size_t line = 1;
+    for (const char *q = data; q < p; q++)
+    {
+        if (*q == '\n')
+            line++;
+    }
+    return line;
+}
+
+static int convert(struct convert_options *opts, struct convert_input *in, FILE *out)
+{
+    struct convert_chunk chunks[CONVERT_MAX_THREADS];
+    struct convert_slice slices[CONVERT_MAX_THREADS];
+    struct convert_window window;
+    struct convert_matches matches = {0};
+    size_t skipped = 0;
+    int ret = 0;
+
+    memset(chunks, 0, sizeof(chunks));
+    memset(slices, 0, sizeof(slices));
+    if (convert_window_init(&window, opts->window_size) != 0)
+    {
+        fprintf(stderr, "Failed to allocate the window\n");
+        return -1;
+    }
+
+    int done = 0;
+    while (!done)
+    {
+        int n = 0;
+        while (n < opts->threads && next_chunk(in, &chunks[n]) == 1)
+            n++;
+        if (n < opts->threads)
+            done = 1;
+
+        if (run_threads(parse_chunk, chunks, sizeof(*chunks), n) != 0)
+        {
+            fprintf(stderr, "Failed to create threads\n");
+            ret = -1;
+            break;
+        }
+
+        // Correlate in order.
+        for (int i = 0; i < n; i++)
+        {
+            for (size_t j = 0; j < chunks[i].len; j++)
+            {
+                if (convert_window_add(&window, &chunks[i].records[j], &matches) != 0)
+                {
+                    fprintf(stderr, "Out of memory\n");
+                    ret = -1;
+                    goto out;
+                }
+            }
+            skipped += chunks[i].skipped;
+            if (chunks[i].error)
+            {
+                if (in->format == INPUT_FORMAT_JSON)
+                    fprintf(stderr, "Invalid record at line %zu\n", get_line_number(in->data, chunks[i].error));
+                else
+                    fprintf(stderr, "Invalid record at offset %zu\n", (size_t)(chunks[i].error - (const char *)in->reader.data));
+                ret = -1;
+                done = 1;
+                break;
+            }
+        }
+        if (in->failed && ret == 0)
+        {
+            fprintf(stderr, "Invalid record at offset %zu\n", in->error_offset);
+            ret = -1;
+        }
+
+        // Records in the window are matched even after an invalid record.
+        if (done && convert_window_flush(&window, &matches) != 0)
+        {
+            fprintf(stderr, "Out of memory\n");
+            ret = -1;
+            break;
+        }
+        if (write_matches(&matches, slices, opts->threads, out) != 0)
+        {
+            fprintf(stderr, "Failed to write the output: %s\n", strerror(errno));
+            ret = -1;
+            break;
+        }
+    }
+
+out:
+    if (skipped)
+        fprintf(stderr, "Skipped %zu records of unknown type or size\n", skipped);
+    for (int i = 0; i < CONVERT_MAX_THREADS; i++)
+    {
+        free(chunks[i].records);
+        free(slices[i].buf);
+    }
+    free(matches.items);
+    convert_window_free(&window);
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    struct convert_options opts = {
+        .input_path = NULL,
+        .output_path = NULL,
+        .format = INPUT_FORMAT_AUTO,
+        .threads = 0,
+        .window_size = CONVERT_DEFAULT_WINDOW_SIZE
+    };
+    argp_parse(&convert_argp, argc, argv, 0, 0, &opts);
+
+    if (opts.threads == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        opts.threads = cpus < 1 ? 1 : (cpus > CONVERT_MAX_THREADS ? CONVERT_MAX_THREADS : cpus);
+    }
+
+    struct convert_input in;
+    if (open_input(&in, opts.input_path, opts.format) != 0)
+        return EXIT_FAILURE;
+
+    FILE *out = stdout;
+    if (opts.output_path)
+    {
+        out = fopen(opts.output_path, "w");
+        if (!out)
+        {
+            fprintf(stderr, "Failed to open '%s': %s\n", opts.output_path, strerror(errno));
+            close_input(&in);
+            return EXIT_FAILURE;
+        }
+    }
+
+    int ret = convert(&opts, &in, out);
+
+    if (fclose(out) != 0 && ret == 0)
+    {
+        fprintf(stderr, "Failed to write the output: %s\n", strerror(errno));
+        ret = -1;
+    }
+    close_input(&in);
+    return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
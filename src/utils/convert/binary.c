@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <string.h>
+
+#include "user/record/serializer/serializer.h"
+#include "utils/convert/convert.h"
+
+
+union convert_binary_record
+{
+    struct elem_common e_common;
+    struct record_new_process new_process;
+    struct record_cred cred;
+    struct record_namespace namespace;
+    struct record_connect connect;
+    struct record_accept accept;
+    struct record_send_recv send_recv;
+    struct record_bind bind;
+    struct record_kill kill;
+    struct record_audit_log_exit audit_log_exit;
+};
+
+
+static void copy_sockaddr(struct convert_sockaddr *dst, const struct elem_sockaddr *src)
+{
+    unsigned int len = src->addrlen;
+    if (len > SOCKADDR_MAX_SIZE)
+        len = SOCKADDR_MAX_SIZE;
+    dst->len = src->addrlen;
+    dst->addr_size = len;
+    memcpy(dst->addr, src->addr, len);
+}
+
+static int get_record_size(record_type_t record_type)
+{
+    switch (record_type)
+    {
+        case RECORD_TYPE_NEW_PROCESS:
+            return RECORD_SIZE_NEW_PROCESS;
+        case RECORD_TYPE_CRED:
+            return RECORD_SIZE_CRED;
+        case RECORD_TYPE_NAMESPACE:
+            return RECORD_SIZE_NAMESPACE;
+        case RECORD_TYPE_CONNECT:
+            return RECORD_SIZE_CONNECT;
+        case RECORD_TYPE_ACCEPT:
+            return RECORD_SIZE_ACCEPT;
+        case RECORD_TYPE_SEND_RECV:
+            return RECORD_SIZE_SEND_RECV;
+        case RECORD_TYPE_BIND:
+            return RECORD_SIZE_BIND;
+        case RECORD_TYPE_KILL:
+            return RECORD_SIZE_KILL;
+        case RECORD_TYPE_AUDIT_LOG_EXIT:
+            return RECORD_SIZE_AUDIT_LOG_EXIT;
+        default:
+            return 0;
+    }
+}
+
+int convert_binary_parse(const void *record, size_t record_len, struct convert_record *r)
+{
+    union convert_binary_record b;
+    union record_expanded expanded;
+
+    if (record_len < sizeof(struct elem_common) || record_len > sizeof(b))
+        return record_len < sizeof(struct elem_common) ? -1 : 0;
+
+    // Copied since records in a stream are not aligned.
+    memcpy(&b, record, record_len);
+    if (b.e_common.magic != AMEBA_MAGIC)
+        return -1;
+
+    const union convert_binary_record *src = &b;
+    long expanded_len = record_serializer_expand_compact(&expanded, &b.e_common, record_len);
+    if (expanded_len < 0)
+        return -1;
+    if (expanded_len > 0)
+    {
+        src = (const union convert_binary_record *)&expanded;
+        record_len = expanded_len;
+    }
+
+    // Same as the records skipped in the JSON output.
+    int size = get_record_size(src->e_common.record_type);
+    if (size == 0 || (size_t)size != record_len)
+        return 0;
+
+    memset(r, 0, sizeof(*r));
+    r->record_type = src->e_common.record_type;
+#ifdef INCLUDE_TASK_CTX_ID
+    r->task_ctx_id = src->e_common.task_ctx_id;
+#endif
+
+    switch (r->record_type)
+    {
+        case RECORD_TYPE_NEW_PROCESS:
+            r->pid = src->new_process.pid;
+            r->ppid = src->new_process.ppid;
+            r->sys_id = src->new_process.sys_id;
+            memcpy(r->comm, src->new_process.comm, sizeof(r->comm));
+            r->comm[sizeof(r->comm) - 1] = '\0';
+            break;
+        case RECORD_TYPE_CRED:
+            r->pid = src->cred.pid;
+            r->sys_id = src->cred.sys_id;
+            r->uid = src->cred.uid;
+            r->euid = src->cred.euid;
+            r->suid = src->cred.suid;
+            r->fsuid = src->cred.fsuid;
+            r->gid = src->cred.gid;
+            r->egid = src->cred.egid;
+            r->sgid = src->cred.sgid;
+            r->fsgid = src->cred.fsgid;
+            break;
+        case RECORD_TYPE_NAMESPACE:
+            r->pid = src->namespace.pid;
+            r->sys_id = src->namespace.sys_id;
+            r->ns_ipc = src->namespace.ns_ipc;
+            r->ns_mnt = src->namespace.ns_mnt;
+            r->ns_pid = src->namespace.ns_pid;
+            r->ns_pid_children = src->namespace.ns_pid_children;
+            r->ns_net = src->namespace.ns_net;
+            r->ns_usr = src->namespace.ns_usr;
+            break;
+        case RECORD_TYPE_CONNECT:
+            r->pid = src->connect.pid;
+            r->fd = src->connect.fd;
+            r->ns_net = src->connect.ns_net;
+            r->sock_type = src->connect.sock_type;
+            copy_sockaddr(&r->local, &src->connect.local);
+            copy_sockaddr(&r->remote, &src->connect.remote);
+            break;
+        case RECORD_TYPE_ACCEPT:
+            r->pid = src->accept.pid;
+            r->sys_id = src->accept.sys_id;
+            r->fd = src->accept.fd;
+            r->ns_net = src->accept.ns_net;
+            r->sock_type = src->accept.sock_type;
+            copy_sockaddr(&r->local, &src->accept.local);
+            copy_sockaddr(&r->remote, &src->accept.remote);
+            break;
+        case RECORD_TYPE_SEND_RECV:
+            r->pid = src->send_recv.pid;
+            r->sys_id = src->send_recv.sys_id;
+            r->fd = src->send_recv.fd;
+            r->ns_net = src->send_recv.ns_net;
+            r->sock_type = src->send_recv.sock_type;
+            copy_sockaddr(&r->local, &src->send_recv.local);
+            copy_sockaddr(&r->remote, &src->send_recv.remote);
+            break;
+        case RECORD_TYPE_BIND:
+            r->pid = src->bind.pid;
+            r->fd = src->bind.fd;
+            r->ns_net = src->bind.ns_net;
+            r->sock_type = src->bind.sock_type;
+            copy_sockaddr(&r->local, &src->bind.local);
+            break;
+        case RECORD_TYPE_KILL:
+            r->acting_pid = src->kill.acting_pid;
+            r->sig = src->kill.sig;
+            r->target_pid = src->kill.target_pid;
+            break;
+        case RECORD_TYPE_AUDIT_LOG_EXIT:
+            r->pid = src->audit_log_exit.pid;
+            r->syscall_number = src->audit_log_exit.syscall_number;
+            r->exit = src->audit_log_exit.ret;
+            r->las_event_id = src->audit_log_exit.e_las_ts.event_id;
+            r->las_sec = src->audit_log_exit.e_las_ts.tv_sec;
+            r->las_msec = src->audit_log_exit.e_las_ts.tv_nsec / 1000000;
+            break;
+    }
+    return 1;
+}
\ No newline at end of file
@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/*
+
+    A module for 'ameba-convert' which converts ameba output (JSON or binary) to SPADE
+    audit records.
+
+    Records are parsed into 'struct convert_record', correlated in a window
+    (see 'convert_window') and formatted as SPADE lines (see 'convert_spade_format').
+
+*/
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "common/types.h"
+
+
+/*
+    Default number of records in the correlation window.
+*/
+#define CONVERT_DEFAULT_WINDOW_SIZE 50
+
+/*
+    Max size (bytes) of a SPADE line including the newline.
+*/
+#define CONVERT_SPADE_MAX_LINE_LEN 2048
+
+
+struct convert_sockaddr
+{
+    // 'sockaddr_len' of the record.
+    unsigned int len;
+    // Bytes in 'addr'.
+    unsigned int addr_size;
+    unsigned char addr[SOCKADDR_MAX_SIZE];
+};
+
+/*
+    The members of all record types needed for the conversion. Members not in the
+    record type are 0.
+*/
+struct convert_record
+{
+    unsigned long long task_ctx_id;
+    int record_type;
+    pid_t pid;
+    pid_t ppid;
+    int sys_id;
+    int fd;
+    short sock_type;
+    inode_num_t ns_ipc;
+    inode_num_t ns_mnt;
+    inode_num_t ns_pid;
+    inode_num_t ns_pid_children;
+    inode_num_t ns_net;
+    inode_num_t ns_usr;
+    uid_t uid;
+    uid_t euid;
+    uid_t suid;
+    uid_t fsuid;
+    gid_t gid;
+    gid_t egid;
+    gid_t sgid;
+    gid_t fsgid;
+    pid_t acting_pid;
+    int sig;
+    pid_t target_pid;
+    int syscall_number;
+    long exit;
+    unsigned long las_event_id;
+    long long las_sec;
+    long las_msec;
+    char comm[COMM_MAX_SIZE];
+    struct convert_sockaddr local;
+    struct convert_sockaddr remote;
+};
+
+/*
+    The last known 'record_cred' and 'record_new_process' of a process.
+*/
+struct convert_proc_info
+{
+    int has_cred;
+    uid_t uid;
+    uid_t euid;
+    uid_t suid;
+    uid_t fsuid;
+    gid_t gid;
+    gid_t egid;
+    gid_t sgid;
+    gid_t fsgid;
+    int has_new_process;
+    pid_t ppid;
+    char comm[COMM_MAX_SIZE];
+};
+
+/*
+    An audit_log_exit record and the record of the same syscall.
+*/
+struct convert_match
+{
+    struct convert_record ale;
+    struct convert_record other;
+    struct convert_proc_info proc_info;
+};
+
+struct convert_matches
+{
+    struct convert_match *items;
+    size_t len;
+    size_t cap;
+};
+
+
+/*
+    Parse a JSON record i.e. a line of the JSON output.
+
+    Return:
+        0  -> Success
+        -1 -> Invalid JSON or the record has no 'record_type' or 'task_ctx_id'
+*/
+int convert_json_parse(const char *line, size_t line_len, struct convert_record *r);
+
+/*
+    Parse a binary record. The record does not need to be aligned.
+
+    Return:
+        1  -> Success
+        0  -> Unknown record type or size. Skip the record
+        -1 -> Invalid record
+*/
+int convert_binary_parse(const void *record, size_t record_len, struct convert_record *r);
+
+
+struct convert_window_entry;
+struct convert_window_key;
+struct convert_proc_infos;
+
+/*
+    A window of the last records in which an audit_log_exit record is matched with the
+    record of the same syscall i.e. the next record with the same 'task_ctx_id' and the
+    expected record type. Records are indexed by ('task_ctx_id', 'record_type') so a
+    match is found without scanning the window.
+*/
+struct convert_window
+{
+    int size;
+    int len;
+    // All entries in the order added. Unused entries are in 'free_entries'.
+    struct convert_window_entry *entries;
+    struct convert_window_entry *oldest;
+    struct convert_window_entry *newest;
+    struct convert_window_entry *free_entries;
+    // Hash of ('task_ctx_id', 'record_type') to the entries with it in the order added.
+    struct convert_window_key **buckets;
+    unsigned int bucket_mask;
+    struct convert_window_key *keys;
+    struct convert_window_key *free_keys;
+    struct convert_proc_infos *proc_infos;
+};
+
+/*
+    Return:
+        0  -> Success
+        -1 -> Error
+*/
+int convert_window_init(struct convert_window *w, int size);
+
+void convert_window_free(struct convert_window *w);
+
+/*
+    Add the record to the window. If the window is full then the oldest record is
+    matched, and any match is appended to 'matches'.
+
+    Return:
+        0  -> Success
+        -1 -> Error i.e. out of memory
+*/
+int convert_window_add(struct convert_window *w, const struct convert_record *r, struct convert_matches *matches);
+
+/*
+    Match all the records in the window. See 'convert_window_add'.
+*/
+int convert_window_flush(struct convert_window *w, struct convert_matches *matches);
+
+
+/*
+    Write the SPADE line (with the newline) for the match into 'dst' which must have
+    at least CONVERT_SPADE_MAX_LINE_LEN bytes.
+
+    Return: The size of the line
+*/
+size_t convert_spade_format(const struct convert_match *m, char *dst);
\ No newline at end of file
@@ -0,0 +1,477 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "utils/convert/convert.h"
+
+
+/*
+    A minimal parser for the JSON records written by 'record_serializer_json'. Only the
+    members needed for the conversion are read. Unknown members are skipped.
+*/
+
+typedef enum {
+    FIELD_INT = 1,
+    FIELD_UINT,
+    FIELD_SHORT,
+    FIELD_LONG,
+    FIELD_ULONG,
+    FIELD_ULONGLONG,
+    FIELD_COMM,
+    FIELD_SOCKADDR,
+    FIELD_SOCKADDR_LEN,
+    FIELD_TIME,
+    FIELD_LOCAL,
+    FIELD_REMOTE,
+    FIELD_LAS_AUDIT,
+    FIELD_RECORD_TYPE,
+    FIELD_TASK_CTX_ID
+} field_type_t;
+
+struct field
+{
+    const char *key;
+    unsigned char key_len;
+    unsigned char type;
+    unsigned short offset;
+};
+
+#define FIELD(key, type, member) { key, sizeof(key) - 1, type, offsetof(struct convert_record, member) }
+#define FIELD_OF(key, type, st, member) { key, sizeof(key) - 1, type, offsetof(st, member) }
+
+static const struct field record_fields[] = {
+    FIELD("record_type", FIELD_RECORD_TYPE, record_type),
+    FIELD("task_ctx_id", FIELD_TASK_CTX_ID, task_ctx_id),
+    FIELD("pid", FIELD_INT, pid),
+    FIELD("ppid", FIELD_INT, ppid),
+    FIELD("sys_id", FIELD_INT, sys_id),
+    FIELD("comm", FIELD_COMM, comm),
+    FIELD("fd", FIELD_INT, fd),
+    FIELD("sock_type", FIELD_SHORT, sock_type),
+    FIELD("ns_ipc", FIELD_UINT, ns_ipc),
+    FIELD("ns_mnt", FIELD_UINT, ns_mnt),
+    FIELD("ns_pid", FIELD_UINT, ns_pid),
+    FIELD("ns_pid_children", FIELD_UINT, ns_pid_children),
+    FIELD("ns_net", FIELD_UINT, ns_net),
+    FIELD("ns_usr", FIELD_UINT, ns_usr),
+    FIELD("uid", FIELD_UINT, uid),
+    FIELD("euid", FIELD_UINT, euid),
+    FIELD("suid", FIELD_UINT, suid),
+    FIELD("fsuid", FIELD_UINT, fsuid),
+    FIELD("gid", FIELD_UINT, gid),
+    FIELD("egid", FIELD_UINT, egid),
+    FIELD("sgid", FIELD_UINT, sgid),
+    FIELD("fsgid", FIELD_UINT, fsgid),
+    FIELD("acting_pid", FIELD_INT, acting_pid),
+    FIELD("sig", FIELD_INT, sig),
+    FIELD("target_pid", FIELD_INT, target_pid),
+    FIELD("syscall_number", FIELD_INT, syscall_number),
+    FIELD("exit", FIELD_LONG, exit),
+    FIELD("local", FIELD_LOCAL, local),
+    FIELD("remote", FIELD_REMOTE, remote),
+    FIELD("las_audit", FIELD_LAS_AUDIT, las_event_id),
+    { NULL, 0, 0, 0 }
+};
+
+static const struct field sockaddr_fields[] = {
+    FIELD_OF("sockaddr", FIELD_SOCKADDR, struct convert_sockaddr, addr),
+    FIELD_OF("sockaddr_len", FIELD_SOCKADDR_LEN, struct convert_sockaddr, len),
+    { NULL, 0, 0, 0 }
+};
+
+static const struct field las_audit_fields[] = {
+    FIELD("event_id", FIELD_ULONG, las_event_id),
+    FIELD("time", FIELD_TIME, las_sec),
+    { NULL, 0, 0, 0 }
+};
+
+struct parser
+{
+    const char *p;
+    const char *end;
+    // Set when 'record_type' and 'task_ctx_id' are read.
+    int has_record_type;
+    int has_task_ctx_id;
+};
+
+
+static void skip_ws(struct parser *s)
+{
+    while (s->p < s->end && (*s->p == ' ' || *s->p == '\t' || *s->p == '\n' || *s->p == '\r'))
+        s->p++;
+}
+
+static int expect(struct parser *s, char c)
+{
+    skip_ws(s);
+    if (s->p >= s->end || *s->p != c)
+        return -1;
+    s->p++;
+    return 0;
+}
+
+/*
+    Parse a string without unescaping it.
+
+    Return:
+        0  -> 'str' and 'str_len' are set to the string between the quotes
+        -1 -> Error
+*/
+static int parse_raw_str(struct parser *s, const char **str, size_t *str_len)
+{
+    if (expect(s, '"') != 0)
+        return -1;
+    const char *start = s->p;
+    while (s->p < s->end && *s->p != '"')
+    {
+        if (*s->p == '\\')
+            s->p++;
+        s->p++;
+    }
+    if (s->p >= s->end)
+        return -1;
+    *str = start;
+    *str_len = s->p - start;
+    s->p++;
+    return 0;
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+/*
+    Parse a string and unescape it into 'dst' of 'dst_len' bytes with the NUL.
+    Longer strings are truncated.
+*/
+static int parse_str(struct parser *s, char *dst, size_t dst_len)
+{
+    const char *str;
+    size_t str_len;
+    if (parse_raw_str(s, &str, &str_len) != 0)
+        return -1;
+
+    size_t j = 0;
+    for (size_t i = 0; i < str_len && j + 1 < dst_len; i++)
+    {
+        char c = str[i];
+        if (c == '\\' && i + 1 < str_len)
+        {
+            c = str[++i];
+            switch (c)
+            {
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                case 'u':
+                    if (i + 4 >= str_len)
+                        return -1;
+                    // Only \u00XX is written for records.
+                    c = (char)((hex_value(str[i + 3]) << 4) | hex_value(str[i + 4]));
+                    i += 4;
+                    break;
+                default: break;
+            }
+        }
+        dst[j++] = c;
+    }
+    if (dst_len > 0)
+        dst[j] = '\0';
+    return 0;
+}
+
+static int parse_hex(struct parser *s, struct convert_sockaddr *sa)
+{
+    const char *str;
+    size_t str_len;
+    if (parse_raw_str(s, &str, &str_len) != 0)
+        return -1;
+
+    size_t n = str_len / 2;
+    if (n > sizeof(sa->addr))
+        n = sizeof(sa->addr);
+    for (size_t i = 0; i < n; i++)
+    {
+        int hi = hex_value(str[2 * i]);
+        int lo = hex_value(str[2 * i + 1]);
+        if (hi < 0 || lo < 0)
+            return -1;
+        sa->addr[i] = (unsigned char)((hi << 4) | lo);
+    }
+    sa->addr_size = n;
+    return 0;
+}
+
+static int parse_ull(struct parser *s, unsigned long long *val, int *negative)
+{
+    skip_ws(s);
+    *negative = 0;
+    if (s->p < s->end && *s->p == '-')
+    {
+        *negative = 1;
+        s->p++;
+    }
+    if (s->p >= s->end || *s->p < '0' || *s->p > '9')
+        return -1;
+    unsigned long long v = 0;
+    while (s->p < s->end && *s->p >= '0' && *s->p <= '9')
+        v = v * 10 + (*s->p++ - '0');
+    *val = v;
+    return 0;
+}
+
+static int parse_ll(struct parser *s, long long *val)
+{
+    unsigned long long v;
+    int negative;
+    if (parse_ull(s, &v, &negative) != 0)
+        return -1;
+    *val = negative ? -(long long)v : (long long)v;
+    return 0;
+}
+
+/*
+    Parse "<sec>.<msec>" as written by 'jsonify_core_write_timespec64'.
+*/
+static int parse_time(struct parser *s, struct convert_record *r)
+{
+    if (parse_ll(s, &r->las_sec) != 0)
+        return -1;
+    r->las_msec = 0;
+    if (s->p < s->end && *s->p == '.')
+    {
+        s->p++;
+        int digits = 0;
+        while (s->p < s->end && *s->p >= '0' && *s->p <= '9')
+        {
+            if (digits < 3)
+                r->las_msec = r->las_msec * 10 + (*s->p - '0');
+            digits++;
+            s->p++;
+        }
+        for (; digits < 3; digits++)
+            r->las_msec *= 10;
+    }
+    return 0;
+}
+
+static int skip_value(struct parser *s, int depth);
+
+static int skip_container(struct parser *s, char close, int depth)
+{
+    if (depth > 16)
+        return -1;
+    s->p++;
+    skip_ws(s);
+    if (s->p < s->end && *s->p == close)
+    {
+        s->p++;
+        return 0;
+    }
+    while (s->p < s->end)
+    {
+        if (close == '}')
+        {
+            const char *key;
+            size_t key_len;
+            if (parse_raw_str(s, &key, &key_len) != 0 || expect(s, ':') != 0)
+                return -1;
+        }
+        if (skip_value(s, depth + 1) != 0)
+            return -1;
+        skip_ws(s);
+        if (s->p < s->end && *s->p == ',')
+        {
+            s->p++;
+            continue;
+        }
+        return expect(s, close);
+    }
+    return -1;
+}
+
+static int skip_value(struct parser *s, int depth)
+{
+    skip_ws(s);
+    if (s->p >= s->end)
+        return -1;
+    switch (*s->p)
+    {
+        case '"':
+        {
+            const char *str;
+            size_t str_len;
+            return parse_raw_str(s, &str, &str_len);
+        }
+        case '{':
+            return skip_container(s, '}', depth);
+        case '[':
+            return skip_container(s, ']', depth);
+        default:
+            // Numbers and literals.
+            while (s->p < s->end && *s->p != ',' && *s->p != '}' && *s->p != ']'
+                && *s->p != ' ' && *s->p != '\n' && *s->p != '\r' && *s->p != '\t')
+                s->p++;
+            return 0;
+    }
+}
+
+static const struct field *find_field(const struct field *fields, const char *key, size_t key_len)
+{
+    for (const struct field *f = fields; f->key; f++)
+    {
+        if (f->key_len == key_len && memcmp(f->key, key, key_len) == 0)
+            return f;
+    }
+    return NULL;
+}
+
+static int parse_obj(struct parser *s, const struct field *fields, void *dst, struct convert_record *r);
+
+static int parse_field(struct parser *s, const struct field *f, void *dst, struct convert_record *r)
+{
+    char *member = (char *)dst + f->offset;
+    unsigned long long u;
+    long long l;
+    int negative;
+
+    switch (f->type)
+    {
+        case FIELD_RECORD_TYPE:
+            s->has_record_type = 1;
+            // fallthrough
+        case FIELD_INT:
+            if (parse_ll(s, &l) != 0)
+                return -1;
+            *(int *)member = (int)l;
+            return 0;
+        case FIELD_UINT:
+        case FIELD_SOCKADDR_LEN:
+            if (parse_ull(s, &u, &negative) != 0)
+                return -1;
+            *(unsigned int *)member = (unsigned int)u;
+            return 0;
+        case FIELD_SHORT:
+            if (parse_ll(s, &l) != 0)
+                return -1;
+            *(short *)member = (short)l;
+            return 0;
+        case FIELD_LONG:
+            if (parse_ll(s, &l) != 0)
+                return -1;
+            *(long *)member = (long)l;
+            return 0;
+        case FIELD_ULONG:
+            if (parse_ull(s, &u, &negative) != 0)
+                return -1;
+            *(unsigned long *)member = (unsigned long)u;
+            return 0;
+        case FIELD_TASK_CTX_ID:
+            s->has_task_ctx_id = 1;
+            // fallthrough
+        case FIELD_ULONGLONG:
+            if (parse_ull(s, &u, &negative) != 0)
+                return -1;
+            *(unsigned long long *)member = u;
+            return 0;
+        case FIELD_COMM:
+            return parse_str(s, member, COMM_MAX_SIZE);
+        case FIELD_SOCKADDR:
+            return parse_hex(s, (struct convert_sockaddr *)dst);
+        case FIELD_TIME:
+            return parse_time(s, r);
+        case FIELD_LOCAL:
+        case FIELD_REMOTE:
+            return parse_obj(s, sockaddr_fields, member, r);
+        case FIELD_LAS_AUDIT:
+            return parse_obj(s, las_audit_fields, r, r);
+        default:
+            return skip_value(s, 0);
+    }
+}
+
+/*
+    Parse an object setting the members in 'fields' at 'dst'.
+*/
+static int parse_obj(struct parser *s, const struct field *fields, void *dst, struct convert_record *r)
+{
+    if (expect(s, '{') != 0)
+        return -1;
+    skip_ws(s);
+    if (s->p < s->end && *s->p == '}')
+    {
+        s->p++;
+        return 0;
+    }
+
+    while (s->p < s->end)
+    {
+        const char *key;
+        size_t key_len;
+        if (parse_raw_str(s, &key, &key_len) != 0 || expect(s, ':') != 0)
+            return -1;
+
+        const struct field *f = find_field(fields, key, key_len);
+        if (f)
+        {
+            if (parse_field(s, f, dst, r) != 0)
+                return -1;
+        } else if (skip_value(s, 1) != 0)
+        {
+            return -1;
+        }
+
+        skip_ws(s);
+        if (s->p < s->end && *s->p == ',')
+        {
+            s->p++;
+            continue;
+        }
+        return expect(s, '}');
+    }
+    return -1;
+}
+
+int convert_json_parse(const char *line, size_t line_len, struct convert_record *r)
+{
+    struct parser s = {
+        .p = line,
+        .end = line + line_len,
+        .has_record_type = 0,
+        .has_task_ctx_id = 0
+    };
+
+    memset(r, 0, sizeof(*r));
+    if (parse_obj(&s, record_fields, r, r) != 0)
+        return -1;
+    if (!s.has_record_type || !s.has_task_ctx_id)
+        return -1;
+    return 0;
+}
\ No newline at end of file
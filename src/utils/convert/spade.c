@@ -0,0 +1,253 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <string.h>
+
+#include "utils/convert/convert.h"
+
+
+static const char hex_digits[] = "0123456789abcdef";
+
+
+static char *put_str(char *p, const char *s)
+{
+    size_t len = strlen(s);
+    memcpy(p, s, len);
+    return p + len;
+}
+
+static char *put_ull(char *p, unsigned long long val)
+{
+    char digits[20];
+    int len = 0;
+    do
+    {
+        digits[len++] = '0' + (val % 10);
+        val /= 10;
+    } while (val > 0);
+    while (len > 0)
+        *p++ = digits[--len];
+    return p;
+}
+
+static char *put_ll(char *p, long long val)
+{
+    if (val < 0)
+    {
+        *p++ = '-';
+        return put_ull(p, -(unsigned long long)val);
+    }
+    return put_ull(p, val);
+}
+
+/*
+    Write the value as the hex of its 32-bit two's complement without leading zeros.
+*/
+static char *put_hex32(char *p, int val)
+{
+    unsigned int v = (unsigned int)val;
+    char digits[8];
+    int len = 0;
+    do
+    {
+        digits[len++] = hex_digits[v & 0xf];
+        v >>= 4;
+    } while (v > 0);
+    while (len > 0)
+        *p++ = digits[--len];
+    return p;
+}
+
+static char *put_hex_bytes(char *p, const unsigned char *bytes, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        *p++ = hex_digits[bytes[i] >> 4];
+        *p++ = hex_digits[bytes[i] & 0xf];
+    }
+    return p;
+}
+
+/*
+    Write "type=USER msg=audit(<time>:<event id>):".
+*/
+static char *put_msg(char *p, const struct convert_record *ale)
+{
+    p = put_str(p, "type=USER msg=audit(");
+    p = put_ll(p, ale->las_sec);
+    *p++ = '.';
+    *p++ = '0' + (ale->las_msec / 100) % 10;
+    *p++ = '0' + (ale->las_msec / 10) % 10;
+    *p++ = '0' + ale->las_msec % 10;
+    *p++ = ':';
+    p = put_ull(p, ale->las_event_id);
+    return put_str(p, "):");
+}
+
+static char *put_proc_info(char *p, const struct convert_proc_info *info)
+{
+    if (info->has_cred)
+    {
+        p = put_str(p, " uid=");
+        p = put_ull(p, info->uid);
+        p = put_str(p, " euid=");
+        p = put_ull(p, info->euid);
+        p = put_str(p, " suid=");
+        p = put_ull(p, info->suid);
+        p = put_str(p, " fsuid=");
+        p = put_ull(p, info->fsuid);
+        p = put_str(p, " gid=");
+        p = put_ull(p, info->gid);
+        p = put_str(p, " egid=");
+        p = put_ull(p, info->egid);
+        p = put_str(p, " sgid=");
+        p = put_ull(p, info->sgid);
+        p = put_str(p, " fsgid=");
+        p = put_ull(p, info->fsgid);
+    }
+    if (info->has_new_process)
+    {
+        p = put_str(p, " ppid=");
+        p = put_ll(p, info->ppid);
+        p = put_str(p, " comm=");
+        p = put_hex_bytes(p, (const unsigned char *)info->comm, strnlen(info->comm, sizeof(info->comm)));
+    }
+    return p;
+}
+
+static char *put_namespace(char *p, const struct convert_record *ale, const struct convert_record *r)
+{
+    const char *operation;
+    switch (r->sys_id)
+    {
+        case SYS_ID_CLONE:
+            operation = "NEWPROCESS";
+            break;
+        case SYS_ID_SETNS:
+            operation = "SETNS";
+            break;
+        case SYS_ID_UNSHARE:
+            operation = "UNSHARE";
+            break;
+        default:
+            operation = "None";
+            break;
+    }
+
+    p = put_msg(p, ale);
+    p = put_str(p, " ns_syscall=");
+    p = put_ll(p, ale->syscall_number);
+    p = put_str(p, " ns_subtype=ns_namespaces ns_operation=ns_");
+    p = put_str(p, operation);
+    p = put_str(p, " ns_ns_pid=");
+    p = put_ll(p, ale->exit);
+    p = put_str(p, " ns_host_pid=");
+    p = put_ll(p, r->pid);
+    p = put_str(p, " ns_inum_mnt=");
+    p = put_ull(p, r->ns_mnt);
+    p = put_str(p, " ns_inum_net=");
+    p = put_ull(p, r->ns_net);
+    p = put_str(p, " ns_inum_pid=");
+    p = put_ull(p, r->ns_pid);
+    p = put_str(p, " ns_inum_pid_children=");
+    p = put_ull(p, r->ns_pid_children);
+    p = put_str(p, " ns_inum_usr=");
+    p = put_ull(p, r->ns_usr);
+    p = put_str(p, " ns_inum_ipc=");
+    p = put_ull(p, r->ns_ipc);
+    return p;
+}
+
+static char *put_netio(char *p, const struct convert_match *m)
+{
+    const struct convert_record *ale = &m->ale;
+    const struct convert_record *r = &m->other;
+
+    p = put_msg(p, ale);
+    p = put_str(p, " netio_intercepted=\"syscall=");
+    p = put_ll(p, ale->syscall_number);
+    p = put_str(p, " exit=");
+    p = put_ll(p, ale->exit);
+    p = put_str(p, " success=1 fd=");
+    p = put_ll(p, r->fd);
+    p = put_str(p, " pid=");
+    p = put_ll(p, r->pid);
+    p = put_proc_info(p, &m->proc_info);
+    p = put_str(p, " socktype=");
+    p = put_ll(p, r->sock_type);
+    p = put_str(p, " local_saddr=");
+    p = put_hex_bytes(p, r->local.addr, r->local.addr_size);
+    p = put_str(p, " remote_saddr=");
+    // A bind has no remote.
+    if (r->record_type != RECORD_TYPE_BIND)
+        p = put_hex_bytes(p, r->remote.addr, r->remote.addr_size);
+    // The local size as in SPADE's netio records.
+    p = put_str(p, " remote_saddr_size=");
+    p = put_ull(p, r->local.len);
+    p = put_str(p, " net_ns_inum=");
+    p = put_ull(p, r->ns_net);
+    *p++ = '"';
+    return p;
+}
+
+static char *put_kill(char *p, const struct convert_match *m)
+{
+    const struct convert_record *ale = &m->ale;
+    const struct convert_record *r = &m->other;
+
+    p = put_msg(p, ale);
+    p = put_str(p, " ubsi_intercepted=\"syscall=");
+    p = put_ll(p, ale->syscall_number);
+    p = put_str(p, ale->exit == 0 ? " success=yes" : " success=no");
+    p = put_str(p, " exit=");
+    p = put_ll(p, ale->exit);
+    p = put_str(p, " a0=");
+    p = put_hex32(p, r->target_pid);
+    p = put_str(p, " a1=");
+    p = put_hex32(p, r->sig);
+    p = put_str(p, " a2=0 a3=0 items=0 pid=");
+    p = put_ll(p, r->acting_pid);
+    p = put_proc_info(p, &m->proc_info);
+    *p++ = '"';
+    return p;
+}
+
+size_t convert_spade_format(const struct convert_match *m, char *dst)
+{
+    char *p = dst;
+    switch (m->other.record_type)
+    {
+        case RECORD_TYPE_NAMESPACE:
+            p = put_namespace(p, &m->ale, &m->other);
+            break;
+        case RECORD_TYPE_BIND:
+        case RECORD_TYPE_SEND_RECV:
+        case RECORD_TYPE_CONNECT:
+        case RECORD_TYPE_ACCEPT:
+            p = put_netio(p, m);
+            break;
+        case RECORD_TYPE_KILL:
+            p = put_kill(p, m);
+            break;
+        default:
+            return 0;
+    }
+    *p++ = '\n';
+    return p - dst;
+}
\ No newline at end of file
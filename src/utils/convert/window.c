@@ -0,0 +1,404 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+
+#include "utils/convert/convert.h"
+
+
+struct convert_window_entry
+{
+    struct convert_record record;
+    // Order added.
+    struct convert_window_entry *prev;
+    struct convert_window_entry *next;
+    // Next with the same key. Also the next free entry.
+    struct convert_window_entry *key_next;
+    struct convert_window_key *key;
+};
+
+struct convert_window_key
+{
+    unsigned long long task_ctx_id;
+    int record_type;
+    struct convert_window_entry *head;
+    struct convert_window_entry *tail;
+    // Next in the bucket. Also the next free key.
+    struct convert_window_key *bucket_next;
+};
+
+struct convert_proc_info_slot
+{
+    int used;
+    pid_t pid;
+    struct convert_proc_info info;
+};
+
+struct convert_proc_infos
+{
+    struct convert_proc_info_slot *slots;
+    size_t cap;
+    size_t len;
+};
+
+
+static unsigned int hash_key(unsigned long long task_ctx_id, int record_type)
+{
+    unsigned long long h = (task_ctx_id ^ ((unsigned long long)record_type << 56)) * 0x9E3779B97F4A7C15ULL;
+    return (unsigned int)(h >> 32);
+}
+
+static unsigned int hash_pid(pid_t pid)
+{
+    return (unsigned int)(((unsigned long long)(unsigned int)pid * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+/*
+    Return: The record type matched with the audit_log_exit record of the syscall, or 0.
+*/
+static int get_record_type_for_syscall(int syscall_number)
+{
+    switch (syscall_number)
+    {
+        case __NR_setns:
+        case __NR_unshare:
+        case __NR_clone:
+#ifdef __NR_clone3
+        case __NR_clone3:
+#endif
+            return RECORD_TYPE_NAMESPACE;
+        case __NR_bind:
+            return RECORD_TYPE_BIND;
+        case __NR_sendto:
+        case __NR_sendmsg:
+        case __NR_recvfrom:
+        case __NR_recvmsg:
+            return RECORD_TYPE_SEND_RECV;
+        case __NR_connect:
+            return RECORD_TYPE_CONNECT;
+        case __NR_accept:
+        case __NR_accept4:
+            return RECORD_TYPE_ACCEPT;
+        case __NR_kill:
+            return RECORD_TYPE_KILL;
+        default:
+            return 0;
+    }
+}
+
+
+static struct convert_proc_info_slot *proc_infos_find_slot(struct convert_proc_info_slot *slots, size_t cap, pid_t pid)
+{
+    size_t i = hash_pid(pid) & (cap - 1);
+    while (slots[i].used && slots[i].pid != pid)
+        i = (i + 1) & (cap - 1);
+    return &slots[i];
+}
+
+static int proc_infos_grow(struct convert_proc_infos *p)
+{
+    size_t cap = p->cap ? p->cap * 2 : 1024;
+    struct convert_proc_info_slot *slots = calloc(cap, sizeof(*slots));
+    if (!slots)
+        return -1;
+
+    for (size_t i = 0; i < p->cap; i++)
+    {
+        if (!p->slots[i].used)
+            continue;
+        *proc_infos_find_slot(slots, cap, p->slots[i].pid) = p->slots[i];
+    }
+    free(p->slots);
+    p->slots = slots;
+    p->cap = cap;
+    return 0;
+}
+
+static const struct convert_proc_info *proc_infos_get(struct convert_proc_infos *p, pid_t pid)
+{
+    if (p->cap == 0)
+        return NULL;
+    struct convert_proc_info_slot *slot = proc_infos_find_slot(p->slots, p->cap, pid);
+    return slot->used ? &slot->info : NULL;
+}
+
+static int proc_infos_set(struct convert_proc_infos *p, const struct convert_record *r)
+{
+    if ((p->len + 1) * 4 > p->cap * 3 && proc_infos_grow(p) != 0)
+        return -1;
+
+    struct convert_proc_info_slot *slot = proc_infos_find_slot(p->slots, p->cap, r->pid);
+    if (!slot->used)
+    {
+        memset(slot, 0, sizeof(*slot));
+        slot->used = 1;
+        slot->pid = r->pid;
+        p->len++;
+    }
+
+    struct convert_proc_info *info = &slot->info;
+    if (r->record_type == RECORD_TYPE_CRED)
+    {
+        info->has_cred = 1;
+        info->uid = r->uid;
+        info->euid = r->euid;
+        info->suid = r->suid;
+        info->fsuid = r->fsuid;
+        info->gid = r->gid;
+        info->egid = r->egid;
+        info->sgid = r->sgid;
+        info->fsgid = r->fsgid;
+    } else {
+        info->has_new_process = 1;
+        info->ppid = r->ppid;
+        memcpy(info->comm, r->comm, sizeof(info->comm));
+    }
+    return 0;
+}
+
+
+int convert_window_init(struct convert_window *w, int size)
+{
+    if (size < 1)
+        return -1;
+
+    memset(w, 0, sizeof(*w));
+    w->size = size;
+
+    unsigned int buckets = 1;
+    while (buckets < (unsigned int)size * 2)
+        buckets <<= 1;
+    w->bucket_mask = buckets - 1;
+
+    w->entries = calloc(size, sizeof(*w->entries));
+    w->keys = calloc(size, sizeof(*w->keys));
+    w->buckets = calloc(buckets, sizeof(*w->buckets));
+    w->proc_infos = calloc(1, sizeof(*w->proc_infos));
+    if (!w->entries || !w->keys || !w->buckets || !w->proc_infos)
+    {
+        convert_window_free(w);
+        return -1;
+    }
+
+    for (int i = 0; i < size; i++)
+    {
+        w->entries[i].key_next = w->free_entries;
+        w->free_entries = &w->entries[i];
+        w->keys[i].bucket_next = w->free_keys;
+        w->free_keys = &w->keys[i];
+    }
+    return 0;
+}
+
+void convert_window_free(struct convert_window *w)
+{
+    free(w->entries);
+    free(w->keys);
+    free(w->buckets);
+    if (w->proc_infos)
+        free(w->proc_infos->slots);
+    free(w->proc_infos);
+    memset(w, 0, sizeof(*w));
+}
+
+static struct convert_window_key *find_key(struct convert_window *w, unsigned long long task_ctx_id, int record_type)
+{
+    struct convert_window_key *k = w->buckets[hash_key(task_ctx_id, record_type) & w->bucket_mask];
+    while (k && (k->task_ctx_id != task_ctx_id || k->record_type != record_type))
+        k = k->bucket_next;
+    return k;
+}
+
+/*
+    Return: The oldest entry with the key, or NULL.
+*/
+static struct convert_window_entry *find_entry(struct convert_window *w, unsigned long long task_ctx_id, int record_type)
+{
+    struct convert_window_key *k = find_key(w, task_ctx_id, record_type);
+    return k ? k->head : NULL;
+}
+
+static void add_entry(struct convert_window *w, const struct convert_record *r)
+{
+    struct convert_window_entry *e = w->free_entries;
+    w->free_entries = e->key_next;
+
+    e->record = *r;
+    e->prev = w->newest;
+    e->next = NULL;
+    e->key_next = NULL;
+    if (w->newest)
+        w->newest->next = e;
+    else
+        w->oldest = e;
+    w->newest = e;
+
+    struct convert_window_key *k = find_key(w, r->task_ctx_id, r->record_type);
+    if (!k)
+    {
+        k = w->free_keys;
+        w->free_keys = k->bucket_next;
+        k->task_ctx_id = r->task_ctx_id;
+        k->record_type = r->record_type;
+        k->head = NULL;
+        k->tail = NULL;
+        struct convert_window_key **bucket = &w->buckets[hash_key(r->task_ctx_id, r->record_type) & w->bucket_mask];
+        k->bucket_next = *bucket;
+        *bucket = k;
+    }
+    if (k->tail)
+        k->tail->key_next = e;
+    else
+        k->head = e;
+    k->tail = e;
+    e->key = k;
+
+    w->len++;
+}
+
+/*
+    Remove the entry which must be the oldest with its key.
+*/
+static void remove_entry(struct convert_window *w, struct convert_window_entry *e)
+{
+    if (e->prev)
+        e->prev->next = e->next;
+    else
+        w->oldest = e->next;
+    if (e->next)
+        e->next->prev = e->prev;
+    else
+        w->newest = e->prev;
+
+    struct convert_window_key *k = e->key;
+    k->head = e->key_next;
+    if (!k->head)
+    {
+        k->tail = NULL;
+        struct convert_window_key **p = &w->buckets[hash_key(k->task_ctx_id, k->record_type) & w->bucket_mask];
+        while (*p != k)
+            p = &(*p)->bucket_next;
+        *p = k->bucket_next;
+        k->bucket_next = w->free_keys;
+        w->free_keys = k;
+    }
+
+    e->key = NULL;
+    e->key_next = w->free_entries;
+    w->free_entries = e;
+    w->len--;
+}
+
+static int add_match(
+    struct convert_window *w, struct convert_matches *matches,
+    const struct convert_record *ale, const struct convert_record *other
+)
+{
+    if (matches->len == matches->cap)
+    {
+        size_t cap = matches->cap ? matches->cap * 2 : 1024;
+        struct convert_match *items = realloc(matches->items, cap * sizeof(*items));
+        if (!items)
+            return -1;
+        matches->items = items;
+        matches->cap = cap;
+    }
+
+    struct convert_match *m = &matches->items[matches->len++];
+    m->ale = *ale;
+    m->other = *other;
+
+    pid_t pid = other->record_type == RECORD_TYPE_KILL ? other->acting_pid : other->pid;
+    const struct convert_proc_info *info = proc_infos_get(w->proc_infos, pid);
+    if (info)
+        m->proc_info = *info;
+    else
+        memset(&m->proc_info, 0, sizeof(m->proc_info));
+    return 0;
+}
+
+/*
+    Remove the oldest record and match it with the oldest record of the same
+    'task_ctx_id' and the expected record type.
+*/
+static int match_oldest(struct convert_window *w, struct convert_matches *matches)
+{
+    struct convert_window_entry *e1 = w->oldest;
+    const struct convert_record *r1 = &e1->record;
+    struct convert_window_entry *e2 = NULL;
+    int err = 0;
+
+    // The entry is not reused until the next add.
+    remove_entry(w, e1);
+
+    switch (r1->record_type)
+    {
+        case RECORD_TYPE_AUDIT_LOG_EXIT:
+        {
+            int record_type = get_record_type_for_syscall(r1->syscall_number);
+            if (!record_type)
+                break;
+            e2 = find_entry(w, r1->task_ctx_id, record_type);
+            if (e2)
+                err = add_match(w, matches, r1, &e2->record);
+            break;
+        }
+        case RECORD_TYPE_NAMESPACE:
+        case RECORD_TYPE_BIND:
+        case RECORD_TYPE_SEND_RECV:
+        case RECORD_TYPE_CONNECT:
+        case RECORD_TYPE_ACCEPT:
+        case RECORD_TYPE_KILL:
+            // The audit_log_exit record is removed even if it is of another syscall.
+            e2 = find_entry(w, r1->task_ctx_id, RECORD_TYPE_AUDIT_LOG_EXIT);
+            if (e2 && get_record_type_for_syscall(e2->record.syscall_number) == r1->record_type)
+                err = add_match(w, matches, &e2->record, r1);
+            break;
+        case RECORD_TYPE_CRED:
+        case RECORD_TYPE_NEW_PROCESS:
+            err = proc_infos_set(w->proc_infos, r1);
+            break;
+        default:
+            break;
+    }
+
+    if (e2)
+        remove_entry(w, e2);
+    return err;
+}
+
+int convert_window_add(struct convert_window *w, const struct convert_record *r, struct convert_matches *matches)
+{
+    add_entry(w, r);
+    if (w->len >= w->size)
+        return match_oldest(w, matches);
+    return 0;
+}
+
+int convert_window_flush(struct convert_window *w, struct convert_matches *matches)
+{
+    while (w->len > 0)
+    {
+        if (match_oldest(w, matches) != 0)
+            return -1;
+    }
+    return 0;
+}
\ No newline at end of file
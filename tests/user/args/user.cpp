@@ -20,6 +20,9 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <CppUTest/CommandLineTestRunner.h>
 #include <CppUTest/TestHarness.h>
 
+#include <stdio.h>
+#include <unistd.h>
+
 extern "C" {
     #include "user/args/user.h"
     #include "user/args/helper.h"
@@ -86,6 +89,18 @@ TEST(UserArgUserInputGroup, TestDefaults)
         u_in.output_file.path,
         strlen("/tmp/current_prov_log.json")
     );
+    CHECK_EQUAL(0, u_in.output_file.flush_policy.buffer_size);
+    CHECK_EQUAL(50, u_in.output_file.flush_policy.flush_interval_ms);
+    CHECK_EQUAL(OUTPUT_FILE_ENGINE_SYNC, u_in.output_file.engine);
+    CHECK_EQUAL(OUTPUT_FORMAT_JSON, u_in.format);
+    CHECK_EQUAL(0, u_in.pipeline_workers);
+    CHECK_EQUAL(RINGBUF_MODE_SHARED, u_in.ringbuf.mode);
+    CHECK_EQUAL(RINGBUF_CONSUMERS_SINGLE, u_in.ringbuf.consumers);
+    CHECK_EQUAL(16UL << 20, u_in.ringbuf.size);
+    CHECK_EQUAL(-1, u_in.ringbuf.wakeup_watermark);
+    CHECK_EQUAL(100, u_in.ringbuf.max_latency_ms);
+    CHECK_EQUAL(60, u_in.stats.interval_sec);
+    CHECK_EQUAL(0, u_in.stats.path[0]);
     CHECK_EQUAL(0, u_in.output_net.ip_family);
     CHECK_EQUAL(-1, u_in.output_net.port);
     CHECK_EQUAL(0, u_in.output_net.ip[0]);
@@ -246,42 +261,1128 @@ TEST(UserArgUserInputGroup, TestOutputFileRelativeInvalid)
     check_parse_state_exit_error(&u_in);
 }
 
-TEST(UserArgUserInputGroup, TestOutputNetValidIp4)
+TEST(UserArgUserInputGroup, TestOutputFileFlushPolicy)
 {
     struct user_input u_in;
 
     char* argv[] = {
         (char*)"test",
         (char*)"--output-uri",
-        (char*)"udp://0.0.0.0:1212"
+        (char*)"file:///tmp/test.json?buffer_size=1M&flush_ms=200"
     };
     int argc = sizeof(argv) / sizeof(char*);
     user_args_user_parse(&u_in, argc, argv);
     check_parse_state_no_exit(&u_in);
 
-    CHECK_EQUAL(OUTPUT_NET, u_in.o_type);
-    CHECK_EQUAL(AF_INET, u_in.output_net.ip_family);
-    STRNCMP_EQUAL("0.0.0.0", u_in.output_net.ip, strlen("0.0.0.0"));
-    CHECK_EQUAL(1212, u_in.output_net.port);
+    CHECK_EQUAL(OUTPUT_FILE, u_in.o_type);
+    STRCMP_EQUAL("/tmp/test.json", u_in.output_file.path);
+    CHECK_EQUAL(1024 * 1024, u_in.output_file.flush_policy.buffer_size);
+    CHECK_EQUAL(200, u_in.output_file.flush_policy.flush_interval_ms);
 }
 
-TEST(UserArgUserInputGroup, TestOutputNetValidIp6)
+TEST(UserArgUserInputGroup, TestOutputFileFlushPolicyBufferSizeOnly)
 {
     struct user_input u_in;
 
     char* argv[] = {
         (char*)"test",
         (char*)"--output-uri",
-        (char*)"udp://[::1]:1212"
+        (char*)"file:///tmp/test.json?buffer_size=65536"
     };
     int argc = sizeof(argv) / sizeof(char*);
     user_args_user_parse(&u_in, argc, argv);
     check_parse_state_no_exit(&u_in);
 
-    CHECK_EQUAL(OUTPUT_NET, u_in.o_type);
-    CHECK_EQUAL(AF_INET6, u_in.output_net.ip_family);
-    STRNCMP_EQUAL("::1", u_in.output_net.ip, strlen("::1"));
-    CHECK_EQUAL(1212, u_in.output_net.port);
+    STRCMP_EQUAL("/tmp/test.json", u_in.output_file.path);
+    CHECK_EQUAL(65536, u_in.output_file.flush_policy.buffer_size);
+    CHECK_EQUAL(50, u_in.output_file.flush_policy.flush_interval_ms);
+}
+
+TEST(UserArgUserInputGroup, TestOutputFileFlushPolicyInvalidSize)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/test.json?buffer_size=-1"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestOutputFileFlushPolicyInvalidInterval)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/test.json?flush_ms=10s"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestOutputFileEngineUring)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/test.json?engine=uring"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    STRCMP_EQUAL("/tmp/test.json", u_in.output_file.path);
+    CHECK_EQUAL(OUTPUT_FILE_ENGINE_URING, u_in.output_file.engine);
+}
+
+TEST(UserArgUserInputGroup, TestOutputFileEngineInvalid)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/test.json?engine=aio"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestOutputFileCompressionDefault)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/test.json"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(OUTPUT_COMPRESSION_NONE, u_in.output_file.compression.codec);
+    CHECK_EQUAL(default_output_compression_block_size, u_in.output_file.compression.block_size);
+}
+
+TEST(UserArgUserInputGroup, TestOutputFileCompressionInvalid)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/test.json?compression=gzip"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+#ifdef OUTPUT_COMPRESSION_HAVE_ZSTD
+TEST(UserArgUserInputGroup, TestOutputFileCompressionZstdFromExtension)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/test.jsonl.zst?compression_level=19&compression_block_size=1M"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    STRCMP_EQUAL("/tmp/test.jsonl.zst", u_in.output_file.path);
+    CHECK_EQUAL(OUTPUT_COMPRESSION_ZSTD, u_in.output_file.compression.codec);
+    CHECK_EQUAL(19, u_in.output_file.compression.level);
+    CHECK_EQUAL(1UL << 20, u_in.output_file.compression.block_size);
+}
+
+TEST(UserArgUserInputGroup, TestOutputFileCompressionBlockSizeInvalid)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/test.jsonl.zst?compression_block_size=1K"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+#else
+TEST(UserArgUserInputGroup, TestOutputFileCompressionZstdUnsupported)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/test.jsonl.zst"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+#endif
+
+#ifdef OUTPUT_COMPRESSION_HAVE_LZ4
+TEST(UserArgUserInputGroup, TestOutputFileCompressionLz4)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/test.json?compression=lz4"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(OUTPUT_COMPRESSION_LZ4, u_in.output_file.compression.codec);
+}
+
+TEST(UserArgUserInputGroup, TestOutputFileCompressionLz4LevelInvalid)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/test.lz4?compression_level=13"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+#endif
+
+TEST(UserArgUserInputGroup, TestOutputFileRotation)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/test.json?rotate_size=100M&rotate_interval_sec=3600&rotate_retain=24"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    STRCMP_EQUAL("/tmp/test.json", u_in.output_file.path);
+    CHECK_EQUAL(100UL << 20, u_in.output_file.rotation.max_size);
+    CHECK_EQUAL(3600, u_in.output_file.rotation.interval_sec);
+    CHECK_EQUAL(24, u_in.output_file.rotation.retain);
+}
+
+TEST(UserArgUserInputGroup, TestOutputFileRotationSizeTooSmall)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/test.json?rotate_size=1K"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestOutputFileUnknownOption)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/test.json?unknown=1"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestOutputFileMalformedOption)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/test.json?buffer_size"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestPipelineWorkers)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--pipeline-workers",
+        (char*)"4"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(4, u_in.pipeline_workers);
+}
+
+TEST(UserArgUserInputGroup, TestPipelineWorkersInvalid)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"-w",
+        (char*)"-1"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestPipelineWorkersTooMany)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--pipeline-workers",
+        (char*)"100000"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestRingbufPercpuNuma)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--ringbuf-mode",
+        (char*)"percpu",
+        (char*)"--ringbuf-consumers",
+        (char*)"numa"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(RINGBUF_MODE_PERCPU, u_in.ringbuf.mode);
+    CHECK_EQUAL(RINGBUF_CONSUMERS_PER_NUMA_NODE, u_in.ringbuf.consumers);
+}
+
+TEST(UserArgUserInputGroup, TestRingbufNumaRequiresPercpu)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--ringbuf-consumers",
+        (char*)"numa"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestRingbufModeInvalid)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--ringbuf-mode",
+        (char*)"pernode"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestRingbufSize)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--ringbuf-size",
+        (char*)"64M"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(64UL << 20, u_in.ringbuf.size);
+}
+
+TEST(UserArgUserInputGroup, TestRingbufSizeNotPowerOf2)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--ringbuf-size",
+        (char*)"12K"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestRingbufSizeTooSmall)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--ringbuf-size",
+        (char*)"1024"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestRingbufSizePage)
+{
+    struct user_input u_in;
+
+    char page_size[32];
+    snprintf(page_size, sizeof(page_size), "%ld", sysconf(_SC_PAGESIZE));
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--ringbuf-size",
+        page_size
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL((size_t)sysconf(_SC_PAGESIZE), u_in.ringbuf.size);
+}
+
+TEST(UserArgUserInputGroup, TestRingbufPercpuDefaultSize)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--ringbuf-mode",
+        (char*)"percpu"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    // The default is split between the CPUs.
+    size_t size = u_in.ringbuf.size;
+    size_t ncpus = (size_t)sysconf(_SC_NPROCESSORS_CONF);
+    CHECK_EQUAL(0, size & (size - 1));
+    CHECK(size <= (16UL << 20));
+    CHECK(size >= (256UL << 10));
+    CHECK(size == (256UL << 10) || size * ncpus <= (64UL << 20));
+    CHECK(size == (16UL << 20) || size * 2 * ncpus > (64UL << 20));
+}
+
+TEST(UserArgUserInputGroup, TestRingbufWakeup)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--ringbuf-wakeup-watermark",
+        (char*)"64K",
+        (char*)"--ringbuf-max-latency",
+        (char*)"20"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(64L << 10, u_in.ringbuf.wakeup_watermark);
+    CHECK_EQUAL(20, u_in.ringbuf.max_latency_ms);
+}
+
+TEST(UserArgUserInputGroup, TestRingbufWakeupEveryRecord)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--ringbuf-wakeup-watermark",
+        (char*)"0"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(0, u_in.ringbuf.wakeup_watermark);
+}
+
+TEST(UserArgUserInputGroup, TestRingbufWakeupWatermarkNotLessThanSize)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--ringbuf-size",
+        (char*)"64K",
+        (char*)"--ringbuf-wakeup-watermark",
+        (char*)"64K"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestRingbufMaxLatencyInvalid)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--ringbuf-max-latency",
+        (char*)"0"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestFormatBinary)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--format",
+        (char*)"binary"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(OUTPUT_FORMAT_BINARY, u_in.format);
+}
+
+TEST(UserArgUserInputGroup, TestFormatCbor)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--format",
+        (char*)"cbor"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(OUTPUT_FORMAT_CBOR, u_in.format);
+}
+
+TEST(UserArgUserInputGroup, TestFormatColumnar)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--format",
+        (char*)"columnar"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(OUTPUT_FORMAT_COLUMNAR, u_in.format);
+    CHECK_EQUAL(default_columnar_batch_rows, u_in.columnar.batch_rows);
+    CHECK_EQUAL(default_columnar_max_age_ms, u_in.columnar.max_age_ms);
+}
+
+TEST(UserArgUserInputGroup, TestFormatColumnarBatch)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--format",
+        (char*)"columnar",
+        (char*)"--columnar-batch-rows",
+        (char*)"100",
+        (char*)"--columnar-max-age",
+        (char*)"0"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(100, u_in.columnar.batch_rows);
+    CHECK_EQUAL(0, u_in.columnar.max_age_ms);
+}
+
+TEST(UserArgUserInputGroup, TestFormatColumnarBatchRowsInvalid)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--format",
+        (char*)"columnar",
+        (char*)"--columnar-batch-rows",
+        (char*)"0"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestFormatColumnarNet)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"udp://0.0.0.0:1212",
+        (char*)"--format",
+        (char*)"columnar"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestFormatInvalid)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--format",
+        (char*)"xml"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestStats)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--stats-interval",
+        (char*)"10",
+        (char*)"--stats-file",
+        (char*)"/tmp/ameba_stats.json"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(10, u_in.stats.interval_sec);
+    STRCMP_EQUAL("/tmp/ameba_stats.json", u_in.stats.path);
+}
+
+TEST(UserArgUserInputGroup, TestStatsFileRelativeInvalid)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--stats-file",
+        (char*)"ameba_stats.json"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestStatsIntervalInvalid)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--stats-interval",
+        (char*)"-5"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestOutputNetValidIp4)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"udp://0.0.0.0:1212"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(OUTPUT_NET, u_in.o_type);
+    CHECK_EQUAL(AF_INET, u_in.output_net.ip_family);
+    STRNCMP_EQUAL("0.0.0.0", u_in.output_net.ip, strlen("0.0.0.0"));
+    CHECK_EQUAL(1212, u_in.output_net.port);
+}
+
+TEST(UserArgUserInputGroup, TestOutputNetValidIp6)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"udp://[::1]:1212"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(OUTPUT_NET, u_in.o_type);
+    CHECK_EQUAL(AF_INET6, u_in.output_net.ip_family);
+    STRNCMP_EQUAL("::1", u_in.output_net.ip, strlen("::1"));
+    CHECK_EQUAL(1212, u_in.output_net.port);
+}
+
+TEST(UserArgUserInputGroup, TestOutputNetDefaultPacking)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"udp://[::1]:1212"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(default_output_udp_datagram_size_ipv6, u_in.output_net.datagram_size);
+    CHECK_EQUAL(default_output_udp_batch, u_in.output_net.batch);
+    CHECK_EQUAL(default_output_flush_interval_ms, u_in.output_net.flush_interval_ms);
+}
+
+TEST(UserArgUserInputGroup, TestOutputNetOptions)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"udp://127.0.0.1:1212?datagram_size=8K&batch=64&flush_ms=10"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(OUTPUT_NET, u_in.o_type);
+    CHECK_EQUAL(1212, u_in.output_net.port);
+    CHECK_EQUAL(8192UL, u_in.output_net.datagram_size);
+    CHECK_EQUAL(64, u_in.output_net.batch);
+    CHECK_EQUAL(10, u_in.output_net.flush_interval_ms);
+}
+
+TEST(UserArgUserInputGroup, TestOutputNetInvalidBatch)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"udp://127.0.0.1:1212?batch=0"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestOutputTcpDefaults)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"tcp://127.0.0.1:1212"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(OUTPUT_TCP, u_in.o_type);
+    CHECK_EQUAL(AF_INET, u_in.output_tcp.ip_family);
+    STRCMP_EQUAL("127.0.0.1", u_in.output_tcp.ip);
+    CHECK_EQUAL(1212, u_in.output_tcp.port);
+    CHECK_EQUAL(default_output_tcp_spool_size, u_in.output_tcp.spool_size);
+    CHECK_EQUAL(OUTPUT_SPOOL_POLICY_BLOCK, u_in.output_tcp.spool_policy);
+    CHECK_EQUAL(default_output_tcp_reconnect_min_ms, u_in.output_tcp.reconnect_min_ms);
+    CHECK_EQUAL(default_output_tcp_reconnect_max_ms, u_in.output_tcp.reconnect_max_ms);
+    CHECK_EQUAL(OUTPUT_COMPRESSION_NONE, u_in.output_tcp.compression.codec);
+}
+
+TEST(UserArgUserInputGroup, TestOutputTcpOptions)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"tcp://[::1]:1212?spool_size=1M&spool_policy=drop_oldest&flush_ms=5&reconnect_min_ms=10&reconnect_max_ms=1000"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(OUTPUT_TCP, u_in.o_type);
+    CHECK_EQUAL(AF_INET6, u_in.output_tcp.ip_family);
+    CHECK_EQUAL(1024UL * 1024, u_in.output_tcp.spool_size);
+    CHECK_EQUAL(OUTPUT_SPOOL_POLICY_DROP_OLDEST, u_in.output_tcp.spool_policy);
+    CHECK_EQUAL(5, u_in.output_tcp.flush_interval_ms);
+    CHECK_EQUAL(10, u_in.output_tcp.reconnect_min_ms);
+    CHECK_EQUAL(1000, u_in.output_tcp.reconnect_max_ms);
+}
+
+TEST(UserArgUserInputGroup, TestOutputTcpInvalidPolicy)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"tcp://127.0.0.1:1212?spool_policy=drop_all"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestOutputTcpInvalidReconnect)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"tcp://127.0.0.1:1212?reconnect_min_ms=500&reconnect_max_ms=100"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestOutputTcpSpill)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"tcp://127.0.0.1:1212?spill_dir=/var/spool/ameba&spill_size=2G&spill_segment_size=64M"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    STRCMP_EQUAL("/var/spool/ameba", u_in.output_tcp.spill.dir);
+    CHECK_EQUAL(2UL << 30, u_in.output_tcp.spill.max_size);
+    CHECK_EQUAL(64UL << 20, u_in.output_tcp.spill.segment_size);
+}
+
+TEST(UserArgUserInputGroup, TestOutputTcpSpillDropPolicy)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"tcp://127.0.0.1:1212?spill_dir=/var/spool/ameba&spool_policy=drop_newest"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestOutputTcpSpillTooSmall)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"tcp://127.0.0.1:1212?spill_dir=/var/spool/ameba&spill_size=16M"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+#ifdef OUTPUT_COMPRESSION_HAVE_ZSTD
+TEST(UserArgUserInputGroup, TestOutputTcpCompression)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"tcp://127.0.0.1:1212?compression=zstd&compression_level=3&compression_block_size=64K"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(OUTPUT_COMPRESSION_ZSTD, u_in.output_tcp.compression.codec);
+    CHECK_EQUAL(3, u_in.output_tcp.compression.level);
+    CHECK_EQUAL(64UL << 10, u_in.output_tcp.compression.block_size);
+}
+
+TEST(UserArgUserInputGroup, TestOutputTcpAndFileCompression)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/test.jsonl.zst",
+        (char*)"--output-uri",
+        (char*)"tcp://127.0.0.1:1212?compression=zstd"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+#else
+TEST(UserArgUserInputGroup, TestOutputTcpCompressionZstdUnsupported)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"tcp://127.0.0.1:1212?compression=zstd"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+#endif
+
+TEST(UserArgUserInputGroup, TestOutputUnixDefaults)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"unix:///run/consumer.sock"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(OUTPUT_UNIX, u_in.o_type);
+    STRCMP_EQUAL("/run/consumer.sock", u_in.output_unix.path);
+    CHECK_EQUAL(default_output_unix_message_size, u_in.output_unix.message_size);
+}
+
+TEST(UserArgUserInputGroup, TestOutputUnixOptions)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"unix:///run/consumer.sock?message_size=0&flush_ms=5"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(OUTPUT_UNIX, u_in.o_type);
+    STRCMP_EQUAL("/run/consumer.sock", u_in.output_unix.path);
+    CHECK_EQUAL(0, u_in.output_unix.message_size);
+    CHECK_EQUAL(5, u_in.output_unix.flush_interval_ms);
+}
+
+TEST(UserArgUserInputGroup, TestOutputUnixRelativePath)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"unix://consumer.sock"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestOutputShm)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"shm:///run/ameba.sock?size=1M"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(OUTPUT_SHM, u_in.o_type);
+    STRCMP_EQUAL("/run/ameba.sock", u_in.output_shm.path);
+    CHECK_EQUAL(1024UL * 1024, u_in.output_shm.size);
+}
+
+TEST(UserArgUserInputGroup, TestOutputShmInvalidSize)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"shm:///run/ameba.sock?size=3M"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestOutputMultipleSinks)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--format",
+        (char*)"binary",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/archive.bin",
+        (char*)"--output-uri",
+        (char*)"tcp://127.0.0.1:9000?format=json"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(2, u_in.sinks_len);
+    CHECK_EQUAL(OUTPUT_FILE, u_in.o_type);
+    CHECK_EQUAL(OUTPUT_FILE, u_in.sinks[0].o_type);
+    CHECK_EQUAL(OUTPUT_FORMAT_BINARY, u_in.sinks[0].format);
+    CHECK_EQUAL(OUTPUT_TCP, u_in.sinks[1].o_type);
+    CHECK_EQUAL(OUTPUT_FORMAT_JSON, u_in.sinks[1].format);
+    STRCMP_EQUAL("/tmp/archive.bin", u_in.output_file.path);
+    CHECK_EQUAL(9000, u_in.output_tcp.port);
+}
+
+TEST(UserArgUserInputGroup, TestOutputDefaultSink)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_no_exit(&u_in);
+
+    CHECK_EQUAL(1, u_in.sinks_len);
+    CHECK_EQUAL(OUTPUT_FILE, u_in.sinks[0].o_type);
+    CHECK_EQUAL(u_in.format, u_in.sinks[0].format);
+}
+
+TEST(UserArgUserInputGroup, TestOutputDuplicateScheme)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/a.json",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/b.json"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestOutputSinkInvalidFormat)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"unix:///run/ameba.sock?format=xml"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestOutputSinkColumnarNotFile)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/archive.bin?format=columnar",
+        (char*)"--output-uri",
+        (char*)"unix:///run/ameba.sock?format=columnar"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
+}
+
+TEST(UserArgUserInputGroup, TestOutputMultipleSinksPipeline)
+{
+    struct user_input u_in;
+
+    char* argv[] = {
+        (char*)"test",
+        (char*)"--pipeline-workers",
+        (char*)"2",
+        (char*)"--output-uri",
+        (char*)"file:///tmp/archive.bin",
+        (char*)"--output-uri",
+        (char*)"unix:///run/ameba.sock"
+    };
+    int argc = sizeof(argv) / sizeof(char*);
+    user_args_user_parse(&u_in, argc, argv);
+    check_parse_state_exit_error(&u_in);
 }
 
 TEST(UserArgUserInputGroup, TestOutputNetInvalidIp4)
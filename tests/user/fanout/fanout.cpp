@@ -0,0 +1,322 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <string.h>
+#include <time.h>
+
+extern "C" {
+    #include "user/fanout/fanout.h"
+}
+
+struct id_record
+{
+    struct elem_common e_common;
+    unsigned long id;
+} __attribute__((packed));
+
+/*
+    Serializers that output the record id (stored after elem_common) as is,
+    once or twice.
+*/
+static unsigned long id_serialize_calls = 0;
+static unsigned long id2_serialize_calls = 0;
+
+static long serialize_id_times(void *dst, size_t dst_len, struct elem_common *record, size_t record_len, int times)
+{
+    if (record_len != sizeof(struct id_record))
+        return -1;
+    for (int i = 0; i < times; i++)
+        memcpy((char *)dst + i * sizeof(unsigned long), &((struct id_record *)record)->id, sizeof(unsigned long));
+    return times * sizeof(unsigned long);
+}
+
+static long serialize_id(void *dst, size_t dst_len, struct elem_common *record, size_t record_len)
+{
+    id_serialize_calls++;
+    return serialize_id_times(dst, dst_len, record, record_len, 1);
+}
+
+static long serialize_id2(void *dst, size_t dst_len, struct elem_common *record, size_t record_len)
+{
+    id2_serialize_calls++;
+    return serialize_id_times(dst, dst_len, record, record_len, 2);
+}
+
+static const struct record_serializer record_serializer_id = {
+    .serialize = serialize_id
+};
+
+static const struct record_serializer record_serializer_id2 = {
+    .serialize = serialize_id2
+};
+
+/*
+    Writers that check that ids arrive in increasing order. Writer N blocks
+    while 'checks[N].blocked' is set.
+*/
+struct check_state
+{
+    unsigned long records;
+    unsigned long last_id;
+    unsigned long out_of_order;
+    unsigned long flushes;
+    int blocked;
+};
+
+static struct check_state checks[2];
+
+static int set_init_args_check(void *ptr, size_t ptr_len) { return 0; }
+static int init_check() { return 0; }
+static int close_check() { return 0; }
+
+template <int N>
+static int write_check(void *data, size_t data_len)
+{
+    struct check_state *c = &checks[N];
+    while (__atomic_load_n(&c->blocked, __ATOMIC_ACQUIRE))
+    {
+        struct timespec ts = {0, 1000000};
+        nanosleep(&ts, NULL);
+    }
+
+    unsigned long id;
+    memcpy(&id, data, sizeof(id));
+    if (c->records > 0 && id <= c->last_id)
+        c->out_of_order++;
+    c->last_id = id;
+    c->records++;
+    return (int)data_len;
+}
+
+template <int N>
+static int flush_check(int force)
+{
+    checks[N].flushes++;
+    return 0;
+}
+
+static const struct record_writer record_writers_check[2] = {
+    {
+        .set_init_args = set_init_args_check,
+        .init = init_check,
+        .close = close_check,
+        .write = write_check<0>,
+        .flush = flush_check<0>
+    },
+    {
+        .set_init_args = set_init_args_check,
+        .init = init_check,
+        .close = close_check,
+        .write = write_check<1>,
+        .flush = flush_check<1>
+    }
+};
+
+static void init_args(
+    struct fanout_args *args,
+    struct consumer_stats *stats,
+    const struct record_serializer *serializer_0,
+    const struct record_serializer *serializer_1
+)
+{
+    memset(stats, 0, sizeof(struct consumer_stats));
+    memset(args, 0, sizeof(struct fanout_args));
+    args->sinks[0].serializer = serializer_0;
+    args->sinks[0].writer = &record_writers_check[0];
+    args->sinks[1].serializer = serializer_1;
+    args->sinks[1].writer = &record_writers_check[1];
+    args->sinks_len = 2;
+    args->queue_size = 64 * 1024;
+    args->stats = stats;
+    args->log_error = NULL;
+}
+
+static void submit_ids(struct fanout *f, unsigned long count)
+{
+    struct id_record r;
+    memset(&r, 0, sizeof(r));
+    for (unsigned long i = 0; i < count; i++)
+    {
+        r.id = i;
+        CHECK_EQUAL(0, fanout_submit(f, &r, sizeof(r)));
+    }
+}
+
+TEST_GROUP(FanoutGroup)
+{
+    void setup()
+    {
+        memset(&checks[0], 0, sizeof(checks));
+        id_serialize_calls = 0;
+        id2_serialize_calls = 0;
+    }
+};
+
+TEST(FanoutGroup, TestInvalidArgs)
+{
+    struct fanout f;
+    struct fanout_args args;
+    struct consumer_stats stats;
+
+    init_args(&args, &stats, &record_serializer_id, &record_serializer_id);
+    args.sinks_len = 0;
+    CHECK(fanout_start(&f, &args) != 0);
+
+    init_args(&args, &stats, &record_serializer_id, &record_serializer_id);
+    args.sinks[1].writer = NULL;
+    CHECK(fanout_start(&f, &args) != 0);
+
+    init_args(&args, &stats, &record_serializer_id, &record_serializer_id);
+    args.queue_size = 1000;
+    CHECK(fanout_start(&f, &args) != 0);
+}
+
+TEST(FanoutGroup, TestOrderedPerSink)
+{
+    struct fanout f;
+    struct fanout_args args;
+    struct consumer_stats stats;
+    init_args(&args, &stats, &record_serializer_id, &record_serializer_id2);
+    // Large enough for all the records.
+    args.queue_size = 0;
+    CHECK_EQUAL(0, fanout_start(&f, &args));
+
+    submit_ids(&f, 100000);
+    fanout_stop(&f);
+
+    for (int i = 0; i < 2; i++)
+    {
+        struct output_sink_stats sink_stats;
+        fanout_get_sink_stats(&f, i, &sink_stats);
+        CHECK_EQUAL(0, sink_stats.dropped_records);
+        CHECK_EQUAL(100000, sink_stats.records);
+        CHECK_EQUAL(100000, checks[i].records);
+        CHECK_EQUAL(0, checks[i].out_of_order);
+    }
+    CHECK_EQUAL(100000, id_serialize_calls);
+    CHECK_EQUAL(100000, id2_serialize_calls);
+    CHECK_EQUAL(100000 * 3 * sizeof(unsigned long), stats.bytes_written);
+}
+
+TEST(FanoutGroup, TestSharedSerializer)
+{
+    struct fanout f;
+    struct fanout_args args;
+    struct consumer_stats stats;
+    init_args(&args, &stats, &record_serializer_id, &record_serializer_id);
+    CHECK_EQUAL(0, fanout_start(&f, &args));
+
+    submit_ids(&f, 1000);
+    fanout_stop(&f);
+
+    CHECK_EQUAL(1000, id_serialize_calls);
+    CHECK_EQUAL(1000, checks[0].records);
+    CHECK_EQUAL(1000, checks[1].records);
+    CHECK_EQUAL(1000 * 2 * sizeof(unsigned long), stats.bytes_written);
+}
+
+TEST(FanoutGroup, TestBlockedSinkDoesNotStallOthers)
+{
+    struct fanout f;
+    struct fanout_args args;
+    struct consumer_stats stats;
+    init_args(&args, &stats, &record_serializer_id, &record_serializer_id2);
+    args.queue_size = 4096;
+    checks[0].blocked = 1;
+    CHECK_EQUAL(0, fanout_start(&f, &args));
+
+    // Never blocks although sink 0 does not write anything.
+    unsigned long count = 10000;
+    struct id_record r;
+    memset(&r, 0, sizeof(r));
+    for (unsigned long i = 0; i < count; i++)
+    {
+        r.id = i;
+        CHECK_EQUAL(0, fanout_submit(&f, &r, sizeof(r)));
+        // Keep pace with sink 1 so that it does not drop any.
+        struct output_sink_stats sink_stats;
+        do
+        {
+            fanout_get_sink_stats(&f, 1, &sink_stats);
+        } while (sink_stats.records + 64 < i);
+    }
+
+    struct output_sink_stats sink_0_stats;
+    fanout_get_sink_stats(&f, 0, &sink_0_stats);
+    CHECK(sink_0_stats.dropped_records > 0);
+    CHECK_EQUAL(sink_0_stats.dropped_records * sizeof(unsigned long), sink_0_stats.dropped_bytes);
+
+    __atomic_store_n(&checks[0].blocked, 0, __ATOMIC_RELEASE);
+    fanout_stop(&f);
+
+    struct output_sink_stats sink_stats;
+    fanout_get_sink_stats(&f, 0, &sink_stats);
+    CHECK_EQUAL(count, sink_stats.records + sink_stats.dropped_records);
+    CHECK_EQUAL(0, checks[0].out_of_order);
+
+    fanout_get_sink_stats(&f, 1, &sink_stats);
+    CHECK_EQUAL(0, sink_stats.dropped_records);
+    CHECK_EQUAL(count, checks[1].records);
+    CHECK_EQUAL(0, checks[1].out_of_order);
+}
+
+TEST(FanoutGroup, TestSerializeError)
+{
+    struct fanout f;
+    struct fanout_args args;
+    struct consumer_stats stats;
+    init_args(&args, &stats, &record_serializer_id, &record_serializer_id2);
+    CHECK_EQUAL(0, fanout_start(&f, &args));
+
+    struct elem_common bad;
+    memset(&bad, 0, sizeof(bad));
+    CHECK_EQUAL(-1, fanout_submit(&f, &bad, sizeof(bad)));
+    submit_ids(&f, 10);
+    fanout_stop(&f);
+
+    CHECK_EQUAL(2, stats.serialize_errors);
+    CHECK_EQUAL(10, checks[0].records);
+    CHECK_EQUAL(10, checks[1].records);
+}
+
+TEST(FanoutGroup, TestFlushWhenIdle)
+{
+    struct fanout f;
+    struct fanout_args args;
+    struct consumer_stats stats;
+    init_args(&args, &stats, &record_serializer_id, &record_serializer_id);
+    args.sinks[0].flush_interval_ms = 1;
+    CHECK_EQUAL(0, fanout_start(&f, &args));
+
+    submit_ids(&f, 1);
+    struct timespec ts = {0, 20 * 1000000};
+    nanosleep(&ts, NULL);
+    fanout_stop(&f);
+
+    CHECK(checks[0].flushes > 0);
+    CHECK_EQUAL(0, checks[1].flushes);
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
@@ -0,0 +1,246 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+extern "C" {
+    #include "user/jsonify/core.h"
+}
+
+
+TEST_GROUP(JsonifyCoreGroup)
+{
+    char dst[MAX_BUFFER_LEN];
+    struct json_buffer s;
+
+    void setup()
+    {
+        jsonify_core_init(&s, dst, sizeof(dst));
+        jsonify_core_open_obj(&s);
+    }
+};
+
+TEST(JsonifyCoreGroup, TestIntegers)
+{
+    jsonify_core_write_int(&s, "a", 0);
+    jsonify_core_write_int(&s, "b", INT_MIN);
+    jsonify_core_write_uint(&s, "c", UINT_MAX);
+    jsonify_core_write_long(&s, "d", LONG_MIN);
+    jsonify_core_write_ulong(&s, "e", ULONG_MAX);
+    jsonify_core_write_ulonglong(&s, "f", 10000000000ULL);
+    jsonify_core_write_short(&s, "g", -42);
+    jsonify_core_write_int(&s, "h", 99);
+    jsonify_core_write_int(&s, "i", 100);
+    jsonify_core_close_obj(&s);
+
+    char expected[MAX_BUFFER_LEN];
+    snprintf(
+        expected, sizeof(expected),
+        "{\"a\":%d,\"b\":%d,\"c\":%u,\"d\":%ld,\"e\":%lu,\"f\":%llu,\"g\":%hd,\"h\":%d,\"i\":%d}",
+        0, INT_MIN, UINT_MAX, LONG_MIN, ULONG_MAX, 10000000000ULL, (short)-42, 99, 100
+    );
+    STRCMP_EQUAL(expected, dst);
+    CHECK_EQUAL((int)strlen(expected), jsonify_core_get_total_chars_written(&s));
+    CHECK_EQUAL(0, jsonify_core_has_overflown(&s));
+}
+
+TEST(JsonifyCoreGroup, TestDigitCounts)
+{
+    // Every power of 10 and the value before it.
+    unsigned long long val = 1;
+    for (int i = 0; i < 20; i++)
+    {
+        char expected[64];
+        char actual[64];
+        struct json_buffer s_val;
+
+        jsonify_core_init(&s_val, actual, sizeof(actual));
+        jsonify_core_write_ulonglong(&s_val, "v", val);
+        snprintf(expected, sizeof(expected), "\"v\":%llu", val);
+        STRCMP_EQUAL(expected, actual);
+
+        jsonify_core_init(&s_val, actual, sizeof(actual));
+        jsonify_core_write_ulonglong(&s_val, "v", val - 1);
+        snprintf(expected, sizeof(expected), "\"v\":%llu", val - 1);
+        STRCMP_EQUAL(expected, actual);
+
+        val *= 10;
+    }
+}
+
+TEST(JsonifyCoreGroup, TestBytesStrAndLiteral)
+{
+    unsigned char bytes[] = {0x00, 0x0a, 0x7f, 0xa0, 0xff};
+    jsonify_core_write_bytes(&s, "bytes", bytes, sizeof(bytes));
+    jsonify_core_write_str(&s, "str", "value");
+    jsonify_core_write_as_literal(&s, "obj", "{\"x\":1}");
+    jsonify_core_close_obj(&s);
+    jsonify_core_write_newline(&s);
+
+    STRCMP_EQUAL("{\"bytes\":\"000a7fa0ff\",\"str\":\"value\",\"obj\":{\"x\":1}}\n", dst);
+}
+
+TEST(JsonifyCoreGroup, TestStrEscaped)
+{
+    jsonify_core_write_str(&s, "a", "q\"b\\n\nt\tc\x01\x1f");
+    jsonify_core_write_str(&s, "b", "\xc3\xa9\x7f");
+    jsonify_core_close_obj(&s);
+
+    STRCMP_EQUAL("{\"a\":\"q\\\"b\\\\n\\nt\\tc\\u0001\\u001f\",\"b\":\"\xc3\xa9\x7f\"}", dst);
+    CHECK_EQUAL((int)strlen(dst), jsonify_core_get_total_chars_written(&s));
+}
+
+TEST(JsonifyCoreGroup, TestStrEscapedAtEveryPosition)
+{
+    // The escaped char at every position in and around the 16 char chunks.
+    for (int len = 1; len <= 40; len++)
+    {
+        for (int pos = 0; pos < len; pos++)
+        {
+            char val[64];
+            memset(val, 'x', len);
+            val[len] = '\0';
+            val[pos] = '"';
+
+            char expected[128];
+            int e = 0;
+            expected[e++] = '"';
+            expected[e++] = 'v';
+            expected[e++] = '"';
+            expected[e++] = ':';
+            expected[e++] = '"';
+            for (int i = 0; i < len; i++)
+            {
+                if (i == pos)
+                    expected[e++] = '\\';
+                expected[e++] = val[i];
+            }
+            expected[e++] = '"';
+            expected[e] = '\0';
+
+            char actual[128];
+            struct json_buffer s_val;
+            jsonify_core_init(&s_val, actual, sizeof(actual));
+            CHECK_EQUAL(e, jsonify_core_write_str(&s_val, "v", val));
+            STRCMP_EQUAL(expected, actual);
+        }
+    }
+}
+
+TEST(JsonifyCoreGroup, TestStrEscapedOverflow)
+{
+    char small[16];
+    struct json_buffer s_small;
+    jsonify_core_init(&s_small, small, sizeof(small));
+
+    // 5 chars unescaped but 10 escaped, so "k":"..." no longer fits.
+    CHECK_EQUAL(0, jsonify_core_write_str(&s_small, "k", "\"\"\"\"\""));
+    CHECK_EQUAL(1, jsonify_core_has_overflown(&s_small));
+}
+
+TEST(JsonifyCoreGroup, TestNestedObj)
+{
+    jsonify_core_write_int(&s, "a", 1);
+    jsonify_core_open_nested_obj(&s, "b");
+    jsonify_core_write_int(&s, "c", 2);
+    jsonify_core_open_nested_obj(&s, "d");
+    jsonify_core_close_nested_obj(&s);
+    jsonify_core_write_int(&s, "e", 3);
+    jsonify_core_close_nested_obj(&s);
+    jsonify_core_open_nested_obj(&s, "f");
+    jsonify_core_write_str(&s, "g", "h");
+    jsonify_core_close_nested_obj(&s);
+    jsonify_core_close_obj(&s);
+
+    STRCMP_EQUAL("{\"a\":1,\"b\":{\"c\":2,\"d\":{},\"e\":3},\"f\":{\"g\":\"h\"}}", dst);
+}
+
+TEST(JsonifyCoreGroup, TestInitOnlyTerminates)
+{
+    char buf[8];
+    memset(buf, 'x', sizeof(buf));
+    struct json_buffer s_buf;
+    jsonify_core_init(&s_buf, buf, sizeof(buf));
+    STRCMP_EQUAL("", buf);
+    CHECK_EQUAL('x', buf[1]);
+
+    jsonify_core_open_obj(&s_buf);
+    STRCMP_EQUAL("{", buf);
+}
+
+TEST(JsonifyCoreGroup, TestTimespec)
+{
+    jsonify_core_write_timespec64(&s, "t1", 1700000000, 5000000);
+    jsonify_core_write_timespec64(&s, "t2", 0, 999999999);
+    jsonify_core_close_obj(&s);
+
+    STRCMP_EQUAL("{\"t1\":1700000000.005,\"t2\":0.999}", dst);
+}
+
+TEST(JsonifyCoreGroup, TestOverflow)
+{
+    char small[16];
+    struct json_buffer s_small;
+    jsonify_core_init(&s_small, small, sizeof(small));
+    jsonify_core_open_obj(&s_small);
+
+    // 1 + 11 = 12 chars fit in 15.
+    CHECK_EQUAL(11, jsonify_core_write_int(&s_small, "key", 12345));
+    CHECK_EQUAL(0, jsonify_core_has_overflown(&s_small));
+
+    // Does not fit.
+    CHECK_EQUAL(0, jsonify_core_write_int(&s_small, "key", 12345));
+    CHECK_EQUAL(1, jsonify_core_has_overflown(&s_small));
+
+    // Nothing is written after an overflow.
+    CHECK_EQUAL(0, jsonify_core_close_obj(&s_small));
+    STRCMP_EQUAL("{\"key\":12345", small);
+}
+
+TEST(JsonifyCoreGroup, TestExactFit)
+{
+    // 13 chars, a spare char and the null terminator are needed.
+    char exact[14];
+    struct json_buffer s_exact;
+    jsonify_core_init(&s_exact, exact, sizeof(exact));
+    jsonify_core_open_obj(&s_exact);
+    jsonify_core_write_int(&s_exact, "key", 12345);
+
+    CHECK_EQUAL(0, jsonify_core_close_obj(&s_exact));
+    CHECK_EQUAL(1, jsonify_core_has_overflown(&s_exact));
+
+    char fit[15];
+    struct json_buffer s_fit;
+    jsonify_core_init(&s_fit, fit, sizeof(fit));
+    jsonify_core_open_obj(&s_fit);
+    jsonify_core_write_int(&s_fit, "key", 12345);
+    CHECK_EQUAL(1, jsonify_core_close_obj(&s_fit));
+    CHECK_EQUAL(0, jsonify_core_has_overflown(&s_fit));
+    STRCMP_EQUAL("{\"key\":12345}", fit);
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
@@ -0,0 +1,232 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <string.h>
+#include <pthread.h>
+
+extern "C" {
+    #include "user/pipeline/pipeline.h"
+}
+
+/*
+    A serializer that outputs the record id (stored after elem_common) as is.
+*/
+static long serialize_id(void *dst, size_t dst_len, struct elem_common *record, size_t record_len)
+{
+    if (record_len != sizeof(struct elem_common) + sizeof(unsigned long))
+        return -1;
+    memcpy(dst, (char *)record + sizeof(struct elem_common), sizeof(unsigned long));
+    return sizeof(unsigned long);
+}
+
+static const struct record_serializer record_serializer_id = {
+    .serialize = serialize_id
+};
+
+/*
+    A writer that checks that ids arrive in order.
+*/
+static unsigned long next_expected_id = 0;
+static unsigned long out_of_order = 0;
+static unsigned long flushes = 0;
+static pthread_t writer_thread_id;
+static int writer_thread_changed = 0;
+
+static int set_init_args_check(void *ptr, size_t ptr_len) { return 0; }
+static int init_check() { return 0; }
+static int close_check() { return 0; }
+
+static int write_check(void *data, size_t data_len)
+{
+    if (next_expected_id == 0)
+        writer_thread_id = pthread_self();
+    else if (!pthread_equal(writer_thread_id, pthread_self()))
+        writer_thread_changed = 1;
+
+    unsigned long id;
+    memcpy(&id, data, sizeof(id));
+    if (id != next_expected_id)
+        out_of_order++;
+    next_expected_id = id + 1;
+    return (int)data_len;
+}
+
+static int flush_check(int force)
+{
+    flushes++;
+    return 0;
+}
+
+static const struct record_writer record_writer_check = {
+    .set_init_args = set_init_args_check,
+    .init = init_check,
+    .close = close_check,
+    .write = write_check,
+    .flush = flush_check
+};
+
+struct id_record
+{
+    struct elem_common e_common;
+    unsigned long id;
+} __attribute__((packed));
+
+static void init_args(struct pipeline_args *args, struct consumer_stats *stats, int workers, size_t slots_len)
+{
+    memset(stats, 0, sizeof(struct consumer_stats));
+    memset(args, 0, sizeof(struct pipeline_args));
+    args->workers = workers;
+    args->slots_len = slots_len;
+    args->serializer = &record_serializer_id;
+    args->writer = &record_writer_check;
+    args->flush_interval_ms = 0;
+    args->stats = stats;
+    args->log_error = NULL;
+}
+
+static void submit_ids(struct pipeline *p, unsigned long count)
+{
+    struct id_record r;
+    memset(&r, 0, sizeof(r));
+    for (unsigned long i = 0; i < count; i++)
+    {
+        r.id = i;
+        CHECK_EQUAL(0, pipeline_submit(p, &r, sizeof(r)));
+    }
+}
+
+TEST_GROUP(PipelineGroup)
+{
+    void setup()
+    {
+        next_expected_id = 0;
+        out_of_order = 0;
+        flushes = 0;
+        writer_thread_changed = 0;
+    }
+};
+
+TEST(PipelineGroup, TestInvalidArgs)
+{
+    struct pipeline p;
+    struct pipeline_args args;
+    struct consumer_stats stats;
+
+    init_args(&args, &stats, 0, 16);
+    CHECK(pipeline_start(&p, &args) != 0);
+
+    init_args(&args, &stats, 1, 16);
+    args.writer = NULL;
+    CHECK(pipeline_start(&p, &args) != 0);
+}
+
+TEST(PipelineGroup, TestOrderedSingleWorker)
+{
+    struct pipeline p;
+    struct pipeline_args args;
+    struct consumer_stats stats;
+    init_args(&args, &stats, 1, 16);
+    CHECK_EQUAL(0, pipeline_start(&p, &args));
+
+    submit_ids(&p, 1000);
+    pipeline_stop(&p);
+
+    CHECK_EQUAL(1000, next_expected_id);
+    CHECK_EQUAL(0, out_of_order);
+    CHECK_EQUAL(1000 * sizeof(unsigned long), stats.bytes_written);
+    CHECK_EQUAL(0, stats.serialize_errors);
+    CHECK_EQUAL(0, stats.write_errors);
+}
+
+TEST(PipelineGroup, TestOrderedManyWorkers)
+{
+    struct pipeline p;
+    struct pipeline_args args;
+    struct consumer_stats stats;
+    init_args(&args, &stats, 8, 64);
+    CHECK_EQUAL(0, pipeline_start(&p, &args));
+
+    submit_ids(&p, 200000);
+    pipeline_stop(&p);
+
+    CHECK_EQUAL(200000, next_expected_id);
+    CHECK_EQUAL(0, out_of_order);
+    CHECK_EQUAL(0, writer_thread_changed);
+    CHECK_EQUAL(200000 * sizeof(unsigned long), stats.bytes_written);
+}
+
+TEST(PipelineGroup, TestSerializeError)
+{
+    struct pipeline p;
+    struct pipeline_args args;
+    struct consumer_stats stats;
+    init_args(&args, &stats, 2, 16);
+    CHECK_EQUAL(0, pipeline_start(&p, &args));
+
+    struct elem_common bad;
+    memset(&bad, 0, sizeof(bad));
+    CHECK_EQUAL(0, pipeline_submit(&p, &bad, sizeof(bad)));
+    submit_ids(&p, 10);
+    pipeline_stop(&p);
+
+    CHECK_EQUAL(1, stats.serialize_errors);
+    CHECK_EQUAL(10, next_expected_id);
+    CHECK_EQUAL(0, out_of_order);
+}
+
+TEST(PipelineGroup, TestRecordTooLarge)
+{
+    struct pipeline p;
+    struct pipeline_args args;
+    struct consumer_stats stats;
+    init_args(&args, &stats, 1, 16);
+    CHECK_EQUAL(0, pipeline_start(&p, &args));
+
+    char big[64 * 1024];
+    memset(big, 0, sizeof(big));
+    CHECK_EQUAL(-1, pipeline_submit(&p, big, sizeof(big)));
+    pipeline_stop(&p);
+
+    CHECK_EQUAL(0, next_expected_id);
+}
+
+TEST(PipelineGroup, TestFlushWhenIdle)
+{
+    struct pipeline p;
+    struct pipeline_args args;
+    struct consumer_stats stats;
+    init_args(&args, &stats, 1, 16);
+    args.flush_interval_ms = 1;
+    CHECK_EQUAL(0, pipeline_start(&p, &args));
+
+    submit_ids(&p, 1);
+    struct timespec ts = {0, 20 * 1000000};
+    nanosleep(&ts, NULL);
+    pipeline_stop(&p);
+
+    CHECK(flushes > 0);
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
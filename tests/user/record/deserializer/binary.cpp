@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <string.h>
+
+extern "C" {
+    #include "user/error.h"
+    #include "user/record/deserializer/deserializer.h"
+    #include "user/record/deserializer/reader.h"
+    #include "user/record/serializer/serializer.h"
+
+    extern const struct record_deserializer record_deserializer_binary;
+    extern const struct record_serializer record_serializer_binary;
+}
+
+
+static void init_record_kill(struct record_kill *r, int event_id)
+{
+    memset(r, 0, sizeof(*r));
+    r->e_common.magic = AMEBA_MAGIC;
+    r->e_common.record_type = RECORD_TYPE_KILL;
+    r->e_common.version.major = RECORD_VERSION_MAJOR;
+    r->e_common.version.minor = RECORD_VERSION_MINOR;
+    r->e_common.version.patch = RECORD_VERSION_PATCH;
+    r->e_ts.event_id = event_id;
+    r->sig = 9;
+}
+
+static size_t write_stream(unsigned char *dst, size_t dst_len, int count)
+{
+    size_t i = record_serializer_binary.serialize_header(dst, dst_len);
+    for (int j = 0; j < count; j++)
+    {
+        struct record_kill r;
+        init_record_kill(&r, j);
+        i += record_serializer_binary.serialize(&dst[i], dst_len - i, &(r.e_common), sizeof(r));
+    }
+    return i;
+}
+
+/*
+    Read all the ready records and check that they follow 'next_event_id'.
+
+    Return: The event id expected next
+*/
+static int read_ready(int next_event_id)
+{
+    while (record_deserializer_binary.deserialize(NULL, 0) > 0)
+    {
+        struct record_kill r;
+        CHECK_EQUAL((int)sizeof(r), record_deserializer_binary.read(&r, sizeof(r)));
+        CHECK_EQUAL((unsigned long)next_event_id, r.e_ts.event_id);
+        next_event_id++;
+    }
+    return next_event_id;
+}
+
+TEST_GROUP(RecordDeserializerBinaryGroup)
+{
+    void teardown()
+    {
+        // Discard any state left by the test.
+        unsigned char bad[sizeof(struct record_stream_header)];
+        memset(bad, 0, sizeof(bad));
+        record_deserializer_binary.deserialize(bad, sizeof(bad));
+    }
+};
+
+TEST(RecordDeserializerBinaryGroup, TestDeserialize)
+{
+    unsigned char stream[1024];
+    size_t len = write_stream(stream, sizeof(stream), 2);
+
+    CHECK_EQUAL((int)sizeof(struct record_kill), record_deserializer_binary.deserialize(stream, len));
+    CHECK_EQUAL(2, read_ready(0));
+    CHECK_EQUAL(0, record_deserializer_binary.deserialize(NULL, 0));
+}
+
+TEST(RecordDeserializerBinaryGroup, TestSplitWhileRecordReady)
+{
+    unsigned char stream[1024];
+    size_t len = write_stream(stream, sizeof(stream), 3);
+
+    // The first record is ready but not read when the rest arrives.
+    size_t split = sizeof(struct record_stream_header) + sizeof(size_t) + sizeof(struct record_kill) + 5;
+    CHECK_EQUAL((int)sizeof(struct record_kill), record_deserializer_binary.deserialize(stream, split));
+    CHECK_EQUAL((int)sizeof(struct record_kill), record_deserializer_binary.deserialize(&stream[split], len - split));
+    CHECK_EQUAL(3, read_ready(0));
+}
+
+TEST(RecordDeserializerBinaryGroup, TestByteAtATime)
+{
+    unsigned char stream[1024];
+    size_t len = write_stream(stream, sizeof(stream), 3);
+
+    int next = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        CHECK_TRUE(record_deserializer_binary.deserialize(&stream[i], 1) >= 0);
+        next = read_ready(next);
+    }
+    CHECK_EQUAL(3, next);
+}
+
+TEST(RecordDeserializerBinaryGroup, TestReadDstInsufficient)
+{
+    unsigned char stream[1024];
+    size_t len = write_stream(stream, sizeof(stream), 1);
+    record_deserializer_binary.deserialize(stream, len);
+
+    unsigned char dst[8];
+    CHECK_EQUAL(ERR_DST_INSUFFICIENT, record_deserializer_binary.read(dst, sizeof(dst)));
+    CHECK_EQUAL(1, read_ready(0));
+}
+
+TEST(RecordDeserializerBinaryGroup, TestInvalidHeaderDiscards)
+{
+    unsigned char stream[1024];
+    size_t len = write_stream(stream, sizeof(stream), 1);
+    stream[0] ^= 0xff;
+
+    CHECK_EQUAL(ERR_STREAM_INVALID_HEADER, record_deserializer_binary.deserialize(stream, len));
+    CHECK_EQUAL(RECORD_READER_DEFAULT_BUF_LEN, record_deserializer_binary.get_available_space());
+
+    // A new stream can follow.
+    stream[0] ^= 0xff;
+    CHECK_EQUAL((int)sizeof(struct record_kill), record_deserializer_binary.deserialize(stream, len));
+    CHECK_EQUAL(1, read_ready(0));
+}
+
+TEST(RecordDeserializerBinaryGroup, TestAvailableSpace)
+{
+    unsigned char stream[1024];
+    size_t len = write_stream(stream, sizeof(stream), 1);
+
+    record_deserializer_binary.deserialize(stream, len - 1);
+    CHECK_EQUAL((int)(RECORD_READER_DEFAULT_BUF_LEN - len + 1), record_deserializer_binary.get_available_space());
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
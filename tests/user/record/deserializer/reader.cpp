@@ -0,0 +1,415 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+extern "C" {
+    #include "user/error.h"
+    #include "user/record/deserializer/reader.h"
+    #include "user/record/serializer/serializer.h"
+
+    extern const struct record_serializer record_serializer_binary;
+}
+
+
+static void init_record_kill(struct record_kill *r, int event_id)
+{
+    memset(r, 0, sizeof(*r));
+    r->e_common.magic = AMEBA_MAGIC;
+    r->e_common.record_type = RECORD_TYPE_KILL;
+    r->e_common.version.major = RECORD_VERSION_MAJOR;
+    r->e_common.version.minor = RECORD_VERSION_MINOR;
+    r->e_common.version.patch = RECORD_VERSION_PATCH;
+    r->e_ts.event_id = event_id;
+    r->acting_pid = 100;
+    r->sig = 9;
+    r->target_pid = 200;
+}
+
+/*
+    Write a stream of the header and 'count' kill records into 'dst'.
+
+    Return: The size of the stream
+*/
+static size_t write_stream(unsigned char *dst, size_t dst_len, int count)
+{
+    long len = record_serializer_binary.serialize_header(dst, dst_len);
+    CHECK_TRUE(len > 0);
+    size_t i = len;
+    for (int j = 0; j < count; j++)
+    {
+        struct record_kill r;
+        init_record_kill(&r, j);
+        len = record_serializer_binary.serialize(&dst[i], dst_len - i, &(r.e_common), sizeof(r));
+        CHECK_TRUE(len > 0);
+        i += len;
+    }
+    return i;
+}
+
+static void check_record(struct elem_common *record, size_t record_len, int event_id)
+{
+    struct record_kill r;
+    CHECK_EQUAL(sizeof(r), record_len);
+    memcpy(&r, record, sizeof(r));
+    CHECK_EQUAL(RECORD_TYPE_KILL, r.e_common.record_type);
+    CHECK_EQUAL((unsigned long)event_id, r.e_ts.event_id);
+    CHECK_EQUAL(9, r.sig);
+}
+
+/*
+    Add 'data' to the reader.
+*/
+static void add(struct record_reader *r, const unsigned char *data, size_t data_len)
+{
+    void *space;
+    size_t space_len;
+    CHECK_EQUAL(0, record_reader_get_space(r, &space, &space_len));
+    CHECK_TRUE(space_len >= data_len);
+    memcpy(space, data, data_len);
+    record_reader_commit(r, data_len);
+}
+
+
+TEST_GROUP(RecordReaderGroup)
+{
+    struct record_reader reader;
+
+    void setup()
+    {
+        CHECK_EQUAL(0, record_reader_init(&reader, RECORD_READER_DEFAULT_BUF_LEN));
+    }
+
+    void teardown()
+    {
+        record_reader_free(&reader);
+    }
+};
+
+TEST(RecordReaderGroup, TestInitTooSmall)
+{
+    struct record_reader r;
+    CHECK_EQUAL(-1, record_reader_init(&r, 16));
+}
+
+TEST(RecordReaderGroup, TestReadAll)
+{
+    unsigned char stream[4096];
+    size_t len = write_stream(stream, sizeof(stream), 5);
+    add(&reader, stream, len);
+
+    struct elem_common *record;
+    size_t record_len;
+    for (int i = 0; i < 5; i++)
+    {
+        CHECK_EQUAL(1, record_reader_next(&reader, &record, &record_len));
+        check_record(record, record_len, i);
+    }
+    CHECK_EQUAL(0, record_reader_next(&reader, &record, &record_len));
+    CHECK_EQUAL(RECORD_STREAM_HEADER_VERSION, reader.header.header_version);
+}
+
+TEST(RecordReaderGroup, TestSplitAtEveryByte)
+{
+    unsigned char stream[4096];
+    size_t len = write_stream(stream, sizeof(stream), 3);
+
+    for (size_t split = 1; split < len; split++)
+    {
+        record_reader_free(&reader);
+        CHECK_EQUAL(0, record_reader_init(&reader, RECORD_READER_DEFAULT_BUF_LEN));
+
+        struct elem_common *record;
+        size_t record_len;
+        int count = 0;
+
+        add(&reader, stream, split);
+        while (record_reader_next(&reader, &record, &record_len) == 1)
+            check_record(record, record_len, count++);
+
+        add(&reader, &stream[split], len - split);
+        while (record_reader_next(&reader, &record, &record_len) == 1)
+            check_record(record, record_len, count++);
+
+        CHECK_EQUAL(3, count);
+    }
+}
+
+TEST(RecordReaderGroup, TestByteAtATime)
+{
+    unsigned char stream[4096];
+    size_t len = write_stream(stream, sizeof(stream), 4);
+
+    struct elem_common *record;
+    size_t record_len;
+    int count = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        add(&reader, &stream[i], 1);
+        while (record_reader_next(&reader, &record, &record_len) == 1)
+            check_record(record, record_len, count++);
+    }
+    CHECK_EQUAL(4, count);
+}
+
+TEST(RecordReaderGroup, TestStreamLargerThanBuffer)
+{
+    // Records are split across chunks, so partial records are moved when the buffer fills.
+    size_t stream_len = 3 * RECORD_READER_DEFAULT_BUF_LEN;
+    int count = (stream_len - sizeof(struct record_stream_header)) / (sizeof(size_t) + sizeof(struct record_kill));
+    unsigned char *stream = (unsigned char *)malloc(stream_len);
+    size_t len = write_stream(stream, stream_len, count);
+
+    struct elem_common *record;
+    size_t record_len;
+    int read = 0;
+    size_t chunk = 1000;
+    for (size_t i = 0; i < len; i += chunk)
+    {
+        add(&reader, &stream[i], i + chunk > len ? len - i : chunk);
+        while (record_reader_next(&reader, &record, &record_len) == 1)
+            check_record(record, record_len, read++);
+    }
+    CHECK_EQUAL(count, read);
+    free(stream);
+}
+
+TEST(RecordReaderGroup, TestInvalidMagic)
+{
+    unsigned char stream[4096];
+    size_t len = write_stream(stream, sizeof(stream), 1);
+    stream[0] ^= 0xff;
+    add(&reader, stream, len);
+
+    struct elem_common *record;
+    size_t record_len;
+    CHECK_EQUAL(ERR_STREAM_INVALID_HEADER, record_reader_next(&reader, &record, &record_len));
+}
+
+TEST(RecordReaderGroup, TestUnsupportedRecordSize)
+{
+    unsigned char stream[4096];
+    size_t len = write_stream(stream, sizeof(stream), 1);
+    struct record_stream_header header;
+    memcpy(&header, stream, sizeof(header));
+    header.record_sizes[RECORD_TYPE_KILL] += 1;
+    memcpy(stream, &header, sizeof(header));
+    add(&reader, stream, len);
+
+    struct elem_common *record;
+    size_t record_len;
+    CHECK_EQUAL(ERR_STREAM_UNSUPPORTED, record_reader_next(&reader, &record, &record_len));
+}
+
+TEST(RecordReaderGroup, TestUnsupportedMajor)
+{
+    unsigned char stream[4096];
+    write_stream(stream, sizeof(stream), 0);
+    struct record_stream_header header;
+    memcpy(&header, stream, sizeof(header));
+    header.record_version.major += 1;
+
+    struct record_stream_header out;
+    CHECK_EQUAL(ERR_STREAM_UNSUPPORTED, record_reader_check_stream_header(&header, sizeof(header), &out));
+}
+
+TEST(RecordReaderGroup, TestLargerHeaderSkipped)
+{
+    // A later header version with extra members.
+    unsigned char stream[4096];
+    memset(stream, 0, sizeof(stream));
+    struct record_stream_header header;
+    record_serializer_init_stream_header(&header);
+    header.header_version += 1;
+    header.header_size += 8;
+    memcpy(stream, &header, sizeof(header));
+    size_t i = header.header_size;
+
+    struct record_kill r;
+    init_record_kill(&r, 7);
+    i += record_serializer_binary.serialize(&stream[i], sizeof(stream) - i, &(r.e_common), sizeof(r));
+    add(&reader, stream, i);
+
+    struct elem_common *record;
+    size_t record_len;
+    CHECK_EQUAL(1, record_reader_next(&reader, &record, &record_len));
+    check_record(record, record_len, 7);
+}
+
+TEST(RecordReaderGroup, TestVersion1Header)
+{
+    // Without 'audit_arch'.
+    unsigned char stream[4096];
+    memset(stream, 0, sizeof(stream));
+    struct record_stream_header header;
+    record_serializer_init_stream_header(&header);
+    header.header_version = 1;
+    header.header_size = offsetof(struct record_stream_header, audit_arch);
+    memcpy(stream, &header, header.header_size);
+    size_t i = header.header_size;
+
+    struct record_kill r;
+    init_record_kill(&r, 7);
+    i += record_serializer_binary.serialize(&stream[i], sizeof(stream) - i, &(r.e_common), sizeof(r));
+    add(&reader, stream, i);
+
+    struct elem_common *record;
+    size_t record_len;
+    CHECK_EQUAL(1, record_reader_next(&reader, &record, &record_len));
+    check_record(record, record_len, 7);
+    CHECK_EQUAL(0, reader.header.audit_arch);
+
+    header.header_size -= 1;
+    struct record_stream_header out;
+    CHECK_EQUAL(ERR_STREAM_INVALID_HEADER, record_reader_check_stream_header(&header, sizeof(header), &out));
+}
+
+TEST(RecordReaderGroup, TestInvalidRecordLength)
+{
+    unsigned char stream[4096];
+    size_t len = write_stream(stream, sizeof(stream), 1);
+    size_t bad_len = RECORD_READER_MAX_RECORD_LEN + 1;
+    memcpy(&stream[sizeof(struct record_stream_header)], &bad_len, sizeof(bad_len));
+    add(&reader, stream, len);
+
+    struct elem_common *record;
+    size_t record_len;
+    CHECK_EQUAL(ERR_RECORD_INVALID, record_reader_next(&reader, &record, &record_len));
+}
+
+TEST(RecordReaderGroup, TestReadFd)
+{
+    unsigned char stream[4096];
+    size_t len = write_stream(stream, sizeof(stream), 2);
+
+    int fds[2];
+    CHECK_EQUAL(0, pipe(fds));
+    CHECK_EQUAL((ssize_t)len, write(fds[1], stream, len));
+    close(fds[1]);
+
+    CHECK_EQUAL((long)len, record_reader_read_fd(&reader, fds[0]));
+    CHECK_EQUAL(0, record_reader_read_fd(&reader, fds[0]));
+    close(fds[0]);
+
+    struct elem_common *record;
+    size_t record_len;
+    CHECK_EQUAL(1, record_reader_next(&reader, &record, &record_len));
+    check_record(record, record_len, 0);
+    CHECK_EQUAL(1, record_reader_next(&reader, &record, &record_len));
+    check_record(record, record_len, 1);
+    CHECK_EQUAL(0, record_reader_next(&reader, &record, &record_len));
+}
+
+
+TEST_GROUP(RecordFileReaderGroup)
+{
+    char path[64];
+
+    void setup()
+    {
+        strcpy(path, "/tmp/ameba_reader_test_XXXXXX");
+        int fd = mkstemp(path);
+        CHECK_TRUE(fd >= 0);
+        close(fd);
+    }
+
+    void teardown()
+    {
+        unlink(path);
+    }
+
+    void write_file(const unsigned char *data, size_t data_len)
+    {
+        int fd = open(path, O_WRONLY | O_TRUNC);
+        CHECK_TRUE(fd >= 0);
+        CHECK_EQUAL((ssize_t)data_len, write(fd, data, data_len));
+        close(fd);
+    }
+};
+
+TEST(RecordFileReaderGroup, TestReadAll)
+{
+    unsigned char stream[4096];
+    size_t len = write_stream(stream, sizeof(stream), 6);
+    write_file(stream, len);
+
+    struct record_file_reader r;
+    CHECK_EQUAL(0, record_file_reader_open(&r, path));
+
+    struct elem_common *record;
+    size_t record_len;
+    for (int i = 0; i < 6; i++)
+    {
+        CHECK_EQUAL(1, record_file_reader_next(&r, &record, &record_len));
+        check_record(record, record_len, i);
+    }
+    CHECK_EQUAL(0, record_file_reader_next(&r, &record, &record_len));
+    record_file_reader_close(&r);
+}
+
+TEST(RecordFileReaderGroup, TestPartialTail)
+{
+    unsigned char stream[4096];
+    size_t len = write_stream(stream, sizeof(stream), 2);
+    write_file(stream, len - 3);
+
+    struct record_file_reader r;
+    CHECK_EQUAL(0, record_file_reader_open(&r, path));
+
+    struct elem_common *record;
+    size_t record_len;
+    CHECK_EQUAL(1, record_file_reader_next(&r, &record, &record_len));
+    check_record(record, record_len, 0);
+    CHECK_EQUAL(0, record_file_reader_next(&r, &record, &record_len));
+    record_file_reader_close(&r);
+}
+
+TEST(RecordFileReaderGroup, TestEmptyFile)
+{
+    struct record_file_reader r;
+    CHECK_EQUAL(ERR_STREAM_INVALID_HEADER, record_file_reader_open(&r, path));
+}
+
+TEST(RecordFileReaderGroup, TestTruncatedHeader)
+{
+    unsigned char stream[4096];
+    write_stream(stream, sizeof(stream), 0);
+    write_file(stream, 10);
+
+    struct record_file_reader r;
+    CHECK_EQUAL(ERR_STREAM_INVALID_HEADER, record_file_reader_open(&r, path));
+}
+
+TEST(RecordFileReaderGroup, TestMissingFile)
+{
+    struct record_file_reader r;
+    CHECK_EQUAL(ERR_STREAM_IO, record_file_reader_open(&r, "/tmp/ameba_reader_test_missing"));
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
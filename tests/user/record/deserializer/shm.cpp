@@ -0,0 +1,303 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+extern "C" {
+    #include "user/error.h"
+    #include "user/record/deserializer/shm.h"
+    #include "user/record/serializer/serializer.h"
+    #include "user/record/writer/shm.h"
+
+    extern const struct record_serializer record_serializer_binary;
+    extern const struct record_writer record_writer_shm;
+}
+
+
+static char dir[] = "/tmp/ameba-shm-XXXXXX";
+static char path[128];
+
+static void init_shm(size_t size, int with_header)
+{
+    struct shm_writer_args args;
+    memset(&args, 0, sizeof(args));
+    strcpy(args.output.path, path);
+    args.output.size = size;
+    if (with_header)
+    {
+        long len = record_serializer_binary.serialize_header(args.header, sizeof(args.header));
+        CHECK_TRUE(len > 0);
+        args.header_len = len;
+    }
+    CHECK_EQUAL(0, record_writer_shm.set_init_args(&args, sizeof(args)));
+    CHECK_EQUAL(0, record_writer_shm.init());
+}
+
+/*
+    Write 'count' numbered records of 10 bytes i.e. 'record 00\n', starting at 'first'.
+*/
+static void write_records(int first, int count)
+{
+    char record[] = "record 00\n";
+    for (int i = first; i < first + count; i++)
+    {
+        record[7] = '0' + (i / 10) % 10;
+        record[8] = '0' + i % 10;
+        CHECK_EQUAL(10, record_writer_shm.write(record, 10));
+    }
+}
+
+/*
+    Read 'count' numbered records, starting at 'first'.
+*/
+static void read_records(struct record_shm_reader *r, int first, int count)
+{
+    char record[] = "record 00\n";
+    for (int i = first; i < first + count; i++)
+    {
+        record[7] = '0' + (i / 10) % 10;
+        record[8] = '0' + i % 10;
+
+        void *data;
+        size_t data_len;
+        CHECK_EQUAL(1, record_shm_reader_next(r, &data, &data_len));
+        CHECK_EQUAL(10, data_len);
+        MEMCMP_EQUAL(record, data, 10);
+    }
+}
+
+static void init_record_kill(struct record_kill *r, int event_id)
+{
+    memset(r, 0, sizeof(*r));
+    r->e_common.magic = AMEBA_MAGIC;
+    r->e_common.record_type = RECORD_TYPE_KILL;
+    r->e_common.version.major = RECORD_VERSION_MAJOR;
+    r->e_common.version.minor = RECORD_VERSION_MINOR;
+    r->e_common.version.patch = RECORD_VERSION_PATCH;
+    r->e_ts.event_id = event_id;
+    r->sig = 9;
+}
+
+static void *write_later(void *arg)
+{
+    (void)arg;
+    usleep(20 * 1000);
+    write_records(0, 1);
+    return NULL;
+}
+
+
+TEST_GROUP(RecordShmReaderGroup)
+{
+    struct record_shm_reader reader;
+
+    void setup()
+    {
+        CHECK(mkdtemp(dir) != NULL);
+        snprintf(path, sizeof(path), "%s/sock", dir);
+        memset(&reader, 0, sizeof(reader));
+        reader.fd = -1;
+    }
+
+    void teardown()
+    {
+        record_shm_reader_close(&reader);
+        record_writer_shm.close();
+        unlink(path);
+        rmdir(dir);
+        strcpy(dir, "/tmp/ameba-shm-XXXXXX");
+    }
+};
+
+TEST(RecordShmReaderGroup, TestNoWriter)
+{
+    CHECK_EQUAL(ERR_STREAM_IO, record_shm_reader_open(&reader, path));
+}
+
+TEST(RecordShmReaderGroup, TestInvalidInitArgs)
+{
+    struct shm_writer_args args;
+    memset(&args, 0, sizeof(args));
+    strcpy(args.output.path, path);
+    args.output.size = 3 * 4096;
+    CHECK_EQUAL(-1, record_writer_shm.set_init_args(&args, sizeof(args)));
+    args.output.size = 4096;
+    CHECK_EQUAL(-1, record_writer_shm.set_init_args(&args, sizeof(args) - 1));
+    strcpy(args.output.path, "relative/sock");
+    CHECK_EQUAL(-1, record_writer_shm.set_init_args(&args, sizeof(args)));
+}
+
+TEST(RecordShmReaderGroup, TestReadAll)
+{
+    init_shm(4096, 0);
+    CHECK_EQUAL(0, record_shm_reader_open(&reader, path));
+    CHECK_EQUAL(0, reader.ring->header_len);
+
+    write_records(0, 5);
+    read_records(&reader, 0, 5);
+
+    void *data;
+    size_t data_len;
+    CHECK_EQUAL(0, record_shm_reader_next(&reader, &data, &data_len));
+}
+
+TEST(RecordShmReaderGroup, TestWrapAround)
+{
+    init_shm(4096, 0);
+    CHECK_EQUAL(0, record_shm_reader_open(&reader, path));
+
+    // Entries of 24 bytes, so every 170 entries one is moved to the start.
+    for (int i = 0; i < 1000; i += 50)
+    {
+        write_records(i, 50);
+        read_records(&reader, i, 50);
+        record_shm_reader_release(&reader);
+    }
+    CHECK_EQUAL(0, reader.ring->dropped_records);
+}
+
+TEST(RecordShmReaderGroup, TestDropWhenFull)
+{
+    init_shm(4096, 0);
+    CHECK_EQUAL(0, record_shm_reader_open(&reader, path));
+
+    // 170 entries of 24 bytes fit, and the rest is dropped.
+    write_records(0, 200);
+    CHECK_EQUAL(30, reader.ring->dropped_records);
+    CHECK_EQUAL(300, reader.ring->dropped_bytes);
+
+    read_records(&reader, 0, 170);
+    record_shm_reader_release(&reader);
+
+    write_records(0, 10);
+    read_records(&reader, 0, 10);
+}
+
+TEST(RecordShmReaderGroup, TestSingleReader)
+{
+    init_shm(4096, 0);
+    CHECK_EQUAL(0, record_shm_reader_open(&reader, path));
+
+    struct record_shm_reader other;
+    CHECK_EQUAL(ERR_STREAM_IO, record_shm_reader_open(&other, path));
+    CHECK_EQUAL(EBUSY, errno);
+}
+
+TEST(RecordShmReaderGroup, TestReattachAfterReleased)
+{
+    init_shm(4096, 0);
+    CHECK_EQUAL(0, record_shm_reader_open(&reader, path));
+
+    write_records(0, 10);
+    read_records(&reader, 0, 4);
+    record_shm_reader_release(&reader);
+    read_records(&reader, 4, 2);
+    record_shm_reader_close(&reader);
+
+    // The next reader continues after the released entries, once the writer noticed the previous one is gone.
+    int ret;
+    for (int i = 0; i < 100; i++)
+    {
+        ret = record_shm_reader_open(&reader, path);
+        if (ret == 0)
+            break;
+        usleep(1000);
+    }
+    CHECK_EQUAL(0, ret);
+    read_records(&reader, 4, 6);
+}
+
+TEST(RecordShmReaderGroup, TestWait)
+{
+    init_shm(4096, 0);
+    CHECK_EQUAL(0, record_shm_reader_open(&reader, path));
+
+    CHECK_EQUAL(0, record_shm_reader_wait(&reader, 10));
+
+    pthread_t thread;
+    CHECK_EQUAL(0, pthread_create(&thread, NULL, write_later, NULL));
+    CHECK_EQUAL(1, record_shm_reader_wait(&reader, 2000));
+    pthread_join(thread, NULL);
+    read_records(&reader, 0, 1);
+
+    // The entries written are read before the writer shows as closed.
+    write_records(1, 1);
+    record_writer_shm.close();
+    CHECK_EQUAL(1, record_shm_reader_wait(&reader, -1));
+    read_records(&reader, 1, 1);
+    CHECK_EQUAL(ERR_STREAM_CLOSED, record_shm_reader_wait(&reader, -1));
+}
+
+TEST(RecordShmReaderGroup, TestBinaryRecords)
+{
+    init_shm(1 << 16, 1);
+    CHECK_EQUAL(0, record_shm_reader_open(&reader, path));
+
+    unsigned char buf[1024];
+    for (int i = 0; i < 3; i++)
+    {
+        struct record_kill r;
+        init_record_kill(&r, i);
+        long len = record_serializer_binary.serialize(buf, sizeof(buf), &(r.e_common), sizeof(r));
+        CHECK_TRUE(len > 0);
+        CHECK_EQUAL(len, record_writer_shm.write(buf, len));
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        struct elem_common *record;
+        size_t record_len;
+        CHECK_EQUAL(1, record_shm_reader_next_record(&reader, &record, &record_len));
+        CHECK_EQUAL(sizeof(struct record_kill), record_len);
+        // In place, and aligned for the record structs.
+        CHECK_EQUAL(0, (uintptr_t)record % 8);
+        struct record_kill *r = (struct record_kill *)record;
+        CHECK_EQUAL(RECORD_TYPE_KILL, r->e_common.record_type);
+        CHECK_EQUAL((unsigned long)i, r->e_ts.event_id);
+    }
+    CHECK_EQUAL(AMEBA_MAGIC, reader.header.magic);
+
+    struct elem_common *record;
+    size_t record_len;
+    CHECK_EQUAL(0, record_shm_reader_next_record(&reader, &record, &record_len));
+}
+
+TEST(RecordShmReaderGroup, TestBinaryRecordsNoHeader)
+{
+    init_shm(4096, 0);
+    CHECK_EQUAL(0, record_shm_reader_open(&reader, path));
+
+    struct elem_common *record;
+    size_t record_len;
+    CHECK_EQUAL(ERR_STREAM_INVALID_HEADER, record_shm_reader_next_record(&reader, &record, &record_len));
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <string.h>
+
+extern "C" {
+    #include "user/error.h"
+    #include "user/record/serializer/serializer.h"
+
+    extern const struct record_serializer record_serializer_binary;
+    extern const struct record_serializer record_serializer_json;
+}
+
+
+static void init_record_kill(struct record_kill *r)
+{
+    memset(r, 0, sizeof(*r));
+    r->e_common.magic = AMEBA_MAGIC;
+    r->e_common.record_type = RECORD_TYPE_KILL;
+    r->e_common.version.major = RECORD_VERSION_MAJOR;
+    r->e_common.version.minor = RECORD_VERSION_MINOR;
+    r->e_common.version.patch = RECORD_VERSION_PATCH;
+    r->e_ts.event_id = 11;
+    r->acting_pid = 100;
+    r->sig = 9;
+    r->target_pid = 200;
+    r->ret = 0;
+}
+
+TEST_GROUP(RecordSerializerBinaryGroup)
+{
+};
+
+TEST(RecordSerializerBinaryGroup, TestSerialize)
+{
+    struct record_kill r;
+    init_record_kill(&r);
+
+    unsigned char dst[256];
+    long len = record_serializer_binary.serialize(dst, sizeof(dst), &(r.e_common), sizeof(r));
+    CHECK_EQUAL((long)(sizeof(size_t) + sizeof(r)), len);
+
+    size_t record_len;
+    memcpy(&record_len, dst, sizeof(size_t));
+    CHECK_EQUAL(sizeof(r), record_len);
+    MEMCMP_EQUAL(&r, dst + sizeof(size_t), sizeof(r));
+}
+
+TEST(RecordSerializerBinaryGroup, TestSerializeDstInsufficient)
+{
+    struct record_kill r;
+    init_record_kill(&r);
+
+    unsigned char dst[sizeof(size_t) + sizeof(r) - 1];
+    long len = record_serializer_binary.serialize(dst, sizeof(dst), &(r.e_common), sizeof(r));
+    CHECK_EQUAL(ERR_DST_INSUFFICIENT, len);
+}
+
+TEST(RecordSerializerBinaryGroup, TestHeader)
+{
+    unsigned char dst[1024];
+    long len = record_serializer_binary.serialize_header(dst, sizeof(dst));
+    CHECK_EQUAL((long)sizeof(struct record_stream_header), len);
+
+    struct record_stream_header header;
+    memcpy(&header, dst, sizeof(header));
+    CHECK_EQUAL(AMEBA_MAGIC, header.magic);
+    CHECK_EQUAL(RECORD_STREAM_HEADER_VERSION, header.header_version);
+    CHECK_EQUAL(sizeof(header), header.header_size);
+    CHECK_EQUAL(RECORD_VERSION_MAJOR, header.record_version.major);
+    CHECK_EQUAL(RECORD_VERSION_MINOR, header.record_version.minor);
+    CHECK_EQUAL(RECORD_VERSION_PATCH, header.record_version.patch);
+    CHECK_EQUAL(RECORD_STREAM_ENDIANNESS_LITTLE, header.endianness);
+    CHECK_EQUAL(sizeof(size_t), header.length_size);
+    CHECK_EQUAL(RECORD_STREAM_MAX_RECORD_TYPES, header.record_types);
+    CHECK_EQUAL(sizeof(struct record_kill), header.record_sizes[RECORD_TYPE_KILL]);
+    CHECK_EQUAL(sizeof(struct record_send_recv), header.record_sizes[RECORD_TYPE_SEND_RECV]);
+    CHECK_EQUAL(RECORD_COMPACT_PREFIX_SIZE_SEND_RECV, header.record_compact_prefix_sizes[RECORD_TYPE_SEND_RECV]);
+    CHECK_EQUAL(0, header.record_compact_prefix_sizes[RECORD_TYPE_KILL]);
+    CHECK_EQUAL(0, header.record_sizes[0]);
+}
+
+TEST(RecordSerializerBinaryGroup, TestHeaderDstInsufficient)
+{
+    unsigned char dst[8];
+    long len = record_serializer_binary.serialize_header(dst, sizeof(dst));
+    CHECK_EQUAL(ERR_DST_INSUFFICIENT, len);
+}
+
+TEST(RecordSerializerBinaryGroup, TestJsonHasNoHeader)
+{
+    POINTERS_EQUAL(NULL, (void *)record_serializer_json.serialize_header);
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
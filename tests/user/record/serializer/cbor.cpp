@@ -0,0 +1,415 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <string.h>
+#include <arpa/inet.h>
+
+extern "C" {
+    #include "user/error.h"
+    #include "user/record/serializer/serializer.h"
+    #include "user/jsonify/fields.h"
+
+    extern const struct record_serializer record_serializer_cbor;
+    extern const struct record_serializer record_serializer_json;
+}
+
+#define MAX_BUFFER_LEN 4096
+
+/*
+    Minimal CBOR reader for the subset written by the serializer.
+*/
+struct cbor_reader
+{
+    const unsigned char *p;
+    const unsigned char *end;
+};
+
+static void read_head(struct cbor_reader *r, int *major, unsigned long long *val)
+{
+    CHECK(r->p < r->end);
+    unsigned char initial = *r->p++;
+    *major = initial >> 5;
+    unsigned char info = initial & 0x1f;
+    if (info < 24)
+    {
+        *val = info;
+        return;
+    }
+    CHECK(info <= 27);
+    int n = 1 << (info - 24);
+    CHECK(r->end - r->p >= n);
+    *val = 0;
+    for (int i = 0; i < n; i++)
+        *val = (*val << 8) | *r->p++;
+}
+
+static unsigned long long read_uint(struct cbor_reader *r)
+{
+    int major;
+    unsigned long long val;
+    read_head(r, &major, &val);
+    CHECK_EQUAL(0, major);
+    return val;
+}
+
+static long long read_int(struct cbor_reader *r)
+{
+    int major;
+    unsigned long long val;
+    read_head(r, &major, &val);
+    CHECK(major == 0 || major == 1);
+    return major == 0 ? (long long)val : -1 - (long long)val;
+}
+
+static unsigned long long read_expect(struct cbor_reader *r, int expected_major)
+{
+    int major;
+    unsigned long long val;
+    read_head(r, &major, &val);
+    CHECK_EQUAL(expected_major, major);
+    return val;
+}
+
+/*
+    Read a byte or text string and return a pointer to its data.
+*/
+static const unsigned char *read_data(struct cbor_reader *r, int expected_major, size_t *len)
+{
+    *len = read_expect(r, expected_major);
+    CHECK((size_t)(r->end - r->p) >= *len);
+    const unsigned char *data = r->p;
+    r->p += *len;
+    return data;
+}
+
+static void check_text(struct cbor_reader *r, const char *expected)
+{
+    size_t len;
+    const unsigned char *data = read_data(r, 3, &len);
+    CHECK_EQUAL(strlen(expected), len);
+    CHECK(memcmp(expected, data, len) == 0);
+}
+
+/*
+    Read the common prefix of a record and return the number of fields that follow.
+*/
+static unsigned long long read_common(struct cbor_reader *r, record_type_t record_type, event_id_t event_id)
+{
+    unsigned long long len = read_expect(r, 4);
+    CHECK_EQUAL(record_type, read_uint(r));
+    CHECK_EQUAL(3, read_expect(r, 4));
+    CHECK_EQUAL(RECORD_VERSION_MAJOR_COMPACT_SOCKADDR - 1, read_uint(r));
+    CHECK_EQUAL(RECORD_VERSION_MINOR, read_uint(r));
+    CHECK_EQUAL(RECORD_VERSION_PATCH, read_uint(r));
+    CHECK_EQUAL(event_id, read_uint(r));
+#ifdef INCLUDE_TASK_CTX_ID
+    read_uint(r);
+    return len - 4;
+#else
+    return len - 3;
+#endif
+}
+
+static void init_common(struct elem_common *e_common, record_type_t record_type)
+{
+    e_common->magic = AMEBA_MAGIC;
+    e_common->record_type = record_type;
+    e_common->version.major = RECORD_VERSION_MAJOR_COMPACT_SOCKADDR - 1;
+    e_common->version.minor = RECORD_VERSION_MINOR;
+    e_common->version.patch = RECORD_VERSION_PATCH;
+}
+
+static void init_record_send_recv(struct record_send_recv *r)
+{
+    memset(r, 0, sizeof(*r));
+    init_common(&(r->e_common), RECORD_TYPE_SEND_RECV);
+    r->e_ts.event_id = 42;
+    r->pid = 100;
+    r->sys_id = SYS_ID_SENDTO;
+    r->fd = 3;
+    r->ret = 512;
+    r->ns_net = 4026531840U;
+    r->sock_type = 2;
+
+    struct sockaddr_in *sa_in = (struct sockaddr_in *)&(r->remote.addr[0]);
+    sa_in->sin_family = AF_INET;
+    sa_in->sin_port = htons(53);
+    inet_pton(AF_INET, "10.0.0.2", &(sa_in->sin_addr));
+    r->remote.addrlen = sizeof(struct sockaddr_in);
+    r->remote.byte_order = BYTE_ORDER_NETWORK;
+}
+
+/*
+    Set the local sockaddr as the BPF programs do i.e. with the port in host byte order.
+*/
+static void set_local_host_order(struct elem_sockaddr *local, unsigned short port)
+{
+    struct sockaddr_in *sa_in = (struct sockaddr_in *)&(local->addr[0]);
+    sa_in->sin_family = AF_INET;
+    sa_in->sin_port = port;
+    inet_pton(AF_INET, "10.0.0.1", &(sa_in->sin_addr));
+    local->addrlen = sizeof(struct sockaddr_in);
+    local->byte_order = BYTE_ORDER_HOST;
+}
+
+static void init_record_audit_log_exit(struct record_audit_log_exit *r)
+{
+    memset(r, 0, sizeof(*r));
+    init_common(&(r->e_common), RECORD_TYPE_AUDIT_LOG_EXIT);
+    r->e_ts.event_id = 7;
+    r->pid = 200;
+    r->syscall_number = 59;
+    r->ret = -2;
+    r->e_las_ts.event_id = 1234;
+    r->e_las_ts.tv_sec = 1700000000;
+    r->e_las_ts.tv_nsec = 250000000;
+}
+
+/*
+    Return the index of the field with the key in the record's field table.
+*/
+static int field_index(record_type_t record_type, const char *key)
+{
+    const struct jsonify_fields *fields = jsonify_fields_get(record_type);
+    for (int i = 0; i < fields->fields_len; i++)
+    {
+        if (strcmp(fields->fields[i].key, key) == 0)
+            return i;
+    }
+    FAIL("Field not found");
+    return -1;
+}
+
+/*
+    Skip a single item (no nesting beyond arrays).
+*/
+static void skip_item(struct cbor_reader *r)
+{
+    int major;
+    unsigned long long val;
+    read_head(r, &major, &val);
+    if (major == 2 || major == 3)
+        r->p += val;
+    else if (major == 4)
+        for (unsigned long long i = 0; i < val; i++)
+            skip_item(r);
+}
+
+TEST_GROUP(RecordSerializerCborGroup)
+{
+};
+
+TEST(RecordSerializerCborGroup, TestSendRecv)
+{
+    struct record_send_recv sr;
+    init_record_send_recv(&sr);
+
+    unsigned char dst[MAX_BUFFER_LEN];
+    long len = record_serializer_cbor.serialize(dst, sizeof(dst), &(sr.e_common), sizeof(sr));
+    CHECK(len > 0);
+
+    struct cbor_reader r = {dst, dst + len};
+    unsigned long long fields_len = read_common(&r, RECORD_TYPE_SEND_RECV, 42);
+    CHECK_EQUAL(jsonify_fields_get(RECORD_TYPE_SEND_RECV)->fields_len, fields_len);
+
+    int ret_index = field_index(RECORD_TYPE_SEND_RECV, "ret");
+    int remote_index = field_index(RECORD_TYPE_SEND_RECV, "remote");
+    for (int i = 0; i < (int)fields_len; i++)
+    {
+        if (i == ret_index)
+        {
+            CHECK_EQUAL(512, read_int(&r));
+        } else if (i == remote_index)
+        {
+            size_t addr_len;
+            const unsigned char *addr = read_data(&r, 2, &addr_len);
+            CHECK_EQUAL(sizeof(struct sockaddr_in), addr_len);
+            CHECK(memcmp(&(sr.remote.addr[0]), addr, addr_len) == 0);
+        } else {
+            skip_item(&r);
+        }
+    }
+    CHECK(r.p == r.end);
+}
+
+TEST(RecordSerializerCborGroup, TestSockaddrHostOrder)
+{
+    struct record_send_recv sr;
+    init_record_send_recv(&sr);
+    set_local_host_order(&(sr.local), 8080);
+
+    unsigned char dst[MAX_BUFFER_LEN];
+    long len = record_serializer_cbor.serialize(dst, sizeof(dst), &(sr.e_common), sizeof(sr));
+    CHECK(len > 0);
+
+    struct cbor_reader r = {dst, dst + len};
+    unsigned long long fields_len = read_common(&r, RECORD_TYPE_SEND_RECV, 42);
+
+    int local_index = field_index(RECORD_TYPE_SEND_RECV, "local");
+    for (int i = 0; i < (int)fields_len; i++)
+    {
+        if (i == local_index)
+        {
+            size_t addr_len;
+            const unsigned char *addr = read_data(&r, 2, &addr_len);
+            CHECK_EQUAL(sizeof(struct sockaddr_in), addr_len);
+            struct sockaddr_in sa_in;
+            memcpy(&sa_in, addr, sizeof(sa_in));
+            CHECK_EQUAL(htons(8080), sa_in.sin_port);
+            CHECK_EQUAL(AF_INET, sa_in.sin_family);
+        } else {
+            skip_item(&r);
+        }
+    }
+    CHECK(r.p == r.end);
+}
+
+TEST(RecordSerializerCborGroup, TestAuditLogExit)
+{
+    struct record_audit_log_exit ale;
+    init_record_audit_log_exit(&ale);
+
+    unsigned char dst[MAX_BUFFER_LEN];
+    long len = record_serializer_cbor.serialize(dst, sizeof(dst), &(ale.e_common), sizeof(ale));
+    CHECK(len > 0);
+
+    struct cbor_reader r = {dst, dst + len};
+    unsigned long long fields_len = read_common(&r, RECORD_TYPE_AUDIT_LOG_EXIT, 7);
+
+    int exit_index = field_index(RECORD_TYPE_AUDIT_LOG_EXIT, "exit");
+    int las_index = field_index(RECORD_TYPE_AUDIT_LOG_EXIT, "las_audit");
+    for (int i = 0; i < (int)fields_len; i++)
+    {
+        if (i == exit_index)
+        {
+            CHECK_EQUAL(-2, read_int(&r));
+        } else if (i == las_index)
+        {
+            CHECK_EQUAL(3, read_expect(&r, 4));
+            CHECK_EQUAL(1234, read_uint(&r));
+            CHECK_EQUAL(1700000000, read_int(&r));
+            CHECK_EQUAL(250000000, read_int(&r));
+        } else {
+            skip_item(&r);
+        }
+    }
+    CHECK(r.p == r.end);
+}
+
+TEST(RecordSerializerCborGroup, TestSmallerThanJson)
+{
+    struct record_send_recv sr;
+    init_record_send_recv(&sr);
+
+    unsigned char cbor[MAX_BUFFER_LEN];
+    char json[MAX_BUFFER_LEN];
+    long cbor_len = record_serializer_cbor.serialize(cbor, sizeof(cbor), &(sr.e_common), sizeof(sr));
+    long json_len = record_serializer_json.serialize(json, sizeof(json), &(sr.e_common), sizeof(sr));
+    CHECK(cbor_len > 0);
+    CHECK(json_len > 3 * cbor_len);
+}
+
+TEST(RecordSerializerCborGroup, TestHeader)
+{
+    unsigned char dst[RECORD_SERIALIZER_MAX_HEADER_LEN];
+    long len = record_serializer_cbor.serialize_header(dst, sizeof(dst));
+    CHECK(len > 0);
+
+    struct cbor_reader r = {dst, dst + len};
+    CHECK_EQUAL(55799, read_expect(&r, 6));
+    CHECK_EQUAL(4, read_expect(&r, 5));
+    check_text(&r, "magic");
+    CHECK_EQUAL(AMEBA_MAGIC, read_uint(&r));
+    check_text(&r, "version");
+    CHECK_EQUAL(RECORD_CBOR_SCHEMA_VERSION, read_uint(&r));
+    check_text(&r, "task_ctx_id");
+    unsigned long long task_ctx_id = read_expect(&r, 7);
+#ifdef INCLUDE_TASK_CTX_ID
+    CHECK_EQUAL(21, task_ctx_id);
+#else
+    CHECK_EQUAL(20, task_ctx_id);
+#endif
+    check_text(&r, "records");
+    unsigned long long records_len = read_expect(&r, 5);
+    CHECK(records_len > 0);
+    for (unsigned long long i = 0; i < records_len; i++)
+    {
+        record_type_t record_type = (record_type_t)read_uint(&r);
+        const struct jsonify_fields *fields = jsonify_fields_get(record_type);
+        CHECK(fields != NULL);
+        CHECK_EQUAL(2, read_expect(&r, 4));
+        check_text(&r, fields->name);
+        CHECK_EQUAL(fields->fields_len, read_expect(&r, 4));
+        for (int j = 0; j < fields->fields_len; j++)
+            check_text(&r, fields->fields[j].key);
+    }
+    CHECK(r.p == r.end);
+}
+
+TEST(RecordSerializerCborGroup, TestHeaderDstInsufficient)
+{
+    unsigned char dst[16];
+    CHECK_EQUAL(ERR_DST_INSUFFICIENT, record_serializer_cbor.serialize_header(dst, sizeof(dst)));
+}
+
+TEST(RecordSerializerCborGroup, TestDstInsufficient)
+{
+    struct record_send_recv sr;
+    init_record_send_recv(&sr);
+
+    unsigned char dst[MAX_BUFFER_LEN];
+    long len = record_serializer_cbor.serialize(dst, sizeof(dst), &(sr.e_common), sizeof(sr));
+    CHECK(len > 0);
+    CHECK_EQUAL(ERR_DST_INSUFFICIENT, record_serializer_cbor.serialize(dst, len - 1, &(sr.e_common), sizeof(sr)));
+}
+
+TEST(RecordSerializerCborGroup, TestDstExact)
+{
+    // Ends with integers whose heads take less than 9 bytes.
+    struct record_audit_log_exit ale;
+    init_record_audit_log_exit(&ale);
+
+    unsigned char dst[MAX_BUFFER_LEN];
+    long len = record_serializer_cbor.serialize(dst, sizeof(dst), &(ale.e_common), sizeof(ale));
+    CHECK(len > 0);
+    CHECK_EQUAL(len, record_serializer_cbor.serialize(dst, len, &(ale.e_common), sizeof(ale)));
+
+    len = record_serializer_cbor.serialize_header(dst, sizeof(dst));
+    CHECK(len > 0);
+    CHECK_EQUAL(len, record_serializer_cbor.serialize_header(dst, len));
+}
+
+TEST(RecordSerializerCborGroup, TestUnknownRecordType)
+{
+    struct record_send_recv sr;
+    init_record_send_recv(&sr);
+    sr.e_common.record_type = (record_type_t)(RECORD_STREAM_MAX_RECORD_TYPES - 1);
+
+    unsigned char dst[MAX_BUFFER_LEN];
+    CHECK_EQUAL(ERR_RECORD_UNKNOWN, record_serializer_cbor.serialize(dst, sizeof(dst), &(sr.e_common), sizeof(sr)));
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
@@ -0,0 +1,306 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+extern "C" {
+    #include "user/error.h"
+    #include "user/record/serializer/serializer.h"
+    #include "user/jsonify/core.h"
+
+    extern const struct record_serializer record_serializer_json;
+
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t nmemb, size_t size);
+    void *__libc_realloc(void *ptr, size_t size);
+}
+
+/*
+    Count heap allocations to check that serialization does not do any.
+*/
+static unsigned long heap_allocs = 0;
+
+extern "C" void *malloc(size_t size)
+{
+    heap_allocs++;
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t nmemb, size_t size)
+{
+    heap_allocs++;
+    return __libc_calloc(nmemb, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    heap_allocs++;
+    return __libc_realloc(ptr, size);
+}
+
+/*
+    Records are initialized with the last version before compact sockaddrs so that
+    they are serialized from their record struct.
+*/
+static void init_common(struct elem_common *e_common, record_type_t record_type)
+{
+    e_common->magic = AMEBA_MAGIC;
+    e_common->record_type = record_type;
+    e_common->version.major = RECORD_VERSION_MAJOR_COMPACT_SOCKADDR - 1;
+    e_common->version.minor = RECORD_VERSION_MINOR;
+    e_common->version.patch = RECORD_VERSION_PATCH;
+}
+
+static void init_sockaddr_in(struct elem_sockaddr *e_sa, const char *ip, int port, byte_order_t byte_order)
+{
+    struct sockaddr_in *sa_in = (struct sockaddr_in *)&(e_sa->addr[0]);
+    sa_in->sin_family = AF_INET;
+    sa_in->sin_port = byte_order == BYTE_ORDER_NETWORK ? htons(port) : port;
+    inet_pton(AF_INET, ip, &(sa_in->sin_addr));
+    e_sa->addrlen = sizeof(struct sockaddr_in);
+    e_sa->byte_order = byte_order;
+}
+
+static void init_record_send_recv(struct record_send_recv *r)
+{
+    memset(r, 0, sizeof(*r));
+    init_common(&(r->e_common), RECORD_TYPE_SEND_RECV);
+    r->e_ts.event_id = 42;
+    r->pid = 100;
+    r->sys_id = SYS_ID_SENDTO;
+    r->fd = 3;
+    r->ret = 512;
+    r->ns_net = 4026531840U;
+    r->sock_type = 2;
+    init_sockaddr_in(&(r->local), "10.0.0.1", 5000, BYTE_ORDER_HOST);
+    init_sockaddr_in(&(r->remote), "10.0.0.2", 53, BYTE_ORDER_NETWORK);
+}
+
+/*
+    Write the sockaddr in compact form to 'dst'.
+
+    Return:
+        The size written.
+*/
+static size_t write_compact_sockaddr(unsigned char *dst, struct elem_sockaddr *e_sa)
+{
+    struct elem_sockaddr_compact header;
+    header.family = ((struct sockaddr *)&(e_sa->addr[0]))->sa_family;
+    header.byte_order = e_sa->byte_order;
+    header.addrlen = e_sa->addrlen;
+    memcpy(dst, &header, sizeof(header));
+    memcpy(dst + sizeof(header), &(e_sa->addr[0]), e_sa->addrlen);
+    return sizeof(header) + e_sa->addrlen;
+}
+
+/*
+    Write the record in compact form to 'dst' with the current version.
+
+    Return:
+        The size written.
+*/
+static size_t write_compact_record(
+    unsigned char *dst, struct elem_common *e_common, size_t prefix_size,
+    struct elem_sockaddr *local, struct elem_sockaddr *remote
+)
+{
+    memcpy(dst, e_common, prefix_size);
+    ((struct elem_common *)dst)->version.major = RECORD_VERSION_MAJOR;
+    size_t size = prefix_size;
+    size += write_compact_sockaddr(dst + size, local);
+    if (remote)
+        size += write_compact_sockaddr(dst + size, remote);
+    return size;
+}
+
+static void init_record_audit_log_exit(struct record_audit_log_exit *r)
+{
+    memset(r, 0, sizeof(*r));
+    init_common(&(r->e_common), RECORD_TYPE_AUDIT_LOG_EXIT);
+    r->e_ts.event_id = 7;
+    r->pid = 200;
+    r->syscall_number = 59;
+    r->ret = -2;
+    r->e_las_ts.event_id = 1234;
+    r->e_las_ts.tv_sec = 1700000000;
+    r->e_las_ts.tv_nsec = 250000000;
+}
+
+TEST_GROUP(RecordSerializerJsonGroup)
+{
+};
+
+TEST(RecordSerializerJsonGroup, TestSendRecv)
+{
+    struct record_send_recv r;
+    init_record_send_recv(&r);
+
+    char dst[MAX_BUFFER_LEN];
+    long len = record_serializer_json.serialize(dst, sizeof(dst), &(r.e_common), sizeof(r));
+    CHECK(len > 0);
+    CHECK_EQUAL('{', dst[0]);
+    CHECK_EQUAL('}', dst[len - 2]);
+    CHECK_EQUAL('\n', dst[len - 1]);
+    CHECK(strstr(dst, "\"record_name\":\"record_send_recv\"") != NULL);
+    CHECK(strstr(dst, "\"event_id\":42") != NULL);
+    CHECK(strstr(dst, "\"ret\":512") != NULL);
+    CHECK(strstr(dst, "\"local\":{\"sockaddr\":\"") != NULL);
+    CHECK(strstr(dst, "\"sockaddr_len\":16}") != NULL);
+}
+
+TEST(RecordSerializerJsonGroup, TestAuditLogExit)
+{
+    struct record_audit_log_exit r;
+    init_record_audit_log_exit(&r);
+
+    char dst[MAX_BUFFER_LEN];
+    long len = record_serializer_json.serialize(dst, sizeof(dst), &(r.e_common), sizeof(r));
+    CHECK(len > 0);
+    CHECK(strstr(dst, "\"exit\":-2") != NULL);
+    CHECK(strstr(dst, "\"las_audit\":{\"event_id\":1234,\"time\":1700000000.250}") != NULL);
+}
+
+TEST(RecordSerializerJsonGroup, TestNoHeapAllocs)
+{
+    struct record_send_recv sr;
+    init_record_send_recv(&sr);
+    struct record_audit_log_exit ale;
+    init_record_audit_log_exit(&ale);
+
+    // The count must see allocations made outside of this file, e.g. by libc.
+    unsigned long heap_allocs_before = heap_allocs;
+    char *copy = strdup("x");
+    CHECK(copy != NULL);
+    free(copy);
+    CHECK(heap_allocs > heap_allocs_before);
+
+    char dst[MAX_BUFFER_LEN];
+    heap_allocs_before = heap_allocs;
+    for (int i = 0; i < 100; i++)
+    {
+        CHECK(record_serializer_json.serialize(dst, sizeof(dst), &(sr.e_common), sizeof(sr)) > 0);
+        CHECK(record_serializer_json.serialize(dst, sizeof(dst), &(ale.e_common), sizeof(ale)) > 0);
+    }
+    CHECK_EQUAL(heap_allocs_before, heap_allocs);
+}
+
+TEST(RecordSerializerJsonGroup, TestInvalidMagic)
+{
+    struct record_send_recv r;
+    init_record_send_recv(&r);
+    r.e_common.magic = 0;
+
+    char dst[MAX_BUFFER_LEN];
+    long len = record_serializer_json.serialize(dst, sizeof(dst), &(r.e_common), sizeof(r));
+    CHECK_EQUAL(ERR_RECORD_INVALID_MAGIC, len);
+}
+
+TEST(RecordSerializerJsonGroup, TestSizeMismatch)
+{
+    struct record_send_recv r;
+    init_record_send_recv(&r);
+
+    char dst[MAX_BUFFER_LEN];
+    long len = record_serializer_json.serialize(dst, sizeof(dst), &(r.e_common), sizeof(r) - 1);
+    CHECK_EQUAL(ERR_RECORD_SIZE_MISMATCH, len);
+}
+
+TEST(RecordSerializerJsonGroup, TestDstInsufficient)
+{
+    struct record_send_recv r;
+    init_record_send_recv(&r);
+
+    char dst[64];
+    long len = record_serializer_json.serialize(dst, sizeof(dst), &(r.e_common), sizeof(r));
+    CHECK_EQUAL(ERR_DST_INSUFFICIENT, len);
+}
+
+TEST(RecordSerializerJsonGroup, TestCompactSendRecv)
+{
+    struct record_send_recv r;
+    init_record_send_recv(&r);
+
+    char expected[MAX_BUFFER_LEN];
+    long expected_len = record_serializer_json.serialize(expected, sizeof(expected), &(r.e_common), sizeof(r));
+    CHECK(expected_len > 0);
+    // Only the version differs.
+    char *version = strstr(expected, "\"record_version\":\"");
+    CHECK(version != NULL);
+    version[strlen("\"record_version\":\"")] = '0' + RECORD_VERSION_MAJOR;
+
+    union record_expanded compact;
+    size_t compact_len = write_compact_record(
+        (unsigned char *)&compact, &(r.e_common), RECORD_COMPACT_PREFIX_SIZE_SEND_RECV, &(r.local), &(r.remote)
+    );
+    CHECK(compact_len < sizeof(r) / 2);
+
+    char dst[MAX_BUFFER_LEN];
+    long len = record_serializer_json.serialize(dst, sizeof(dst), &(compact.e_common), compact_len);
+    CHECK_EQUAL(expected_len, len);
+    STRCMP_EQUAL(expected, dst);
+}
+
+TEST(RecordSerializerJsonGroup, TestCompactBind)
+{
+    struct record_bind r;
+    memset(&r, 0, sizeof(r));
+    init_common(&(r.e_common), RECORD_TYPE_BIND);
+    r.e_ts.event_id = 9;
+    r.pid = 300;
+    r.fd = 4;
+    init_sockaddr_in(&(r.local), "0.0.0.0", 8080, BYTE_ORDER_NETWORK);
+
+    union record_expanded compact;
+    size_t compact_len = write_compact_record(
+        (unsigned char *)&compact, &(r.e_common), RECORD_COMPACT_PREFIX_SIZE_BIND, &(r.local), NULL
+    );
+
+    char dst[MAX_BUFFER_LEN];
+    long len = record_serializer_json.serialize(dst, sizeof(dst), &(compact.e_common), compact_len);
+    CHECK(len > 0);
+    CHECK(strstr(dst, "\"record_name\":\"record_bind\"") != NULL);
+    CHECK(strstr(dst, "\"fd\":4") != NULL);
+    CHECK(strstr(dst, "\"sockaddr_len\":16}") != NULL);
+}
+
+TEST(RecordSerializerJsonGroup, TestCompactTruncated)
+{
+    struct record_send_recv r;
+    init_record_send_recv(&r);
+
+    union record_expanded compact;
+    size_t compact_len = write_compact_record(
+        (unsigned char *)&compact, &(r.e_common), RECORD_COMPACT_PREFIX_SIZE_SEND_RECV, &(r.local), &(r.remote)
+    );
+
+    char dst[MAX_BUFFER_LEN];
+    long len = record_serializer_json.serialize(dst, sizeof(dst), &(compact.e_common), compact_len - 1);
+    CHECK_EQUAL(ERR_RECORD_SIZE_MISMATCH, len);
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include <string.h>
+#include <unistd.h>
+
+#include "capture.h"
+
+
+char captured[1 << 20];
+size_t captured_len = 0;
+int captured_closed = 0;
+int capture_fails = 0;
+int capture_blocked = 0;
+static int capture_stopped = 0;
+
+
+static int set_init_args_capture(void *ptr, size_t ptr_len)
+{
+    (void)ptr;
+    (void)ptr_len;
+    return 0;
+}
+
+static int init_capture()
+{
+    return 0;
+}
+
+static int close_capture()
+{
+    captured_closed = 1;
+    return 0;
+}
+
+static int flush_capture(int force)
+{
+    (void)force;
+    return 0;
+}
+
+static int write_capture(void *data, size_t data_len)
+{
+    if (__atomic_load_n(&capture_blocked, __ATOMIC_SEQ_CST))
+    {
+        while (__atomic_load_n(&capture_blocked, __ATOMIC_SEQ_CST) && !__atomic_load_n(&capture_stopped, __ATOMIC_SEQ_CST))
+            usleep(1000);
+        if (__atomic_load_n(&capture_stopped, __ATOMIC_SEQ_CST))
+            return (int)data_len;
+    }
+    if (__atomic_load_n(&capture_fails, __ATOMIC_SEQ_CST) || captured_len + data_len > sizeof(captured))
+        return -1;
+    memcpy(&captured[captured_len], data, data_len);
+    __atomic_store_n(&captured_len, captured_len + data_len, __ATOMIC_SEQ_CST);
+    return (int)data_len;
+}
+
+void stop_capture()
+{
+    __atomic_store_n(&capture_stopped, 1, __ATOMIC_SEQ_CST);
+}
+
+void reset_capture()
+{
+    captured_len = 0;
+    captured_closed = 0;
+    capture_fails = 0;
+    capture_blocked = 0;
+    capture_stopped = 0;
+}
+
+
+const struct record_writer record_writer_capture = {
+    .set_init_args = set_init_args_capture,
+    .init = init_capture,
+    .close = close_capture,
+    .write = write_capture,
+    .flush = flush_capture
+};
\ No newline at end of file
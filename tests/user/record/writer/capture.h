@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+/*
+
+    A writer that keeps everything written to it in memory, to test the writers
+    that wrap another writer. Can be written from another thread than the one
+    checking the captured data.
+
+*/
+
+#include <stddef.h>
+
+#include "user/record/writer/writer.h"
+
+
+extern char captured[1 << 20];
+extern size_t captured_len;
+extern int captured_closed;
+// While set, writes fail.
+extern int capture_fails;
+// While set, writes wait until it is cleared or the writer is stopped.
+extern int capture_blocked;
+
+extern const struct record_writer record_writer_capture;
+
+
+/*
+    Drop the data of the waiting and later writes, like the TCP writer does once
+    stopped.
+*/
+void stop_capture();
+
+/*
+    Clear the captured data and the flags.
+*/
+void reset_capture();
\ No newline at end of file
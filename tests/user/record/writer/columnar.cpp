@@ -0,0 +1,421 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+extern "C" {
+    #include "user/types.h"
+    #include "user/record/writer/writer.h"
+    #include "user/record/writer/columnar.h"
+    #include "user/record/serializer/serializer.h"
+    #include "user/jsonify/fields.h"
+
+    #include "capture.h"
+
+    extern const struct record_writer record_writer_columnar;
+    extern const struct record_serializer record_serializer_binary;
+}
+
+static void init_columnar(unsigned long batch_rows, long max_age_ms)
+{
+    struct columnar_writer_args args = {
+        .writer = &record_writer_capture,
+        .batch_rows = batch_rows,
+        .max_age_ms = max_age_ms
+    };
+    CHECK_EQUAL(0, record_writer_columnar.set_init_args(&args, sizeof(args)));
+    CHECK_EQUAL(0, record_writer_columnar.init());
+}
+
+static void init_common(struct elem_common *e_common, record_type_t record_type)
+{
+    e_common->magic = AMEBA_MAGIC;
+    e_common->record_type = record_type;
+    e_common->version.major = RECORD_VERSION_MAJOR_COMPACT_SOCKADDR - 1;
+    e_common->version.minor = RECORD_VERSION_MINOR;
+    e_common->version.patch = RECORD_VERSION_PATCH;
+}
+
+/*
+    Serialize the record with the binary serializer and write it to the columnar writer.
+*/
+static int write_record(struct elem_common *record, size_t record_len)
+{
+    char dst[1024];
+    long len = record_serializer_binary.serialize(dst, sizeof(dst), record, record_len);
+    CHECK(len > 0);
+    return record_writer_columnar.write(dst, len);
+}
+
+static int write_kill(int i)
+{
+    struct record_kill r;
+    memset(&r, 0, sizeof(r));
+    init_common(&(r.e_common), RECORD_TYPE_KILL);
+    r.e_ts.event_id = 1000 + i;
+    r.acting_pid = 10 + i;
+    r.sig = 9;
+    r.target_pid = 20 + i;
+    r.ret = -i;
+    return write_record(&(r.e_common), sizeof(r));
+}
+
+/*
+    Size (bytes) of the header and schema written at init.
+*/
+static size_t get_schema_size()
+{
+    const struct columnar_file_header *header = (const struct columnar_file_header *)&captured[0];
+    size_t offset = sizeof(*header);
+    for (int i = 0; i < header->record_types; i++)
+    {
+        const struct columnar_schema_record *s_record = (const struct columnar_schema_record *)&captured[offset];
+        offset += sizeof(*s_record) + s_record->columns_len * sizeof(struct columnar_schema_column);
+    }
+    return offset;
+}
+
+/*
+    Return the data of column 'index' of the batch, and its size in 'len'.
+*/
+static const unsigned char *get_column(const struct columnar_batch_header *batch, unsigned int index, size_t *len)
+{
+    CHECK(index < batch->columns_len);
+    const unsigned char *p = (const unsigned char *)(batch + 1);
+    for (unsigned int i = 0; ; i++)
+    {
+        unsigned long long data_size;
+        memcpy(&data_size, p, sizeof(data_size));
+        p += sizeof(data_size);
+        if (i == index)
+        {
+            *len = data_size;
+            return p;
+        }
+        p += (data_size + 7) & ~7ULL;
+    }
+}
+
+/*
+    Index of the column of the record field with the key.
+*/
+static unsigned int get_column_index(record_type_t record_type, const char *key)
+{
+    const struct jsonify_fields *fields = jsonify_fields_get(record_type);
+#ifdef INCLUDE_TASK_CTX_ID
+    unsigned int common_columns = 2;
+#else
+    unsigned int common_columns = 1;
+#endif
+    for (int i = 0; i < fields->fields_len; i++)
+    {
+        if (strcmp(fields->fields[i].key, key) == 0)
+            return common_columns + i;
+    }
+    FAIL("Field not found");
+    return 0;
+}
+
+TEST_GROUP(RecordWriterColumnarGroup)
+{
+    void setup()
+    {
+        reset_capture();
+    }
+
+    void teardown()
+    {
+        record_writer_columnar.close();
+    }
+};
+
+TEST(RecordWriterColumnarGroup, TestNotInitialized)
+{
+    char data[16] = {0};
+    CHECK_EQUAL(-2, record_writer_columnar.write(data, sizeof(data)));
+    CHECK_EQUAL(-2, record_writer_columnar.flush(1));
+}
+
+TEST(RecordWriterColumnarGroup, TestInvalidInitArgs)
+{
+    struct columnar_writer_args args = {
+        .writer = NULL,
+        .batch_rows = 1,
+        .max_age_ms = 0
+    };
+    CHECK_EQUAL(-1, record_writer_columnar.set_init_args(&args, sizeof(args)));
+
+    args.writer = &record_writer_capture;
+    args.batch_rows = 0;
+    CHECK_EQUAL(-1, record_writer_columnar.set_init_args(&args, sizeof(args)));
+
+    args.batch_rows = COLUMNAR_MAX_BATCH_ROWS + 1;
+    CHECK_EQUAL(-1, record_writer_columnar.set_init_args(&args, sizeof(args)));
+
+    args.batch_rows = 1;
+    CHECK_EQUAL(-1, record_writer_columnar.set_init_args(&args, sizeof(args) - 1));
+    CHECK_EQUAL(0, record_writer_columnar.set_init_args(&args, sizeof(args)));
+}
+
+TEST(RecordWriterColumnarGroup, TestSchema)
+{
+    init_columnar(4, 0);
+
+    const struct columnar_file_header *header = (const struct columnar_file_header *)&captured[0];
+    CHECK_EQUAL(AMEBA_MAGIC, header->magic);
+    CHECK_EQUAL(COLUMNAR_FORMAT_VERSION, header->format_version);
+    CHECK_EQUAL(sizeof(*header), header->header_size);
+    CHECK_EQUAL(RECORD_VERSION_MAJOR, header->record_version.major);
+#ifdef INCLUDE_TASK_CTX_ID
+    CHECK_EQUAL(1, header->has_task_ctx_id);
+#else
+    CHECK_EQUAL(0, header->has_task_ctx_id);
+#endif
+    CHECK_EQUAL(get_schema_size(), captured_len);
+
+    int found = 0;
+    size_t offset = sizeof(*header);
+    for (int i = 0; i < header->record_types; i++)
+    {
+        const struct columnar_schema_record *s_record = (const struct columnar_schema_record *)&captured[offset];
+        const struct columnar_schema_column *s_columns = (const struct columnar_schema_column *)(s_record + 1);
+        offset += sizeof(*s_record) + s_record->columns_len * sizeof(struct columnar_schema_column);
+
+        const struct jsonify_fields *fields = jsonify_fields_get((record_type_t)s_record->record_type);
+        CHECK(fields != NULL);
+        STRCMP_EQUAL(fields->name, s_record->name);
+        STRCMP_EQUAL("event_id", s_columns[0].name);
+        CHECK_EQUAL(COLUMNAR_TYPE_UINT64, s_columns[0].type);
+
+        if (s_record->record_type != RECORD_TYPE_AUDIT_LOG_EXIT)
+            continue;
+        found = 1;
+        unsigned int las = get_column_index(RECORD_TYPE_AUDIT_LOG_EXIT, "las_audit");
+        CHECK_EQUAL(las + 3, s_record->columns_len);
+        STRCMP_EQUAL("exit", s_columns[get_column_index(RECORD_TYPE_AUDIT_LOG_EXIT, "exit")].name);
+        STRCMP_EQUAL("las_audit.event_id", s_columns[las].name);
+        STRCMP_EQUAL("las_audit.tv_sec", s_columns[las + 1].name);
+        STRCMP_EQUAL("las_audit.tv_nsec", s_columns[las + 2].name);
+        CHECK_EQUAL(COLUMNAR_TYPE_INT64, s_columns[las + 2].type);
+        CHECK_EQUAL(8, s_columns[las + 2].width);
+    }
+    CHECK(found);
+}
+
+TEST(RecordWriterColumnarGroup, TestBatchOnFull)
+{
+    init_columnar(3, 0);
+    size_t schema_size = captured_len;
+
+    for (int i = 0; i < 2; i++)
+        CHECK(write_kill(i) > 0);
+    CHECK_EQUAL(schema_size, captured_len);
+
+    CHECK(write_kill(2) > 0);
+    CHECK(captured_len > schema_size);
+
+    const struct columnar_batch_header *batch = (const struct columnar_batch_header *)&captured[schema_size];
+    CHECK_EQUAL(AMEBA_MAGIC, batch->magic);
+    CHECK_EQUAL(RECORD_TYPE_KILL, batch->record_type);
+    CHECK_EQUAL(3, batch->rows);
+    CHECK_EQUAL(captured_len - schema_size, batch->batch_size);
+
+    size_t len;
+    const unsigned char *event_ids = get_column(batch, 0, &len);
+    CHECK_EQUAL(3 * sizeof(unsigned long long), len);
+    const unsigned char *target_pids = get_column(batch, get_column_index(RECORD_TYPE_KILL, "target_pid"), &len);
+    CHECK_EQUAL(3 * sizeof(int), len);
+    const unsigned char *rets = get_column(batch, get_column_index(RECORD_TYPE_KILL, "ret"), &len);
+    for (int i = 0; i < 3; i++)
+    {
+        unsigned long long event_id;
+        int target_pid, ret;
+        memcpy(&event_id, event_ids + i * sizeof(event_id), sizeof(event_id));
+        memcpy(&target_pid, target_pids + i * sizeof(target_pid), sizeof(target_pid));
+        memcpy(&ret, rets + i * sizeof(ret), sizeof(ret));
+        CHECK_EQUAL(1000ULL + i, event_id);
+        CHECK_EQUAL(20 + i, target_pid);
+        CHECK_EQUAL(-i, ret);
+    }
+}
+
+TEST(RecordWriterColumnarGroup, TestVariableWidthColumns)
+{
+    init_columnar(2, 0);
+    size_t schema_size = captured_len;
+
+    const char *comms[] = {"bash", "python3"};
+    for (int i = 0; i < 2; i++)
+    {
+        struct record_new_process r;
+        memset(&r, 0, sizeof(r));
+        init_common(&(r.e_common), RECORD_TYPE_NEW_PROCESS);
+        r.pid = 100 + i;
+        strncpy(r.comm, comms[i], sizeof(r.comm) - 1);
+        CHECK(write_record(&(r.e_common), sizeof(r)) > 0);
+    }
+
+    const struct columnar_batch_header *batch = (const struct columnar_batch_header *)&captured[schema_size];
+    CHECK_EQUAL(RECORD_TYPE_NEW_PROCESS, batch->record_type);
+
+    size_t len;
+    const unsigned char *comm = get_column(batch, get_column_index(RECORD_TYPE_NEW_PROCESS, "comm"), &len);
+    unsigned int offsets[3];
+    memcpy(offsets, comm, sizeof(offsets));
+    CHECK_EQUAL(sizeof(offsets) + strlen("bash") + strlen("python3"), len);
+    CHECK_EQUAL(0, offsets[0]);
+    CHECK_EQUAL(4, offsets[1]);
+    CHECK_EQUAL(11, offsets[2]);
+    CHECK(memcmp("bashpython3", comm + sizeof(offsets), 11) == 0);
+}
+
+TEST(RecordWriterColumnarGroup, TestCompactSockaddr)
+{
+    init_columnar(1, 0);
+    size_t schema_size = captured_len;
+
+    struct record_send_recv r;
+    memset(&r, 0, sizeof(r));
+    init_common(&(r.e_common), RECORD_TYPE_SEND_RECV);
+    r.ret = 512;
+    struct sockaddr_in *sa_in = (struct sockaddr_in *)&(r.remote.addr[0]);
+    sa_in->sin_family = AF_INET;
+    sa_in->sin_port = htons(53);
+    inet_pton(AF_INET, "10.0.0.2", &(sa_in->sin_addr));
+    r.remote.addrlen = sizeof(struct sockaddr_in);
+    r.remote.byte_order = BYTE_ORDER_NETWORK;
+    // The port of a local address is in host byte order.
+    struct sockaddr_in *local_sa_in = (struct sockaddr_in *)&(r.local.addr[0]);
+    local_sa_in->sin_family = AF_INET;
+    local_sa_in->sin_port = 8080;
+    inet_pton(AF_INET, "10.0.0.1", &(local_sa_in->sin_addr));
+    r.local.addrlen = sizeof(struct sockaddr_in);
+    r.local.byte_order = BYTE_ORDER_HOST;
+
+    // Compact form: the prefix, then each sockaddr as a header and 'addrlen' bytes.
+    unsigned char compact[sizeof(r)];
+    size_t prefix_size = offsetof(struct record_send_recv, local);
+    memcpy(compact, &r, prefix_size);
+    ((struct elem_common *)compact)->version.major = RECORD_VERSION_MAJOR;
+    size_t compact_len = prefix_size;
+    struct elem_sockaddr *sockaddrs[] = {&(r.local), &(r.remote)};
+    for (int i = 0; i < 2; i++)
+    {
+        struct elem_sockaddr_compact header;
+        header.family = ((struct sockaddr *)&(sockaddrs[i]->addr[0]))->sa_family;
+        header.byte_order = sockaddrs[i]->byte_order;
+        header.addrlen = sockaddrs[i]->addrlen;
+        memcpy(compact + compact_len, &header, sizeof(header));
+        compact_len += sizeof(header);
+        memcpy(compact + compact_len, &(sockaddrs[i]->addr[0]), sockaddrs[i]->addrlen);
+        compact_len += sockaddrs[i]->addrlen;
+    }
+    CHECK_EQUAL(RECORD_COMPACT_PREFIX_SIZE_SEND_RECV, prefix_size);
+    CHECK(write_record((struct elem_common *)compact, compact_len) > 0);
+
+    const struct columnar_batch_header *batch = (const struct columnar_batch_header *)&captured[schema_size];
+    CHECK_EQUAL(RECORD_TYPE_SEND_RECV, batch->record_type);
+    CHECK_EQUAL(1, batch->rows);
+
+    size_t len;
+    const unsigned char *remote = get_column(batch, get_column_index(RECORD_TYPE_SEND_RECV, "remote"), &len);
+    unsigned int offsets[2];
+    memcpy(offsets, remote, sizeof(offsets));
+    CHECK_EQUAL(sizeof(struct sockaddr_in), offsets[1]);
+    CHECK(memcmp(sa_in, remote + sizeof(offsets), sizeof(struct sockaddr_in)) == 0);
+
+    const unsigned char *local = get_column(batch, get_column_index(RECORD_TYPE_SEND_RECV, "local"), &len);
+    memcpy(offsets, local, sizeof(offsets));
+    CHECK_EQUAL(sizeof(struct sockaddr_in), offsets[1]);
+    struct sockaddr_in local_value;
+    memcpy(&local_value, local + sizeof(offsets), sizeof(local_value));
+    CHECK_EQUAL(htons(8080), local_value.sin_port);
+    CHECK(memcmp(&(local_sa_in->sin_addr), &(local_value.sin_addr), sizeof(local_value.sin_addr)) == 0);
+
+    const unsigned char *ret = get_column(batch, get_column_index(RECORD_TYPE_SEND_RECV, "ret"), &len);
+    long long ret_value;
+    memcpy(&ret_value, ret, sizeof(ret_value));
+    CHECK_EQUAL(512, ret_value);
+}
+
+TEST(RecordWriterColumnarGroup, TestFlushForced)
+{
+    init_columnar(100, 0);
+    size_t schema_size = captured_len;
+
+    CHECK(write_kill(0) > 0);
+    CHECK(record_writer_columnar.flush(0) >= 0);
+    CHECK_EQUAL(schema_size, captured_len);
+
+    CHECK(record_writer_columnar.flush(1) > 0);
+    const struct columnar_batch_header *batch = (const struct columnar_batch_header *)&captured[schema_size];
+    CHECK_EQUAL(1, batch->rows);
+    CHECK_EQUAL(captured_len - schema_size, batch->batch_size);
+}
+
+TEST(RecordWriterColumnarGroup, TestFlushOnAge)
+{
+    init_columnar(100, 10);
+    size_t schema_size = captured_len;
+
+    CHECK(write_kill(0) > 0);
+    CHECK(record_writer_columnar.flush(0) >= 0);
+    CHECK_EQUAL(schema_size, captured_len);
+
+    usleep(20 * 1000);
+    CHECK(record_writer_columnar.flush(0) > 0);
+    CHECK(captured_len > schema_size);
+}
+
+TEST(RecordWriterColumnarGroup, TestCloseWritesBatches)
+{
+    init_columnar(100, 0);
+    size_t schema_size = captured_len;
+
+    CHECK(write_kill(0) > 0);
+    record_writer_columnar.close();
+    CHECK(captured_len > schema_size);
+    CHECK_EQUAL(1, captured_closed);
+}
+
+TEST(RecordWriterColumnarGroup, TestInvalidRecord)
+{
+    init_columnar(100, 0);
+
+    struct record_kill r;
+    memset(&r, 0, sizeof(r));
+    init_common(&(r.e_common), RECORD_TYPE_KILL);
+    CHECK_EQUAL(-1, write_record(&(r.e_common), sizeof(r) - 1));
+
+    char data[sizeof(size_t) + sizeof(r)];
+    size_t record_len = sizeof(r) + 1;
+    memcpy(data, &record_len, sizeof(record_len));
+    memcpy(data + sizeof(record_len), &r, sizeof(r));
+    CHECK_EQUAL(-1, record_writer_columnar.write(data, sizeof(data)));
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
@@ -0,0 +1,304 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+extern "C" {
+    #include "user/types.h"
+    #include "user/record/writer/writer.h"
+    #include "user/record/writer/compress.h"
+
+    #include "capture.h"
+
+    extern const struct record_writer record_writer_compress;
+}
+
+#ifdef OUTPUT_COMPRESSION_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef OUTPUT_COMPRESSION_HAVE_LZ4
+#include <lz4frame.h>
+#endif
+
+/*
+    The uncompressed data written to the compression writer.
+*/
+static size_t written_len = 0;
+
+#if defined(OUTPUT_COMPRESSION_HAVE_ZSTD) || defined(OUTPUT_COMPRESSION_HAVE_LZ4)
+static char written[1 << 21];
+
+static void init_compress(
+    enum output_compression_codec codec, size_t block_size, long flush_interval_ms, int frame_per_block = 0
+)
+{
+    struct compress_writer_args args;
+    memset(&args, 0, sizeof(args));
+    args.writer = &record_writer_capture;
+    args.compression.codec = codec;
+    args.compression.level = 0;
+    args.compression.block_size = block_size;
+    args.flush_interval_ms = flush_interval_ms;
+    args.frame_per_block = frame_per_block;
+    CHECK_EQUAL(0, record_writer_compress.set_init_args(&args, sizeof(args)));
+    CHECK_EQUAL(0, record_writer_compress.init());
+}
+
+/*
+    Write 'count' JSON-like lines.
+*/
+static void write_lines(int count)
+{
+    char line[256];
+    for (int i = 0; i < count; i++)
+    {
+        int len = snprintf(
+            line, sizeof(line),
+            "{\"record_name\":\"record_send_recv\",\"event_id\":%d,\"pid\":%d,\"fd\":3,\"ret\":512}\n",
+            i, 1000 + i % 7
+        );
+        CHECK_EQUAL(len, record_writer_compress.write(line, len));
+        memcpy(&written[written_len], line, len);
+        written_len += len;
+    }
+}
+
+#endif
+
+#ifdef OUTPUT_COMPRESSION_HAVE_ZSTD
+/*
+    Decompress the captured (possibly unfinished) zstd frame.
+
+    Return:
+        The size decompressed into 'dst'
+*/
+static size_t decompress_zstd(char *dst, size_t dst_len)
+{
+    ZSTD_DCtx *dctx = ZSTD_createDCtx();
+    ZSTD_inBuffer input = {captured, captured_len, 0};
+    ZSTD_outBuffer output = {dst, dst_len, 0};
+    while (input.pos < input.size)
+    {
+        size_t ret = ZSTD_decompressStream(dctx, &output, &input);
+        CHECK(!ZSTD_isError(ret));
+    }
+    ZSTD_freeDCtx(dctx);
+    return output.pos;
+}
+#endif
+
+#ifdef OUTPUT_COMPRESSION_HAVE_LZ4
+static size_t decompress_lz4(char *dst, size_t dst_len)
+{
+    LZ4F_dctx *dctx;
+    CHECK(!LZ4F_isError(LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION)));
+    size_t src_pos = 0;
+    size_t dst_pos = 0;
+    while (src_pos < captured_len)
+    {
+        size_t src_size = captured_len - src_pos;
+        size_t dst_size = dst_len - dst_pos;
+        size_t ret = LZ4F_decompress(dctx, dst + dst_pos, &dst_size, captured + src_pos, &src_size, NULL);
+        CHECK(!LZ4F_isError(ret));
+        src_pos += src_size;
+        dst_pos += dst_size;
+    }
+    LZ4F_freeDecompressionContext(dctx);
+    return dst_pos;
+}
+#endif
+
+#if defined(OUTPUT_COMPRESSION_HAVE_ZSTD) || defined(OUTPUT_COMPRESSION_HAVE_LZ4)
+static char decompressed[1 << 21];
+
+static const char header[] = "{\"header\":1}\n";
+static const size_t header_len = sizeof(header) - 1;
+
+/*
+    Put a frame of the header ahead of the captured data.
+*/
+static void prepend_header_frame(enum output_compression_codec codec)
+{
+    struct output_compression c = {codec, 0, 4096};
+    char frame[256];
+    long frame_len = record_writer_compress_frame(&c, header, header_len, frame, sizeof(frame));
+    CHECK(frame_len > 0);
+    memmove(&captured[frame_len], captured, captured_len);
+    memcpy(captured, frame, frame_len);
+    captured_len += frame_len;
+}
+
+/*
+    Check that the decompressed data is the header followed by the written data.
+*/
+static void check_header_and_written(size_t decompressed_len)
+{
+    CHECK_EQUAL(header_len + written_len, decompressed_len);
+    CHECK(memcmp(header, decompressed, header_len) == 0);
+    CHECK(memcmp(written, decompressed + header_len, written_len) == 0);
+}
+#endif
+
+TEST_GROUP(RecordWriterCompressGroup)
+{
+    void setup()
+    {
+        reset_capture();
+        written_len = 0;
+    }
+
+    void teardown()
+    {
+        record_writer_compress.close();
+    }
+};
+
+TEST(RecordWriterCompressGroup, TestNotInitialized)
+{
+    char data[16] = {0};
+    CHECK_EQUAL(-2, record_writer_compress.write(data, sizeof(data)));
+    CHECK_EQUAL(-2, record_writer_compress.flush(1));
+}
+
+TEST(RecordWriterCompressGroup, TestInvalidInitArgs)
+{
+    struct compress_writer_args args;
+    memset(&args, 0, sizeof(args));
+    args.writer = NULL;
+    args.compression.codec = OUTPUT_COMPRESSION_ZSTD;
+    args.compression.block_size = 4096;
+    CHECK_EQUAL(-1, record_writer_compress.set_init_args(&args, sizeof(args)));
+
+    args.writer = &record_writer_capture;
+    args.compression.codec = OUTPUT_COMPRESSION_NONE;
+    CHECK_EQUAL(-1, record_writer_compress.set_init_args(&args, sizeof(args)));
+
+    args.compression.codec = OUTPUT_COMPRESSION_ZSTD;
+    args.compression.block_size = 0;
+    CHECK_EQUAL(-1, record_writer_compress.set_init_args(&args, sizeof(args)));
+
+    args.compression.block_size = 4096;
+    CHECK_EQUAL(-1, record_writer_compress.set_init_args(&args, sizeof(args) - 1));
+    CHECK_EQUAL(0, record_writer_compress.set_init_args(&args, sizeof(args)));
+}
+
+#ifdef OUTPUT_COMPRESSION_HAVE_ZSTD
+
+TEST(RecordWriterCompressGroup, TestZstdRoundTrip)
+{
+    init_compress(OUTPUT_COMPRESSION_ZSTD, 4096, 0);
+    write_lines(10000);
+    record_writer_compress.close();
+    CHECK_EQUAL(1, captured_closed);
+
+    CHECK(captured_len * 10 < written_len);
+    CHECK_EQUAL(written_len, decompress_zstd(decompressed, sizeof(decompressed)));
+    CHECK(memcmp(written, decompressed, written_len) == 0);
+}
+
+TEST(RecordWriterCompressGroup, TestZstdFlushForced)
+{
+    init_compress(OUTPUT_COMPRESSION_ZSTD, 64 * 1024, 0);
+    write_lines(10);
+    CHECK_EQUAL(0, record_writer_compress.flush(0));
+    CHECK_EQUAL((int)written_len, record_writer_compress.flush(1));
+
+    // Everything written so far can be decompressed before the frame ends.
+    CHECK_EQUAL(written_len, decompress_zstd(decompressed, sizeof(decompressed)));
+    CHECK(memcmp(written, decompressed, written_len) == 0);
+}
+
+TEST(RecordWriterCompressGroup, TestZstdFlushOnAge)
+{
+    init_compress(OUTPUT_COMPRESSION_ZSTD, 64 * 1024, 10);
+    write_lines(10);
+    CHECK_EQUAL(0, record_writer_compress.flush(0));
+
+    usleep(20 * 1000);
+    CHECK_EQUAL((int)written_len, record_writer_compress.flush(0));
+}
+
+TEST(RecordWriterCompressGroup, TestZstdFramePerBlock)
+{
+    init_compress(OUTPUT_COMPRESSION_ZSTD, 4096, 0, 1);
+    write_lines(1000);
+    CHECK_EQUAL((int)(written_len % 4096), record_writer_compress.flush(1));
+
+    // Every block is a frame of its own.
+    size_t frames = 0;
+    for (size_t pos = 0; pos < captured_len; frames++)
+    {
+        size_t len = ZSTD_findFrameCompressedSize(&captured[pos], captured_len - pos);
+        CHECK(!ZSTD_isError(len));
+        pos += len;
+    }
+    CHECK_EQUAL((written_len + 4095) / 4096, frames);
+
+    prepend_header_frame(OUTPUT_COMPRESSION_ZSTD);
+    check_header_and_written(decompress_zstd(decompressed, sizeof(decompressed)));
+}
+
+TEST(RecordWriterCompressGroup, TestWriteFailure)
+{
+    init_compress(OUTPUT_COMPRESSION_ZSTD, 4096, 0);
+    capture_fails = 1;
+    write_lines(10);
+    CHECK_EQUAL(-1, record_writer_compress.flush(1));
+    CHECK_EQUAL(0, record_writer_compress.flush(1));
+}
+
+#endif
+
+#ifdef OUTPUT_COMPRESSION_HAVE_LZ4
+
+TEST(RecordWriterCompressGroup, TestLz4RoundTrip)
+{
+    init_compress(OUTPUT_COMPRESSION_LZ4, 4096, 0);
+    write_lines(10000);
+    CHECK_EQUAL((int)(written_len % 4096), record_writer_compress.flush(1));
+    write_lines(100);
+    record_writer_compress.close();
+
+    CHECK(captured_len * 4 < written_len);
+    CHECK_EQUAL(written_len, decompress_lz4(decompressed, sizeof(decompressed)));
+    CHECK(memcmp(written, decompressed, written_len) == 0);
+}
+
+TEST(RecordWriterCompressGroup, TestLz4FramePerBlock)
+{
+    init_compress(OUTPUT_COMPRESSION_LZ4, 4096, 0, 1);
+    write_lines(1000);
+    record_writer_compress.close();
+
+    prepend_header_frame(OUTPUT_COMPRESSION_LZ4);
+    check_header_and_written(decompress_lz4(decompressed, sizeof(decompressed)));
+}
+
+#endif
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
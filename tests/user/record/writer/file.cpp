@@ -0,0 +1,261 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+extern "C" {
+    #include "user/types.h"
+    #include "user/record/writer/writer.h"
+
+    extern const struct record_writer record_writer_file;
+    extern const struct record_writer record_writer_file_uring;
+}
+
+static const char *test_file_path = "/tmp/ameba_test_record_writer_file.out";
+
+static void init_output_file(struct output_file *f, size_t buffer_size, long flush_interval_ms)
+{
+    memset(f, 0, sizeof(struct output_file));
+    strncpy(&(f->path[0]), test_file_path, PATH_MAX - 1);
+    f->flush_policy.buffer_size = buffer_size;
+    f->flush_policy.flush_interval_ms = flush_interval_ms;
+    f->engine = OUTPUT_FILE_ENGINE_SYNC;
+}
+
+static long get_file_size()
+{
+    struct stat st;
+    if (stat(test_file_path, &st) != 0)
+        return -1;
+    return (long)st.st_size;
+}
+
+/*
+    Write 'count' numbered lines and return the total bytes written.
+*/
+static long write_lines(const struct record_writer *w, int count)
+{
+    long total = 0;
+    char line[64];
+    for (int i = 0; i < count; i++)
+    {
+        int len = snprintf(line, sizeof(line), "record %d\n", i);
+        CHECK_EQUAL(len, w->write(line, len));
+        total += len;
+    }
+    return total;
+}
+
+static void check_lines(int count)
+{
+    FILE *fp = fopen(test_file_path, "r");
+    CHECK(fp != NULL);
+
+    char expected[64];
+    char actual[64];
+    for (int i = 0; i < count; i++)
+    {
+        snprintf(expected, sizeof(expected), "record %d\n", i);
+        CHECK(fgets(actual, sizeof(actual), fp) != NULL);
+        STRCMP_EQUAL(expected, actual);
+    }
+    CHECK(fgets(actual, sizeof(actual), fp) == NULL);
+    fclose(fp);
+}
+
+TEST_GROUP(RecordWriterFileGroup)
+{
+    void teardown()
+    {
+        unlink(test_file_path);
+    }
+};
+
+TEST(RecordWriterFileGroup, TestNotInitialized)
+{
+    char data[] = "x";
+    CHECK_EQUAL(-2, record_writer_file.write(data, 1));
+    CHECK_EQUAL(-2, record_writer_file.flush(1));
+}
+
+TEST(RecordWriterFileGroup, TestInvalidInitArgs)
+{
+    struct output_file f;
+    init_output_file(&f, 0, -1);
+    CHECK_EQUAL(-1, record_writer_file.set_init_args(&f, sizeof(f)));
+    CHECK_EQUAL(-1, record_writer_file.set_init_args(&f, sizeof(f) - 1));
+}
+
+TEST(RecordWriterFileGroup, TestUnbuffered)
+{
+    struct output_file f;
+    init_output_file(&f, 0, 0);
+    CHECK_EQUAL(0, record_writer_file.set_init_args(&f, sizeof(f)));
+    CHECK_EQUAL(0, record_writer_file.init());
+
+    long total = write_lines(&record_writer_file, 100);
+    CHECK_EQUAL(total, get_file_size());
+
+    record_writer_file.close();
+    check_lines(100);
+}
+
+TEST(RecordWriterFileGroup, TestBufferedFlushOnFull)
+{
+    struct output_file f;
+    init_output_file(&f, 4096, 0);
+    CHECK_EQUAL(0, record_writer_file.set_init_args(&f, sizeof(f)));
+    CHECK_EQUAL(0, record_writer_file.init());
+
+    long total = write_lines(&record_writer_file, 1000);
+    CHECK(get_file_size() > 0);
+    CHECK(get_file_size() < total);
+
+    record_writer_file.close();
+    check_lines(1000);
+}
+
+TEST(RecordWriterFileGroup, TestBufferedFlushForced)
+{
+    struct output_file f;
+    init_output_file(&f, 4096, 0);
+    CHECK_EQUAL(0, record_writer_file.set_init_args(&f, sizeof(f)));
+    CHECK_EQUAL(0, record_writer_file.init());
+
+    long total = write_lines(&record_writer_file, 10);
+    CHECK_EQUAL(0, get_file_size());
+    CHECK_EQUAL(0, record_writer_file.flush(0));
+    CHECK_EQUAL(total, record_writer_file.flush(1));
+    CHECK_EQUAL(total, get_file_size());
+
+    record_writer_file.close();
+    check_lines(10);
+}
+
+TEST(RecordWriterFileGroup, TestBufferedFlushOnAge)
+{
+    struct output_file f;
+    init_output_file(&f, 4096, 1);
+    CHECK_EQUAL(0, record_writer_file.set_init_args(&f, sizeof(f)));
+    CHECK_EQUAL(0, record_writer_file.init());
+
+    long total = write_lines(&record_writer_file, 1);
+    usleep(5000);
+    CHECK_EQUAL(total, record_writer_file.flush(0));
+    CHECK_EQUAL(total, get_file_size());
+
+    record_writer_file.close();
+    check_lines(1);
+}
+
+TEST(RecordWriterFileGroup, TestBufferedLargerThanBuffer)
+{
+    struct output_file f;
+    init_output_file(&f, 4096, 0);
+    CHECK_EQUAL(0, record_writer_file.set_init_args(&f, sizeof(f)));
+    CHECK_EQUAL(0, record_writer_file.init());
+
+    char data[8192];
+    memset(data, 'x', sizeof(data));
+    CHECK_EQUAL((int)sizeof(data), record_writer_file.write(data, sizeof(data)));
+
+    record_writer_file.close();
+    CHECK_EQUAL((long)sizeof(data), get_file_size());
+}
+
+TEST(RecordWriterFileGroup, TestBufferedFlushFailureKeepsData)
+{
+    struct output_file f;
+    init_output_file(&f, 4096, 0);
+    CHECK_EQUAL(0, record_writer_file.set_init_args(&f, sizeof(f)));
+    CHECK_EQUAL(0, record_writer_file.init());
+
+    long total = write_lines(&record_writer_file, 100);
+
+    // Writes past the file size limit fail with EFBIG instead of raising SIGXFSZ.
+    struct rlimit old_limit;
+    CHECK_EQUAL(0, getrlimit(RLIMIT_FSIZE, &old_limit));
+    struct rlimit limit = old_limit;
+    limit.rlim_cur = 100;
+    void (*old_handler)(int) = signal(SIGXFSZ, SIG_IGN);
+    CHECK_EQUAL(0, setrlimit(RLIMIT_FSIZE, &limit));
+
+    CHECK_EQUAL(-1, record_writer_file.flush(1));
+    CHECK_EQUAL(100, get_file_size());
+
+    CHECK_EQUAL(0, setrlimit(RLIMIT_FSIZE, &old_limit));
+    signal(SIGXFSZ, old_handler);
+
+    // The part that was not written is written by the next flush.
+    CHECK_EQUAL(total - 100, record_writer_file.flush(1));
+    CHECK_EQUAL(total, get_file_size());
+
+    record_writer_file.close();
+    check_lines(100);
+}
+
+TEST(RecordWriterFileGroup, TestUring)
+{
+    struct output_file f;
+    init_output_file(&f, 4096, 0);
+    f.engine = OUTPUT_FILE_ENGINE_URING;
+    CHECK_EQUAL(0, record_writer_file_uring.set_init_args(&f, sizeof(f)));
+    if (record_writer_file_uring.init() != 0)
+    {
+        // io_uring unavailable on this host. ameba falls back to record_writer_file.
+        return;
+    }
+
+    write_lines(&record_writer_file_uring, 10000);
+
+    char data[8192];
+    memset(data, 'x', sizeof(data));
+    CHECK_EQUAL((int)sizeof(data), record_writer_file_uring.write(data, sizeof(data)));
+    CHECK(record_writer_file_uring.flush(1) >= 0);
+
+    record_writer_file_uring.close();
+
+    FILE *fp = fopen(test_file_path, "r");
+    CHECK(fp != NULL);
+    char expected[64];
+    char actual[64];
+    for (int i = 0; i < 10000; i++)
+    {
+        snprintf(expected, sizeof(expected), "record %d\n", i);
+        CHECK(fgets(actual, sizeof(actual), fp) != NULL);
+        STRCMP_EQUAL(expected, actual);
+    }
+    size_t read = fread(data, 1, sizeof(data), fp);
+    CHECK_EQUAL(sizeof(data), read);
+    CHECK_EQUAL('x', data[sizeof(data) - 1]);
+    fclose(fp);
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
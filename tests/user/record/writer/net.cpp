@@ -0,0 +1,276 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+extern "C" {
+    #include "user/types.h"
+    #include "user/record/writer/writer.h"
+    #include "user/record/writer/net.h"
+
+    extern const struct record_writer record_writer_net;
+}
+
+/*
+    The socket the writer sends to.
+*/
+static int receiver_fd = -1;
+static int receiver_port = 0;
+
+static void open_receiver()
+{
+    receiver_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    CHECK(receiver_fd >= 0);
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    CHECK_EQUAL(0, bind(receiver_fd, (struct sockaddr *)&addr, sizeof(addr)));
+
+    socklen_t addr_len = sizeof(addr);
+    CHECK_EQUAL(0, getsockname(receiver_fd, (struct sockaddr *)&addr, &addr_len));
+    receiver_port = ntohs(addr.sin_port);
+
+    // Large enough to hold every datagram sent by a test.
+    int rcvbuf = 4 << 20;
+    setsockopt(receiver_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+}
+
+static void init_net(size_t datagram_size, int batch, long flush_interval_ms, const char *header = "")
+{
+    struct net_writer_args args;
+    memset(&args, 0, sizeof(args));
+    args.output.ip_family = AF_INET;
+    strcpy(args.output.ip, "127.0.0.1");
+    args.output.port = receiver_port;
+    args.output.datagram_size = datagram_size;
+    args.output.batch = batch;
+    args.output.flush_interval_ms = flush_interval_ms;
+    args.header_len = strlen(header);
+    memcpy(args.header, header, args.header_len);
+    CHECK_EQUAL(0, record_writer_net.set_init_args(&args, sizeof(args)));
+    CHECK_EQUAL(0, record_writer_net.init());
+}
+
+/*
+    Receive the next datagram without waiting.
+
+    Return:
+        -1  => No datagram
+        >=0 => The datagram size
+*/
+static int receive(char *dst, size_t dst_len)
+{
+    ssize_t len = recv(receiver_fd, dst, dst_len, MSG_DONTWAIT);
+    return (int)len;
+}
+
+/*
+    Write 'count' numbered records of 10 bytes i.e. 'record 00\n'.
+*/
+static void write_records(int count)
+{
+    char record[] = "record 00\n";
+    for (int i = 0; i < count; i++)
+    {
+        record[7] = '0' + i / 10;
+        record[8] = '0' + i % 10;
+        CHECK_EQUAL(10, record_writer_net.write(record, 10));
+    }
+}
+
+TEST_GROUP(RecordWriterNetGroup)
+{
+    void setup()
+    {
+        open_receiver();
+    }
+
+    void teardown()
+    {
+        record_writer_net.close();
+        close(receiver_fd);
+    }
+};
+
+TEST(RecordWriterNetGroup, TestNotInitialized)
+{
+    char data[] = "x";
+    CHECK_EQUAL(-2, record_writer_net.write(data, 1));
+    CHECK_EQUAL(-2, record_writer_net.flush(1));
+}
+
+TEST(RecordWriterNetGroup, TestInvalidInitArgs)
+{
+    struct net_writer_args args;
+    memset(&args, 0, sizeof(args));
+    args.output.ip_family = AF_INET;
+    strcpy(args.output.ip, "127.0.0.1");
+    args.output.port = receiver_port;
+    args.output.datagram_size = 1472;
+    args.output.batch = 0;
+    CHECK_EQUAL(-1, record_writer_net.set_init_args(&args, sizeof(args)));
+    CHECK_EQUAL(-1, record_writer_net.set_init_args(&args, sizeof(args) - 1));
+
+    // No room for a record after the header.
+    args.output.batch = 1;
+    args.output.datagram_size = 4;
+    args.header_len = 4;
+    CHECK_EQUAL(-1, record_writer_net.set_init_args(&args, sizeof(args)));
+}
+
+TEST(RecordWriterNetGroup, TestDatagramPerRecord)
+{
+    init_net(0, 1, 0);
+    write_records(3);
+
+    char buf[2048];
+    CHECK_EQUAL(10, receive(buf, sizeof(buf)));
+    STRNCMP_EQUAL("record 00\n", buf, 10);
+    CHECK_EQUAL(10, receive(buf, sizeof(buf)));
+    CHECK_EQUAL(10, receive(buf, sizeof(buf)));
+    CHECK_EQUAL(-1, receive(buf, sizeof(buf)));
+}
+
+TEST(RecordWriterNetGroup, TestPacked)
+{
+    // 3 records per datagram, 2 datagrams per batch.
+    init_net(35, 2, 0);
+    write_records(6);
+
+    // Not sent until the batch is full or flushed.
+    char buf[2048];
+    CHECK_EQUAL(-1, receive(buf, sizeof(buf)));
+
+    write_records(1);
+    CHECK_EQUAL(30, receive(buf, sizeof(buf)));
+    STRNCMP_EQUAL("record 00\nrecord 01\nrecord 02\n", buf, 30);
+    CHECK_EQUAL(30, receive(buf, sizeof(buf)));
+    STRNCMP_EQUAL("record 03\nrecord 04\nrecord 05\n", buf, 30);
+    CHECK_EQUAL(-1, receive(buf, sizeof(buf)));
+
+    CHECK_EQUAL(10, record_writer_net.flush(1));
+    CHECK_EQUAL(10, receive(buf, sizeof(buf)));
+    STRNCMP_EQUAL("record 00\n", buf, 10);
+    CHECK_EQUAL(0, record_writer_net.flush(1));
+}
+
+TEST(RecordWriterNetGroup, TestLargeRecord)
+{
+    init_net(20, 4, 0);
+    write_records(1);
+
+    char large[64];
+    memset(large, 'x', sizeof(large));
+    CHECK_EQUAL(64, record_writer_net.write(large, sizeof(large)));
+
+    // The packed records are sent before the large record.
+    char buf[2048];
+    CHECK_EQUAL(10, receive(buf, sizeof(buf)));
+    CHECK_EQUAL(64, receive(buf, sizeof(buf)));
+    CHECK_EQUAL(-1, receive(buf, sizeof(buf)));
+}
+
+TEST(RecordWriterNetGroup, TestFlushOnAge)
+{
+    init_net(1472, 32, 20);
+    write_records(5);
+
+    char buf[2048];
+    CHECK_EQUAL(0, record_writer_net.flush(0));
+    CHECK_EQUAL(-1, receive(buf, sizeof(buf)));
+
+    usleep(30 * 1000);
+    CHECK_EQUAL(50, record_writer_net.flush(0));
+    CHECK_EQUAL(50, receive(buf, sizeof(buf)));
+}
+
+TEST(RecordWriterNetGroup, TestSentOnClose)
+{
+    init_net(1472, 32, 0);
+    write_records(50);
+    record_writer_net.close();
+
+    char buf[2048];
+    CHECK_EQUAL(500, receive(buf, sizeof(buf)));
+    CHECK_EQUAL(-1, receive(buf, sizeof(buf)));
+}
+
+TEST(RecordWriterNetGroup, TestHeaderInEveryDatagram)
+{
+    // 3 records after the header per datagram.
+    init_net(36, 2, 0, "HD\n");
+    write_records(4);
+    CHECK_EQUAL(40, record_writer_net.flush(1));
+
+    char buf[2048];
+    CHECK_EQUAL(33, receive(buf, sizeof(buf)));
+    STRNCMP_EQUAL("HD\nrecord 00\nrecord 01\nrecord 02\n", buf, 33);
+    CHECK_EQUAL(13, receive(buf, sizeof(buf)));
+    STRNCMP_EQUAL("HD\nrecord 03\n", buf, 13);
+
+    // A record sent on its own too.
+    char large[64];
+    memset(large, 'x', sizeof(large));
+    CHECK_EQUAL(64, record_writer_net.write(large, sizeof(large)));
+    CHECK_EQUAL(67, receive(buf, sizeof(buf)));
+    STRNCMP_EQUAL("HD\nxxx", buf, 6);
+    CHECK_EQUAL(-1, receive(buf, sizeof(buf)));
+}
+
+TEST(RecordWriterNetGroup, TestHeaderPerRecord)
+{
+    init_net(0, 1, 0, "HD\n");
+    write_records(2);
+
+    char buf[2048];
+    CHECK_EQUAL(13, receive(buf, sizeof(buf)));
+    STRNCMP_EQUAL("HD\nrecord 00\n", buf, 13);
+    CHECK_EQUAL(13, receive(buf, sizeof(buf)));
+    STRNCMP_EQUAL("HD\nrecord 01\n", buf, 13);
+}
+
+TEST(RecordWriterNetGroup, TestNoReceiver)
+{
+    init_net(35, 1, 0);
+    close(receiver_fd);
+    receiver_fd = -1;
+
+    // Datagrams to a closed port are dropped rather than failing the writer.
+    for (int i = 0; i < 10; i++)
+    {
+        write_records(10);
+        CHECK(record_writer_net.flush(1) >= 0);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
@@ -0,0 +1,379 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+extern "C" {
+    #include "user/types.h"
+    #include "user/record/writer/writer.h"
+    #include "user/record/writer/rotate.h"
+
+    extern const struct record_writer record_writer_file;
+    extern const struct record_writer record_writer_rotate;
+}
+
+static const char *test_dir = "/tmp/ameba_test_record_writer_rotate";
+static const char *test_file_path = "/tmp/ameba_test_record_writer_rotate/out.json";
+static const char *test_next_file_path = "/tmp/ameba_test_record_writer_rotate/.out.json.next";
+static const char *test_header = "header\n";
+
+static int open_count = 0;
+static int open_fails = 0;
+// Set to hold the open on the helper thread until cleared.
+static int open_blocked = 0;
+
+/*
+    Open a file writer over the test file and write the header, like ameba does.
+*/
+static const struct record_writer *open_file_writer(void *ctx)
+{
+    while (__atomic_load_n(&open_blocked, __ATOMIC_ACQUIRE))
+        usleep(1000);
+
+    open_count++;
+    if (open_fails)
+        return NULL;
+
+    struct output_file f;
+    memset(&f, 0, sizeof(f));
+    strncpy(&(f.path[0]), test_file_path, PATH_MAX - 1);
+    f.engine = OUTPUT_FILE_ENGINE_SYNC;
+    if (record_writer_file.set_init_args(&f, sizeof(f)) != 0 || record_writer_file.init() != 0)
+        return NULL;
+    if (record_writer_file.write((void *)test_header, strlen(test_header)) < 0)
+    {
+        record_writer_file.close();
+        return NULL;
+    }
+    return &record_writer_file;
+}
+
+static void init_rotate(size_t max_size, long interval_sec, int retain)
+{
+    struct rotate_writer_args args;
+    memset(&args, 0, sizeof(args));
+    args.open = open_file_writer;
+    strncpy(&(args.path[0]), test_file_path, PATH_MAX - 1);
+    args.rotation.max_size = max_size;
+    args.rotation.interval_sec = interval_sec;
+    args.rotation.retain = retain;
+    CHECK_EQUAL(0, record_writer_rotate.set_init_args(&args, sizeof(args)));
+    CHECK_EQUAL(0, record_writer_rotate.init());
+}
+
+static void write_file(const char *path, const char *data)
+{
+    FILE *fp = fopen(path, "w");
+    CHECK(fp != NULL);
+    fputs(data, fp);
+    fclose(fp);
+}
+
+static void read_file(const char *path, char *dst, size_t dst_len)
+{
+    FILE *fp = fopen(path, "r");
+    CHECK(fp != NULL);
+    size_t len = fread(dst, 1, dst_len - 1, fp);
+    dst[len] = '\0';
+    fclose(fp);
+}
+
+static int file_exists(const char *path)
+{
+    struct stat st;
+    return stat(path, &st) == 0;
+}
+
+/*
+    Get the paths of the rotated files in the order they were rotated.
+
+    Return:
+        The number of rotated files
+*/
+static int list_rotated_files(char paths[][PATH_MAX], int max_paths)
+{
+    DIR *d = opendir(test_dir);
+    CHECK(d != NULL);
+
+    int count = 0;
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL)
+    {
+        if (strncmp(e->d_name, "out.", 4) != 0 || strcmp(e->d_name, "out.json") == 0)
+            continue;
+        CHECK(count < max_paths);
+        snprintf(paths[count], PATH_MAX, "%s/%s", test_dir, e->d_name);
+        count++;
+    }
+    closedir(d);
+
+    qsort(paths, count, PATH_MAX, (int (*)(const void *, const void *))strcmp);
+    return count;
+}
+
+/*
+    Wait for the helper thread to bring the number of rotated files down to 'count'.
+*/
+static int wait_rotated_files(int count)
+{
+    char paths[16][PATH_MAX];
+    int actual = 0;
+    for (int i = 0; i < 200; i++)
+    {
+        actual = list_rotated_files(paths, 16);
+        if (actual == count)
+            break;
+        usleep(5000);
+    }
+    return actual;
+}
+
+TEST_GROUP(RecordWriterRotateGroup)
+{
+    void setup()
+    {
+        open_count = 0;
+        open_fails = 0;
+        open_blocked = 0;
+        mkdir(test_dir, 0700);
+    }
+
+    void teardown()
+    {
+        record_writer_rotate.close();
+
+        DIR *d = opendir(test_dir);
+        if (d)
+        {
+            char path[PATH_MAX];
+            struct dirent *e;
+            while ((e = readdir(d)) != NULL)
+            {
+                if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0)
+                    continue;
+                snprintf(path, sizeof(path), "%s/%s", test_dir, e->d_name);
+                unlink(path);
+            }
+            closedir(d);
+        }
+        rmdir(test_dir);
+    }
+};
+
+TEST(RecordWriterRotateGroup, TestNotInitialized)
+{
+    char data[] = "x";
+    CHECK_EQUAL(-2, record_writer_rotate.write(data, 1));
+    CHECK_EQUAL(-2, record_writer_rotate.flush(1));
+}
+
+TEST(RecordWriterRotateGroup, TestInvalidInitArgs)
+{
+    struct rotate_writer_args args;
+    memset(&args, 0, sizeof(args));
+    strncpy(&(args.path[0]), test_file_path, PATH_MAX - 1);
+    CHECK_EQUAL(-1, record_writer_rotate.set_init_args(&args, sizeof(args)));
+
+    args.open = open_file_writer;
+    args.rotation.retain = -1;
+    CHECK_EQUAL(-1, record_writer_rotate.set_init_args(&args, sizeof(args)));
+    CHECK_EQUAL(-1, record_writer_rotate.set_init_args(&args, sizeof(args) - 1));
+}
+
+TEST(RecordWriterRotateGroup, TestRotatePath)
+{
+    // 2026-10-17 12:00:00.042 UTC
+    long long now_ms = 1792238400042LL;
+    char path[PATH_MAX];
+
+    CHECK_EQUAL(0, record_writer_rotate_path("/var/log/out.jsonl.zst", now_ms, path, sizeof(path)));
+    STRCMP_EQUAL("/var/log/out.20261017-120000-042.jsonl.zst", path);
+
+    CHECK_EQUAL(0, record_writer_rotate_path("/var/log/out", now_ms, path, sizeof(path)));
+    STRCMP_EQUAL("/var/log/out.20261017-120000-042", path);
+
+    CHECK_EQUAL(0, record_writer_rotate_path("/var/log/.out.json", now_ms, path, sizeof(path)));
+    STRCMP_EQUAL("/var/log/.out.20261017-120000-042.json", path);
+
+    CHECK_EQUAL(-1, record_writer_rotate_path("/var/log/out.json", now_ms, path, 20));
+}
+
+TEST(RecordWriterRotateGroup, TestExistingFileRotatedOnInit)
+{
+    write_file(test_file_path, "earlier run\n");
+
+    init_rotate(0, 0, 0);
+    record_writer_rotate.close();
+
+    char paths[16][PATH_MAX];
+    CHECK_EQUAL(1, list_rotated_files(paths, 16));
+
+    char data[256];
+    read_file(paths[0], data, sizeof(data));
+    STRCMP_EQUAL("earlier run\n", data);
+    read_file(test_file_path, data, sizeof(data));
+    STRCMP_EQUAL(test_header, data);
+}
+
+TEST(RecordWriterRotateGroup, TestRotateOnSize)
+{
+    init_rotate(100, 0, 0);
+
+    // 10 bytes each so that 10 records fit in a file.
+    char record[] = "record 00\n";
+    for (int i = 0; i < 35; i++)
+    {
+        record[7] = '0' + i / 10;
+        record[8] = '0' + i % 10;
+        CHECK_EQUAL(10, record_writer_rotate.write(record, 10));
+        // Wait for any rotation started by the write.
+        CHECK_EQUAL(0, record_writer_rotate.flush(1));
+    }
+    CHECK_EQUAL(0, record_writer_rotate.flush(1));
+    record_writer_rotate.close();
+
+    CHECK_EQUAL(4, open_count);
+    CHECK(!file_exists(test_next_file_path));
+
+    char paths[16][PATH_MAX];
+    CHECK_EQUAL(3, list_rotated_files(paths, 16));
+
+    char data[256];
+    for (int i = 0; i < 3; i++)
+    {
+        read_file(paths[i], data, sizeof(data));
+        CHECK_EQUAL(strlen(test_header) + 100, strlen(data));
+        STRNCMP_EQUAL(test_header, data, strlen(test_header));
+        record[7] = '0' + i;
+        record[8] = '0';
+        STRNCMP_EQUAL(record, &data[strlen(test_header)], 10);
+    }
+    read_file(test_file_path, data, sizeof(data));
+    STRCMP_EQUAL("header\nrecord 30\nrecord 31\nrecord 32\nrecord 33\nrecord 34\n", data);
+}
+
+TEST(RecordWriterRotateGroup, TestRotateOnRequest)
+{
+    init_rotate(0, 0, 0);
+    CHECK_EQUAL(4, record_writer_rotate.write((void *)"abc\n", 4));
+
+    record_writer_rotate_request();
+    CHECK_EQUAL(0, record_writer_rotate.flush(1));
+    CHECK_EQUAL(2, open_count);
+
+    // Only one rotation per request.
+    CHECK_EQUAL(0, record_writer_rotate.flush(1));
+    CHECK_EQUAL(2, open_count);
+
+    char paths[16][PATH_MAX];
+    CHECK_EQUAL(1, list_rotated_files(paths, 16));
+
+    char data[256];
+    read_file(paths[0], data, sizeof(data));
+    STRCMP_EQUAL("header\nabc\n", data);
+}
+
+TEST(RecordWriterRotateGroup, TestMovedByOthers)
+{
+    init_rotate(0, 0, 0);
+    CHECK_EQUAL(4, record_writer_rotate.write((void *)"abc\n", 4));
+
+    // i.e. logrotate moves the file and sends SIGHUP.
+    char moved_path[PATH_MAX];
+    snprintf(moved_path, sizeof(moved_path), "%s/moved", test_dir);
+    CHECK_EQUAL(0, rename(test_file_path, moved_path));
+    record_writer_rotate_request();
+    CHECK_EQUAL(4, record_writer_rotate.write((void *)"def\n", 4));
+    record_writer_rotate.close();
+
+    char paths[16][PATH_MAX];
+    CHECK_EQUAL(0, list_rotated_files(paths, 16));
+
+    char data[256];
+    read_file(moved_path, data, sizeof(data));
+    STRCMP_EQUAL("header\nabc\n", data);
+    read_file(test_file_path, data, sizeof(data));
+    STRCMP_EQUAL("header\ndef\n", data);
+}
+
+TEST(RecordWriterRotateGroup, TestRetain)
+{
+    init_rotate(0, 0, 2);
+
+    for (int i = 0; i < 5; i++)
+    {
+        CHECK_EQUAL(4, record_writer_rotate.write((void *)"abc\n", 4));
+        record_writer_rotate_request();
+        CHECK_EQUAL(0, record_writer_rotate.flush(1));
+    }
+
+    CHECK_EQUAL(2, wait_rotated_files(2));
+}
+
+TEST(RecordWriterRotateGroup, TestOpenFailure)
+{
+    init_rotate(0, 0, 0);
+
+    open_fails = 1;
+    record_writer_rotate_request();
+    CHECK_EQUAL(-1, record_writer_rotate.flush(1));
+    CHECK_EQUAL(-1, record_writer_rotate.write((void *)"abc\n", 4));
+    CHECK_EQUAL(2, open_count);
+}
+
+TEST(RecordWriterRotateGroup, TestWriteDuringRotation)
+{
+    init_rotate(0, 0, 0);
+    CHECK_EQUAL(4, record_writer_rotate.write((void *)"abc\n", 4));
+
+    // The writes go on while the helper thread reopens the file.
+    __atomic_store_n(&open_blocked, 1, __ATOMIC_RELEASE);
+    record_writer_rotate_request();
+    CHECK_EQUAL(4, record_writer_rotate.write((void *)"def\n", 4));
+    CHECK_EQUAL(0, record_writer_rotate.flush(0));
+    CHECK_EQUAL(4, record_writer_rotate.write((void *)"ghi\n", 4));
+    __atomic_store_n(&open_blocked, 0, __ATOMIC_RELEASE);
+
+    CHECK_EQUAL(0, record_writer_rotate.flush(1));
+    CHECK_EQUAL(2, open_count);
+    CHECK_EQUAL(4, record_writer_rotate.write((void *)"jkl\n", 4));
+    record_writer_rotate.close();
+
+    char paths[16][PATH_MAX];
+    CHECK_EQUAL(1, list_rotated_files(paths, 16));
+
+    char data[256];
+    read_file(paths[0], data, sizeof(data));
+    STRCMP_EQUAL("header\nabc\n", data);
+    read_file(test_file_path, data, sizeof(data));
+    STRCMP_EQUAL("header\ndef\nghi\njkl\n", data);
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
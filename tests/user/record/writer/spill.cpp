@@ -0,0 +1,388 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+extern "C" {
+    #include "user/types.h"
+    #include "user/record/writer/writer.h"
+    #include "user/record/writer/spill.h"
+
+    #include "capture.h"
+
+    extern const struct record_writer record_writer_spill;
+}
+
+static const char *test_dir = "/tmp/ameba_test_record_writer_spill";
+
+// 4032 bytes of records per segment i.e. 237 records of 'RECORD_LEN' bytes.
+static const size_t test_segment_size = 4096;
+static const int RECORD_LEN = 13;
+// 10 records of 'RECORD_LEN' bytes (24 bytes each in the queue).
+static const size_t test_queue_size = 256;
+static const int QUEUED_RECORDS = 10;
+
+static void init_spill(int segments, unsigned int format, size_t queue_size = test_queue_size)
+{
+    struct spill_writer_args args;
+    memset(&args, 0, sizeof(args));
+    args.writer = &record_writer_capture;
+    args.stop_writer = stop_capture;
+    strcpy(args.spill.dir, test_dir);
+    args.spill.segment_size = test_segment_size;
+    args.spill.max_size = test_segment_size * segments;
+    args.format = format;
+    args.queue_size = queue_size;
+    CHECK_EQUAL(0, record_writer_spill.set_init_args(&args, sizeof(args)));
+    CHECK_EQUAL(0, record_writer_spill.init());
+}
+
+/*
+    Write the records numbered [first, first + count) i.e. 'record 00000\n'.
+*/
+static void write_records(int first, int count)
+{
+    char record[32];
+    for (int i = first; i < first + count; i++)
+    {
+        snprintf(record, sizeof(record), "record %05d\n", i);
+        CHECK_EQUAL(RECORD_LEN, record_writer_spill.write(record, RECORD_LEN));
+    }
+}
+
+/*
+    Wait up to 2s for 'len' bytes to be captured.
+*/
+static void wait_captured(size_t len)
+{
+    for (int i = 0; i < 2000 && __atomic_load_n(&captured_len, __ATOMIC_SEQ_CST) < len; i++)
+        usleep(1000);
+    CHECK_EQUAL(len, __atomic_load_n(&captured_len, __ATOMIC_SEQ_CST));
+}
+
+static int captured_record(size_t i)
+{
+    return atoi(&captured[i * RECORD_LEN + 7]);
+}
+
+/*
+    Check the captured records are numbered [first, first + count).
+*/
+static void check_captured(int first, int count)
+{
+    CHECK_EQUAL((size_t)count * RECORD_LEN, captured_len);
+    for (int i = 0; i < count; i++)
+        CHECK_EQUAL(first + i, captured_record(i));
+}
+
+/*
+    Flip a byte of the records of every segment file.
+*/
+static void corrupt_segments()
+{
+    DIR *d = opendir(test_dir);
+    CHECK(d != NULL);
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL)
+    {
+        if (e->d_name[0] == '.')
+            continue;
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", test_dir, e->d_name);
+        int fd = open(path, O_RDWR);
+        CHECK(fd >= 0);
+        char c;
+        CHECK_EQUAL(1, pread(fd, &c, 1, SPILL_WRITER_SEGMENT_HEADER_SIZE + 100));
+        c ^= 0x20;
+        CHECK_EQUAL(1, pwrite(fd, &c, 1, SPILL_WRITER_SEGMENT_HEADER_SIZE + 100));
+        close(fd);
+    }
+    closedir(d);
+}
+
+TEST_GROUP(RecordWriterSpillGroup)
+{
+    void setup()
+    {
+        reset_capture();
+        mkdir(test_dir, 0700);
+    }
+
+    void teardown()
+    {
+        __atomic_store_n(&capture_blocked, 0, __ATOMIC_SEQ_CST);
+        record_writer_spill.close();
+
+        DIR *d = opendir(test_dir);
+        if (d)
+        {
+            char path[PATH_MAX];
+            struct dirent *e;
+            while ((e = readdir(d)) != NULL)
+            {
+                if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0)
+                    continue;
+                snprintf(path, sizeof(path), "%s/%s", test_dir, e->d_name);
+                unlink(path);
+            }
+            closedir(d);
+        }
+        rmdir(test_dir);
+    }
+};
+
+TEST(RecordWriterSpillGroup, TestNotInitialized)
+{
+    char data[] = "x";
+    CHECK_EQUAL(-2, record_writer_spill.write(data, 1));
+    CHECK_EQUAL(-2, record_writer_spill.flush(1));
+}
+
+TEST(RecordWriterSpillGroup, TestInvalidInitArgs)
+{
+    struct spill_writer_args args;
+    memset(&args, 0, sizeof(args));
+    strcpy(args.spill.dir, test_dir);
+    args.spill.segment_size = test_segment_size;
+    args.spill.max_size = test_segment_size * 4;
+    CHECK_EQUAL(-1, record_writer_spill.set_init_args(&args, sizeof(args)));
+
+    args.writer = &record_writer_capture;
+    args.spill.max_size = test_segment_size;
+    CHECK_EQUAL(-1, record_writer_spill.set_init_args(&args, sizeof(args)));
+
+    args.spill.max_size = test_segment_size * 4;
+    args.spill.segment_size = SPILL_WRITER_SEGMENT_HEADER_SIZE;
+    CHECK_EQUAL(-1, record_writer_spill.set_init_args(&args, sizeof(args)));
+
+    args.spill.segment_size = test_segment_size;
+    args.queue_size = 100;
+    CHECK_EQUAL(-1, record_writer_spill.set_init_args(&args, sizeof(args)));
+
+    args.queue_size = 32;
+    CHECK_EQUAL(-1, record_writer_spill.set_init_args(&args, sizeof(args)));
+
+    args.queue_size = 0;
+    strcpy(args.spill.dir, "spill");
+    CHECK_EQUAL(-1, record_writer_spill.set_init_args(&args, sizeof(args)));
+    CHECK_EQUAL(-1, record_writer_spill.set_init_args(&args, sizeof(args) - 1));
+}
+
+TEST(RecordWriterSpillGroup, TestNotSpilledWhileKeepingUp)
+{
+    init_spill(64, 1, 0);
+    write_records(0, 1000);
+    CHECK_EQUAL(0, record_writer_spill.flush(1));
+    wait_captured(1000 * RECORD_LEN);
+    check_captured(0, 1000);
+
+    // Everything went through the queue.
+    struct output_spill_stats stats;
+    record_writer_spill_get_stats(&stats);
+    CHECK_EQUAL(0, stats.spill_segments);
+    CHECK_EQUAL(0, stats.replayed_bytes);
+    CHECK_EQUAL(0, stats.spill_bytes);
+    CHECK_EQUAL(0, stats.dropped_records);
+
+    record_writer_spill.close();
+    CHECK_EQUAL(1, captured_closed);
+}
+
+TEST(RecordWriterSpillGroup, TestReplayInOrder)
+{
+    init_spill(64, 1);
+    capture_blocked = 1;
+    write_records(0, 1000);
+
+    __atomic_store_n(&capture_blocked, 0, __ATOMIC_SEQ_CST);
+    CHECK_EQUAL(0, record_writer_spill.flush(1));
+    wait_captured(1000 * RECORD_LEN);
+    check_captured(0, 1000);
+
+    // Only the records that did not fit in the queue were spilled.
+    struct output_spill_stats stats;
+    record_writer_spill_get_stats(&stats);
+    CHECK_EQUAL((1000UL - QUEUED_RECORDS) * RECORD_LEN, stats.replayed_bytes);
+    CHECK_EQUAL(0, stats.spill_bytes);
+    CHECK_EQUAL(0, stats.dropped_records);
+}
+
+TEST(RecordWriterSpillGroup, TestQueueAfterReplay)
+{
+    init_spill(64, 1);
+    capture_blocked = 1;
+    write_records(0, 300);
+    __atomic_store_n(&capture_blocked, 0, __ATOMIC_SEQ_CST);
+    wait_captured(300 * RECORD_LEN);
+    struct output_spill_stats stats;
+    for (int i = 0; i < 2000; i++)
+    {
+        record_writer_spill_get_stats(&stats);
+        if (stats.spill_bytes == 0)
+            break;
+        usleep(1000);
+    }
+    CHECK_EQUAL(0, stats.spill_bytes);
+
+    // Once the spilled records are replayed, records go through the queue again.
+    for (int i = 300; i < 310; i++)
+    {
+        write_records(i, 1);
+        wait_captured((i + 1) * RECORD_LEN);
+    }
+    check_captured(0, 310);
+
+    record_writer_spill_get_stats(&stats);
+    CHECK_EQUAL((300UL - QUEUED_RECORDS) * RECORD_LEN, stats.replayed_bytes);
+}
+
+TEST(RecordWriterSpillGroup, TestWrappedWriterBlocked)
+{
+    init_spill(64, 1);
+    capture_blocked = 1;
+
+    // Written while the wrapped writer waits for its output.
+    write_records(0, 2000);
+
+    struct output_spill_stats stats;
+    record_writer_spill_get_stats(&stats);
+    CHECK_EQUAL(0, captured_len);
+    CHECK_EQUAL((2000UL - QUEUED_RECORDS) * RECORD_LEN, stats.spill_bytes);
+    CHECK_EQUAL(9, stats.spill_segments);
+
+    __atomic_store_n(&capture_blocked, 0, __ATOMIC_SEQ_CST);
+    wait_captured(2000 * RECORD_LEN);
+    check_captured(0, 2000);
+}
+
+TEST(RecordWriterSpillGroup, TestDiskBound)
+{
+    init_spill(4, 1);
+    capture_blocked = 1;
+    write_records(0, 2000);
+
+    // The oldest segments but the first one are dropped.
+    struct output_spill_stats stats;
+    record_writer_spill_get_stats(&stats);
+    CHECK_EQUAL(4, stats.spill_segments);
+    CHECK(stats.dropped_records > 0);
+    CHECK_EQUAL(stats.dropped_records * RECORD_LEN, stats.dropped_bytes);
+
+    __atomic_store_n(&capture_blocked, 0, __ATOMIC_SEQ_CST);
+    wait_captured((2000 - stats.dropped_records) * RECORD_LEN);
+
+    size_t count = captured_len / RECORD_LEN;
+    CHECK_EQUAL(0, captured_record(0));
+    CHECK_EQUAL(1999, captured_record(count - 1));
+    for (size_t i = 1; i < count; i++)
+        CHECK(captured_record(i) > captured_record(i - 1));
+}
+
+TEST(RecordWriterSpillGroup, TestReplayAfterClose)
+{
+    init_spill(8, 1);
+    capture_blocked = 1;
+    write_records(0, 300);
+
+    // The record being written when the writer is stopped is lost. The records
+    // left in the queue are spilled to a third segment, replayed first.
+    record_writer_spill.close();
+    CHECK_EQUAL(0, captured_len);
+
+    reset_capture();
+    init_spill(8, 1);
+    write_records(300, 10);
+    record_writer_spill.flush(1);
+    wait_captured(309 * RECORD_LEN);
+    check_captured(1, 309);
+
+    struct output_spill_stats stats;
+    record_writer_spill_get_stats(&stats);
+    CHECK_EQUAL(3, stats.recovered_segments);
+    CHECK_EQUAL(0, stats.discarded_segments);
+}
+
+TEST(RecordWriterSpillGroup, TestCorruptSegmentDiscarded)
+{
+    init_spill(8, 1);
+    capture_blocked = 1;
+    write_records(0, 300);
+    record_writer_spill.close();
+
+    corrupt_segments();
+    reset_capture();
+    init_spill(8, 1);
+
+    struct output_spill_stats stats;
+    record_writer_spill_get_stats(&stats);
+    CHECK_EQUAL(0, stats.recovered_segments);
+    CHECK_EQUAL(3, stats.discarded_segments);
+    CHECK_EQUAL(0, stats.spill_bytes);
+
+    write_records(0, 1);
+    record_writer_spill.flush(1);
+    wait_captured(RECORD_LEN);
+}
+
+TEST(RecordWriterSpillGroup, TestOtherFormatDiscarded)
+{
+    init_spill(8, 1);
+    capture_blocked = 1;
+    write_records(0, 300);
+    record_writer_spill.close();
+
+    reset_capture();
+    init_spill(8, 2);
+
+    struct output_spill_stats stats;
+    record_writer_spill_get_stats(&stats);
+    CHECK_EQUAL(0, stats.recovered_segments);
+    CHECK_EQUAL(3, stats.discarded_segments);
+}
+
+TEST(RecordWriterSpillGroup, TestWrappedWriterFails)
+{
+    init_spill(8, 1);
+    capture_fails = 1;
+
+    // The failure is reported by a later write or flush.
+    int failed = 0;
+    for (int i = 0; i < 2000 && !failed; i++)
+    {
+        char record[] = "x";
+        failed = record_writer_spill.write(record, 1) == -1 || record_writer_spill.flush(0) == -1;
+        usleep(1000);
+    }
+    CHECK_EQUAL(1, failed);
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
@@ -0,0 +1,338 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+extern "C" {
+    #include "user/types.h"
+    #include "user/record/writer/writer.h"
+    #include "user/record/writer/tcp.h"
+
+    extern const struct record_writer record_writer_tcp;
+}
+
+/*
+    The collector the writer connects to.
+*/
+static int listener_fd = -1;
+static int listener_port = 0;
+
+static void open_listener(int port)
+{
+    listener_fd = socket(AF_INET, SOCK_STREAM, 0);
+    CHECK(listener_fd >= 0);
+
+    int one = 1;
+    setsockopt(listener_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    CHECK_EQUAL(0, bind(listener_fd, (struct sockaddr *)&addr, sizeof(addr)));
+    CHECK_EQUAL(0, listen(listener_fd, 4));
+
+    socklen_t addr_len = sizeof(addr);
+    CHECK_EQUAL(0, getsockname(listener_fd, (struct sockaddr *)&addr, &addr_len));
+    listener_port = ntohs(addr.sin_port);
+}
+
+static void close_listener()
+{
+    if (listener_fd >= 0)
+        close(listener_fd);
+    listener_fd = -1;
+}
+
+static void init_tcp(enum output_spool_policy policy, size_t spool_size, const char *header)
+{
+    struct tcp_writer_args args;
+    memset(&args, 0, sizeof(args));
+    args.output.ip_family = AF_INET;
+    strcpy(args.output.ip, "127.0.0.1");
+    args.output.port = listener_port;
+    args.output.spool_size = spool_size;
+    args.output.spool_policy = policy;
+    args.output.flush_interval_ms = 0;
+    args.output.reconnect_min_ms = 10;
+    args.output.reconnect_max_ms = 20;
+    args.header_len = strlen(header);
+    memcpy(args.header, header, args.header_len);
+    CHECK_EQUAL(0, record_writer_tcp.set_init_args(&args, sizeof(args)));
+    CHECK_EQUAL(0, record_writer_tcp.init());
+}
+
+/*
+    Write 'count' numbered records of 10 bytes i.e. 'record 00\n'.
+*/
+static void write_records(int first, int count)
+{
+    char record[] = "record 00\n";
+    for (int i = first; i < first + count; i++)
+    {
+        record[7] = '0' + i / 10;
+        record[8] = '0' + i % 10;
+        CHECK_EQUAL(10, record_writer_tcp.write(record, 10));
+    }
+}
+
+/*
+    Flush until 'bytes_sent' reaches 'expected', for up to 2s.
+*/
+static void flush_until_sent(unsigned long expected)
+{
+    struct output_spool_stats stats;
+    for (int i = 0; i < 200; i++)
+    {
+        CHECK(record_writer_tcp.flush(1) >= 0);
+        record_writer_tcp_get_stats(&stats);
+        if (stats.bytes_sent >= expected)
+            break;
+        usleep(10 * 1000);
+    }
+    CHECK_EQUAL(expected, stats.bytes_sent);
+}
+
+/*
+    Accept the next connection of the writer and read 'len' bytes from it.
+
+    Return:
+        The connection
+*/
+static int accept_and_read(char *dst, size_t len)
+{
+    int conn_fd = accept(listener_fd, NULL, NULL);
+    CHECK(conn_fd >= 0);
+
+    size_t got = 0;
+    while (got < len)
+    {
+        struct pollfd p = { .fd = conn_fd, .events = POLLIN, .revents = 0 };
+        CHECK_EQUAL(1, poll(&p, 1, 2000));
+        ssize_t n = recv(conn_fd, dst + got, len - got, 0);
+        CHECK(n > 0);
+        got += (size_t)n;
+    }
+    return conn_fd;
+}
+
+TEST_GROUP(RecordWriterTcpGroup)
+{
+    void setup()
+    {
+        open_listener(0);
+    }
+
+    void teardown()
+    {
+        record_writer_tcp.close();
+        close_listener();
+    }
+};
+
+TEST(RecordWriterTcpGroup, TestNotInitialized)
+{
+    char data[] = "x";
+    CHECK_EQUAL(-2, record_writer_tcp.write(data, 1));
+    CHECK_EQUAL(-2, record_writer_tcp.flush(1));
+}
+
+TEST(RecordWriterTcpGroup, TestInvalidInitArgs)
+{
+    struct tcp_writer_args args;
+    memset(&args, 0, sizeof(args));
+    args.output.ip_family = AF_INET;
+    strcpy(args.output.ip, "127.0.0.1");
+    args.output.port = listener_port;
+    args.output.spool_size = 1024;
+    args.output.spool_policy = OUTPUT_SPOOL_POLICY_BLOCK;
+    args.output.reconnect_min_ms = 100;
+    args.output.reconnect_max_ms = 50;
+    CHECK_EQUAL(-1, record_writer_tcp.set_init_args(&args, sizeof(args)));
+
+    args.output.reconnect_max_ms = 100;
+    args.output.spool_policy = (enum output_spool_policy)0;
+    CHECK_EQUAL(-1, record_writer_tcp.set_init_args(&args, sizeof(args)));
+
+    args.output.spool_policy = OUTPUT_SPOOL_POLICY_BLOCK;
+    strcpy(args.output.ip, "not an ip");
+    CHECK_EQUAL(-1, record_writer_tcp.set_init_args(&args, sizeof(args)));
+    CHECK_EQUAL(-1, record_writer_tcp.set_init_args(&args, sizeof(args) - 1));
+}
+
+TEST(RecordWriterTcpGroup, TestSendWithHeader)
+{
+    init_tcp(OUTPUT_SPOOL_POLICY_BLOCK, 1024, "HDR\n");
+    write_records(0, 3);
+    flush_until_sent(34);
+
+    char buf[64];
+    int conn_fd = accept_and_read(buf, 34);
+    STRNCMP_EQUAL("HDR\nrecord 00\nrecord 01\nrecord 02\n", buf, 34);
+    close(conn_fd);
+
+    struct output_spool_stats stats;
+    record_writer_tcp_get_stats(&stats);
+    CHECK_EQUAL(1, stats.connects);
+    CHECK_EQUAL(0, stats.spool_records);
+    CHECK_EQUAL(0, stats.spool_bytes);
+    CHECK_EQUAL(0, stats.dropped_records);
+}
+
+TEST(RecordWriterTcpGroup, TestSentOnClose)
+{
+    init_tcp(OUTPUT_SPOOL_POLICY_BLOCK, 1024, "");
+    write_records(0, 5);
+    record_writer_tcp.close();
+
+    char buf[64];
+    int conn_fd = accept_and_read(buf, 50);
+    STRNCMP_EQUAL("record 00\n", buf, 10);
+    STRNCMP_EQUAL("record 04\n", buf + 40, 10);
+    close(conn_fd);
+}
+
+TEST(RecordWriterTcpGroup, TestSpoolUntilReconnect)
+{
+    // Nothing listens on the port for now.
+    int port = listener_port;
+    close_listener();
+    init_tcp(OUTPUT_SPOOL_POLICY_BLOCK, 1024, "HDR\n");
+
+    write_records(0, 2);
+    CHECK_EQUAL(0, record_writer_tcp.flush(1));
+
+    struct output_spool_stats stats;
+    record_writer_tcp_get_stats(&stats);
+    CHECK_EQUAL(0, stats.connects);
+    CHECK(stats.disconnects >= 1);
+    CHECK_EQUAL(2, stats.spool_records);
+    CHECK_EQUAL(20, stats.spool_bytes);
+
+    // The collector comes up.
+    open_listener(port);
+    flush_until_sent(24);
+
+    char buf[64];
+    int conn_fd = accept_and_read(buf, 24);
+    STRNCMP_EQUAL("HDR\nrecord 00\nrecord 01\n", buf, 24);
+
+    // The collector goes away, and the header starts the next connection.
+    close(conn_fd);
+    for (int i = 0; i < 200; i++)
+    {
+        write_records(2, 1);
+        record_writer_tcp.flush(1);
+        record_writer_tcp_get_stats(&stats);
+        if (stats.connects == 2)
+            break;
+        usleep(10 * 1000);
+    }
+    CHECK_EQUAL(2, stats.connects);
+
+    conn_fd = accept_and_read(buf, 4);
+    STRNCMP_EQUAL("HDR\n", buf, 4);
+    close(conn_fd);
+}
+
+TEST(RecordWriterTcpGroup, TestDropNewest)
+{
+    close_listener();
+    // 4 records of 10 bytes fit, each with its 4-byte length.
+    init_tcp(OUTPUT_SPOOL_POLICY_DROP_NEWEST, 64, "");
+    write_records(0, 5);
+
+    struct output_spool_stats stats;
+    record_writer_tcp_get_stats(&stats);
+    CHECK_EQUAL(4, stats.spool_records);
+    CHECK_EQUAL(40, stats.spool_bytes);
+    CHECK_EQUAL(1, stats.dropped_records);
+    CHECK_EQUAL(10, stats.dropped_bytes);
+
+    // A record larger than the spool is dropped whatever the policy.
+    char large[128];
+    memset(large, 'x', sizeof(large));
+    CHECK_EQUAL(128, record_writer_tcp.write(large, sizeof(large)));
+    record_writer_tcp_get_stats(&stats);
+    CHECK_EQUAL(2, stats.dropped_records);
+    CHECK_EQUAL(138, stats.dropped_bytes);
+}
+
+TEST(RecordWriterTcpGroup, TestDropOldest)
+{
+    int port = listener_port;
+    close_listener();
+    init_tcp(OUTPUT_SPOOL_POLICY_DROP_OLDEST, 64, "");
+    write_records(0, 6);
+
+    struct output_spool_stats stats;
+    record_writer_tcp_get_stats(&stats);
+    CHECK_EQUAL(4, stats.spool_records);
+    CHECK_EQUAL(2, stats.dropped_records);
+    CHECK_EQUAL(20, stats.dropped_bytes);
+
+    // The newest records are delivered.
+    open_listener(port);
+    flush_until_sent(40);
+
+    char buf[64];
+    int conn_fd = accept_and_read(buf, 40);
+    STRNCMP_EQUAL("record 02\n", buf, 10);
+    STRNCMP_EQUAL("record 05\n", buf + 30, 10);
+    close(conn_fd);
+}
+
+TEST(RecordWriterTcpGroup, TestStopBlocking)
+{
+    close_listener();
+    init_tcp(OUTPUT_SPOOL_POLICY_BLOCK, 64, "");
+    write_records(0, 4);
+
+    // The spool is full, so the next write would wait for the collector.
+    record_writer_tcp_stop_blocking();
+    write_records(4, 1);
+
+    struct output_spool_stats stats;
+    record_writer_tcp_get_stats(&stats);
+    CHECK_EQUAL(4, stats.spool_records);
+    CHECK_EQUAL(1, stats.dropped_records);
+
+    // What cannot be sent on close is counted as dropped.
+    record_writer_tcp.close();
+    record_writer_tcp_get_stats(&stats);
+    CHECK_EQUAL(0, stats.spool_records);
+    CHECK_EQUAL(5, stats.dropped_records);
+    CHECK_EQUAL(50, stats.dropped_bytes);
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
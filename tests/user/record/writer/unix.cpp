@@ -0,0 +1,280 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+extern "C" {
+    #include "user/types.h"
+    #include "user/record/writer/writer.h"
+    #include "user/record/writer/unix.h"
+
+    extern const struct record_writer record_writer_unix;
+}
+
+/*
+    The socket the writer connects to, and the accepted connection.
+*/
+static char dir[] = "/tmp/ameba-unix-XXXXXX";
+static char path[128];
+static int listen_fd = -1;
+static int consumer_fd = -1;
+
+static void open_listener()
+{
+    CHECK(mkdtemp(dir) != NULL);
+    snprintf(path, sizeof(path), "%s/sock", dir);
+
+    listen_fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    CHECK(listen_fd >= 0);
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    CHECK_EQUAL(0, bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)));
+    CHECK_EQUAL(0, listen(listen_fd, 4));
+}
+
+static void close_listener()
+{
+    if (consumer_fd >= 0)
+        close(consumer_fd);
+    if (listen_fd >= 0)
+        close(listen_fd);
+    consumer_fd = -1;
+    listen_fd = -1;
+    unlink(path);
+    rmdir(dir);
+    strcpy(dir, "/tmp/ameba-unix-XXXXXX");
+}
+
+static void init_unix(size_t message_size, long flush_interval_ms, const char *header = "")
+{
+    struct unix_writer_args args;
+    memset(&args, 0, sizeof(args));
+    strcpy(args.output.path, path);
+    args.output.message_size = message_size;
+    args.output.flush_interval_ms = flush_interval_ms;
+    args.header_len = strlen(header);
+    memcpy(args.header, header, args.header_len);
+    CHECK_EQUAL(0, record_writer_unix.set_init_args(&args, sizeof(args)));
+    CHECK_EQUAL(0, record_writer_unix.init());
+
+    consumer_fd = accept(listen_fd, NULL, NULL);
+    CHECK(consumer_fd >= 0);
+}
+
+/*
+    Receive the next message without waiting.
+
+    Return:
+        -1  => No message
+        >=0 => The message size
+*/
+static int receive(char *dst, size_t dst_len)
+{
+    ssize_t len = recv(consumer_fd, dst, dst_len, MSG_DONTWAIT);
+    return (int)len;
+}
+
+/*
+    Write 'count' numbered records of 10 bytes i.e. 'record 00\n'.
+*/
+static void write_records(int count)
+{
+    char record[] = "record 00\n";
+    for (int i = 0; i < count; i++)
+    {
+        record[7] = '0' + i / 10;
+        record[8] = '0' + i % 10;
+        CHECK_EQUAL(10, record_writer_unix.write(record, 10));
+    }
+}
+
+TEST_GROUP(RecordWriterUnixGroup)
+{
+    void setup()
+    {
+        open_listener();
+    }
+
+    void teardown()
+    {
+        record_writer_unix.close();
+        close_listener();
+    }
+};
+
+TEST(RecordWriterUnixGroup, TestNotInitialized)
+{
+    char data[] = "x";
+    CHECK_EQUAL(-2, record_writer_unix.write(data, 1));
+    CHECK_EQUAL(-2, record_writer_unix.flush(1));
+}
+
+TEST(RecordWriterUnixGroup, TestInvalidInitArgs)
+{
+    struct unix_writer_args args;
+    memset(&args, 0, sizeof(args));
+    strcpy(args.output.path, "relative/sock");
+    CHECK_EQUAL(-1, record_writer_unix.set_init_args(&args, sizeof(args)));
+    strcpy(args.output.path, path);
+    CHECK_EQUAL(-1, record_writer_unix.set_init_args(&args, sizeof(args) - 1));
+    args.header_len = sizeof(args.header) + 1;
+    CHECK_EQUAL(-1, record_writer_unix.set_init_args(&args, sizeof(args)));
+}
+
+TEST(RecordWriterUnixGroup, TestNoConsumer)
+{
+    struct unix_writer_args args;
+    memset(&args, 0, sizeof(args));
+    snprintf(args.output.path, sizeof(args.output.path), "%s/missing", dir);
+    CHECK_EQUAL(0, record_writer_unix.set_init_args(&args, sizeof(args)));
+    CHECK_EQUAL(-1, record_writer_unix.init());
+}
+
+TEST(RecordWriterUnixGroup, TestMessagePerRecord)
+{
+    init_unix(0, 0);
+    write_records(3);
+
+    char buf[2048];
+    CHECK_EQUAL(10, receive(buf, sizeof(buf)));
+    STRNCMP_EQUAL("record 00\n", buf, 10);
+    CHECK_EQUAL(10, receive(buf, sizeof(buf)));
+    CHECK_EQUAL(10, receive(buf, sizeof(buf)));
+    CHECK_EQUAL(-1, receive(buf, sizeof(buf)));
+}
+
+TEST(RecordWriterUnixGroup, TestPacked)
+{
+    // 3 records per message.
+    init_unix(35, 0);
+    write_records(3);
+
+    // Not sent until the message is full or flushed.
+    char buf[2048];
+    CHECK_EQUAL(-1, receive(buf, sizeof(buf)));
+
+    write_records(1);
+    CHECK_EQUAL(30, receive(buf, sizeof(buf)));
+    STRNCMP_EQUAL("record 00\nrecord 01\nrecord 02\n", buf, 30);
+    CHECK_EQUAL(-1, receive(buf, sizeof(buf)));
+
+    CHECK_EQUAL(10, record_writer_unix.flush(1));
+    CHECK_EQUAL(10, receive(buf, sizeof(buf)));
+    CHECK_EQUAL(0, record_writer_unix.flush(1));
+}
+
+TEST(RecordWriterUnixGroup, TestLargeRecord)
+{
+    init_unix(20, 0);
+    write_records(1);
+
+    char large[64];
+    memset(large, 'x', sizeof(large));
+    CHECK_EQUAL(64, record_writer_unix.write(large, sizeof(large)));
+
+    // The packed records are sent before the large record.
+    char buf[2048];
+    CHECK_EQUAL(10, receive(buf, sizeof(buf)));
+    CHECK_EQUAL(64, receive(buf, sizeof(buf)));
+    CHECK_EQUAL(-1, receive(buf, sizeof(buf)));
+}
+
+TEST(RecordWriterUnixGroup, TestFlushOnAge)
+{
+    init_unix(4096, 20);
+    write_records(5);
+
+    char buf[2048];
+    CHECK_EQUAL(0, record_writer_unix.flush(0));
+    CHECK_EQUAL(-1, receive(buf, sizeof(buf)));
+
+    usleep(30 * 1000);
+    CHECK_EQUAL(50, record_writer_unix.flush(0));
+    CHECK_EQUAL(50, receive(buf, sizeof(buf)));
+}
+
+TEST(RecordWriterUnixGroup, TestSentOnClose)
+{
+    init_unix(4096, 0);
+    write_records(50);
+    record_writer_unix.close();
+
+    char buf[2048];
+    CHECK_EQUAL(500, receive(buf, sizeof(buf)));
+    CHECK_EQUAL(0, receive(buf, sizeof(buf)));
+}
+
+TEST(RecordWriterUnixGroup, TestConsumerGone)
+{
+    init_unix(0, 0);
+    close(consumer_fd);
+    consumer_fd = -1;
+
+    // Fails without a signal, and is not reconnected right away.
+    char data[] = "x";
+    CHECK_EQUAL(-1, record_writer_unix.write(data, 1));
+    CHECK_EQUAL(-1, record_writer_unix.write(data, 1));
+
+    struct pollfd pfd = { .fd = listen_fd, .events = POLLIN, .revents = 0 };
+    CHECK_EQUAL(0, poll(&pfd, 1, 0));
+}
+
+TEST(RecordWriterUnixGroup, TestHeaderOnEveryConnection)
+{
+    init_unix(0, 0, "HDR\n");
+    write_records(1);
+
+    char buf[2048];
+    CHECK_EQUAL(4, receive(buf, sizeof(buf)));
+    STRNCMP_EQUAL("HDR\n", buf, 4);
+    CHECK_EQUAL(10, receive(buf, sizeof(buf)));
+
+    close(consumer_fd);
+    consumer_fd = -1;
+    char data[] = "x";
+    CHECK_EQUAL(-1, record_writer_unix.write(data, 1));
+
+    // The next consumer is sent the header first too.
+    usleep(1100 * 1000);
+    write_records(1);
+    consumer_fd = accept(listen_fd, NULL, NULL);
+    CHECK(consumer_fd >= 0);
+    CHECK_EQUAL(4, receive(buf, sizeof(buf)));
+    STRNCMP_EQUAL("HDR\n", buf, 4);
+    CHECK_EQUAL(10, receive(buf, sizeof(buf)));
+    STRNCMP_EQUAL("record 00\n", buf, 10);
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
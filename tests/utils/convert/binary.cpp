@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <string.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+extern "C" {
+    #include "common/types.h"
+    #include "utils/convert/convert.h"
+}
+
+static void init_common(struct elem_common *e_common, record_type_t record_type)
+{
+    e_common->magic = AMEBA_MAGIC;
+    e_common->record_type = record_type;
+    e_common->version.major = RECORD_VERSION_MAJOR;
+    e_common->version.minor = RECORD_VERSION_MINOR;
+    e_common->version.patch = RECORD_VERSION_PATCH;
+#ifdef INCLUDE_TASK_CTX_ID
+    e_common->task_ctx_id = 77;
+#endif
+}
+
+static void init_sockaddr_in(struct elem_sockaddr *e_sa, const char *ip, int port)
+{
+    struct sockaddr_in *sa_in = (struct sockaddr_in *)&(e_sa->addr[0]);
+    sa_in->sin_family = AF_INET;
+    sa_in->sin_port = htons(port);
+    inet_pton(AF_INET, ip, &(sa_in->sin_addr));
+    e_sa->addrlen = sizeof(struct sockaddr_in);
+    e_sa->byte_order = BYTE_ORDER_NETWORK;
+}
+
+/*
+    Write the sockaddr in compact form to 'dst'.
+
+    Return:
+        The size written.
+*/
+static size_t write_compact_sockaddr(unsigned char *dst, struct elem_sockaddr *e_sa)
+{
+    struct elem_sockaddr_compact header;
+    header.family = ((struct sockaddr *)&(e_sa->addr[0]))->sa_family;
+    header.byte_order = e_sa->byte_order;
+    header.addrlen = e_sa->addrlen;
+    memcpy(dst, &header, sizeof(header));
+    memcpy(dst + sizeof(header), &(e_sa->addr[0]), e_sa->addrlen);
+    return sizeof(header) + e_sa->addrlen;
+}
+
+TEST_GROUP(ConvertBinaryGroup)
+{
+    struct convert_record r;
+};
+
+TEST(ConvertBinaryGroup, TestParseAuditLogExit)
+{
+    struct record_audit_log_exit ale;
+    memset(&ale, 0, sizeof(ale));
+    init_common(&(ale.e_common), RECORD_TYPE_AUDIT_LOG_EXIT);
+    ale.pid = 5;
+    ale.syscall_number = 42;
+    ale.ret = -2;
+    ale.e_las_ts.event_id = 1234;
+    ale.e_las_ts.tv_sec = 1700000000;
+    ale.e_las_ts.tv_nsec = 250000000;
+
+    // Records in a stream are not aligned.
+    unsigned char buf[sizeof(ale) + 1];
+    memcpy(&buf[1], &ale, sizeof(ale));
+    CHECK_EQUAL(1, convert_binary_parse(&buf[1], sizeof(ale), &r));
+
+    CHECK_EQUAL(RECORD_TYPE_AUDIT_LOG_EXIT, r.record_type);
+#ifdef INCLUDE_TASK_CTX_ID
+    CHECK_EQUAL(77, r.task_ctx_id);
+#endif
+    CHECK_EQUAL(5, r.pid);
+    CHECK_EQUAL(42, r.syscall_number);
+    CHECK_EQUAL(-2, r.exit);
+    CHECK_EQUAL(1234, r.las_event_id);
+    CHECK_EQUAL(1700000000LL, r.las_sec);
+    CHECK_EQUAL(250, r.las_msec);
+}
+
+TEST(ConvertBinaryGroup, TestParseCompactConnect)
+{
+    struct record_connect connect;
+    memset(&connect, 0, sizeof(connect));
+    init_common(&(connect.e_common), RECORD_TYPE_CONNECT);
+    connect.pid = 100;
+    connect.fd = 3;
+    connect.sock_type = 1;
+    init_sockaddr_in(&(connect.local), "192.168.0.1", 8080);
+    init_sockaddr_in(&(connect.remote), "10.0.0.2", 53);
+
+    unsigned char buf[sizeof(connect)];
+    memcpy(buf, &connect, RECORD_COMPACT_PREFIX_SIZE_CONNECT);
+    size_t len = RECORD_COMPACT_PREFIX_SIZE_CONNECT;
+    len += write_compact_sockaddr(&buf[len], &(connect.local));
+    len += write_compact_sockaddr(&buf[len], &(connect.remote));
+    CHECK(len < sizeof(connect));
+    CHECK_EQUAL(1, convert_binary_parse(buf, len, &r));
+
+    CHECK_EQUAL(RECORD_TYPE_CONNECT, r.record_type);
+    CHECK_EQUAL(100, r.pid);
+    CHECK_EQUAL(3, r.fd);
+    CHECK_EQUAL(1, r.sock_type);
+    CHECK_EQUAL(sizeof(struct sockaddr_in), r.local.len);
+    CHECK_EQUAL(sizeof(struct sockaddr_in), r.local.addr_size);
+    MEMCMP_EQUAL(connect.local.addr, r.local.addr, sizeof(struct sockaddr_in));
+    MEMCMP_EQUAL(connect.remote.addr, r.remote.addr, sizeof(struct sockaddr_in));
+}
+
+TEST(ConvertBinaryGroup, TestSkipped)
+{
+    // Unknown record type.
+    struct record_kill kill;
+    memset(&kill, 0, sizeof(kill));
+    init_common(&(kill.e_common), (record_type_t)15);
+    CHECK_EQUAL(0, convert_binary_parse(&kill, sizeof(kill), &r));
+
+    // Size not of the record type.
+    init_common(&(kill.e_common), RECORD_TYPE_KILL);
+    CHECK_EQUAL(0, convert_binary_parse(&kill, sizeof(kill) - 1, &r));
+    CHECK_EQUAL(1, convert_binary_parse(&kill, sizeof(kill), &r));
+}
+
+TEST(ConvertBinaryGroup, TestInvalid)
+{
+    struct record_kill kill;
+    memset(&kill, 0, sizeof(kill));
+    init_common(&(kill.e_common), RECORD_TYPE_KILL);
+    CHECK_EQUAL(-1, convert_binary_parse(&kill, sizeof(struct elem_common) - 1, &r));
+
+    kill.e_common.magic = 0;
+    CHECK_EQUAL(-1, convert_binary_parse(&kill, sizeof(kill), &r));
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <stdio.h>
+#include <string.h>
+
+extern "C" {
+    #include "utils/convert/convert.h"
+}
+
+static int parse(const char *line, struct convert_record *r)
+{
+    return convert_json_parse(line, strlen(line), r);
+}
+
+TEST_GROUP(ConvertJsonGroup)
+{
+    struct convert_record r;
+};
+
+TEST(ConvertJsonGroup, TestParseConnect)
+{
+    const char *line =
+        "{\"record_type\":4,\"record_version\":{\"major\":2,\"minor\":0,\"patch\":0},\"task_ctx_id\":77,"
+        "\"event_id\":5,\"pid\":100,\"fd\":3,\"ret\":0,\"ns_net\":4026531840,\"sock_type\":1,"
+        "\"local\":{\"sockaddr\":\"02001f90c0a80001\",\"sockaddr_len\":16},"
+        "\"remote\":{\"sockaddr\":\"02000035\",\"sockaddr_len\":16}}";
+    CHECK_EQUAL(0, parse(line, &r));
+
+    CHECK_EQUAL(RECORD_TYPE_CONNECT, r.record_type);
+    CHECK_EQUAL(77, r.task_ctx_id);
+    CHECK_EQUAL(100, r.pid);
+    CHECK_EQUAL(3, r.fd);
+    CHECK_EQUAL(4026531840U, r.ns_net);
+    CHECK_EQUAL(1, r.sock_type);
+
+    CHECK_EQUAL(16, r.local.len);
+    CHECK_EQUAL(8, r.local.addr_size);
+    const unsigned char local[] = { 0x02, 0x00, 0x1f, 0x90, 0xc0, 0xa8, 0x00, 0x01 };
+    MEMCMP_EQUAL(local, r.local.addr, sizeof(local));
+    CHECK_EQUAL(4, r.remote.addr_size);
+    CHECK_EQUAL(0x35, r.remote.addr[3]);
+}
+
+TEST(ConvertJsonGroup, TestParseAuditLogExit)
+{
+    const char *line =
+        "{ \"record_type\": 9, \"task_ctx_id\": 1, \"pid\": 5, \"syscall_number\": 42, \"exit\": -2,"
+        " \"las_audit\": { \"event_id\": 1234, \"time\": 1700000000.25 } }";
+    CHECK_EQUAL(0, parse(line, &r));
+
+    CHECK_EQUAL(RECORD_TYPE_AUDIT_LOG_EXIT, r.record_type);
+    CHECK_EQUAL(5, r.pid);
+    CHECK_EQUAL(42, r.syscall_number);
+    CHECK_EQUAL(-2, r.exit);
+    CHECK_EQUAL(1234, r.las_event_id);
+    CHECK_EQUAL(1700000000LL, r.las_sec);
+    CHECK_EQUAL(250, r.las_msec);
+}
+
+TEST(ConvertJsonGroup, TestParseComm)
+{
+    CHECK_EQUAL(0, parse("{\"record_type\":1,\"task_ctx_id\":1,\"comm\":\"a\\\"b\\\\c\\u0041\"}", &r));
+    STRCMP_EQUAL("a\"b\\cA", r.comm);
+
+    // Truncated to COMM_MAX_SIZE with the NUL.
+    char line[256];
+    char comm[COMM_MAX_SIZE * 2];
+    memset(comm, 'x', sizeof(comm) - 1);
+    comm[sizeof(comm) - 1] = '\0';
+    snprintf(line, sizeof(line), "{\"record_type\":1,\"task_ctx_id\":1,\"comm\":\"%s\"}", comm);
+    CHECK_EQUAL(0, parse(line, &r));
+    CHECK_EQUAL(COMM_MAX_SIZE - 1, strlen(r.comm));
+}
+
+TEST(ConvertJsonGroup, TestUnknownMembersSkipped)
+{
+    const char *line =
+        "{\"record_type\":8,\"extra\":{\"a\":[1,\"x}\",{\"b\":null}],\"c\":true},\"task_ctx_id\":2,"
+        "\"acting_pid\":10,\"sig\":9,\"target_pid\":20}";
+    CHECK_EQUAL(0, parse(line, &r));
+    CHECK_EQUAL(RECORD_TYPE_KILL, r.record_type);
+    CHECK_EQUAL(2, r.task_ctx_id);
+    CHECK_EQUAL(10, r.acting_pid);
+    CHECK_EQUAL(9, r.sig);
+    CHECK_EQUAL(20, r.target_pid);
+}
+
+TEST(ConvertJsonGroup, TestMissingMembers)
+{
+    CHECK_EQUAL(-1, parse("{\"record_type\":8,\"pid\":1}", &r));
+    CHECK_EQUAL(-1, parse("{\"task_ctx_id\":8,\"pid\":1}", &r));
+}
+
+TEST(ConvertJsonGroup, TestInvalid)
+{
+    CHECK_EQUAL(-1, parse("", &r));
+    CHECK_EQUAL(-1, parse("[1,2]", &r));
+    CHECK_EQUAL(-1, parse("{\"record_type\":8,\"task_ctx_id\":1", &r));
+    CHECK_EQUAL(-1, parse("{\"record_type\":\"8\",\"task_ctx_id\":1}", &r));
+    CHECK_EQUAL(-1, parse("{\"record_type\":8,\"task_ctx_id\":1,\"local\":{\"sockaddr\":\"0g\"}}", &r));
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file
@@ -0,0 +1,206 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+AMEBA - A Minimal eBPF-based Audit: an eBPF-based Linux telemetry collection tool.
+Copyright (C) 2025  Hassaan Irshad
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+
+extern "C" {
+    #include "utils/convert/convert.h"
+}
+
+static struct convert_record make_record(int record_type, unsigned long long task_ctx_id, pid_t pid)
+{
+    struct convert_record r;
+    memset(&r, 0, sizeof(r));
+    r.record_type = record_type;
+    r.task_ctx_id = task_ctx_id;
+    r.pid = pid;
+    return r;
+}
+
+static struct convert_record make_audit_log_exit(unsigned long long task_ctx_id, int syscall_number, long exit)
+{
+    struct convert_record r = make_record(RECORD_TYPE_AUDIT_LOG_EXIT, task_ctx_id, 100);
+    r.syscall_number = syscall_number;
+    r.exit = exit;
+    return r;
+}
+
+TEST_GROUP(ConvertWindowGroup)
+{
+    struct convert_window window;
+    struct convert_matches matches;
+
+    void init(int size)
+    {
+        CHECK_EQUAL(0, convert_window_init(&window, size));
+    }
+
+    void add(struct convert_record r)
+    {
+        CHECK_EQUAL(0, convert_window_add(&window, &r, &matches));
+    }
+
+    void setup()
+    {
+        memset(&window, 0, sizeof(window));
+        memset(&matches, 0, sizeof(matches));
+    }
+
+    void teardown()
+    {
+        convert_window_free(&window);
+        free(matches.items);
+    }
+};
+
+TEST(ConvertWindowGroup, TestInvalidSize)
+{
+    CHECK_EQUAL(-1, convert_window_init(&window, 0));
+}
+
+TEST(ConvertWindowGroup, TestMatchAuditLogExitFirst)
+{
+    init(CONVERT_DEFAULT_WINDOW_SIZE);
+    add(make_audit_log_exit(1, __NR_connect, 0));
+    struct convert_record connect = make_record(RECORD_TYPE_CONNECT, 1, 100);
+    connect.fd = 3;
+    add(connect);
+    CHECK_EQUAL(0, matches.len);
+
+    CHECK_EQUAL(0, convert_window_flush(&window, &matches));
+    CHECK_EQUAL(1, matches.len);
+    CHECK_EQUAL(__NR_connect, matches.items[0].ale.syscall_number);
+    CHECK_EQUAL(RECORD_TYPE_CONNECT, matches.items[0].other.record_type);
+    CHECK_EQUAL(3, matches.items[0].other.fd);
+    CHECK_EQUAL(0, window.len);
+}
+
+TEST(ConvertWindowGroup, TestMatchRecordFirst)
+{
+    init(CONVERT_DEFAULT_WINDOW_SIZE);
+    add(make_record(RECORD_TYPE_BIND, 1, 100));
+    add(make_audit_log_exit(1, __NR_bind, 0));
+
+    CHECK_EQUAL(0, convert_window_flush(&window, &matches));
+    CHECK_EQUAL(1, matches.len);
+    CHECK_EQUAL(RECORD_TYPE_BIND, matches.items[0].other.record_type);
+}
+
+TEST(ConvertWindowGroup, TestNoMatchOtherTask)
+{
+    init(CONVERT_DEFAULT_WINDOW_SIZE);
+    add(make_audit_log_exit(1, __NR_connect, 0));
+    add(make_record(RECORD_TYPE_CONNECT, 2, 100));
+
+    CHECK_EQUAL(0, convert_window_flush(&window, &matches));
+    CHECK_EQUAL(0, matches.len);
+}
+
+TEST(ConvertWindowGroup, TestNoMatchOutsideWindow)
+{
+    // The audit_log_exit record is matched (with nothing) once the window is full.
+    init(2);
+    add(make_audit_log_exit(1, __NR_connect, 0));
+    add(make_record(RECORD_TYPE_KILL, 2, 100));
+    add(make_record(RECORD_TYPE_CONNECT, 1, 100));
+
+    CHECK_EQUAL(0, convert_window_flush(&window, &matches));
+    CHECK_EQUAL(0, matches.len);
+}
+
+TEST(ConvertWindowGroup, TestOtherSyscallRemoved)
+{
+    // The audit_log_exit record of another syscall is removed without a match.
+    init(CONVERT_DEFAULT_WINDOW_SIZE);
+    add(make_record(RECORD_TYPE_CONNECT, 1, 100));
+    add(make_audit_log_exit(1, __NR_kill, 0));
+    add(make_record(RECORD_TYPE_KILL, 1, 100));
+
+    CHECK_EQUAL(0, convert_window_flush(&window, &matches));
+    CHECK_EQUAL(0, matches.len);
+}
+
+TEST(ConvertWindowGroup, TestMatchInOrder)
+{
+    init(CONVERT_DEFAULT_WINDOW_SIZE);
+    add(make_audit_log_exit(1, __NR_sendto, 10));
+    add(make_audit_log_exit(1, __NR_recvfrom, 20));
+    struct convert_record send_recv = make_record(RECORD_TYPE_SEND_RECV, 1, 100);
+    send_recv.fd = 3;
+    add(send_recv);
+    send_recv.fd = 4;
+    add(send_recv);
+
+    CHECK_EQUAL(0, convert_window_flush(&window, &matches));
+    CHECK_EQUAL(2, matches.len);
+    CHECK_EQUAL(10, matches.items[0].ale.exit);
+    CHECK_EQUAL(3, matches.items[0].other.fd);
+    CHECK_EQUAL(20, matches.items[1].ale.exit);
+    CHECK_EQUAL(4, matches.items[1].other.fd);
+}
+
+TEST(ConvertWindowGroup, TestMatchWhenFull)
+{
+    init(2);
+    add(make_audit_log_exit(1, __NR_connect, 0));
+    add(make_record(RECORD_TYPE_CONNECT, 1, 100));
+    CHECK_EQUAL(1, matches.len);
+    CHECK_EQUAL(0, window.len);
+}
+
+TEST(ConvertWindowGroup, TestProcInfo)
+{
+    init(CONVERT_DEFAULT_WINDOW_SIZE);
+    struct convert_record new_process = make_record(RECORD_TYPE_NEW_PROCESS, 1, 100);
+    new_process.ppid = 1;
+    strcpy(new_process.comm, "sh");
+    add(new_process);
+    struct convert_record cred = make_record(RECORD_TYPE_CRED, 1, 100);
+    cred.uid = 1000;
+    cred.egid = 1001;
+    add(cred);
+    add(make_audit_log_exit(2, __NR_connect, 0));
+    add(make_record(RECORD_TYPE_CONNECT, 2, 100));
+    add(make_audit_log_exit(3, __NR_connect, 0));
+    add(make_record(RECORD_TYPE_CONNECT, 3, 200));
+
+    CHECK_EQUAL(0, convert_window_flush(&window, &matches));
+    CHECK_EQUAL(2, matches.len);
+    const struct convert_proc_info *info = &matches.items[0].proc_info;
+    CHECK_EQUAL(1, info->has_new_process);
+    CHECK_EQUAL(1, info->ppid);
+    STRCMP_EQUAL("sh", info->comm);
+    CHECK_EQUAL(1, info->has_cred);
+    CHECK_EQUAL(1000, info->uid);
+    CHECK_EQUAL(1001, info->egid);
+
+    info = &matches.items[1].proc_info;
+    CHECK_EQUAL(0, info->has_new_process);
+    CHECK_EQUAL(0, info->has_cred);
+}
+
+int main(int argc, char** argv)
+{
+    const char* verboseArgv[] = { argv[0], "-v" };
+    return CommandLineTestRunner::RunAllTests(2, verboseArgv);
+}
\ No newline at end of file